@@ -17,6 +17,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 
 // -------------------------------------------------------------------
@@ -32,6 +33,10 @@ typedef enum JsonType
     JsonType_Number,
     JsonType_String,
     JsonType_Boolean,
+
+    /* Array subtypes, homogeneous number arrays packed by JsonParseFlags_PackNumberArrays */
+    JsonType_Int32Array,
+    JsonType_NumberArray,
 } JsonType;
 
 /// JSON error code
@@ -56,6 +61,7 @@ typedef enum JsonError
     JsonError_OutOfMemory,
     JsonError_InvalidValue,
     JsonError_InternalFatal,
+    JsonError_FileUnreadable,
 
 } JsonError;
 
@@ -67,29 +73,199 @@ typedef struct JsonResult
 
     //JsonParser*     parser;
     int32_t         memoryUsage;
+    int32_t         stringMemoryUsage;  // Bytes used in the string buffer, 0 when strings share the main buffer
 } JsonResult;
 
 /// Json parse flags
 typedef enum JsonParseFlags
 {
     JsonParseFlags_None             = 0,
-    JsonParseFlags_SupportComment   = 1 << 0,
+    JsonParseFlags_SupportComment   = 1 << 0,   // Allow // and /* */ comments wherever whitespace is allowed
     JsonParseFlags_NoStrictTopLevel = 1 << 1,
+    JsonParseFlags_PackNumberArrays = 1 << 2,   // Store all-number arrays as int32_t[] or double[] instead of Json[], with LazyNumbers only arrays of int32 integer literals
+    JsonParseFlags_LazyNumbers      = 1 << 3,   // Keep numbers as raw text of the source, read them with JsonGetNumber/JsonGetInt64, PackNumberArrays never drops that text
+    JsonParseFlags_LazyStrings      = 1 << 4,   // Keep string values as slices of the source, read them with JsonCopyString
+    JsonParseFlags_KeySummary       = 1 << 5,   // Keep a bloom filter of the keys of each object/array subtree, used by JsonFindAll
+    JsonParseFlags_UnorderedLines   = 1 << 6,   // JsonParseLines hands records over as soon as they are parsed, from several threads at once
 
     JsonParseFlags_Default          = JsonParseFlags_None,
 } JsonParseFlags;
 
+/// Typed column for JsonExtractColumns
+typedef enum JsonColumnType
+{
+    JsonColumnType_Int32,       // int32_t, numbers that are not an exact int32_t do not match
+    JsonColumnType_Float,       // float
+    JsonColumnType_Double,      // double
+    JsonColumnType_Boolean,     // bool
+    JsonColumnType_String,      // const char*, never NULL for a present empty string, non-empty lazy strings do not match (use Value and JsonCopyString)
+    JsonColumnType_Value,       // Json
+    JsonColumnType_Struct,      // Nested struct of a JsonFieldDesc, struct bindings only
+} JsonColumnType;
+
+/// Field to extract from each object of an array
+typedef struct JsonColumnSpec
+{
+    const char*     name;
+    JsonColumnType  type;
+} JsonColumnSpec;
+
+/// Output of one field: contiguous values, plus a bitmap with bit i set when row i has the field with a matching type
+typedef struct JsonColumn
+{
+    void*           values;     // Row count elements of the column type, missing rows are zeroed, can be NULL
+    uint8_t*        presence;   // (rowCount + 7) / 8 bytes, can be NULL
+} JsonColumn;
+
+#define JSON_MAX_COLUMNS 64
+
+#define JSON_STRUCT_MAX_FIELDS      32
+#define JSON_STRUCT_TABLE_SIZE      128
+
+typedef struct JsonStructDesc JsonStructDesc;
+
+/// Field of a struct binding, usually declared with JSON_FIELD
+typedef struct JsonFieldDesc
+{
+    const char*     name;       // JSON key
+    JsonColumnType  type;       // C type of the field (of the elements for arrays), same set as columns
+    int32_t         offset;     // offsetof the field in the struct, a pointer to the elements for arrays
+    bool            required;   // Decoding fails with JsonError_MissingField when the key is absent
+    int32_t         countOffset;// offsetof the int32_t element count of an array field, -1 for single values
+    JsonStructDesc* desc;       // Binding of JsonColumnType_Struct fields
+} JsonFieldDesc;
+
+/// Struct binding: fields plus a perfect hash of their keys built by JsonStructDescInit
+struct JsonStructDesc
+{
+    const JsonFieldDesc*    fields;
+    int32_t                 fieldCount;
+    int32_t                 size;                           // sizeof the struct, for arrays of it
+
+    uint32_t                seed;
+    int32_t                 shift;                          // 0 until JsonStructDescInit succeeded
+    int8_t                  table[JSON_STRUCT_TABLE_SIZE];  // Field index of each hash slot, -1 when empty
+};
+
+/// X-macro entry: #define MY_FIELDS(FIELD) FIELD(MyStruct, member, "key", Int32, true) ..., then { MY_FIELDS(JSON_FIELD) }
+#define JSON_FIELD(STRUCT, MEMBER, KEY, TYPE, REQUIRED) \
+    { KEY, JsonColumnType_##TYPE, (int32_t)offsetof(STRUCT, MEMBER), REQUIRED, -1, NULL },
+
+/// Nested struct, DESC is the JsonStructDesc of the member type
+#define JSON_FIELD_STRUCT(STRUCT, MEMBER, KEY, DESC, REQUIRED) \
+    { KEY, JsonColumnType_Struct, (int32_t)offsetof(STRUCT, MEMBER), REQUIRED, -1, &(DESC) },
+
+/// Array of TYPE, MEMBER points to the elements and COUNT is their int32_t count (decoded by JsonParseStruct only)
+#define JSON_FIELD_ARRAY(STRUCT, MEMBER, COUNT, KEY, TYPE, REQUIRED) \
+    { KEY, JsonColumnType_##TYPE, (int32_t)offsetof(STRUCT, MEMBER), REQUIRED, (int32_t)offsetof(STRUCT, COUNT), NULL },
+
+/// Array of structs described by DESC (decoded by JsonParseStruct only, not encoded)
+#define JSON_FIELD_STRUCT_ARRAY(STRUCT, MEMBER, COUNT, KEY, DESC, REQUIRED) \
+    { KEY, JsonColumnType_Struct, (int32_t)offsetof(STRUCT, MEMBER), REQUIRED, (int32_t)offsetof(STRUCT, COUNT), &(DESC) },
+
+/// Initializer of a JsonStructDesc from a JsonFieldDesc array
+#define JSON_STRUCT_DESC(STRUCT, FIELDS) { FIELDS, (int32_t)(sizeof(FIELDS) / sizeof((FIELDS)[0])), (int32_t)sizeof(STRUCT), 0, 0, { 0 } }
+
+#ifndef JSON_EVENTS_MAX_DEPTH
+#define JSON_EVENTS_MAX_DEPTH       1024    // Nesting levels of JsonParseEvents, one bit each on the stack
+#endif
+
+#ifndef JSON_VALIDATE_MAX_DEPTH
+#define JSON_VALIDATE_MAX_DEPTH     1024    // Nesting levels of JsonValidate, one bit each on the stack
+#endif
+
+#ifndef JSON_SKIP_MAX_DEPTH
+#define JSON_SKIP_MAX_DEPTH         1024    // Nesting levels of subtrees skipped by JsonParseProjected and JsonParseStruct, one bit each on the stack
+#endif
+
+#ifndef JSON_MAX_THREADS
+#define JSON_MAX_THREADS            64      // Workers of the parallel parsers, the calling thread included
+#endif
+
+#define JSON_PATH_MAX_DEPTH         16
+#define JSON_PATH_MAX_NAMES         128     // Bytes of all keys of one path
+#define JSON_PROJECTION_MAX_PATHS   16
+
+#define JSON_PATH_KEY               -1      // JsonPathSegment.index of a member key
+#define JSON_PATH_ANY               -2      // JsonPathSegment.index of `*` and `[*]`, matches any member or element
+
+/// One step of a path: a member key or an array index
+typedef struct JsonPathSegment
+{
+    int32_t         index;      // Array index, JSON_PATH_KEY or JSON_PATH_ANY
+    int32_t         keyOffset;  // Member key in JsonPath.names, JSON Pointer index tokens keep their key too
+    int32_t         keyLength;
+} JsonPathSegment;
+
+/// Compiled path, self-contained so it can be copied and reused
+typedef struct JsonPath
+{
+    int32_t         count;
+    int32_t         namesLength;
+    JsonPathSegment segments[JSON_PATH_MAX_DEPTH];
+    char            names[JSON_PATH_MAX_NAMES];
+} JsonPath;
+
+/// Set of paths for JsonParseProjected
+typedef struct JsonProjection
+{
+    int32_t         count;
+    JsonPath        paths[JSON_PROJECTION_MAX_PATHS];
+} JsonProjection;
+
+#define JSON_QUERY_MAX_FILTERS      4
+#define JSON_QUERY_MAX_FILTER_KEYS  4
+
+#define JSON_PATH_FILTER            -3      // JsonPathSegment.index of `[?(...)]` in a query, keyOffset is the filter index
+
+/// Comparison of a query filter
+typedef enum JsonQueryOp
+{
+    JsonQueryOp_Exists,         // [?(@.field)]
+    JsonQueryOp_Equal,
+    JsonQueryOp_NotEqual,
+    JsonQueryOp_Less,
+    JsonQueryOp_LessEqual,
+    JsonQueryOp_Greater,
+    JsonQueryOp_GreaterEqual,
+} JsonQueryOp;
+
+/// Compiled `[?(@.a.b op literal)]`, ordering ops only take number literals
+typedef struct JsonQueryFilter
+{
+    JsonQueryOp     op;
+    int32_t         keyCount;                               // Member keys from the element, 0 tests the element itself
+    int32_t         keyOffsets[JSON_QUERY_MAX_FILTER_KEYS]; // In JsonQuery.path.names
+    int32_t         keyLengths[JSON_QUERY_MAX_FILTER_KEYS];
+
+    JsonType        literalType;                            // Number, String, Boolean or Null
+    double          literalNumber;
+    bool            literalBoolean;
+    int32_t         literalOffset;                          // String literal in JsonQuery.path.names
+    int32_t         literalLength;
+} JsonQueryFilter;
+
+/// Compiled query plan for JsonQueryRun
+typedef struct JsonQuery
+{
+    JsonPath        path;
+    int32_t         filterCount;
+    JsonQueryFilter filters[JSON_QUERY_MAX_FILTERS];
+} JsonQuery;
+
 typedef struct Json             Json;
 //typedef struct JsonParser       JsonParser;
 typedef struct JsonObjectMember JsonObjectMember;
+typedef struct JsonHandler      JsonHandler;
 
 struct Json
 {
     JsonType                type;       // Type of value: number, boolean, string, array, object
-    int32_t                 length;     // Length of value, always 1 on primitive types, UTF8 string length
+    int32_t                 length;     // Length of value, 0 on null, boolean and decoded numbers, UTF8 string length in bytes (negative raw length for escaped lazy strings), negative raw text length of lazy numbers
     union
     {
         double              number;
+        const char*         rawNumber;      // JsonType_Number with length < 0, slice of the source, not null-terminated
         bool                boolean;
 
         const char*         string;
@@ -97,6 +273,9 @@ struct Json
         Json*               array;
 
         JsonObjectMember*   object;
+
+        const int32_t*      int32Array;     // JsonType_Int32Array
+        const double*       numberArray;    // JsonType_NumberArray
     };
 };
 
@@ -106,6 +285,32 @@ struct JsonObjectMember
     Json                    value;
 };
 
+/// Events of JsonParseEvents, any callback can be NULL, return false to stop parsing
+/// Keys and strings are lazy strings (see JsonParseFlags_LazyStrings), numbers follow JsonParseFlags_LazyNumbers
+struct JsonHandler
+{
+    bool (*onStartObject)(void* user);
+    bool (*onEndObject)(void* user);
+    bool (*onStartArray)(void* user);
+    bool (*onEndArray)(void* user);
+
+    bool (*onKey)(void* user, const Json name);
+    bool (*onString)(void* user, const Json value);
+    bool (*onNumber)(void* user, const Json value);
+    bool (*onBoolean)(void* user, bool value);
+    bool (*onNull)(void* user);
+};
+
+/// Receives the records of JsonParseLines, offset is where the line starts in the input
+/// result->error tells whether the line parsed, the value and the message are valid until the callback returns
+/// Return false to stop
+typedef bool (*JsonLineHandler)(void* user, int64_t offset, const Json value, const JsonResult* result);
+
+/// Receives the documents of JsonParseFiles, index is the position of the file in paths
+/// Called from the worker threads, several at once. The value and the message are valid until the callback returns
+/// Return false to stop
+typedef bool (*JsonFileHandler)(void* user, int32_t index, const Json value, const JsonResult* result);
+
 // -------------------------------------------------------------------
 // Constants
 // -------------------------------------------------------------------
@@ -114,9 +319,24 @@ struct JsonObjectMember
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 #endif
 
-JSON_CONST Json JSON_NULL     = { JsonType_Null   , 0             };
-JSON_CONST Json JSON_TRUE     = { JsonType_Boolean, 0, { true  }  };
-JSON_CONST Json JSON_FALSE    = { JsonType_Boolean, 0, { false }  };
+// The union starts with number, so booleans need a designated initializer
+#if !defined(__cplusplus) || __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+JSON_CONST Json JSON_NULL     = { JsonType_Null   , 0                       };
+JSON_CONST Json JSON_TRUE     = { JsonType_Boolean, 0, { .boolean = true  } };
+JSON_CONST Json JSON_FALSE    = { JsonType_Boolean, 0, { .boolean = false } };
+#else
+// C++ before C++20 has none, and cannot switch the union member in a constant expression
+static inline Json JsonMakeBoolean(bool value)
+{
+    Json result = { JsonType_Boolean, 0 };
+    result.boolean = value;
+    return result;
+}
+
+JSON_CONST Json JSON_NULL     = { JsonType_Null   , 0 };
+static const Json JSON_TRUE   = JsonMakeBoolean(true);
+static const Json JSON_FALSE  = JsonMakeBoolean(false);
+#endif
 
 #if defined(__GNUC__)
 #pragma GCC diagnostic warning "-Wmissing-field-initializers"
@@ -127,16 +347,159 @@ JSON_CONST Json JSON_FALSE    = { JsonType_Boolean, 0, { false }  };
 // -------------------------------------------------------------------
 
 JSON_API JsonResult JsonParse(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, void* buffer, int32_t bufferSize, Json* outValue);
+
+/// Parse with strings byte-packed into stringBuffer, so buffer only holds the nodes
+JSON_API JsonResult JsonParseWithStringBuffer(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, void* buffer, int32_t bufferSize, void* stringBuffer, int32_t stringBufferSize, Json* outValue);
 //JSON_API JsonResult JsonContinueParse(JsonParser* parser, Json* outValue);
 
+/// Compile a dotted path like `defs.layers[3].gridSize` (optional `$.` root, `*` and `[*]` wildcards for projections)
+JSON_API JsonError  JsonPathCompile(const char* path, JsonPath* outPath);
+
+/// Compile an RFC 6901 JSON Pointer like `/defs/layers/3/gridSize`, with `~0` and `~1` escapes
+JSON_API JsonError  JsonPointerCompile(const char* pointer, JsonPath* outPath);
+
+/// Follow a compiled path from root, JsonError_MissingField when a step does not exist
+/// Wildcards are not resolved (JsonError_InvalidValue), use a projection or a query for them
+JSON_API JsonError  JsonPathResolve(const Json root, const JsonPath* path, Json* outResult);
+
+/// Build the key dispatch of a struct binding and of its nested bindings, JsonError_InvalidValue on duplicated keys or too many fields
+JSON_API JsonError  JsonStructDescInit(JsonStructDesc* desc);
+
+/// Decode an object in one pass over its members, fields without their key are zeroed, other struct memory is untouched
+/// JsonError_WrongType when a key holds another type (null is missing for optional fields), JsonError_MissingField for absent required keys
+/// Array fields need an arena, they are cleared with JsonError_InvalidValue here, use JsonParseStruct
+JSON_API JsonError  JsonDecodeStruct(const Json object, const JsonStructDesc* desc, void* outStruct);
+
+/// Object of the fields of value, members gets one entry per field and strings reference the struct
+/// Nested structs are objects whose members follow the ones of their parent in members
+/// Int32, Double and Value array fields are views over their elements, other array fields fail with JsonError_InvalidValue unless NULL (null)
+JSON_API JsonError  JsonEncodeStruct(const void* value, const JsonStructDesc* desc, JsonObjectMember* members, int32_t memberCapacity, Json* outObject);
+
+/// Parse an object straight into outStruct without building Json nodes, only decoded strings, arrays and Value fields go to buffer
+/// Unknown keys are skipped like unselected subtrees of JsonParseProjected, type errors stop parsing with JsonError_WrongType
+/// Missing and null optional fields are zeroed, so a NULL string is absent and an empty one is ""
+JSON_API JsonResult JsonParseStruct(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonStructDesc* desc, void* buffer, int32_t bufferSize, void* outStruct);
+
+/// Compile a JSONPath subset: `$`, `.key`, `['key']`, `[n]`, `*`, `[*]` and filters `[?(@.a.b op literal)]`
+/// op is one of == != < <= > >= (or none to test existence), literal is a number, 'string', true, false or null
+JSON_API JsonError  JsonQueryCompile(const char* query, JsonQuery* outQuery);
+
+/// Run a compiled query from root, writes at most maxResults matches in document order, returns the total match count
+JSON_API int32_t    JsonQueryRun(const JsonQuery* query, const Json root, Json* outResults, int32_t maxResults);
+
+/// Compile dotted paths like `defs.tilesets[*].uid`, `levels[0]` or `*` into a projection
+JSON_API JsonError  JsonProjectionCompile(const char* const* paths, int32_t pathCount, JsonProjection* outProjection);
+
+/// Parse only the subtrees selected by the projection, everything else is skipped without allocation
+/// Skipped subtrees are only checked for matching brackets (up to JSON_SKIP_MAX_DEPTH levels) and quotes, unselected array elements before a selected index are null
+JSON_API JsonResult JsonParseProjected(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonProjection* projection, void* buffer, int32_t bufferSize, Json* outValue);
+
+/// Parse without building a DOM, emitting events straight from the tokenizer (constant memory, no buffer)
+/// Nesting deeper than JSON_EVENTS_MAX_DEPTH fails with JsonError_OutOfMemory
+/// The message lives in thread local storage, it is valid until the next JsonParseEvents call on the same thread (any thread with JSON_NO_THREADS)
+JSON_API JsonResult JsonParseEvents(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonHandler* handler, void* user);
+
+/// Check grammar and UTF-8 of strings without allocating, up to JSON_VALIDATE_MAX_DEPTH levels of nesting
+/// Stricter than JsonParse: strict RFC 8259 plus UTF-8, so raw control characters in strings, malformed UTF-8 and a NUL after the value fail here only
+/// outErrorOffset (can be NULL) receives the byte offset of the first error
+JSON_API JsonError  JsonValidate(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, int32_t* outErrorOffset);
+
+/// Name of the scanning kernels picked for the running CPU: "scalar", "sse4.2", "avx2" or "avx512"
+/// The JSON_FORCE_KERNEL environment variable picks one of them instead, when the CPU supports it
+JSON_API const char* JsonKernelName(void);
+
+/// Parse newline-delimited JSON (NDJSON, JSON Lines) on threadCount threads, the calling thread included (0 for one per CPU)
+/// buffer is split into one arena per thread (at most 2 GB each), each arena must hold the largest record. Blank lines are skipped
+/// Records reach handler in input order, one at a time, unless JsonParseFlags_UnorderedLines is given
+/// Returns JsonError_InvalidValue when handler stopped the parsing, JsonError_OutOfMemory when buffer is too small to be split
+JSON_API JsonError  JsonParseLines(const char* input, int64_t inputLength, JsonParseFlags flags, int32_t threadCount, JsonLineHandler handler, void* user, void* buffer, int64_t bufferSize);
+
+/// Parse one large document whose top level is an array or object on threadCount threads, the calling thread included (0 for one per CPU)
+/// The top level items are split between the threads, each parses into its own slice of buffer, so the document may be larger than 2 GB
+/// Small documents, documents with comments and other top level values are parsed by JsonParse. memoryUsage stops at INT32_MAX
+JSON_API JsonResult JsonParseParallel(const char* jsonCode, int64_t jsonCodeLength, JsonParseFlags flags, int32_t threadCount, void* buffer, int64_t bufferSize, Json* outValue);
+
+/// Read and parse many files on threadCount threads, the calling thread included (0 for one per CPU), largest files first
+/// buffer holds the file list and one arena per thread, reused for each of its files. Workers that run out of files take some from the others
+/// Every file reaches handler, unreadable ones with JsonError_FileUnreadable. Returns JsonError_InvalidValue when handler stopped the parsing
+JSON_API JsonError  JsonParseFiles(const char* const* paths, int32_t count, JsonParseFlags flags, int32_t threadCount, JsonFileHandler handler, void* user, void* buffer, int64_t bufferSize);
+
 JSON_API bool       JsonEquals(const Json a, const Json b);
 
 JSON_API bool       JsonFind(const Json parent, const char* name, Json* outResult);
 JSON_API JsonError  JsonFindWithType(const Json parent, const char* name, JsonType type, Json* outResult);
 
+/// Values of every member named name at any depth (`$..name`) in document order, returns the total count
+/// Pass the flags root was parsed with, subtrees are pruned by their key summary with JsonParseFlags_KeySummary
+JSON_API int32_t    JsonFindAll(const Json root, const char* name, JsonParseFlags flags, Json* outResults, int32_t maxResults);
+
+/// Convert the first count elements of a number array (any subtype) into outValues
+/// JsonError_WrongType when an element is not a number, JsonError_MissingField when the array is shorter than count
+/// JsonError_InvalidValue when count is negative, nothing is written then
+/// JsonArrayToInt32 gives JsonError_InvalidValue when an element is not an exact int32_t, outValues is then filled up to that element
+JSON_API JsonError  JsonArrayToInt32(const Json array, int32_t* outValues, int32_t count);
+JSON_API JsonError  JsonArrayToFloat(const Json array, float* outValues, int32_t count);
+JSON_API JsonError  JsonArrayToDouble(const Json array, double* outValues, int32_t count);
+
+/// Walk an array of objects once, writing each field of specs into its own column (structure-of-arrays)
+/// JsonError_InvalidValue for more than JSON_MAX_COLUMNS specs or a JsonColumnType_Struct spec
+JSON_API JsonError  JsonExtractColumns(const Json array, const JsonColumnSpec* specs, int32_t specCount, JsonColumn* columns);
+
 static inline bool JsonValidType(const Json json)
 {
-    return json.type >= JsonType_Null && json.type <= JsonType_Boolean;
+    return json.type >= JsonType_Null && json.type <= JsonType_NumberArray;
+}
+
+/// Number value, lazy numbers (length < 0) are converted from their raw text on each call, any other length reads .number
+JSON_API double     JsonGetNumber(const Json value);
+
+/// Integer value, exact for integer text of lazy numbers, false when the number is not an int64
+JSON_API bool       JsonGetInt64(const Json value, int64_t* outResult);
+
+/// Decoded, null-terminated copy of a string, returns the full decoded length (like snprintf)
+/// Lazy strings are not null-terminated (length >= 0) or still hold their escapes (length < 0, -length raw bytes)
+JSON_API int32_t    JsonCopyString(const Json value, char* buffer, int32_t bufferSize);
+
+/// Any array subtype: Json[], int32_t[] or double[]
+static inline bool JsonIsArray(const Json json)
+{
+    return json.type == JsonType_Array || json.type == JsonType_Int32Array || json.type == JsonType_NumberArray;
+}
+
+/// Number element of any array subtype, 0 when the element is not a number
+static inline double JsonArrayGetNumber(const Json array, int32_t index)
+{
+    switch (array.type)
+    {
+    case JsonType_Int32Array:
+        return array.int32Array[index];
+
+    case JsonType_NumberArray:
+        return array.numberArray[index];
+
+    case JsonType_Array:
+        return JsonGetNumber(array.array[index]);
+
+    default:
+        return 0;
+    }
+}
+
+/// Element of any array subtype, packed elements are returned as JsonType_Number values
+static inline Json JsonArrayGet(const Json array, int32_t index)
+{
+    if (array.type == JsonType_Array)
+    {
+        return array.array[index];
+    }
+
+    Json result = JSON_NULL;
+    if (array.type == JsonType_Int32Array || array.type == JsonType_NumberArray)
+    {
+        result.type   = JsonType_Number;
+        result.number = JsonArrayGetNumber(array, index);
+    }
+    return result;
 }
 
 /* END OF EXTERN "C" */
@@ -160,7 +523,6 @@ static inline bool JsonValidType(const Json json)
 // -------------------------------------------------------------------
 
 #include <math.h>
-#include <ctype.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <stddef.h>
@@ -169,6 +531,22 @@ static inline bool JsonValidType(const Json json)
 #include <assert.h>
 #include <setjmp.h>
 #include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// Threads, windows.h is trimmed since it leaks into the translation unit that includes the implementation
+#if defined(_WIN32) && !defined(JSON_NO_THREADS)
+#  ifndef WIN32_LEAN_AND_MEAN
+#     define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#     define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif !defined(JSON_NO_THREADS)
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
 
 // -------------------------------------------------------------------
 // Compiler options
@@ -190,1208 +568,6768 @@ static inline bool JsonValidType(const Json json)
 #  endif
 #endif
 
+#ifndef JSON_THREAD_LOCAL
+#  if defined(JSON_NO_THREADS)
+#     define JSON_THREAD_LOCAL
+#  elif defined(_MSC_VER)
+#     define JSON_THREAD_LOCAL __declspec(thread)
+#  elif defined(__GNUC__) || defined(__clang__)
+#     define JSON_THREAD_LOCAL __thread
+#  elif defined(__cplusplus) && __cplusplus >= 201103L
+#     define JSON_THREAD_LOCAL thread_local
+#  elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#     define JSON_THREAD_LOCAL _Thread_local
+#  else
+#     error "No thread local storage keyword for this compiler, define JSON_THREAD_LOCAL, or JSON_NO_THREADS for single threaded use"
+#  endif
+#endif
+
 #ifndef JSON_ASSERT
 #define JSON_ASSERT(cond, msg, ...) assert((cond) && (msg))
 #endif
 
 // -----------------------------------------------------------------------
-// Utility
+// Character classes and scanning kernels
 // -----------------------------------------------------------------------
 
-typedef struct JsonAllocator
+/* Character classes of the tokenizer, looked up by byte so the scan does not depend on the C locale */
+typedef enum JsonCharClass
 {
-    uint8_t*        buffer;
-    int32_t         length;
+    JsonCharClass_Space      = 1 << 0,  /* Whitespace allowed by RFC 8259: tab, line feed, carriage return, space */
+    JsonCharClass_Digit      = 1 << 1,
+    JsonCharClass_Hex        = 1 << 2,
+    JsonCharClass_Alpha      = 1 << 3,
+    JsonCharClass_Structural = 1 << 4,  /* Bytes that matter while skipping a container: quotes, brackets, braces, slash, line feed */
+} JsonCharClass;
+
+static const uint8_t JsonParser_CharClasses[256] = {
+    /* 0x00 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  1, 17,  0,  0,  1,  0,  0,
+    /* 0x10 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    /* 0x20 */  1,  0, 16,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 16,
+    /* 0x30 */  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  0,  0,  0,  0,  0,  0,
+    /* 0x40 */  0, 12, 12, 12, 12, 12, 12,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+    /* 0x50 */  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, 16,  0, 16,  0,  0,
+    /* 0x60 */  0, 12, 12, 12, 12, 12, 12,  8,  8,  8,  8,  8,  8,  8,  8,  8,
+    /* 0x70 */  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, 16,  0, 16,  0,  0,
+    /* 0x80 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    /* 0x90 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    /* 0xA0 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    /* 0xB0 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    /* 0xC0 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    /* 0xD0 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    /* 0xE0 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    /* 0xF0 */  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
 
-    uint8_t*        lowerMarker;
-    uint8_t*        upperMarker;
-} JsonAllocator;
+#define JsonParser_IsCharClass(c, cls) ((JsonParser_CharClasses[(uint8_t)(c)] & (cls)) != 0)
 
-static int32_t JsonAllocator_BlockSize(int32_t size)
+/* Hot scanning loops, picked once at first use from the instruction sets the running CPU supports.
+   Each scan returns the length of the prefix that holds none of its stop bytes. A scan may stop early
+   on another byte, callers handle whatever byte they land on and scan again. */
+typedef struct JsonKernels
 {
-	int32_t alignment = sizeof(Json);
-	int32_t misalign = size & (alignment - 1);
-	int32_t adjustment = (misalign != 0) * (alignment - misalign);
-	return size + adjustment;
-}
+    const char* name;
 
-static bool JsonAllocator_Init(JsonAllocator* allocator, void* buffer, int32_t bufferSize)
-{
-    if (buffer && bufferSize > 0)
-    {
-		allocator->buffer = (uint8_t*)buffer;
-		allocator->length = bufferSize;
+    /* Whitespace run, also counts its line feeds and the offset of the last one (-1 when none) */
+    int32_t     (*skipSpace)(const uint8_t* ptr, int32_t length, int32_t* outNewLines, int32_t* outLastNewLine);
 
-		// Aligned buffer for cache-friendly processing
-		const int32_t	alignment	= sizeof(Json);
-		const int32_t	mask		= alignment - 1;
+    /* String content, stops at quote, backslash, carriage return, line feed and NUL */
+    int32_t     (*scanString)(const uint8_t* ptr, int32_t length);
 
-		const uintptr_t address		= (uintptr_t)buffer;
-		const int32_t	misalign	= address & mask;
-		const int32_t	adjustment	= (misalign != 0) * (alignment - misalign);
+    /* Container content while skipping a value, stops at quotes, brackets, braces, slash and line feed */
+    int32_t     (*scanStructural)(const uint8_t* ptr, int32_t length);
 
-		buffer = (void*)(address + adjustment);
-		bufferSize = JsonAllocator_BlockSize(bufferSize - adjustment);
+    /* String content while validating, stops at quote, backslash, control characters and non-ASCII bytes */
+    int32_t     (*scanText)(const uint8_t* ptr, int32_t length);
+} JsonKernels;
 
-        allocator->lowerMarker = (uint8_t*)buffer;
-        allocator->upperMarker = (uint8_t*)buffer + bufferSize;
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(_MSC_VER) || defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)) && !defined(JSON_NO_SIMD)
+#  define JSON_KERNELS_X86 1
+#  if defined(_MSC_VER) && !defined(__clang__)
+#     include <intrin.h>
+#     define JSON_TARGET(isa)
+#  else
+#     include <cpuid.h>
+#     define JSON_TARGET(isa) __attribute__((target(isa)))
+#  endif
+#  include <immintrin.h>
+#else
+#  define JSON_KERNELS_X86 0
+#endif
 
-        return true;
-    }
+JSON_INLINE int32_t JsonKernel_TrailingZeros(uint64_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int32_t)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
 
-    return false;
+JSON_INLINE int32_t JsonKernel_HighestBit(uint64_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return (int32_t)index;
+#else
+    return 63 - __builtin_clzll(mask);
+#endif
 }
 
-static int32_t JsonAllocator_RemainSize(JsonAllocator* allocator)
+JSON_INLINE int32_t JsonKernel_PopCount(uint64_t mask)
 {
-	int32_t remain = (int32_t)(allocator->upperMarker - allocator->lowerMarker);
-	return  remain;
+    int32_t count = 0;
+    for (; mask; mask &= mask - 1)
+    {
+        count++;
+    }
+    return count;
 }
 
-static bool JsonAllocator_CanAlloc(JsonAllocator* allocator, int32_t size)
+/* Account the line feeds of a block mask at offset, only bits below count are part of the run */
+JSON_INLINE void JsonKernel_CountLines(uint64_t lines, int32_t offset, int32_t count, int32_t* newLines, int32_t* lastNewLine)
 {
-    int32_t remain = JsonAllocator_RemainSize(allocator);
-    return  remain >= size;
+    lines &= count < 64 ? (1ull << count) - 1 : ~0ull;
+    if (lines)
+    {
+        *newLines   += JsonKernel_PopCount(lines);
+        *lastNewLine = offset + JsonKernel_HighestBit(lines);
+    }
 }
 
-static void JsonAllocator_FreeLower(JsonAllocator* allocator, void* buffer, int32_t size)
+/* 8 bytes at once: any quote, backslash or control character, may report false positives past the first hit */
+static bool JsonKernel_HasControl(uint64_t word)
 {
-	const int32_t blockSize = JsonAllocator_BlockSize(size);
-	void* lastBuffer = allocator->lowerMarker - blockSize;
-	if (lastBuffer == buffer)
-	{
-		allocator->lowerMarker = lastBuffer;
-	}
+    const uint64_t ones      = 0x0101010101010101ull;
+    const uint64_t highs     = 0x8080808080808080ull;
+    const uint64_t quote     = word ^ (ones * '"');
+    const uint64_t backslash = word ^ (ones * '\\');
+
+    return ((((word - ones * 0x20) & ~word) | ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash)) & highs) != 0;
 }
 
-static void* JsonAllocator_AllocLower(JsonAllocator* allocator, void* oldBuffer, int32_t oldSize, int32_t newSize)
+/* Same as JsonKernel_HasControl, non-ASCII bytes are reported too */
+static bool JsonKernel_HasSpecial(uint64_t word)
 {
-    JsonAllocator_FreeLower(allocator, oldBuffer, oldSize);
+    return (word & 0x8080808080808080ull) != 0 || JsonKernel_HasControl(word);
+}
 
-    if (newSize <= 0)
+/* Continue a whitespace run from offset i one byte at a time, line feeds are counted with absolute offsets */
+static int32_t JsonKernel_SkipSpaceFrom(const uint8_t* ptr, int32_t i, int32_t length, int32_t* outNewLines, int32_t* outLastNewLine)
+{
+    for (; i < length && JsonParser_IsCharClass(ptr[i], JsonCharClass_Space); i++)
     {
-        return NULL;
+        if (ptr[i] == '\n')
+        {
+            (*outNewLines)++;
+            *outLastNewLine = i;
+        }
     }
+    return i;
+}
 
-	const int32_t blockSize = JsonAllocator_BlockSize(newSize);
-    if (JsonAllocator_CanAlloc(allocator, blockSize))
+/* @funcdef: JsonKernel_SkipSpaceScalar */
+static int32_t JsonKernel_SkipSpaceScalar(const uint8_t* ptr, int32_t length, int32_t* outNewLines, int32_t* outLastNewLine)
+{
+    return JsonKernel_SkipSpaceFrom(ptr, 0, length, outNewLines, outLastNewLine);
+}
+
+/* @funcdef: JsonKernel_ScanStringScalar */
+static int32_t JsonKernel_ScanStringScalar(const uint8_t* ptr, int32_t length)
+{
+    int32_t  i = 0;
+    uint64_t word;
+    while (length - i >= 8 && (memcpy(&word, ptr + i, sizeof(word)), !JsonKernel_HasControl(word)))
     {
-        void* result = allocator->lowerMarker;
-        allocator->lowerMarker += blockSize;
-        return result;
+        i += 8;
     }
 
-    return NULL;
+    while (i < length && ptr[i] != '"' && ptr[i] != '\\' && ptr[i] >= 0x20)
+    {
+        i++;
+    }
+    return i;
 }
 
-static void JsonAllocator_FreeUpper(JsonAllocator* allocator, void* buffer, int32_t size)
+/* @funcdef: JsonKernel_ScanStructuralScalar */
+static int32_t JsonKernel_ScanStructuralScalar(const uint8_t* ptr, int32_t length)
 {
-    void* lastBuffer = allocator->upperMarker;
-    if (lastBuffer == buffer)
+    int32_t i = 0;
+    while (i < length && !JsonParser_IsCharClass(ptr[i], JsonCharClass_Structural))
     {
-		const int32_t blockSize = JsonAllocator_BlockSize(size);
-        allocator->upperMarker += blockSize;
+        i++;
     }
+    return i;
 }
 
-static void* JsonAllocator_AllocUpper(JsonAllocator* allocator, void* oldBuffer, int32_t oldSize, int32_t newSize)
+/* @funcdef: JsonKernel_ScanTextScalar */
+static int32_t JsonKernel_ScanTextScalar(const uint8_t* ptr, int32_t length)
 {
-    JsonAllocator_FreeUpper(allocator, oldBuffer, oldSize);
-
-    if (newSize <= 0)
+    int32_t  i = 0;
+    uint64_t word;
+    while (length - i >= 8 && (memcpy(&word, ptr + i, sizeof(word)), !JsonKernel_HasSpecial(word)))
     {
-        return NULL;
+        i += 8;
     }
 
-	const int32_t blockSize = JsonAllocator_BlockSize(newSize);
-    if (JsonAllocator_CanAlloc(allocator, blockSize))
+    while (i < length && ptr[i] != '"' && ptr[i] != '\\' && ptr[i] >= 0x20 && ptr[i] < 0x80)
     {
-        allocator->upperMarker -= blockSize;
-        return allocator->upperMarker;
+        i++;
     }
-
-    return NULL;
+    return i;
 }
 
-/* 
-JsonArray: dynamic, scalable array
-@note: internal only
-*/
-typedef struct JsonArray
-{
-    int32_t size;
-    int32_t count;
-    Json    buffer[];
-} JsonArray;
+static const JsonKernels JsonKernels_Scalar = {
+    "scalar",
+    JsonKernel_SkipSpaceScalar,
+    JsonKernel_ScanStringScalar,
+    JsonKernel_ScanStructuralScalar,
+    JsonKernel_ScanTextScalar,
+};
 
-#define JsonArray_GetHeader(a)              ((JsonArray*)(a) - 1)
-#define JsonArray_Init()                    NULL
-#define JsonArray_Free(a, alloc)            JsonAllocator_FreeUpper(alloc, a ? JsonArray_GetHeader(a) : NULL, JsonArray_GetSize(a) * sizeof((a)[0]))
-#define JsonArray_GetSize(a)                ((a) ? JsonArray_GetHeader(a)->size  : 0)
-#define JsonArray_GetCount(a)               ((a) ? JsonArray_GetHeader(a)->count : 0)
-#define JsonArray_GetAllocMemory(a)         (sizeof(JsonArray) + JsonArray_GetSize(a) * sizeof(*(a)))
-#define JsonArray_GetUsageMemory(a)         (sizeof(JsonArray) + JsonArray_GetCount(a) * sizeof(*(a)))
-#define JsonArray_Push(a, v, alloc)         (JsonArray_EnsureSize(a, JsonArray_GetCount(a) + 1, alloc) ? ((void)((a)[JsonArray_GetHeader(a)->count++] = v), 1) : 0)
-#define JsonArray_Pop(a, v, alloc)          ((a)[--JsonArray_GetHeader(a)->count]);
-#define JsonArray_EnsureSize(a, n, alloc)   ((!(a) || JsonArray_GetSize(a) < (n)) ? (*((void**)&(a))=JsonArray_Grow(a, n + 1, sizeof((a)[0]), alloc)) != NULL : 1)
-#define JsonArray_Clear(a)                  ((a) ? (void)(JsonArray_GetHeader(a)->count = 0) : (void)0)
-#define JsonArray_Clone(a, alloc)           ((a) ? memcpy(JsonArray_Grow(0, JsonArray_GetCount(a), sizeof((a)[0]), alloc), JsonArray_GetHeader(a), JsonArray_GetUsageMemory(a)) : NULL)
+/* Builds without vector paths call the scalar loops directly, so the compiler can inline them */
+#if JSON_KERNELS_X86
+#  define JsonKernels_Call(kernels, scan) ((kernels)->scan)
+#else
+#  define JsonKernels_Call(kernels, scan) ((void)(kernels), JsonKernels_Scalar.scan)
+#endif
 
-JSON_INLINE void* JsonArray_Grow(void* array, int32_t reqsize, int32_t elemsize, JsonAllocator* allocator)
-{
-    assert(elemsize > 0);
-    assert(allocator != NULL);
+#if JSON_KERNELS_X86
 
-    JsonArray*  raw   = array ? JsonArray_GetHeader(array) : NULL;
-    int32_t     size  = JsonArray_GetSize(array);
-    int32_t     count = JsonArray_GetCount(array);
+/* SSE4.2: the string compare instructions match a whole set of bytes against a 16 byte block */
+#define JSON_SSE42_ANY      (_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT)
+#define JSON_SSE42_RANGES   (_SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT)
 
-    if (size >= reqsize)
-    {
-        return array;
-    }
+/* @funcdef: JsonKernel_SkipSpaceSSE42 */
+JSON_TARGET("sse4.2")
+static int32_t JsonKernel_SkipSpaceSSE42(const uint8_t* ptr, int32_t length, int32_t* outNewLines, int32_t* outLastNewLine)
+{
+    const __m128i spaces = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
 
-    int32_t newSize = size;
-    while (newSize < reqsize)
+    int32_t i = 0;
+    for (; length - i >= 16; i += 16)
     {
-        newSize += 32;
+        const __m128i block = _mm_loadu_si128((const __m128i*)(ptr + i));
+        const int32_t count = _mm_cmpestri(spaces, 4, block, 16, JSON_SSE42_ANY | _SIDD_NEGATIVE_POLARITY);
+
+        JsonKernel_CountLines((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))), i, count, outNewLines, outLastNewLine);
+        if (count < 16)
+        {
+            return i + count;
+        }
     }
 
-    JsonArray* newArray = (JsonArray*)JsonAllocator_AllocUpper(allocator, raw, sizeof(JsonArray) + size * elemsize, sizeof(JsonArray) + newSize * elemsize);
-    if (newArray)
-    {
-        newArray->size  = newSize;
-        newArray->count = count;
+    return JsonKernel_SkipSpaceFrom(ptr, i, length, outNewLines, outLastNewLine);
+}
 
-        if (raw && count > 0)
+/* Offset of the first byte of set, length rounded down to whole blocks when there is none */
+JSON_TARGET("sse4.2")
+static int32_t JsonKernel_ScanAnySSE42(const uint8_t* ptr, int32_t length, const __m128i set, int32_t setLength)
+{
+    int32_t i = 0;
+    for (; length - i >= 16; i += 16)
+    {
+        const int32_t index = _mm_cmpestri(set, setLength, _mm_loadu_si128((const __m128i*)(ptr + i)), 16, JSON_SSE42_ANY);
+        if (index < 16)
         {
-            memcpy(newArray->buffer, raw->buffer, count * elemsize);
+            return i + index;
         }
-
-        return newArray->buffer;
     }
-    else
+    return i;
+}
+
+/* @funcdef: JsonKernel_ScanStringSSE42 */
+JSON_TARGET("sse4.2")
+static int32_t JsonKernel_ScanStringSSE42(const uint8_t* ptr, int32_t length)
+{
+    const __m128i set = _mm_setr_epi8('"', '\\', '\r', '\n', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const int32_t i   = JsonKernel_ScanAnySSE42(ptr, length, set, 5);
+    return i + JsonKernel_ScanStringScalar(ptr + i, length - i);
+}
+
+/* @funcdef: JsonKernel_ScanStructuralSSE42 */
+JSON_TARGET("sse4.2")
+static int32_t JsonKernel_ScanStructuralSSE42(const uint8_t* ptr, int32_t length)
+{
+    const __m128i set = _mm_setr_epi8('"', '{', '}', '[', ']', '/', '\n', 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const int32_t i   = JsonKernel_ScanAnySSE42(ptr, length, set, 7);
+    return i + JsonKernel_ScanStructuralScalar(ptr + i, length - i);
+}
+
+/* @funcdef: JsonKernel_ScanTextSSE42 */
+JSON_TARGET("sse4.2")
+static int32_t JsonKernel_ScanTextSSE42(const uint8_t* ptr, int32_t length)
+{
+    const __m128i ranges = _mm_setr_epi8(0, 0x1F, '"', '"', '\\', '\\', (char)0x80, (char)0xFF, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    int32_t i = 0;
+    for (; length - i >= 16; i += 16)
     {
-        return NULL;
+        const int32_t index = _mm_cmpestri(ranges, 8, _mm_loadu_si128((const __m128i*)(ptr + i)), 16, JSON_SSE42_RANGES);
+        if (index < 16)
+        {
+            return i + index;
+        }
     }
+
+    return i + JsonKernel_ScanTextScalar(ptr + i, length - i);
 }
 
-/*
-JsonTempArray: memory-wise array for containing parsing value
-@note: internal only 
-*/
-#define JsonTempArray(T, CAPACITY)                  \
-    struct {                                        \
-        T*      array;                              \
-        int32_t count;                              \
-        T       buffer[CAPACITY];                   \
-    }
+static const JsonKernels JsonKernels_SSE42 = {
+    "sse4.2",
+    JsonKernel_SkipSpaceSSE42,
+    JsonKernel_ScanStringSSE42,
+    JsonKernel_ScanStructuralSSE42,
+    JsonKernel_ScanTextSSE42,
+};
 
-#define JsonTempArray_Init(a)             { a, 0 }
-#define JsonTempArray_Free(a, alloc)      JsonArray_Free((a)->array, alloc)
-#define JsonTempArray_Push(a, v, alloc)   ((a)->count >= (int32_t)(sizeof((a)->buffer) / sizeof((a)->buffer[0])) ? JsonArray_Push((a)->array, v, alloc) : ((a)->buffer[(a)->count++] = v, 1))
-#define JsonTempArray_GetCount(a)         ((a)->count + JsonArray_GetCount((a)->array))
-#define JsonTempArray_ToBuffer(a, alloc)  JsonTempArray_ToBufferFunc((a)->buffer, (a)->count, (a)->array, (int)sizeof((a)->buffer[0]), alloc)
+/* AVX2: byte compares over 32 byte blocks, hits are read back as a bit mask */
+#define JSON_AVX2_EQ(block, c) _mm256_cmpeq_epi8(block, _mm256_set1_epi8(c))
+#define JSON_AVX2_MASK(v)      ((uint32_t)_mm256_movemask_epi8(v))
 
-JSON_INLINE void* JsonTempArray_ToBufferFunc(void* buffer, int32_t count, void* dynamicBuffer, int32_t itemSize, JsonAllocator* allocator)
+/* @funcdef: JsonKernel_SkipSpaceAVX2 */
+JSON_TARGET("avx2")
+static int32_t JsonKernel_SkipSpaceAVX2(const uint8_t* ptr, int32_t length, int32_t* outNewLines, int32_t* outLastNewLine)
 {
-    int total = count + JsonArray_GetCount(dynamicBuffer);
-    if (total > 0)
+    int32_t i = 0;
+    for (; length - i >= 32; i += 32)
     {
-        // Aligned total
-        const int32_t mod = (total * itemSize) & (sizeof(Json) - 1);
-        const int32_t size = total * itemSize + (mod != 0) * (sizeof(Json) - mod);
-
-        void* array = (JsonArray*)JsonAllocator_AllocLower(allocator, NULL, 0, size);
-        if (array)
+        const __m256i  block  = _mm256_loadu_si256((const __m256i*)(ptr + i));
+        const __m256i  lf     = JSON_AVX2_EQ(block, '\n');
+        const __m256i  space  = _mm256_or_si256(_mm256_or_si256(JSON_AVX2_EQ(block, ' '), JSON_AVX2_EQ(block, '\t')), _mm256_or_si256(JSON_AVX2_EQ(block, '\r'), lf));
+        const uint32_t others = ~JSON_AVX2_MASK(space);
+        const int32_t  count  = others ? JsonKernel_TrailingZeros(others) : 32;
+
+        JsonKernel_CountLines(JSON_AVX2_MASK(lf), i, count, outNewLines, outLastNewLine);
+        if (count < 32)
         {
-            memcpy(array, buffer, count * itemSize);
-            if (total > count)
-            {
-                memcpy((char*)array + count * itemSize, dynamicBuffer, (total - count) * itemSize);
-            }
+            return i + count;
         }
-        return array;
     }
-    return NULL;
+
+    return JsonKernel_SkipSpaceFrom(ptr, i, length, outNewLines, outLastNewLine);
 }
 
-typedef struct JsonParser JsonParser;
-struct JsonParser
+/* @funcdef: JsonKernel_ScanStringAVX2 */
+JSON_TARGET("avx2")
+static int32_t JsonKernel_ScanStringAVX2(const uint8_t* ptr, int32_t length)
 {
-    JsonParseFlags      flags;
-
-    int32_t             line;
-    int32_t             column;
-    int32_t             cursor;
-    //JsonType            parsingType;
-    
-    int32_t             length;         /* Reference only */
-    const char*         buffer;         /* Reference only */
-    
-    JsonError           errnum;
-    char*               errmsg;
-    jmp_buf             errjmp;
+    int32_t i = 0;
+    for (; length - i >= 32; i += 32)
+    {
+        const __m256i  block = _mm256_loadu_si256((const __m256i*)(ptr + i));
+        const __m256i  stops = _mm256_or_si256(_mm256_or_si256(JSON_AVX2_EQ(block, '"'), JSON_AVX2_EQ(block, '\\')), 
+                                               _mm256_or_si256(_mm256_or_si256(JSON_AVX2_EQ(block, '\r'), JSON_AVX2_EQ(block, '\n')), JSON_AVX2_EQ(block, 0)));
+        const uint32_t mask  = JSON_AVX2_MASK(stops);
+        if (mask)
+        {
+            return i + JsonKernel_TrailingZeros(mask);
+        }
+    }
 
-    JsonAllocator       allocator;      /* Runtime allocator */
-};
+    return i + JsonKernel_ScanStringScalar(ptr + i, length - i);
+}
 
-static void JsonParser_SetErrorWithArgs(JsonParser* parser, JsonType type, JsonError code, const char* fmt, va_list valist)
+/* @funcdef: JsonKernel_ScanStructuralAVX2 */
+JSON_TARGET("avx2")
+static int32_t JsonKernel_ScanStructuralAVX2(const uint8_t* ptr, int32_t length)
 {
-    const int errmsg_size = 1024;
-
-    const char* type_name;
-    switch (type)
+    int32_t i = 0;
+    for (; length - i >= 32; i += 32)
     {
-    case JsonType_Null:
-        type_name = "null";
-        break;
-
-    case JsonType_Boolean:
-        type_name = "boolean";
-        break;
+        // '[' and '{' (also ']' and '}') only differ in bit 5, setting it folds each pair into one compare
+        const __m256i  block    = _mm256_loadu_si256((const __m256i*)(ptr + i));
+        const __m256i  brackets = _mm256_or_si256(block, _mm256_set1_epi8(0x20));
+        const __m256i  stops    = _mm256_or_si256(_mm256_or_si256(JSON_AVX2_EQ(brackets, '{'), JSON_AVX2_EQ(brackets, '}')),
+                                                  _mm256_or_si256(_mm256_or_si256(JSON_AVX2_EQ(block, '"'), JSON_AVX2_EQ(block, '/')), JSON_AVX2_EQ(block, '\n')));
+        const uint32_t mask     = JSON_AVX2_MASK(stops);
+        if (mask)
+        {
+            return i + JsonKernel_TrailingZeros(mask);
+        }
+    }
 
-    case JsonType_Number:
-        type_name = "number";
-        break;
+    return i + JsonKernel_ScanStructuralScalar(ptr + i, length - i);
+}
 
-    case JsonType_Array:
-        type_name = "array";
-        break;
+/* @funcdef: JsonKernel_ScanTextAVX2 */
+JSON_TARGET("avx2")
+static int32_t JsonKernel_ScanTextAVX2(const uint8_t* ptr, int32_t length)
+{
+    int32_t i = 0;
+    for (; length - i >= 32; i += 32)
+    {
+        // Signed compare: both control characters and bytes from 0x80 up are below 0x20
+        const __m256i  block = _mm256_loadu_si256((const __m256i*)(ptr + i));
+        const __m256i  stops = _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), block),
+                                               _mm256_or_si256(JSON_AVX2_EQ(block, '"'), JSON_AVX2_EQ(block, '\\')));
+        const uint32_t mask  = JSON_AVX2_MASK(stops);
+        if (mask)
+        {
+            return i + JsonKernel_TrailingZeros(mask);
+        }
+    }
 
-    case JsonType_String:
-        type_name = "string";
-        break;
+    return i + JsonKernel_ScanTextScalar(ptr + i, length - i);
+}
 
-    case JsonType_Object:
-        type_name = "object";
-        break;
+static const JsonKernels JsonKernels_AVX2 = {
+    "avx2",
+    JsonKernel_SkipSpaceAVX2,
+    JsonKernel_ScanStringAVX2,
+    JsonKernel_ScanStructuralAVX2,
+    JsonKernel_ScanTextAVX2,
+};
 
-    default:
-        type_name = "unknown";
-        break;
-    }
+/* AVX-512BW: byte compares over 64 byte blocks straight into mask registers */
+#define JSON_AVX512_EQ(block, c) _mm512_cmpeq_epi8_mask(block, _mm512_set1_epi8(c))
 
-    parser->errnum = code;
-    if (parser->errmsg == NULL)
+/* @funcdef: JsonKernel_SkipSpaceAVX512 */
+JSON_TARGET("avx512f,avx512bw")
+static int32_t JsonKernel_SkipSpaceAVX512(const uint8_t* ptr, int32_t length, int32_t* outNewLines, int32_t* outLastNewLine)
+{
+    int32_t i = 0;
+    for (; length - i >= 64; i += 64)
     {
-        parser->errmsg = (char*)JsonAllocator_AllocUpper(&parser->allocator, NULL, 0, errmsg_size);
-    }
+        const __m512i  block  = _mm512_loadu_si512((const void*)(ptr + i));
+        const uint64_t lf     = JSON_AVX512_EQ(block, '\n');
+        const uint64_t others = ~(JSON_AVX512_EQ(block, ' ') | JSON_AVX512_EQ(block, '\t') | JSON_AVX512_EQ(block, '\r') | lf);
+        const int32_t  count  = others ? JsonKernel_TrailingZeros(others) : 64;
 
-    char final_format[1024];
-    char templ_format[1024] = "%s\n\tAt line %d, column %d. Parsing token: <%s>.";
+        JsonKernel_CountLines(lf, i, count, outNewLines, outLastNewLine);
+        if (count < 64)
+        {
+            return i + count;
+        }
+    }
 
-#if defined(_MSC_VER) && _MSC_VER >= 1200
-    sprintf_s(final_format, sizeof(final_format), templ_format, fmt, parser->line, parser->column, type_name);
-    sprintf_s(parser->errmsg, errmsg_size, final_format, valist);
-#else
-    sprintf(final_format, templ_format, fmt, parser->line, parser->column, type_name);
-    sprintf(parser->errmsg, final_format, valist);
-#endif
+    return JsonKernel_SkipSpaceFrom(ptr, i, length, outNewLines, outLastNewLine);
 }
 
-/* @funcdef: JsonParser_SetError */
-static void JsonParser_SetError(JsonParser* parser, JsonType type, JsonError code, const char* fmt, ...)
+/* @funcdef: JsonKernel_ScanStringAVX512 */
+JSON_TARGET("avx512f,avx512bw")
+static int32_t JsonKernel_ScanStringAVX512(const uint8_t* ptr, int32_t length)
 {
-    va_list varg;
-    va_start(varg, fmt);
-    JsonParser_SetErrorWithArgs(parser, type, code, fmt, varg);
-    va_end(varg);
+    int32_t i = 0;
+    for (; length - i >= 64; i += 64)
+    {
+        const __m512i  block = _mm512_loadu_si512((const void*)(ptr + i));
+        const uint64_t mask  = JSON_AVX512_EQ(block, '"') | JSON_AVX512_EQ(block, '\\') | JSON_AVX512_EQ(block, '\r') | JSON_AVX512_EQ(block, '\n') | JSON_AVX512_EQ(block, 0);
+        if (mask)
+        {
+            return i + JsonKernel_TrailingZeros(mask);
+        }
+    }
+
+    return i + JsonKernel_ScanStringScalar(ptr + i, length - i);
 }
 
-/* funcdef: JsonParser_Panic */
-static void JsonParser_Panic(JsonParser* parser, JsonType type, JsonError code, const char* fmt, ...)
+/* @funcdef: JsonKernel_ScanStructuralAVX512 */
+JSON_TARGET("avx512f,avx512bw")
+static int32_t JsonKernel_ScanStructuralAVX512(const uint8_t* ptr, int32_t length)
 {
-    va_list varg;
-    va_start(varg, fmt);
-    JsonParser_SetErrorWithArgs(parser, type, code, fmt, varg);
-    va_end(varg);
+    int32_t i = 0;
+    for (; length - i >= 64; i += 64)
+    {
+        const __m512i  block    = _mm512_loadu_si512((const void*)(ptr + i));
+        const __m512i  brackets = _mm512_or_si512(block, _mm512_set1_epi8(0x20));
+        const uint64_t mask     = JSON_AVX512_EQ(brackets, '{') | JSON_AVX512_EQ(brackets, '}') | JSON_AVX512_EQ(block, '"') | JSON_AVX512_EQ(block, '/') | JSON_AVX512_EQ(block, '\n');
+        if (mask)
+        {
+            return i + JsonKernel_TrailingZeros(mask);
+        }
+    }
 
-    longjmp(parser->errjmp, code);
+    return i + JsonKernel_ScanStructuralScalar(ptr + i, length - i);
 }
 
-/* @funcdef: JsonParser_Init */
-static bool JsonParser_Init(JsonParser* parser, const char* jsonCode, int32_t jsonLength, JsonAllocator allocator, JsonParseFlags flags)
+/* @funcdef: JsonKernel_ScanTextAVX512 */
+JSON_TARGET("avx512f,avx512bw")
+static int32_t JsonKernel_ScanTextAVX512(const uint8_t* ptr, int32_t length)
 {
-    JSON_ASSERT(parser, "parser mustnot be null");
-
-    parser->flags        = flags;
-
-	parser->line         = 1;
-	parser->column       = 1;
-	parser->cursor       = 0;
-	parser->buffer       = jsonCode;
-	parser->length       = jsonLength;
+    int32_t i = 0;
+    for (; length - i >= 64; i += 64)
+    {
+        const __m512i  block = _mm512_loadu_si512((const void*)(ptr + i));
+        const uint64_t mask  = _mm512_cmplt_epu8_mask(block, _mm512_set1_epi8(0x20)) | _mm512_movepi8_mask(block) | JSON_AVX512_EQ(block, '"') | JSON_AVX512_EQ(block, '\\');
+        if (mask)
+        {
+            return i + JsonKernel_TrailingZeros(mask);
+        }
+    }
 
-	parser->errmsg       = "Success!";
-	parser->errnum       = JsonError_None;
+    return i + JsonKernel_ScanTextScalar(ptr + i, length - i);
+}
 
-    parser->allocator    = allocator;
+static const JsonKernels JsonKernels_AVX512 = {
+    "avx512",
+    JsonKernel_SkipSpaceAVX512,
+    JsonKernel_ScanStringAVX512,
+    JsonKernel_ScanStructuralAVX512,
+    JsonKernel_ScanTextAVX512,
+};
 
-    return true;
+/* @funcdef: JsonKernels_CpuId */
+static void JsonKernels_CpuId(uint32_t leaf, uint32_t regs[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuidex(info, (int)leaf, 0);
+    regs[0] = (uint32_t)info[0]; regs[1] = (uint32_t)info[1]; regs[2] = (uint32_t)info[2]; regs[3] = (uint32_t)info[3];
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
 }
 
-/* @funcdef: JsonParser_IsAtEnd */
-static int JsonParser_IsAtEnd(const JsonParser* parser)
+/* Register state the OS saves on context switches (XCR0), vector paths are only usable when it saves their registers */
+static uint64_t JsonKernels_SavedState(void)
 {
-    return parser->cursor >= parser->length || parser->buffer[parser->cursor] <= 0;
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
 }
 
-/* @funcdef: JsonParser_PeekChar */
-static int JsonParser_PeekChar(const JsonParser* parser)
+#endif /* JSON_KERNELS_X86 */
+
+/* Read the JSON_FORCE_KERNEL environment variable into name, empty when it is not set */
+static void JsonKernels_ForcedName(char* name, size_t size)
 {
-    return parser->buffer[parser->cursor];
+    name[0] = 0;
+
+#if defined(_MSC_VER) && _MSC_VER >= 1400
+    char* value = NULL;
+    if (_dupenv_s(&value, NULL, "JSON_FORCE_KERNEL") == 0 && value)
+    {
+        strncpy_s(name, size, value, _TRUNCATE);
+        free(value);
+    }
+#else
+    const char* value = getenv("JSON_FORCE_KERNEL");
+    if (value)
+    {
+        strncpy(name, value, size - 1);
+        name[size - 1] = 0;
+    }
+#endif
 }
 
-/* @funcdef: JsonParser_NextChar */
-static int JsonParser_NextChar(JsonParser* parser)
+/* Vector kernels the running CPU supports, from the oldest to the best one */
+static int32_t JsonKernels_Supported(const JsonKernels* supported[3])
 {
-    if (JsonParser_IsAtEnd(parser))
+    int32_t count = 0;
+
+#if JSON_KERNELS_X86
+    uint32_t basic[4], extended[4] = { 0, 0, 0, 0 };
+    JsonKernels_CpuId(0, basic);
+    const uint32_t maxLeaf = basic[0];
+
+    JsonKernels_CpuId(1, basic);
+    if (maxLeaf >= 7)
     {
-		return -1;
+        JsonKernels_CpuId(7, extended);
     }
-    else
+
+    const bool     osxsave = (basic[2] & (1u << 27)) != 0;
+    const uint64_t state   = osxsave ? JsonKernels_SavedState() : 0;
+
+    if (basic[2] & (1u << 20))
     {
-		int c = parser->buffer[++parser->cursor];
+        supported[count++] = &JsonKernels_SSE42;
+    }
 
-		if (c == '\n')
-		{
-			parser->line++;
-			parser->column = 1;
-		}
-		else
-		{
-			parser->column = parser->column + 1;
-		}
-		
-		return c;
+    // AVX2 needs the YMM state saved, AVX-512 the opmask and ZMM state as well
+    if ((basic[2] & (1u << 28)) && (extended[1] & (1u << 5)) && (state & 0x06) == 0x06)
+    {
+        supported[count++] = &JsonKernels_AVX2;
+    }
+
+    if ((extended[1] & (1u << 16)) && (extended[1] & (1u << 30)) && (state & 0xE6) == 0xE6)
+    {
+        supported[count++] = &JsonKernels_AVX512;
     }
+#else
+    (void)supported;
+#endif
+
+    return count;
 }
 
-/* @funcdef: JsonParser_NextLine */
-static int JsonParser_NextLine(JsonParser* parser)
+/* Best kernels of the running CPU, JSON_FORCE_KERNEL picks a specific one when the CPU supports it */
+static const JsonKernels* JsonKernels_Select(void)
 {
-    if (JsonParser_IsAtEnd(parser))
+    const JsonKernels* supported[3];
+    const int32_t      count = JsonKernels_Supported(supported);
+
+    char forced[16];
+    JsonKernels_ForcedName(forced, sizeof(forced));
+    if (strcmp(forced, JsonKernels_Scalar.name) == 0)
     {
-        return -1;
+        return &JsonKernels_Scalar;
     }
-    else
+
+    for (int32_t i = 0; i < count; i++)
     {
-        int c = parser->buffer[parser->cursor];
-        while (c != '\n')
+        if (strcmp(forced, supported[i]->name) == 0)
         {
-            c = parser->buffer[++parser->cursor];
+            return supported[i];
         }
-
-        c = parser->buffer[++parser->cursor];
-        parser->line++;
-        parser->column = 1;
-        return c;
     }
+
+    return count > 0 ? supported[count - 1] : &JsonKernels_Scalar;
 }
 
-/* @funcdef: JsonParser_SkipSpace */
-static int JsonParser_SkipSpace(JsonParser* parser)
+/* Selected once per process, before the first parse of any thread can read it */
+static const JsonKernels* JsonKernels_Active = NULL;
+
+#if defined(JSON_NO_THREADS)
+/* @funcdef: JsonKernels_Get */
+static const JsonKernels* JsonKernels_Get(void)
 {
-    int c = JsonParser_PeekChar(parser);
-    while (c > 0 && isspace(c))
+    if (!JsonKernels_Active)
     {
-		c = JsonParser_NextChar(parser);
+        JsonKernels_Active = JsonKernels_Select();
     }
-    return c;
+    return JsonKernels_Active;
 }
+#elif defined(_WIN32)
+static INIT_ONCE JsonKernels_Once = INIT_ONCE_STATIC_INIT;
 
-/* @funcdef: JsonParser_MatchChar */
-static int JsonParser_MatchChar(JsonParser* parser, JsonType type, int c)
+static BOOL CALLBACK JsonKernels_Init(PINIT_ONCE once, PVOID parameter, PVOID* context)
 {
-    if (JsonParser_PeekChar(parser) == c)
-    {
-		return JsonParser_NextChar(parser);
-    }
-    else
-    {
-        JsonParser_Panic(parser, type, JsonError_UnmatchToken, "Expected '%c'", (char)c);
-		return -1;
-    }
+    (void)once;
+    (void)parameter;
+    (void)context;
+
+    JsonKernels_Active = JsonKernels_Select();
+    return TRUE;
 }
 
-/* @funcdef: JsonParser_SkipComments */
-static int JsonParser_SkipComments(JsonParser* parser)
+/* @funcdef: JsonKernels_Get */
+static const JsonKernels* JsonKernels_Get(void)
 {
-    while (true)
-    {
-        int c = JsonParser_NextChar(parser);
-        if (c == '/')
-        {
-            c = JsonParser_NextChar(parser);
-            if (c == '/')
-            {
-                JsonParser_NextLine(parser);
-            }    
-            else if (c == '*')
-            {
-                int c0 = JsonParser_NextChar(parser);
-                int c1 = JsonParser_NextChar(parser);
-                while (c0 != '*' || c1 != '/')
-                {
-                    c0 = c1;
-                    c1 = JsonParser_NextChar(parser);
-                }
+    InitOnceExecuteOnce(&JsonKernels_Once, JsonKernels_Init, NULL, NULL);
+    return JsonKernels_Active;
+}
+#else
+static pthread_once_t JsonKernels_Once = PTHREAD_ONCE_INIT;
+
+static void JsonKernels_Init(void)
+{
+    JsonKernels_Active = JsonKernels_Select();
+}
+
+/* @funcdef: JsonKernels_Get */
+static const JsonKernels* JsonKernels_Get(void)
+{
+    pthread_once(&JsonKernels_Once, JsonKernels_Init);
+    return JsonKernels_Active;
+}
+#endif
+
+/* @funcdef: JsonKernelName */
+const char* JsonKernelName(void)
+{
+    return JsonKernels_Get()->name;
+}
+
+// -----------------------------------------------------------------------
+// Utility
+// -----------------------------------------------------------------------
+
+typedef struct JsonAllocator
+{
+    uint8_t*        buffer;
+    int32_t         length;
+
+    uint8_t*        lowerMarker;
+    uint8_t*        upperMarker;
+
+    uint8_t*        stringMarker;   /* Byte-packed string region, NULL when strings share the lower marker */
+    uint8_t*        stringEnd;
+} JsonAllocator;
+
+static int32_t JsonAllocator_BlockSize(int32_t size)
+{
+	int32_t alignment = sizeof(Json);
+	int32_t misalign = size & (alignment - 1);
+	int32_t adjustment = (misalign != 0) * (alignment - misalign);
+	return size + adjustment;
+}
+
+static bool JsonAllocator_Init(JsonAllocator* allocator, void* buffer, int32_t bufferSize)
+{
+    if (buffer && bufferSize > 0)
+    {
+		allocator->buffer = (uint8_t*)buffer;
+		allocator->length = bufferSize;
+
+		// Aligned buffer for cache-friendly processing
+		const int32_t	alignment	= sizeof(Json);
+		const int32_t	mask		= alignment - 1;
+
+		const uintptr_t address		= (uintptr_t)buffer;
+		const int32_t	misalign	= address & mask;
+		const int32_t	adjustment	= (misalign != 0) * (alignment - misalign);
+
+		buffer = (void*)(address + adjustment);
+		bufferSize = (bufferSize - adjustment) & ~mask;
+
+        allocator->lowerMarker = (uint8_t*)buffer;
+        allocator->upperMarker = (uint8_t*)buffer + bufferSize;
+
+        allocator->stringMarker = NULL;
+        allocator->stringEnd    = NULL;
+
+        return true;
+    }
+
+    return false;
+}
+
+static bool JsonAllocator_InitStrings(JsonAllocator* allocator, void* stringBuffer, int32_t stringBufferSize)
+{
+    if (stringBuffer && stringBufferSize > 0)
+    {
+        allocator->stringMarker = (uint8_t*)stringBuffer;
+        allocator->stringEnd    = (uint8_t*)stringBuffer + stringBufferSize;
+        return true;
+    }
+
+    return false;
+}
+
+static int32_t JsonAllocator_RemainSize(JsonAllocator* allocator)
+{
+	int32_t remain = (int32_t)(allocator->upperMarker - allocator->lowerMarker);
+	return  remain;
+}
+
+static bool JsonAllocator_CanAlloc(JsonAllocator* allocator, int32_t size)
+{
+    int32_t remain = JsonAllocator_RemainSize(allocator);
+    return  remain >= size;
+}
+
+static void JsonAllocator_FreeLower(JsonAllocator* allocator, void* buffer, int32_t size)
+{
+	const int32_t blockSize = JsonAllocator_BlockSize(size);
+	uint8_t* lastBuffer = allocator->lowerMarker - blockSize;
+	if (lastBuffer == buffer)
+	{
+		allocator->lowerMarker = lastBuffer;
+	}
+}
+
+static void* JsonAllocator_AllocLower(JsonAllocator* allocator, void* oldBuffer, int32_t oldSize, int32_t newSize)
+{
+    JsonAllocator_FreeLower(allocator, oldBuffer, oldSize);
+
+    if (newSize <= 0)
+    {
+        return NULL;
+    }
+
+    // Strings may leave the lower marker unaligned, nodes always start at Json alignment
+    const uintptr_t address    = (uintptr_t)allocator->lowerMarker;
+    const int32_t   misalign   = (int32_t)(address & (sizeof(Json) - 1));
+    const int32_t   adjustment = (misalign != 0) * ((int32_t)sizeof(Json) - misalign);
+
+	const int32_t blockSize = JsonAllocator_BlockSize(newSize);
+    if (JsonAllocator_CanAlloc(allocator, adjustment + blockSize))
+    {
+        void* result = allocator->lowerMarker + adjustment;
+        allocator->lowerMarker += adjustment + blockSize;
+        return result;
+    }
+
+    return NULL;
+}
+
+/* Strings have no alignment requirement, so they are byte-packed: into the string region when present, otherwise behind the nodes */
+static char* JsonAllocator_AllocString(JsonAllocator* allocator, int32_t size)
+{
+    if (size <= 0)
+    {
+        return NULL;
+    }
+
+    if (allocator->stringMarker)
+    {
+        if ((int32_t)(allocator->stringEnd - allocator->stringMarker) >= size)
+        {
+            char* result = (char*)allocator->stringMarker;
+            allocator->stringMarker += size;
+            return result;
+        }
+
+        return NULL;
+    }
+
+    if (JsonAllocator_CanAlloc(allocator, size))
+    {
+        char* result = (char*)allocator->lowerMarker;
+        allocator->lowerMarker += size;
+        return result;
+    }
+
+    return NULL;
+}
+
+/* Give back the unused tail of the last string */
+static void JsonAllocator_ShrinkString(JsonAllocator* allocator, char* string, int32_t oldSize, int32_t newSize)
+{
+    uint8_t** marker = allocator->stringMarker ? &allocator->stringMarker : &allocator->lowerMarker;
+    if (*marker == (uint8_t*)string + oldSize)
+    {
+        *marker = (uint8_t*)string + newSize;
+    }
+}
+
+static void JsonAllocator_FreeUpper(JsonAllocator* allocator, void* buffer, int32_t size)
+{
+    void* lastBuffer = allocator->upperMarker;
+    if (lastBuffer == buffer)
+    {
+		const int32_t blockSize = JsonAllocator_BlockSize(size);
+        allocator->upperMarker += blockSize;
+    }
+}
+
+static void* JsonAllocator_AllocUpper(JsonAllocator* allocator, void* oldBuffer, int32_t oldSize, int32_t newSize)
+{
+    JsonAllocator_FreeUpper(allocator, oldBuffer, oldSize);
+
+    if (newSize <= 0)
+    {
+        return NULL;
+    }
+
+	const int32_t blockSize = JsonAllocator_BlockSize(newSize);
+    if (JsonAllocator_CanAlloc(allocator, blockSize))
+    {
+        allocator->upperMarker -= blockSize;
+        return allocator->upperMarker;
+    }
+
+    return NULL;
+}
+
+/* 
+JsonArray: dynamic, scalable array
+@note: internal only
+*/
+typedef struct JsonArray
+{
+    int32_t size;
+    int32_t count;
+    Json    buffer[];
+} JsonArray;
+
+#define JsonArray_GetHeader(a)              ((JsonArray*)(a) - 1)
+#define JsonArray_Init()                    NULL
+#define JsonArray_Free(a, alloc)            JsonAllocator_FreeUpper(alloc, a ? JsonArray_GetHeader(a) : NULL, (int32_t)JsonArray_GetAllocMemory(a))
+#define JsonArray_GetSize(a)                ((a) ? JsonArray_GetHeader(a)->size  : 0)
+#define JsonArray_GetCount(a)               ((a) ? JsonArray_GetHeader(a)->count : 0)
+#define JsonArray_GetAllocMemory(a)         (sizeof(JsonArray) + JsonArray_GetSize(a) * sizeof(*(a)))
+#define JsonArray_GetUsageMemory(a)         (sizeof(JsonArray) + JsonArray_GetCount(a) * sizeof(*(a)))
+#define JsonArray_Push(a, v, alloc)         (JsonArray_EnsureSize(a, JsonArray_GetCount(a) + 1, alloc) ? ((void)((a)[JsonArray_GetHeader(a)->count++] = v), 1) : 0)
+#define JsonArray_Pop(a, v, alloc)          ((a)[--JsonArray_GetHeader(a)->count]);
+#define JsonArray_EnsureSize(a, n, alloc)   ((!(a) || JsonArray_GetSize(a) < (n)) ? (*((void**)&(a))=JsonArray_Grow(a, n + 1, sizeof((a)[0]), alloc)) != NULL : 1)
+#define JsonArray_Clear(a)                  ((a) ? (void)(JsonArray_GetHeader(a)->count = 0) : (void)0)
+#define JsonArray_Clone(a, alloc)           ((a) ? memcpy(JsonArray_Grow(0, JsonArray_GetCount(a), sizeof((a)[0]), alloc), JsonArray_GetHeader(a), JsonArray_GetUsageMemory(a)) : NULL)
+
+JSON_INLINE void* JsonArray_Grow(void* array, int32_t reqsize, int32_t elemsize, JsonAllocator* allocator)
+{
+    assert(elemsize > 0);
+    assert(allocator != NULL);
+
+    JsonArray*  raw   = array ? JsonArray_GetHeader(array) : NULL;
+    int32_t     size  = JsonArray_GetSize(array);
+    int32_t     count = JsonArray_GetCount(array);
+
+    if (size >= reqsize)
+    {
+        return array;
+    }
+
+    int32_t newSize = size;
+    while (newSize < reqsize)
+    {
+        newSize += 32;
+    }
+
+    JsonArray* newArray = (JsonArray*)JsonAllocator_AllocUpper(allocator, raw, sizeof(JsonArray) + size * elemsize, sizeof(JsonArray) + newSize * elemsize);
+    if (newArray)
+    {
+        newArray->size  = newSize;
+        newArray->count = count;
+
+        if (raw && count > 0)
+        {
+            memmove(newArray->buffer, raw->buffer, count * elemsize); // Blocks overlap when the old one was on top of the upper stack
+        }
+
+        return newArray->buffer;
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+/*
+JsonTempArray: memory-wise array for containing parsing value
+@note: internal only 
+*/
+#define JsonTempArray(T, CAPACITY)                  \
+    struct {                                        \
+        T*      array;                              \
+        int32_t count;                              \
+        T       buffer[CAPACITY];                   \
+    }
+
+#define JsonTempArray_Init(a)             { a, 0 }
+#define JsonTempArray_Free(a, alloc)      JsonArray_Free((a)->array, alloc)
+#define JsonTempArray_Push(a, v, alloc)   ((a)->count >= (int32_t)(sizeof((a)->buffer) / sizeof((a)->buffer[0])) ? JsonArray_Push((a)->array, v, alloc) : ((a)->buffer[(a)->count++] = v, 1))
+#define JsonTempArray_GetCount(a)         ((a)->count + JsonArray_GetCount((a)->array))
+#define JsonTempArray_ToBuffer(a, alloc)  JsonTempArray_ToBufferFunc((a)->buffer, (a)->count, (a)->array, (int)sizeof((a)->buffer[0]), alloc)
+
+#define JsonTempArray_CopyTo(a, dst)      JsonTempArray_CopyToFunc((a)->buffer, (a)->count, (a)->array, (int)sizeof((a)->buffer[0]), dst)
+
+JSON_INLINE void JsonTempArray_CopyToFunc(const void* buffer, int32_t count, const void* dynamicBuffer, int32_t itemSize, void* dst)
+{
+    int total = count + JsonArray_GetCount(dynamicBuffer);
+
+    memcpy(dst, buffer, count * itemSize);
+    if (total > count)
+    {
+        memcpy((char*)dst + count * itemSize, dynamicBuffer, (total - count) * itemSize);
+    }
+}
+
+JSON_INLINE void* JsonTempArray_ToBufferFunc(void* buffer, int32_t count, void* dynamicBuffer, int32_t itemSize, JsonAllocator* allocator)
+{
+    int total = count + JsonArray_GetCount(dynamicBuffer);
+    if (total > 0)
+    {
+        // Aligned total
+        const int32_t mod = (total * itemSize) & (sizeof(Json) - 1);
+        const int32_t size = total * itemSize + (mod != 0) * (sizeof(Json) - mod);
+
+        void* array = (JsonArray*)JsonAllocator_AllocLower(allocator, NULL, 0, size);
+        if (array)
+        {
+            JsonTempArray_CopyToFunc(buffer, count, dynamicBuffer, itemSize, array);
+        }
+        return array;
+    }
+    return NULL;
+}
+
+typedef struct JsonParser JsonParser;
+struct JsonParser
+{
+    JsonParseFlags      flags;
+
+    int32_t             line;
+    int32_t             column;
+    int32_t             cursor;
+    //JsonType            parsingType;
+    
+    int32_t             length;         /* Reference only */
+    const char*         buffer;         /* Reference only */
+    
+    JsonError           errnum;
+    char*               errmsg;
+    jmp_buf             errjmp;
+
+    JsonAllocator       allocator;      /* Runtime allocator */
+
+    const JsonProjection* projection;   /* Reference only, NULL when every value is parsed */
+    const JsonKernels*    kernels;      /* Scanning loops of the running CPU */
+};
+
+static void JsonParser_SetErrorWithArgs(JsonParser* parser, JsonType type, JsonError code, const char* fmt, va_list valist)
+{
+    const int errmsg_size = 1024;
+
+    const char* type_name;
+    switch (type)
+    {
+    case JsonType_Null:
+        type_name = "null";
+        break;
+
+    case JsonType_Boolean:
+        type_name = "boolean";
+        break;
+
+    case JsonType_Number:
+        type_name = "number";
+        break;
+
+    case JsonType_Array:
+        type_name = "array";
+        break;
+
+    case JsonType_String:
+        type_name = "string";
+        break;
+
+    case JsonType_Object:
+        type_name = "object";
+        break;
+
+    default:
+        type_name = "unknown";
+        break;
+    }
+
+    // errmsg points to the static success message until the first error
+    if (parser->errnum == JsonError_None)
+    {
+        parser->errmsg = (char*)JsonAllocator_AllocUpper(&parser->allocator, NULL, 0, errmsg_size);
+    }
+
+    parser->errnum = code;
+    if (parser->errmsg == NULL)
+    {
+        parser->errmsg = (char*)"Not enough memory for error message";
+        return;
+    }
+
+    char final_format[1024];
+    char templ_format[1024] = "%s\n\tAt line %d, column %d. Parsing token: <%s>.";
+
+#if defined(_MSC_VER) && _MSC_VER >= 1200
+    sprintf_s(final_format, sizeof(final_format), templ_format, fmt, parser->line, parser->column, type_name);
+    vsprintf_s(parser->errmsg, errmsg_size, final_format, valist);
+#else
+    sprintf(final_format, templ_format, fmt, parser->line, parser->column, type_name);
+    vsnprintf(parser->errmsg, errmsg_size, final_format, valist);
+#endif
+}
+
+/* @funcdef: JsonParser_SetError */
+static void JsonParser_SetError(JsonParser* parser, JsonType type, JsonError code, const char* fmt, ...)
+{
+    va_list varg;
+    va_start(varg, fmt);
+    JsonParser_SetErrorWithArgs(parser, type, code, fmt, varg);
+    va_end(varg);
+}
+
+/* funcdef: JsonParser_Panic */
+static void JsonParser_Panic(JsonParser* parser, JsonType type, JsonError code, const char* fmt, ...)
+{
+    va_list varg;
+    va_start(varg, fmt);
+    JsonParser_SetErrorWithArgs(parser, type, code, fmt, varg);
+    va_end(varg);
+
+    longjmp(parser->errjmp, code);
+}
+
+/* @funcdef: JsonParser_Init */
+static bool JsonParser_Init(JsonParser* parser, const char* jsonCode, int32_t jsonLength, JsonAllocator allocator, JsonParseFlags flags)
+{
+    JSON_ASSERT(parser, "parser mustnot be null");
+
+    parser->flags        = flags;
+
+	parser->line         = 1;
+	parser->column       = 1;
+	parser->cursor       = 0;
+	parser->buffer       = jsonCode;
+	parser->length       = jsonLength;
+
+	parser->errmsg       = (char*)"Success!";
+	parser->errnum       = JsonError_None;
+
+    parser->allocator    = allocator;
+    parser->projection   = NULL;
+    parser->kernels      = JsonKernels_Get();
+
+    return true;
+}
+
+/* @funcdef: JsonParser_IsAtEnd */
+static int JsonParser_IsAtEnd(const JsonParser* parser)
+{
+    return parser->cursor >= parser->length || parser->buffer[parser->cursor] == 0;
+}
+
+/* @funcdef: JsonParser_PeekChar */
+static int JsonParser_PeekChar(const JsonParser* parser)
+{
+    return parser->cursor < parser->length ? (uint8_t)parser->buffer[parser->cursor] : 0;
+}
+
+/* @funcdef: JsonParser_NextChar */
+static int JsonParser_NextChar(JsonParser* parser)
+{
+    if (JsonParser_IsAtEnd(parser))
+    {
+		return -1;
+    }
+    else
+    {
+		int c = ++parser->cursor < parser->length ? (uint8_t)parser->buffer[parser->cursor] : 0;
+
+		if (c == '\n')
+		{
+			parser->line++;
+			parser->column = 1;
+		}
+		else
+		{
+			parser->column = parser->column + 1;
+		}
+		
+		return c;
+    }
+}
+
+/* @funcdef: JsonParser_NextLine */
+static int JsonParser_NextLine(JsonParser* parser)
+{
+    if (JsonParser_IsAtEnd(parser))
+    {
+        return -1;
+    }
+    else
+    {
+        int c = parser->buffer[parser->cursor];
+        while (c != '\n' && parser->cursor + 1 < parser->length)
+        {
+            c = parser->buffer[++parser->cursor];
+        }
+
+        c = ++parser->cursor < parser->length ? parser->buffer[parser->cursor] : 0;
+        parser->line++;
+        parser->column = 1;
+        return c;
+    }
+}
+
+/* @funcdef: JsonParser_SkipBlank */
+static int JsonParser_SkipBlank(JsonParser* parser)
+{
+    const uint8_t* buffer = (const uint8_t*)parser->buffer;
+    const int32_t  length = parser->length;
+    const int32_t  cursor = parser->cursor;
+
+    // Compact JSON has no space between most tokens
+    if (cursor >= length || !JsonParser_IsCharClass(buffer[cursor], JsonCharClass_Space))
+    {
+        return cursor < length ? buffer[cursor] : 0;
+    }
+
+    int32_t       newLines    = 0;
+    int32_t       lastNewLine = -1;
+    const int32_t count       = JsonKernels_Call(parser->kernels, skipSpace)(buffer + cursor, length - cursor, &newLines, &lastNewLine);
+
+    // Same bookkeeping as JsonParser_NextChar, a line feed under the cursor was counted when the cursor stepped onto it
+    parser->line   += newLines - (buffer[cursor] == '\n');
+    parser->column  = lastNewLine > 0 ? 1 + count - lastNewLine : parser->column + count;
+    parser->cursor  = cursor + count;
+    return parser->cursor < length ? buffer[parser->cursor] : 0;
+}
+
+/* @funcdef: JsonParser_MatchChar */
+static int JsonParser_MatchChar(JsonParser* parser, JsonType type, int c)
+{
+    if (JsonParser_PeekChar(parser) == c)
+    {
+		return JsonParser_NextChar(parser);
+    }
+    else
+    {
+        JsonParser_Panic(parser, type, JsonError_UnmatchToken, "Expected '%c'", (char)c);
+		return -1;
+    }
+}
+
+/* @funcdef: JsonParser_SkipComments */
+static int JsonParser_SkipComments(JsonParser* parser)
+{
+    while (true)
+    {
+        int c = JsonParser_PeekChar(parser);
+        if (c == '/')
+        {
+            c = JsonParser_NextChar(parser);
+            if (c == '/')
+            {
+                JsonParser_NextLine(parser);
+            }    
+            else if (c == '*')
+            {
+                int c0 = JsonParser_NextChar(parser);
+                int c1 = JsonParser_NextChar(parser);
+                while (c1 > 0 && (c0 != '*' || c1 != '/'))
+                {
+                    c0 = c1;
+                    c1 = JsonParser_NextChar(parser);
+                }
+
+                if (c1 <= 0)
+                {
+                    JsonParser_Panic(parser, JsonType_Null, JsonError_UnmatchToken, "Expected '*/'");
+                }
+                JsonParser_NextChar(parser);
+            }
+            else
+            {
+                JsonParser_Panic(parser, JsonType_Null, JsonError_UnexpectedToken, "Unexpected token '%c'", c);
+            }
+
+            JsonParser_SkipBlank(parser);
+        }
+        else
+        {
+            break;
+        }
+    }
+    
+    return JsonParser_PeekChar(parser);
+}
+
+/* Skip what may stand between two tokens: whitespace and, with JsonParseFlags_SupportComment, comments */
+static int JsonParser_SkipSpace(JsonParser* parser)
+{
+    const int c = JsonParser_SkipBlank(parser);
+    return c == '/' && (parser->flags & JsonParseFlags_SupportComment) ? JsonParser_SkipComments(parser) : c;
+}
+
+/* Key summary: 64-bit bloom filter of all keys in a container subtree, stored in a Json sized slot in front of its items */
+#define JsonKeySummary_Slot(items)  ((uint64_t*)((uint8_t*)(items) - sizeof(Json)))
+
+/* FNV-1a hash of a key */
+static uint32_t JsonString_Hash(const char* name, int32_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (int32_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/* Two bloom bits of a key */
+static uint64_t JsonKeySummary_Bits(const char* name, int32_t length)
+{
+    const uint32_t hash = JsonString_Hash(name, length);
+    return ((uint64_t)1 << (hash & 63)) | ((uint64_t)1 << ((hash >> 6) & 63));
+}
+
+/* Summary of a value parsed with JsonParseFlags_KeySummary, 0 for values without keys */
+static uint64_t JsonKeySummary_Get(const Json value)
+{
+    if ((value.type == JsonType_Object || value.type == JsonType_Array) && value.length > 0)
+    {
+        return *JsonKeySummary_Slot(value.array);
+    }
+
+    return 0;
+}
+
+/* Move parsed items to the lower stack, with a summary slot in front when summaries are enabled */
+static void* JsonParser_ToContainer(JsonParser* parser, void* buffer, int32_t count, void* dynamicBuffer, int32_t itemSize)
+{
+    const int32_t total = count + JsonArray_GetCount(dynamicBuffer);
+    if (!(parser->flags & JsonParseFlags_KeySummary) || total == 0)
+    {
+        void* array = JsonTempArray_ToBufferFunc(buffer, count, dynamicBuffer, itemSize, &parser->allocator);
+        if (!array && total > 0)
+        {
+            JsonParser_Panic(parser, JsonType_Null, JsonError_OutOfMemory, "Not enough memory for <container>");
+        }
+        return array;
+    }
+
+    const int32_t mod  = (total * itemSize) & (sizeof(Json) - 1);
+    const int32_t size = (int32_t)sizeof(Json) + total * itemSize + (mod != 0) * ((int32_t)sizeof(Json) - mod);
+
+    uint8_t* block = (uint8_t*)JsonAllocator_AllocLower(&parser->allocator, NULL, 0, size);
+    if (!block)
+    {
+        JsonParser_Panic(parser, JsonType_Null, JsonError_OutOfMemory, "Not enough memory for <container>");
+    }
+
+    JsonTempArray_CopyToFunc(buffer, count, dynamicBuffer, itemSize, block + sizeof(Json));
+
+    // The items are summarized in place, so a container summary covers its whole subtree
+    uint64_t summary = 0;
+    if (itemSize == (int32_t)sizeof(JsonObjectMember))
+    {
+        const JsonObjectMember* members = (const JsonObjectMember*)(block + sizeof(Json));
+        for (int32_t i = 0; i < total; i++)
+        {
+            const char* name = members[i].name;
+            summary |= JsonKeySummary_Bits(name, name ? (int32_t)strlen(name) : 0) | JsonKeySummary_Get(members[i].value);
+        }
+    }
+    else
+    {
+        const Json* values = (const Json*)(block + sizeof(Json));
+        for (int32_t i = 0; i < total; i++)
+        {
+            summary |= JsonKeySummary_Get(values[i]);
+        }
+    }
+
+    memset(block, 0, sizeof(Json));
+    *(uint64_t*)block = summary;
+    return block + sizeof(Json);
+}
+
+#define JsonParser_ToContainerFrom(parser, a) JsonParser_ToContainer(parser, (a)->buffer, (a)->count, (a)->array, (int)sizeof((a)->buffer[0]))
+
+/* All parse functions declaration */
+
+static void JsonParser_ParseArray(JsonParser* parser, Json* outValue);
+static void JsonParser_ParseSingle(JsonParser* parser, Json* outValue);
+static void JsonParser_ParseObject(JsonParser* parser, Json* outValue);
+static void JsonParser_ParseNumber(JsonParser* parser, Json* outValue);
+static void JsonParser_ParseString(JsonParser* parser, Json* outValue);
+
+/* Correctly rounded conversion through strtod, the text is rewritten as digits and exponent so the locale decimal point does not matter */
+static double JsonParser_ConvertNumberSlow(const char* text, int32_t length)
+{
+    // Digits past 780 cannot change the rounding of a double (halfway points have at most 767), they only leave a sticky digit
+    char        buffer[800];
+    int32_t     size     = 0;
+    int32_t     digits   = 0;
+    int32_t     exponent = 0;
+    bool        sticky   = false;
+    bool        fraction = false;
+    const char* end      = text + length;
+
+    if (text < end && *text == '-')
+    {
+        buffer[size++] = *text++;
+    }
+
+    for (; text < end && ((*text >= '0' && *text <= '9') || *text == '.'); text++)
+    {
+        if (*text == '.')
+        {
+            fraction = true;
+        }
+        else if (digits == 0 && *text == '0')
+        {
+            exponent -= fraction;
+        }
+        else if (digits < 780)
+        {
+            buffer[size++] = *text;
+            digits++;
+            exponent -= fraction;
+        }
+        else
+        {
+            sticky   |= *text != '0';
+            exponent += !fraction;
+        }
+    }
+
+    if (sticky)
+    {
+        buffer[size++] = '1';
+        exponent--;
+    }
+    else if (digits == 0)
+    {
+        buffer[size++] = '0';
+    }
+
+    if (text < end && (*text == 'e' || *text == 'E'))
+    {
+        text++;
+
+        int32_t expsgn = 1;
+        if (text < end && (*text == '-' || *text == '+'))
+        {
+            expsgn = (*text++ == '-') ? -1 : 1;
+        }
+
+        int32_t exppow = 0;
+        while (text < end && *text >= '0' && *text <= '9')
+        {
+            exppow = exppow < 100000 ? exppow * 10 + (*text - '0') : exppow;
+            text++;
+        }
+
+        exponent += expsgn * exppow;
+    }
+
+    snprintf(buffer + size, sizeof(buffer) - (size_t)size, "e%d", (int)exponent);
+    return strtod(buffer, NULL);
+}
+
+/* Convert the text of a number token, which is already validated by the tokenizer */
+static double JsonParser_ConvertNumber(const char* text, int32_t length)
+{
+    static const double powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    const char* start = text;
+    const char* end   = text + length;
+
+    bool negative = false;
+    if (text < end && *text == '-')
+    {
+        negative = true;
+        text++;
+    }
+
+    uint64_t mantissa = 0;
+    int32_t  digits   = 0;
+    int32_t  exponent = 0;
+    while (text < end && *text >= '0' && *text <= '9')
+    {
+        digits  += digits > 0 || *text != '0';
+        mantissa = mantissa * 10 + (uint64_t)(*text++ - '0');
+    }
+
+    if (text < end && *text == '.')
+    {
+        text++;
+        while (text < end && *text >= '0' && *text <= '9')
+        {
+            digits  += digits > 0 || *text != '0';
+            mantissa = mantissa * 10 + (uint64_t)(*text++ - '0');
+            exponent--;
+        }
+    }
+
+    if (text < end && (*text == 'e' || *text == 'E'))
+    {
+        text++;
+
+        int32_t expsgn = 1;
+        if (text < end && (*text == '-' || *text == '+'))
+        {
+            expsgn = (*text++ == '-') ? -1 : 1;
+        }
+
+        int32_t exppow = 0;
+        while (text < end && *text >= '0' && *text <= '9')
+        {
+            exppow = exppow < 100000 ? exppow * 10 + (*text - '0') : exppow;
+            text++;
+        }
+
+        exponent += expsgn * exppow;
+    }
+
+    // Both the mantissa and the power of ten are exact doubles, so one multiply or divide rounds correctly
+    if (digits <= 19 && mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22)
+    {
+        const double number = exponent < 0 ? (double)mantissa / powers[-exponent] : (double)mantissa * powers[exponent];
+        return negative ? -number : number;
+    }
+
+    return JsonParser_ConvertNumberSlow(start, length);
+}
+
+/* @funcdef: JsonParser_ParseNumber */
+static void JsonParser_ParseNumber(JsonParser* parser, Json* outValue)
+{
+    int c = JsonParser_SkipSpace(parser);
+    if (c > 0)
+    {
+        const int32_t start = parser->cursor;
+
+		if (c == '+')
+		{
+			c = JsonParser_NextChar(parser);
+			JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "JSON does not support number start with '+'");
+		}
+		else if (c == '-')
+		{
+			c = JsonParser_NextChar(parser);
+		}
+		
+		if (c == '0')
+		{
+			c = JsonParser_NextChar(parser);
+			if (JsonParser_IsCharClass(c, JsonCharClass_Digit))
+			{
+				JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "JSON does not support number start with '0' (only standalone '0' is accepted)");
+			}
+		}
+		else if (!JsonParser_IsCharClass(c, JsonCharClass_Digit))
+		{
+			JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Unexpected '%c'", c);
+		}
+
+		int    dot    = 0;
+        int    dotchk = 0;
+        int    exp    = 0;
+        int    expsgn = 0;
+        int    expchk = 0;
+
+		while (c > 0)
+		{
+            if (c == 'e' || c == 'E')
+            {
+                if (exp)
+                {
+                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Too many 'e' are presented in a <number>");
+                }
+                else if (dot && !dotchk)
+                {
+                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken,
+                                "'.' is presented in number token, but require a digit after '.' ('%c')", c);
+                }
+                else
+                {
+                    exp    = 1;
+                    expchk = 0;
+                }
+            }
+			else if (c == '.')
+			{
+                if (exp)
+                {
+                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Cannot has '.' after 'e' is presented in a <number>");
+                }
+				else if (dot)
+				{
+					JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Too many '.' are presented in a <number>");
+				}
+				else
+				{
+					dot = 1;
+				}
+			}
+            else if (exp && (c == '-' || c == '+'))
+            {
+                if (expchk)
+                {
+                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "'%c' is presented after digits are presented of exponent part", c);
+                }
+                else if (expsgn)
+                {
+                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Too many signed characters are presented after 'e'");
+                }
+                else
+                {
+                    expsgn = 1;
+                }
+            }
+			else if (!JsonParser_IsCharClass(c, JsonCharClass_Digit))
+			{
+				break;
+			}
+			else if (exp)
+			{
+                expchk = 1;
+			}
+            else if (dot)
+            {
+                dotchk = 1;
+            }
+
+			c = JsonParser_NextChar(parser);
+		}
+
+        if (exp && !expchk)
+        {
+            JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "'e' is presented in number token, but require a digit after 'e' ('%c')", (char)c);
+        }
+		if (dot && !dotchk)
+		{
+			JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "'.' is presented in number token, but require a digit after '.' ('%c')", (char)c);
+		}
+		else
+		{
+            const char*   text   = parser->buffer + start;
+            const int32_t length = parser->cursor - start;
+
+            Json value;
+            value.type = JsonType_Number;
+            if (parser->flags & JsonParseFlags_LazyNumbers)
+            {
+                value.length    = -length;
+                value.rawNumber = text;
+            }
+            else
+            {
+                value.length = 0;
+                value.number = JsonParser_ConvertNumber(text, length);
+            }
+
+            *outValue = value;
+		}
+    }
+    else
+    {
+        JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Reached the end of json!");
+    }
+}
+
+/* @funcdef: JsonParser_IsInt32 */
+static bool JsonParser_IsInt32(double number)
+{
+    return number >= -2147483648.0 && number <= 2147483647.0 && number == (double)(int32_t)number;
+}
+
+/* Numbers an int32_t[] keeps as they are, negative zero would come back as 0 */
+static bool JsonParser_IsPackedInt32(double number)
+{
+    return JsonParser_IsInt32(number) && (number != 0 || !signbit(number));
+}
+
+/* Narrow down whether an array can still be packed once value is added to it
+   Lazy numbers must come back as the same text, which only an int32_t[] of plain integers guarantees */
+static void JsonParser_UpdatePackable(const Json value, bool* allNumbers, bool* allInt32)
+{
+    *allNumbers = *allNumbers && value.type == JsonType_Number;
+    *allInt32   = *allNumbers && *allInt32 && JsonParser_IsPackedInt32(JsonGetNumber(value));
+
+    if (*allNumbers && value.length < 0)
+    {
+        for (int32_t i = 0; *allInt32 && i < -value.length; i++)
+        {
+            *allInt32 = value.rawNumber[i] == '-' || JsonParser_IsCharClass(value.rawNumber[i], JsonCharClass_Digit);
+        }
+
+        *allNumbers = *allInt32;
+    }
+}
+
+/* @funcdef: JsonParser_PackNumbers */
+static void JsonParser_PackNumbers(JsonParser* parser, const Json* values, int32_t count, const Json* dynamicValues, bool allInt32, Json* outValue)
+{
+    const int32_t total    = count + JsonArray_GetCount(dynamicValues);
+    const int32_t itemSize = allInt32 ? (int32_t)sizeof(int32_t) : (int32_t)sizeof(double);
+
+    void* buffer = JsonAllocator_AllocLower(&parser->allocator, NULL, 0, total * itemSize);
+    if (!buffer)
+    {
+        JsonParser_Panic(parser, JsonType_Array, JsonError_OutOfMemory, "Not enough memory for packed <array>");
+    }
+
+    if (allInt32)
+    {
+        int32_t* numbers = (int32_t*)buffer;
+        for (int32_t i = 0; i < total; i++)
+        {
+            numbers[i] = (int32_t)JsonGetNumber(i < count ? values[i] : dynamicValues[i - count]);
+        }
+
+        outValue->type       = JsonType_Int32Array;
+        outValue->int32Array = numbers;
+    }
+    else
+    {
+        double* numbers = (double*)buffer;
+        for (int32_t i = 0; i < total; i++)
+        {
+            numbers[i] = JsonGetNumber(i < count ? values[i] : dynamicValues[i - count]);
+        }
+
+        outValue->type        = JsonType_NumberArray;
+        outValue->numberArray = numbers;
+    }
+
+    outValue->length = total;
+}
+
+/* @funcdef: JsonParser_ParseArray */
+static void JsonParser_ParseArray(JsonParser* parser, Json* outValue)
+{
+    if (JsonParser_SkipSpace(parser) > 0)
+    {
+	    JsonParser_MatchChar(parser, JsonType_Array, '[');
+
+        bool allNumbers = (parser->flags & JsonParseFlags_PackNumberArrays) != 0;
+        bool allInt32   = allNumbers;
+
+        JsonTempArray(Json, 64) values = JsonTempArray_Init(NULL);
+	    while (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != ']')
+	    {
+	        if (values.count > 0)
+	        {
+                JsonParser_MatchChar(parser, JsonType_Array, ',');
+	        }
+	    
+            Json value;
+            JsonParser_ParseSingle(parser, &value);
+
+            if (allNumbers)
+            {
+                JsonParser_UpdatePackable(value, &allNumbers, &allInt32);
+            }
+
+            if (!JsonTempArray_Push(&values, value, &parser->allocator))
+            {
+                JsonParser_Panic(parser, JsonType_Array, JsonError_OutOfMemory, "Not enough memory for <array>");
+            }
+	    }
+
+	    JsonParser_SkipSpace(parser);
+	    JsonParser_MatchChar(parser, JsonType_Array, ']');
+
+        const int32_t count = JsonTempArray_GetCount(&values);
+        if (allNumbers && count > 0)
+        {
+            JsonParser_PackNumbers(parser, values.buffer, values.count, values.array, allInt32, outValue);
+        }
+        else
+        {
+            outValue->type   = JsonType_Array;
+            outValue->length = count;
+            outValue->array  = (Json*)JsonParser_ToContainerFrom(parser, &values);
+        }
+
+        JsonTempArray_Free(&values, &parser->allocator);
+    }
+}
+
+/* @funcdef: JsonParser_LiteralWord */
+static uint32_t JsonParser_LiteralWord(const char* text)
+{
+    uint32_t word;
+    memcpy(&word, text, sizeof(word));
+    return word;
+}
+
+/* @funcdef: JsonParser_ParseLiteral */
+static void JsonParser_ParseLiteral(JsonParser* parser, Json* outValue)
+{
+    const char*   token  = parser->buffer + parser->cursor;
+    const int32_t remain = parser->length - parser->cursor;
+
+    // Compare whole words instead of scanning letter by letter, the literal must not run into another letter
+    int32_t length = 0;
+    if (remain >= 4)
+    {
+        const uint32_t word = JsonParser_LiteralWord(token);
+        if (word == JsonParser_LiteralWord("null"))
+        {
+            length    = 4;
+            *outValue = JSON_NULL;
+        }
+        else if (word == JsonParser_LiteralWord("true"))
+        {
+            length    = 4;
+            *outValue = JSON_TRUE;
+        }
+        else if (remain >= 5 && token[0] == 'f' && JsonParser_LiteralWord(token + 1) == JsonParser_LiteralWord("alse"))
+        {
+            length    = 5;
+            *outValue = JSON_FALSE;
+        }
+    }
+
+    if (length > 0 && (length == remain || !JsonParser_IsCharClass(token[length], JsonCharClass_Alpha)))
+    {
+        parser->cursor += length;
+        parser->column += length;
+        return;
+    }
+
+    length = 0;
+    while (length < remain && JsonParser_IsCharClass(token[length], JsonCharClass_Alpha))
+    {
+        length++;
+    }
+    parser->cursor += length;
+    parser->column += length;
+
+    char tmp[256];
+    length = length < 255 ? length : 255;
+    memcpy(tmp, token, (size_t)length);
+    tmp[length] = 0;
+
+    JsonParser_Panic(parser, JsonType_Null, JsonError_UnexpectedToken, "Unexpected token '%s'", tmp);
+}
+
+/* JsonState_ParseSingle */
+static void JsonParser_ParseSingle(JsonParser* parser, Json* outValue)
+{
+    if (JsonParser_SkipSpace(parser) > 0)
+    {
+	    int c = JsonParser_PeekChar(parser);
+	
+	    switch (c)
+	    {
+	    case '[':
+	        JsonParser_ParseArray(parser, outValue);
+            break;
+	    
+	    case '{':
+	        JsonParser_ParseObject(parser, outValue);
+            break;
+	    
+	    case '"':
+	        JsonParser_ParseString(parser, outValue);
+            break;
+
+	    case '+': case '-': case '0': 
+        case '1': case '2': case '3': 
+        case '4': case '5': case '6': 
+        case '7': case '8': case '9':
+	        JsonParser_ParseNumber(parser, outValue);
+            break;
+
+
+        case '/':
+            JsonParser_Panic(parser, JsonType_String, JsonError_UnknownToken, "Unknown token '%c'", c);
+            break;
+	    
+        default:
+            JsonParser_ParseLiteral(parser, outValue);
+            break;
+	    /* END OF SWITCH STATEMENT */
+        }
+    }
+}
+
+/* Values of hexadecimal digits, -1 for every other byte */
+static const int8_t JsonString_HexDigits[256] = {
+    /* 0x00 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0x10 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0x20 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0x30 */  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    /* 0x40 */ -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0x50 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0x60 */ -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0x70 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0x80 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0x90 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0xA0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0xB0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0xC0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0xD0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0xE0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    /* 0xF0 */ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+/* Decode the 4 hex digits of a \u escape, returns -1 when one of them is not a hex digit */
+static int32_t JsonString_DecodeHex4(const char* hex)
+{
+    const int32_t d0 = JsonString_HexDigits[(uint8_t)hex[0]];
+    const int32_t d1 = JsonString_HexDigits[(uint8_t)hex[1]];
+    const int32_t d2 = JsonString_HexDigits[(uint8_t)hex[2]];
+    const int32_t d3 = JsonString_HexDigits[(uint8_t)hex[3]];
+    return (d0 | d1 | d2 | d3) < 0 ? -1 : (d0 << 12) | (d1 << 8) | (d2 << 4) | d3;
+}
+
+/* Encode a code point as UTF-8 into out, returns the number of bytes written */
+static int32_t JsonString_EncodeUtf8(uint32_t codepoint, char* out)
+{
+    if (codepoint <= 0x7F)
+    {
+        out[0] = (char)codepoint;
+        return 1;
+    }
+    else if (codepoint <= 0x7FF)
+    {
+        out[0] = (char)(0xC0 | (codepoint >> 6));            /* 110xxxxx */
+        out[1] = (char)(0x80 | (codepoint & 0x3F));          /* 10xxxxxx */
+        return 2;
+    }
+    else if (codepoint <= 0xFFFF)
+    {
+        out[0] = (char)(0xE0 | (codepoint >> 12));           /* 1110xxxx */
+        out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));   /* 10xxxxxx */
+        out[2] = (char)(0x80 | (codepoint & 0x3F));          /* 10xxxxxx */
+        return 3;
+    }
+    else
+    {
+        out[0] = (char)(0xF0 | (codepoint >> 18));           /* 11110xxx */
+        out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));  /* 10xxxxxx */
+        out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));   /* 10xxxxxx */
+        out[3] = (char)(0x80 | (codepoint & 0x3F));          /* 10xxxxxx */
+        return 4;
+    }
+}
+
+/* Decode the escape sequence after a backslash into out (up to 4 bytes), returns the number of raw bytes consumed */
+static int32_t JsonString_DecodeEscape(const char* raw, const char* end, char* out, int32_t* outBytes)
+{
+    switch (raw[0])
+    {
+    case 'n':   out[0] = '\n'; *outBytes = 1; return 1;
+    case 't':   out[0] = '\t'; *outBytes = 1; return 1;
+    case 'r':   out[0] = '\r'; *outBytes = 1; return 1;
+    case 'b':   out[0] = '\b'; *outBytes = 1; return 1;
+    case 'f':   out[0] = '\f'; *outBytes = 1; return 1;
+    case '/':   out[0] = '/';  *outBytes = 1; return 1;
+    case '\\':  out[0] = '\\'; *outBytes = 1; return 1;
+    case '"':   out[0] = '\"'; *outBytes = 1; return 1;
+
+    case 'u':
+    {
+        int32_t codepoint = JsonString_DecodeHex4(raw + 1);
+        int32_t consumed  = 5;
+
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+        {
+            // A high surrogate combines with a following \u low surrogate into one supplementary code point
+            const int32_t low = end - raw >= 11 && raw[5] == '\\' && raw[6] == 'u' ? JsonString_DecodeHex4(raw + 7) : -1;
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                consumed  = 11;
+            }
+            else
+            {
+                codepoint = 0xFFFD;
+            }
+        }
+        else if ((codepoint >= 0xDC00 && codepoint <= 0xDFFF) || codepoint < 0)
+        {
+            // Unpaired surrogates have no UTF-8 form, they become the replacement character
+            codepoint = 0xFFFD;
+        }
+
+        *outBytes = JsonString_EncodeUtf8((uint32_t)codepoint, out);
+        return consumed;
+    }
+
+    default:
+        JSON_ASSERT(false, "escape sequence must be validated by the tokenizer");
+        *outBytes = 0;
+        return 1;
+    }
+}
+
+/* Decode one character of a string, raw bytes are only escapes when the string is escaped */
+static int32_t JsonString_DecodeNext(const char* raw, const char* end, bool escaped, char* out, int32_t* outBytes)
+{
+    if (escaped && raw[0] == '\\')
+    {
+        return 1 + JsonString_DecodeEscape(raw + 1, end, out, outBytes);
+    }
+
+    out[0] = raw[0];
+    *outBytes = 1;
+    return 1;
+}
+
+/* Unescape raw string content into out, writes at most outSize bytes and returns the full decoded length */
+static int32_t JsonString_Unescape(const char* raw, int32_t rawLength, char* out, int32_t outSize)
+{
+    const char* end    = raw + rawLength;
+    int32_t     length = 0;
+
+    while (raw < end)
+    {
+        // Copy the run of plain characters up to the next escape at once
+        const char* escape = (const char*)memchr(raw, '\\', (size_t)(end - raw));
+        const int32_t run  = (int32_t)((escape ? escape : end) - raw);
+        if (run > 0)
+        {
+            if (length < outSize)
+            {
+                memcpy(out + length, raw, (size_t)(run < outSize - length ? run : outSize - length));
+            }
+
+            length += run;
+            raw    += run;
+        }
+
+        if (escape)
+        {
+            int32_t count;
+            if (outSize - length >= 4)
+            {
+                // Enough room for the widest UTF-8 sequence, decode straight into the output
+                raw    += 1 + JsonString_DecodeEscape(escape + 1, end, out + length, &count);
+                length += count;
+            }
+            else
+            {
+                char bytes[4];
+                raw += 1 + JsonString_DecodeEscape(escape + 1, end, bytes, &count);
+
+                for (int32_t i = 0; i < count; i++, length++)
+                {
+                    if (length < outSize)
+                    {
+                        out[length] = bytes[i];
+                    }
+                }
+            }
+        }
+    }
+
+    return length;
+}
+
+/* @funcdef: JsonParser_ScanString */
+static const char* JsonParser_ScanString(JsonParser* parser, int32_t* outRawLength, bool* outEscaped)
+{
+    JsonParser_MatchChar(parser, JsonType_String, '"');
+
+    const uint8_t* buffer  = (const uint8_t*)parser->buffer;
+    const int32_t  length  = parser->length;
+    const int32_t  start   = parser->cursor;
+    int32_t        cursor  = start;
+    bool           escaped = false;
+
+    // Strings cannot span lines, so only the column moves while the cursor is kept in a local
+    while (true)
+    {
+        // The kernel jumps over plain characters and stops on anything that needs a look
+        cursor += JsonKernels_Call(parser->kernels, scanString)(buffer + cursor, length - cursor);
+
+        const int32_t c0 = cursor < length ? buffer[cursor] : 0;
+        if (c0 == '"' || c0 == 0)
+        {
+            break;
+        }
+        else if (c0 == '\\')
+        {
+            escaped = true;
+
+            switch (++cursor < length ? buffer[cursor] : 0)
+            {
+            case 'n':
+            case 't':
+            case 'r':
+            case 'b':
+            case 'f':
+            case '/':
+            case '\\':
+            case '"':
+                break;
+
+            case 'u':
+                if (length - cursor <= 4 || JsonString_DecodeHex4((const char*)buffer + cursor + 1) < 0)
+                {
+                    parser->column += cursor - parser->cursor;
+                    parser->cursor  = cursor;
+                    JsonParser_Panic(parser, JsonType_String, JsonError_UnknownToken, "Expected hexa character in unicode character");
+                }
+                cursor += 4;
+                break;
+
+            default:
+                parser->column += cursor - parser->cursor;
+                parser->cursor  = cursor;
+                JsonParser_Panic(parser, JsonType_String, JsonError_UnknownToken, "Unknown escape character");
+                break;
+            }
+        }
+        else if (c0 == '\r' || c0 == '\n')
+        {
+            parser->column += cursor - parser->cursor;
+            parser->cursor  = cursor;
+            JsonParser_Panic(parser, JsonType_String, JsonError_UnexpectedToken, "Unexpected newline characters '%c'", c0);
+        }
+
+        cursor++;
+    }
+
+    parser->column += cursor - parser->cursor;
+    parser->cursor  = cursor;
+    JsonParser_MatchChar(parser, JsonType_String, '"');
+
+    *outRawLength = cursor - start;
+    *outEscaped   = escaped;
+    return parser->buffer + start;
+}
+
+/* Decode a scanned string into the string arena */
+static char* JsonParser_DecodeString(JsonParser* parser, const char* raw, int32_t rawLength, bool escaped, int32_t* outLength)
+{
+    if (rawLength > 0)
+    {
+        // Escapes never expand, so the decoded string is written in place of a raw sized block
+        char* string = JsonAllocator_AllocString(&parser->allocator, rawLength + 1);
+        if (!string)
+        {
+            JsonParser_Panic(parser, JsonType_String, JsonError_OutOfMemory, "Not enough memory for <string>");
+        }
+
+        int32_t length = rawLength;
+        if (escaped)
+        {
+            length = JsonString_Unescape(raw, rawLength, string, rawLength);
+            JsonAllocator_ShrinkString(&parser->allocator, string, rawLength + 1, length + 1);
+        }
+        else
+        {
+            memcpy(string, raw, rawLength);
+        }
+        string[length] = 0;
+
+        if (outLength) *outLength = length;
+        return string;
+    }
+    else
+    {
+        if (outLength) *outLength = 0;
+        return NULL;
+    }
+}
+
+static char* JsonParser_ParseStringNoToken(JsonParser* parser, int32_t* outLength)
+{
+    int32_t     rawLength;
+    bool        escaped;
+    const char* raw = JsonParser_ScanString(parser, &rawLength, &escaped);
+
+    return JsonParser_DecodeString(parser, raw, rawLength, escaped, outLength);
+}
+
+/* @funcdef: JsonParser_ParseString */
+static void JsonParser_ParseString(JsonParser* parser, Json* outValue)
+{
+    if (JsonParser_SkipSpace(parser) > 0)
+    {
+        outValue->type = JsonType_String;
+
+        // Lazy strings reference the source, escaped ones are flagged by a negative raw length
+        if (parser->flags & JsonParseFlags_LazyStrings)
+        {
+            int32_t rawLength;
+            bool    escaped;
+            outValue->string = JsonParser_ScanString(parser, &rawLength, &escaped);
+            outValue->length = escaped ? -rawLength : rawLength;
+        }
+        else
+        {
+            int32_t length;
+            outValue->string = JsonParser_ParseStringNoToken(parser, &length);
+            outValue->length = length;
+        }
+    }
+}
+
+/* @funcdef: JsonParser_ParseObject */
+static void JsonParser_ParseObject(JsonParser* parser, Json* outValue)
+{
+    if (JsonParser_SkipSpace(parser) > 0)
+    {
+        JsonParser_MatchChar(parser, JsonType_Object, '{');
+
+        JsonTempArray(JsonObjectMember, 32) values = JsonTempArray_Init(NULL);
+        while (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != '}')
+        {
+            if (values.count > 0)
+            {
+                JsonParser_MatchChar(parser, JsonType_Object, ',');
+            }
+
+            if (JsonParser_SkipSpace(parser) != '"')
+            {
+                JsonParser_Panic(parser, JsonType_Object, JsonError_UnexpectedToken, "Expected <string> for <member-key> of <object>");
+            }
+
+            const char* name = JsonParser_ParseStringNoToken(parser, 0);
+
+            JsonParser_SkipSpace(parser);
+            JsonParser_MatchChar(parser, JsonType_Object, ':');
+
+            Json value;
+            JsonParser_ParseSingle(parser, &value);
+
+            /* Well done */
+            JsonObjectMember member;
+            member.name  = name;
+            member.value = value;
+            if (!JsonTempArray_Push(&values, member, &parser->allocator))
+            {
+                JsonParser_Panic(parser, JsonType_Object, JsonError_OutOfMemory, "Not enough memory for <object>");
+            }
+        }
+
+        JsonParser_SkipSpace(parser);
+        JsonParser_MatchChar(parser, JsonType_Object, '}');
+
+        outValue->type   = JsonType_Object;
+        outValue->length = JsonTempArray_GetCount(&values);
+        outValue->object = (JsonObjectMember*)JsonParser_ToContainerFrom(parser, &values);
+
+        JsonTempArray_Free(&values, &parser->allocator);
+    }
+}
+
+// -------------------------------------------------------------------
+// Projected parsing: only the subtrees selected by a JsonProjection
+// -------------------------------------------------------------------
+
+/* Copy length bytes of name null-terminated into the path names, returns its offset or -1 when full */
+static int32_t JsonPath_AddName(JsonPath* path, const char* name, int32_t length)
+{
+    if (path->namesLength + length + 1 > JSON_PATH_MAX_NAMES)
+    {
+        return -1;
+    }
+
+    const int32_t offset = path->namesLength;
+    memcpy(path->names + offset, name, length);
+    path->names[offset + length] = 0;
+    path->namesLength += length + 1;
+
+    return offset;
+}
+
+/* Append a segment, its key is copied in the path names */
+static JsonError JsonPath_AddSegment(JsonPath* path, int32_t index, const char* key, int32_t keyLength)
+{
+    if (path->count >= JSON_PATH_MAX_DEPTH)
+    {
+        return JsonError_OutOfMemory;
+    }
+
+    const int32_t offset = JsonPath_AddName(path, key, keyLength);
+    if (offset < 0)
+    {
+        return JsonError_OutOfMemory;
+    }
+
+    JsonPathSegment* segment = &path->segments[path->count++];
+    segment->index     = index;
+    segment->keyOffset = offset;
+    segment->keyLength = keyLength;
+
+    return JsonError_None;
+}
+
+/* @funcdef: JsonPathCompile */
+JsonError JsonPathCompile(const char* path, JsonPath* outPath)
+{
+    JSON_ASSERT(path, "path mustnot be null");
+    JSON_ASSERT(outPath, "outPath mustnot be null");
+
+    outPath->count       = 0;
+    outPath->namesLength = 0;
+
+    // `$`, `$.a` or `$[0]`
+    const char* c = path;
+    if (*c == '$' && (*++c == '.' ? (*++c == 0 || *c == '.' || *c == '[') : (*c != 0 && *c != '[')))
+    {
+        return JsonError_WrongFormat;
+    }
+
+    while (*c)
+    {
+        JsonError error;
+        if (*c == '[')
+        {
+            c++;
+
+            int32_t index = 0;
+            if (*c == '*')
+            {
+                index = JSON_PATH_ANY;
+                c++;
+            }
+            else if (*c >= '0' && *c <= '9')
+            {
+                while (*c >= '0' && *c <= '9')
+                {
+                    if (index > (INT32_MAX - 9) / 10)
+                    {
+                        return JsonError_WrongFormat;
+                    }
+
+                    index = index * 10 + (*c++ - '0');
+                }
+            }
+            else
+            {
+                return JsonError_WrongFormat;
+            }
+
+            // An index is followed by another step or the end
+            if (*c++ != ']' || (*c != 0 && *c != '.' && *c != '['))
+            {
+                return JsonError_WrongFormat;
+            }
+
+            error = JsonPath_AddSegment(outPath, index, "", 0);
+        }
+        else
+        {
+            const char* key = c;
+            while (*c && *c != '.' && *c != '[')
+            {
+                c++;
+            }
+
+            const int32_t keyLength = (int32_t)(c - key);
+            if (keyLength == 0)
+            {
+                return JsonError_WrongFormat;
+            }
+
+            const bool any = keyLength == 1 && key[0] == '*';
+            error = JsonPath_AddSegment(outPath, any ? JSON_PATH_ANY : JSON_PATH_KEY, key, any ? 0 : keyLength);
+        }
+
+        if (error != JsonError_None)
+        {
+            return error;
+        }
+
+        // A dot is always followed by a key
+        if (*c == '.' && (*++c == 0 || *c == '.' || *c == '['))
+        {
+            return JsonError_WrongFormat;
+        }
+    }
+
+    return JsonError_None;
+}
+
+/* @funcdef: JsonPointerCompile */
+JsonError JsonPointerCompile(const char* pointer, JsonPath* outPath)
+{
+    JSON_ASSERT(pointer, "pointer mustnot be null");
+    JSON_ASSERT(outPath, "outPath mustnot be null");
+
+    outPath->count       = 0;
+    outPath->namesLength = 0;
+
+    // The empty pointer is the whole document
+    const char* c = pointer;
+    while (*c)
+    {
+        if (*c++ != '/')
+        {
+            return JsonError_WrongFormat;
+        }
+
+        char    key[JSON_PATH_MAX_NAMES];
+        int32_t keyLength = 0;
+        bool    digits    = true;
+        for (; *c && *c != '/'; c++)
+        {
+            char ch = *c;
+            if (ch == '~')
+            {
+                ch = *++c == '0' ? '~' : *c == '1' ? '/' : 0;
+                if (ch == 0)
+                {
+                    return JsonError_WrongFormat;
+                }
+            }
+
+            if (keyLength >= JSON_PATH_MAX_NAMES - 1)
+            {
+                return JsonError_OutOfMemory;
+            }
+
+            digits = digits && ch >= '0' && ch <= '9';
+            key[keyLength++] = ch;
+        }
+
+        // Reference tokens are keys, canonical numbers also index arrays (RFC 6901, section 4)
+        int32_t index = JSON_PATH_KEY;
+        if (digits && keyLength > 0 && keyLength <= 9 && (keyLength == 1 || key[0] != '0'))
+        {
+            index = 0;
+            for (int32_t i = 0; i < keyLength; i++)
+            {
+                index = index * 10 + (key[i] - '0');
+            }
+        }
+
+        const JsonError error = JsonPath_AddSegment(outPath, index, key, keyLength);
+        if (error != JsonError_None)
+        {
+            return error;
+        }
+    }
+
+    return JsonError_None;
+}
+
+/* @funcdef: JsonProjectionCompile */
+JsonError JsonProjectionCompile(const char* const* paths, int32_t pathCount, JsonProjection* outProjection)
+{
+    JSON_ASSERT(outProjection, "outProjection mustnot be null");
+
+    outProjection->count = 0;
+    if (pathCount > JSON_PROJECTION_MAX_PATHS)
+    {
+        return JsonError_OutOfMemory;
+    }
+
+    for (int32_t i = 0; i < pathCount; i++)
+    {
+        const JsonError error = JsonPathCompile(paths[i], &outProjection->paths[i]);
+        if (error != JsonError_None)
+        {
+            return error;
+        }
+    }
+
+    outProjection->count = pathCount;
+    return JsonError_None;
+}
+
+/* Paths of mask which select the member key at depth */
+static uint32_t JsonProjection_MatchKey(const JsonProjection* projection, uint32_t mask, int32_t depth, const char* key, int32_t keyLength)
+{
+    uint32_t result = 0;
+    for (int32_t i = 0; i < projection->count; i++)
+    {
+        if (mask & (1u << i))
+        {
+            const JsonPath*        path    = &projection->paths[i];
+            const JsonPathSegment* segment = &path->segments[depth];
+            if (segment->index == JSON_PATH_ANY 
+                || ((segment->index == JSON_PATH_KEY || segment->keyLength > 0) && segment->keyLength == keyLength && memcmp(path->names + segment->keyOffset, key, keyLength) == 0))
+            {
+                result |= 1u << i;
+            }
+        }
+    }
+    return result;
+}
+
+/* Paths of mask which select the element index at depth */
+static uint32_t JsonProjection_MatchIndex(const JsonProjection* projection, uint32_t mask, int32_t depth, int32_t index)
+{
+    uint32_t result = 0;
+    for (int32_t i = 0; i < projection->count; i++)
+    {
+        if (mask & (1u << i))
+        {
+            const int32_t segmentIndex = projection->paths[i].segments[depth].index;
+            if (segmentIndex == JSON_PATH_ANY || segmentIndex == index)
+            {
+                result |= 1u << i;
+            }
+        }
+    }
+    return result;
+}
+
+/* Move the parser to where a skip stopped, so errors point at the offending byte */
+static void JsonParser_SkipValueAt(JsonParser* parser, int32_t cursor, int32_t line, int32_t lineStart)
+{
+    parser->cursor = cursor < parser->length ? cursor : parser->length;
+    parser->line   = line;
+    parser->column = parser->cursor - lineStart + 1;
+}
+
+/* Skip a value without materializing it, only brackets, quotes and comments are tracked */
+static void JsonParser_SkipValue(JsonParser* parser)
+{
+    JsonParser_SkipSpace(parser);
+
+    const char*        buffer   = parser->buffer;
+    const int32_t      length   = parser->length;
+    const bool         comments = (parser->flags & JsonParseFlags_SupportComment) != 0;
+    const JsonKernels* kernels  = parser->kernels;
+
+    int32_t cursor    = parser->cursor;
+    int32_t line      = parser->line;
+    int32_t lineStart = cursor - (parser->column - 1);
+    int32_t depth     = 0;
+    uint64_t stack[(JSON_SKIP_MAX_DEPTH + 63) / 64];
+
+    while (cursor < length)
+    {
+        const char c = buffer[cursor];
+        if (c == '"')
+        {
+            for (cursor++; cursor < length; cursor += buffer[cursor] == '\\' ? 2 : 1)
+            {
+                cursor += JsonKernels_Call(kernels, scanString)((const uint8_t*)buffer + cursor, length - cursor);
+                if (cursor >= length || buffer[cursor] == '"')
+                {
+                    break;
+                }
+            }
+
+            cursor++;
+            if (depth == 0)
+            {
+                break;
+            }
+        }
+        else if (c == '{' || c == '[')
+        {
+            if (depth == JSON_SKIP_MAX_DEPTH)
+            {
+                JsonParser_SkipValueAt(parser, cursor, line, lineStart);
+                JsonParser_Panic(parser, JsonType_Null, JsonError_OutOfMemory, "Nesting is deeper than %d levels", JSON_SKIP_MAX_DEPTH);
+            }
+
+            const uint64_t bit = (uint64_t)1 << (depth & 63);
+            stack[depth >> 6] = c == '{' ? stack[depth >> 6] | bit : stack[depth >> 6] & ~bit;
+            depth++;
+            cursor++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (depth == 0)
+            {
+                break;
+            }
+
+            // Closers must match the kind of their opener, not only balance the count
+            const int close = (stack[(depth - 1) >> 6] >> ((depth - 1) & 63)) & 1 ? '}' : ']';
+            if (c != close)
+            {
+                JsonParser_SkipValueAt(parser, cursor, line, lineStart);
+                JsonParser_Panic(parser, JsonType_Null, JsonError_UnmatchToken, "Expected '%c'", (char)close);
+            }
+
+            cursor++;
+            if (--depth == 0)
+            {
+                break;
+            }
+        }
+        else if (depth == 0 && (c == ',' || c == '/' || JsonParser_IsCharClass(c, JsonCharClass_Space)))
+        {
+            break;
+        }
+        else if (c == '/' && comments && cursor + 1 < length && (buffer[cursor + 1] == '/' || buffer[cursor + 1] == '*'))
+        {
+            // The '*' of the opener cannot also close the comment, so "*/" is only looked for from cursor + 3 on
+            const bool    block  = buffer[cursor + 1] == '*';
+            const int32_t opener = cursor;
+            for (cursor += 2; cursor < length && (block ? !(cursor > opener + 2 && buffer[cursor - 1] == '*' && buffer[cursor] == '/') : buffer[cursor] != '\n'); cursor++)
+            {
+                if (buffer[cursor] == '\n')
+                {
+                    line++;
+                    lineStart = cursor + 1;
+                }
+            }
+
+            cursor += block;
+        }
+        else
+        {
+            if (c == '\n')
+            {
+                line++;
+                lineStart = cursor + 1;
+            }
+
+            cursor++;
+
+            // Inside a container only the structural bytes need a look
+            if (depth > 0 && cursor < length)
+            {
+                cursor += JsonKernels_Call(kernels, scanStructural)((const uint8_t*)buffer + cursor, length - cursor);
+            }
+        }
+    }
+
+    JsonParser_SkipValueAt(parser, cursor, line, lineStart);
+    if (depth > 0 || cursor > length)
+    {
+        JsonParser_Panic(parser, JsonType_Null, JsonError_WrongFormat, "Unterminated value");
+    }
+}
+
+static bool JsonParser_ParseProjected(JsonParser* parser, uint32_t mask, int32_t depth, Json* outValue);
+
+/* @funcdef: JsonParser_ParseProjectedArray */
+static void JsonParser_ParseProjectedArray(JsonParser* parser, uint32_t mask, int32_t depth, Json* outValue)
+{
+    const JsonProjection* projection = parser->projection;
+
+    // Elements after the last selected index are never kept
+    bool    anyElement = false;
+    int32_t lastIndex  = -1;
+    for (int32_t i = 0; i < projection->count; i++)
+    {
+        if (mask & (1u << i))
+        {
+            const int32_t index = projection->paths[i].segments[depth].index;
+            anyElement = anyElement || index == JSON_PATH_ANY;
+            lastIndex  = index > lastIndex ? index : lastIndex;
+        }
+    }
+
+    JsonParser_MatchChar(parser, JsonType_Array, '[');
+
+    // Dropped elements only become null when a later one is kept, so indices still match the source
+    int32_t index        = 0;
+    int32_t pendingNulls = 0;
+
+    JsonTempArray(Json, 64) values = JsonTempArray_Init(NULL);
+    while (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != ']')
+    {
+        if (index > 0)
+        {
+            JsonParser_MatchChar(parser, JsonType_Array, ',');
+        }
+
+        const uint32_t childMask = (anyElement || index <= lastIndex) ? JsonProjection_MatchIndex(projection, mask, depth, index) : 0;
+        index++;
+
+        Json value;
+        if (childMask && JsonParser_ParseProjected(parser, childMask, depth + 1, &value))
+        {
+            for (; pendingNulls > 0; pendingNulls--)
+            {
+                if (!JsonTempArray_Push(&values, JSON_NULL, &parser->allocator))
+                {
+                    JsonParser_Panic(parser, JsonType_Array, JsonError_OutOfMemory, "Not enough memory for <array>");
+                }
+            }
+
+            if (!JsonTempArray_Push(&values, value, &parser->allocator))
+            {
+                JsonParser_Panic(parser, JsonType_Array, JsonError_OutOfMemory, "Not enough memory for <array>");
+            }
+        }
+        else
+        {
+            if (!childMask)
+            {
+                JsonParser_SkipValue(parser);
+            }
+
+            pendingNulls++;
+        }
+    }
+
+    JsonParser_SkipSpace(parser);
+    JsonParser_MatchChar(parser, JsonType_Array, ']');
+
+    outValue->type   = JsonType_Array;
+    outValue->length = JsonTempArray_GetCount(&values);
+    outValue->array  = (Json*)JsonParser_ToContainerFrom(parser, &values);
+
+    JsonTempArray_Free(&values, &parser->allocator);
+}
+
+/* @funcdef: JsonParser_ParseProjectedObject */
+static void JsonParser_ParseProjectedObject(JsonParser* parser, uint32_t mask, int32_t depth, Json* outValue)
+{
+    JsonParser_MatchChar(parser, JsonType_Object, '{');
+
+    int32_t count = 0;
+
+    JsonTempArray(JsonObjectMember, 32) values = JsonTempArray_Init(NULL);
+    while (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != '}')
+    {
+        if (count++ > 0)
+        {
+            JsonParser_MatchChar(parser, JsonType_Object, ',');
+        }
+
+        if (JsonParser_SkipSpace(parser) != '"')
+        {
+            JsonParser_Panic(parser, JsonType_Object, JsonError_UnexpectedToken, "Expected <string> for <member-key> of <object>");
+        }
+
+        // Keys are compared before anything is allocated
+        int32_t     rawLength;
+        bool        escaped;
+        const char* raw = JsonParser_ScanString(parser, &rawLength, &escaped);
+
+        uint32_t childMask;
+        if (escaped)
+        {
+            char          key[JSON_PATH_MAX_NAMES];
+            const int32_t keyLength = JsonString_Unescape(raw, rawLength, key, JSON_PATH_MAX_NAMES);
+            childMask = keyLength <= JSON_PATH_MAX_NAMES ? JsonProjection_MatchKey(parser->projection, mask, depth, key, keyLength) : 0;
+        }
+        else
+        {
+            childMask = JsonProjection_MatchKey(parser->projection, mask, depth, raw, rawLength);
+        }
+
+        JsonParser_SkipSpace(parser);
+        JsonParser_MatchChar(parser, JsonType_Object, ':');
+
+        Json value;
+        if (childMask && JsonParser_ParseProjected(parser, childMask, depth + 1, &value))
+        {
+            JsonObjectMember member;
+            member.name  = JsonParser_DecodeString(parser, raw, rawLength, escaped, NULL);
+            member.value = value;
+            if (!JsonTempArray_Push(&values, member, &parser->allocator))
+            {
+                JsonParser_Panic(parser, JsonType_Object, JsonError_OutOfMemory, "Not enough memory for <object>");
+            }
+        }
+        else if (!childMask)
+        {
+            JsonParser_SkipValue(parser);
+        }
+    }
+
+    JsonParser_SkipSpace(parser);
+    JsonParser_MatchChar(parser, JsonType_Object, '}');
+
+    outValue->type   = JsonType_Object;
+    outValue->length = JsonTempArray_GetCount(&values);
+    outValue->object = (JsonObjectMember*)JsonParser_ToContainerFrom(parser, &values);
+
+    JsonTempArray_Free(&values, &parser->allocator);
+}
+
+/* Parse a value reached by the paths of mask after depth segments, false when it is skipped */
+static bool JsonParser_ParseProjected(JsonParser* parser, uint32_t mask, int32_t depth, Json* outValue)
+{
+    const JsonProjection* projection = parser->projection;
+
+    // A path ending here selects the whole subtree
+    for (int32_t i = 0; i < projection->count; i++)
+    {
+        if ((mask & (1u << i)) && projection->paths[i].count == depth)
+        {
+            JsonParser_ParseSingle(parser, outValue);
+            return true;
+        }
+    }
+
+    const int c = JsonParser_SkipSpace(parser);
+    if (c == '{')
+    {
+        JsonParser_ParseProjectedObject(parser, mask, depth, outValue);
+        return true;
+    }
+    else if (c == '[')
+    {
+        JsonParser_ParseProjectedArray(parser, mask, depth, outValue);
+        return true;
+    }
+    else
+    {
+        // Scalars cannot hold the rest of the paths
+        JsonParser_SkipValue(parser);
+        return false;
+    }
+}
+
+/* Parse the top level container, through the projection when the parser has one */
+static void JsonParser_ParseRoot(JsonParser* parser, Json* outValue)
+{
+    if (parser->projection)
+    {
+        const uint32_t mask = parser->projection->count < 32 ? (1u << parser->projection->count) - 1 : ~0u;
+        if (!JsonParser_ParseProjected(parser, mask, 0, outValue))
+        {
+            *outValue = JSON_NULL;
+        }
+    }
+    else
+    {
+        JsonParser_ParseSingle(parser, outValue);
+    }
+}
+
+/* Internal parsing function
+ */
+static Json* JsonState_ParseTopLevel(JsonParser* parser)
+{
+    JSON_ASSERT(parser, "parser mustnot be null");
+
+    Json* value = (Json*)JsonAllocator_AllocLower(&parser->allocator, NULL, 0, sizeof(Json));
+    value->type = JsonType_Null;
+
+    // Use setjmp for quick exit when parse error happend
+    if (setjmp(parser->errjmp) == 0)
+    {
+        // Just parse value from the top level
+        if (parser->flags & JsonParseFlags_NoStrictTopLevel)
+        {
+            JsonParser_ParseRoot(parser, value);
+        }
+        // Make sure the toplevel is JsonType_Object
+        else if (JsonParser_SkipSpace(parser) == '{')
+        {
+            JsonParser_ParseRoot(parser, value);
+
+            JsonParser_SkipSpace(parser);
+            if (!JsonParser_IsAtEnd(parser))
+            {
+                JsonParser_Panic(parser, JsonType_Null, JsonError_WrongFormat, "JSON is not well-formed. JSON is start with <object>.");
+            }
+        }
+        // Make sure the toplevel is JsonType_Array
+        else if (JsonParser_SkipSpace(parser) == '[')
+        {
+            JsonParser_ParseRoot(parser, value);
+
+            JsonParser_SkipSpace(parser);
+            if (!JsonParser_IsAtEnd(parser))
+            {
+                JsonParser_Panic(parser, JsonType_Null, JsonError_WrongFormat, "JSON is not well-formed. JSON is start with <array>.");
+            }
+        }
+        else
+        {
+            JsonParser_SetError(parser, JsonType_Null, JsonError_WrongFormat, "JSON must be starting with '{' or '[', first character is '%c'", JsonParser_PeekChar(parser));
+        }
+    }
+
+    return value;
+}
+
+/* Shared body of the DOM parsing entry points */
+static JsonResult JsonParser_Run(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonProjection* projection, void* buffer, int32_t bufferSize, void* stringBuffer, int32_t stringBufferSize, Json* outValue)
+{
+    JSON_ASSERT(outValue, "outValue mustnot be null");
+
+    // Validate json input
+    if (!jsonCode || jsonCodeLength <= 0)
+    {
+        //const JsonResult result = { JsonError_WrongFormat, "Json code is empty", NULL, 0 };
+        const JsonResult result = { JsonError_WrongFormat, "Json code is empty", 0 };
+        return result;
+    }
+    
+    // Create new allocator
+    JsonAllocator allocator;
+    if (!JsonAllocator_Init(&allocator, buffer, bufferSize))
+    {
+        //const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", NULL, 0 };
+        const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", 0 };
+        return result;
+    }
+
+    // Strings go to their own region when the user gives one
+    if (stringBuffer && !JsonAllocator_InitStrings(&allocator, stringBuffer, stringBufferSize))
+    {
+        const JsonResult result = { JsonError_OutOfMemory, "String buffer is too small", 0 };
+        return result;
+    }
+
+    // Create parser
+    JsonParser parser;
+    if (!JsonParser_Init(&parser, jsonCode, jsonCodeLength, allocator, flags))
+    {
+        //const JsonResult result = { JsonError_InternalFatal, "Wrong behaviour when create new parser", NULL, 0 };
+        const JsonResult result = { JsonError_InternalFatal, "Wrong behaviour when create new parser", 0 };
+        return result;
+    }
+    parser.projection = projection;
+    
+    // Parse the top level
+    Json* value = JsonState_ParseTopLevel(&parser);
+    JSON_ASSERT(value, "value mustnot be null");
+    *outValue = *value;
+
+    // Done!
+	JsonResult result;
+	result.error = parser.errnum;
+	result.message = parser.errmsg;
+
+    //result.parser = NULL;
+	result.memoryUsage = (int32_t)(parser.allocator.lowerMarker - (uint8_t*)buffer);
+    result.stringMemoryUsage = stringBuffer ? (int32_t)(parser.allocator.stringMarker - (uint8_t*)stringBuffer) : 0;
+    return result;
+}
+
+/* @funcdef: JsonParse */
+JsonResult JsonParse(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, void* buffer, int32_t bufferSize, Json* outValue)
+{
+    return JsonParseWithStringBuffer(jsonCode, jsonCodeLength, flags, buffer, bufferSize, NULL, 0, outValue);
+}
+
+/* @funcdef: JsonParseWithStringBuffer */
+JsonResult JsonParseWithStringBuffer(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, void* buffer, int32_t bufferSize, void* stringBuffer, int32_t stringBufferSize, Json* outValue)
+{
+    return JsonParser_Run(jsonCode, jsonCodeLength, flags, NULL, buffer, bufferSize, stringBuffer, stringBufferSize, outValue);
+}
+
+/* @funcdef: JsonParseProjected */
+JsonResult JsonParseProjected(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonProjection* projection, void* buffer, int32_t bufferSize, Json* outValue)
+{
+    JSON_ASSERT(projection, "projection mustnot be null");
+
+    return JsonParser_Run(jsonCode, jsonCodeLength, flags, projection, buffer, bufferSize, NULL, 0, outValue);
+}
+
+// -------------------------------------------------------------------
+// Events parsing: same tokenizer, no DOM
+// -------------------------------------------------------------------
+
+typedef struct JsonEmitter
+{
+    JsonParser          parser;
+    const JsonHandler*  handler;
+    void*               user;
+} JsonEmitter;
+
+/* Stop parsing when the handler rejects an event */
+static void JsonEmitter_Check(JsonEmitter* emitter, JsonType type, bool accepted)
+{
+    if (!accepted)
+    {
+        JsonParser_Panic(&emitter->parser, type, JsonError_InvalidValue, "Parsing is stopped by the handler");
+    }
+}
+
+/* @funcdef: JsonEmitter_EmitScalar */
+static void JsonEmitter_EmitScalar(JsonEmitter* emitter, int c)
+{
+    JsonParser*         parser  = &emitter->parser;
+    const JsonHandler*  handler = emitter->handler;
+
+    Json value;
+    switch (c)
+    {
+    case '"':
+        JsonParser_ParseString(parser, &value);
+        JsonEmitter_Check(emitter, JsonType_String, !handler->onString || handler->onString(emitter->user, value));
+        break;
+
+    case '+': case '-': case '0': 
+    case '1': case '2': case '3': 
+    case '4': case '5': case '6': 
+    case '7': case '8': case '9':
+        JsonParser_ParseNumber(parser, &value);
+        JsonEmitter_Check(emitter, JsonType_Number, !handler->onNumber || handler->onNumber(emitter->user, value));
+        break;
+
+    case '/':
+        JsonParser_Panic(parser, JsonType_String, JsonError_UnknownToken, "Unknown token '%c'", c);
+        break;
+
+    default:
+        JsonParser_ParseLiteral(parser, &value);
+        if (value.type == JsonType_Boolean)
+        {
+            JsonEmitter_Check(emitter, JsonType_Boolean, !handler->onBoolean || handler->onBoolean(emitter->user, c == 't'));
+        }
+        else
+        {
+            JsonEmitter_Check(emitter, JsonType_Null, !handler->onNull || handler->onNull(emitter->user));
+        }
+        break;
+    }
+}
+
+/* Walk the values with an explicit bit stack of containers like JsonValidate, set bits are objects */
+static void JsonEmitter_Run(JsonEmitter* emitter)
+{
+    JsonParser*         parser  = &emitter->parser;
+    const JsonHandler*  handler = emitter->handler;
+
+    uint64_t stack[(JSON_EVENTS_MAX_DEPTH + 63) / 64];
+    int32_t  depth  = 0;
+    bool     member = false;
+    for (;;)
+    {
+        if (member)
+        {
+            if (JsonParser_SkipSpace(parser) != '"')
+            {
+                JsonParser_Panic(parser, JsonType_Object, JsonError_UnexpectedToken, "Expected <string> for <member-key> of <object>");
+            }
+
+            int32_t rawLength;
+            bool    escaped;
+
+            Json name;
+            name.type   = JsonType_String;
+            name.string = JsonParser_ScanString(parser, &rawLength, &escaped);
+            name.length = escaped ? -rawLength : rawLength;
+            JsonEmitter_Check(emitter, JsonType_Object, !handler->onKey || handler->onKey(emitter->user, name));
+
+            JsonParser_SkipSpace(parser);
+            JsonParser_MatchChar(parser, JsonType_Object, ':');
+        }
+
+        int c = JsonParser_SkipSpace(parser);
+        if (c == '[' || c == '{')
+        {
+            const JsonType type = c == '{' ? JsonType_Object : JsonType_Array;
+            if (depth == JSON_EVENTS_MAX_DEPTH)
+            {
+                JsonParser_Panic(parser, type, JsonError_OutOfMemory, "Nesting is deeper than %d levels", JSON_EVENTS_MAX_DEPTH);
+            }
+
+            JsonParser_MatchChar(parser, type, c);
+            if (type == JsonType_Object)
+            {
+                JsonEmitter_Check(emitter, type, !handler->onStartObject || handler->onStartObject(emitter->user));
+            }
+            else
+            {
+                JsonEmitter_Check(emitter, type, !handler->onStartArray || handler->onStartArray(emitter->user));
+            }
+
+            const uint64_t bit = (uint64_t)1 << (depth & 63);
+            stack[depth >> 6] = type == JsonType_Object ? stack[depth >> 6] | bit : stack[depth >> 6] & ~bit;
+            depth++;
+
+            // Non-empty containers go on with their first member or element
+            const int close = type == JsonType_Object ? '}' : ']';
+            if (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != close)
+            {
+                member = type == JsonType_Object;
+                continue;
+            }
+        }
+        else if (c > 0)
+        {
+            JsonEmitter_EmitScalar(emitter, c);
+        }
+        else if (depth == 0)
+        {
+            return;
+        }
+
+        // After a value: a comma, or the end of one or more containers
+        for (;;)
+        {
+            if (depth == 0)
+            {
+                return;
+            }
+
+            const bool     inObject = (stack[(depth - 1) >> 6] >> ((depth - 1) & 63)) & 1;
+            const JsonType type     = inObject ? JsonType_Object : JsonType_Array;
+            const int      close    = inObject ? '}' : ']';
+
+            c = JsonParser_SkipSpace(parser);
+            if (c > 0 && c != close)
+            {
+                JsonParser_MatchChar(parser, type, ',');
+                member = inObject;
+                break;
+            }
+
+            JsonParser_MatchChar(parser, type, close);
+            if (inObject)
+            {
+                JsonEmitter_Check(emitter, type, !handler->onEndObject || handler->onEndObject(emitter->user));
+            }
+            else
+            {
+                JsonEmitter_Check(emitter, type, !handler->onEndArray || handler->onEndArray(emitter->user));
+            }
+            depth--;
+        }
+    }
+}
+
+/* @funcdef: JsonParseEvents */
+JsonResult JsonParseEvents(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonHandler* handler, void* user)
+{
+    JSON_ASSERT(handler, "handler mustnot be null");
+
+    if (!jsonCode || jsonCodeLength <= 0)
+    {
+        const JsonResult result = { JsonError_WrongFormat, "Json code is empty", 0 };
+        return result;
+    }
+
+    // Nothing is allocated while parsing, the buffer only holds the error message, which outlives the call until the next one on this thread
+    static JSON_THREAD_LOCAL uint8_t buffer[1024 + 2 * sizeof(Json)];
+    JsonAllocator allocator;
+    JsonAllocator_Init(&allocator, buffer, (int32_t)sizeof(buffer));
+
+    // Strings are never copied, they are handed over as lazy strings
+    JsonEmitter emitter;
+    emitter.handler = handler;
+    emitter.user    = user;
+    JsonParser_Init(&emitter.parser, jsonCode, jsonCodeLength, allocator, (JsonParseFlags)(flags | JsonParseFlags_LazyStrings));
+
+    JsonParser* parser = &emitter.parser;
+    if (setjmp(parser->errjmp) == 0)
+    {
+        const int c = JsonParser_SkipSpace(parser);
+        if ((parser->flags & JsonParseFlags_NoStrictTopLevel) || c == '{' || c == '[')
+        {
+            JsonEmitter_Run(&emitter);
+
+            JsonParser_SkipSpace(parser);
+            if (!(parser->flags & JsonParseFlags_NoStrictTopLevel) && !JsonParser_IsAtEnd(parser))
+            {
+                JsonParser_Panic(parser, JsonType_Null, JsonError_WrongFormat, "JSON is not well-formed. JSON is start with <%s>.", c == '{' ? "object" : "array");
+            }
+        }
+        else
+        {
+            JsonParser_SetError(parser, JsonType_Null, JsonError_WrongFormat, "JSON must be starting with '{' or '[', first character is '%c'", c);
+        }
+    }
+
+    JsonResult result;
+    result.error             = parser->errnum;
+    result.message           = parser->errmsg;
+    result.memoryUsage       = 0;
+    result.stringMemoryUsage = 0;
+    return result;
+}
+
+/* Cursor of JsonValidate */
+typedef struct JsonValidator
+{
+    const uint8_t*      cursor;
+    const uint8_t*      end;
+    JsonParseFlags      flags;
+    const JsonKernels*  kernels;
+} JsonValidator;
+
+/* Length of the UTF-8 sequence at ptr, 0 for overlong forms, surrogates, code points above U+10FFFF and truncated sequences */
+static int32_t JsonValidator_Utf8Length(const uint8_t* ptr, const uint8_t* end)
+{
+    const uint8_t c      = ptr[0];
+    uint8_t       lower  = 0x80;
+    uint8_t       upper  = 0xBF;
+    int32_t       length;
+
+    if (c >= 0xC2 && c <= 0xDF)
+    {
+        length = 2;
+    }
+    else if (c >= 0xE0 && c <= 0xEF)
+    {
+        length = 3;
+        lower  = c == 0xE0 ? 0xA0 : lower;
+        upper  = c == 0xED ? 0x9F : upper;
+    }
+    else if (c >= 0xF0 && c <= 0xF4)
+    {
+        length = 4;
+        lower  = c == 0xF0 ? 0x90 : lower;
+        upper  = c == 0xF4 ? 0x8F : upper;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (end - ptr < length || ptr[1] < lower || ptr[1] > upper)
+    {
+        return 0;
+    }
+
+    for (int32_t i = 2; i < length; i++)
+    {
+        if ((ptr[i] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+    }
+
+    return length;
+}
+
+/* Skip whitespace and, with JsonParseFlags_SupportComment, comments; false on an unterminated block comment */
+static bool JsonValidator_SkipSpace(JsonValidator* validator)
+{
+    const uint8_t* ptr = validator->cursor;
+    const uint8_t* end = validator->end;
+
+    // Compact JSON has no space between most tokens
+    if (ptr < end && *ptr > ' ' && *ptr != '/')
+    {
+        return true;
+    }
+
+    while (ptr < end)
+    {
+        const uint8_t c = *ptr;
+        if (JsonParser_IsCharClass(c, JsonCharClass_Space))
+        {
+            ptr++;
+        }
+        else if (c == '/' && (validator->flags & JsonParseFlags_SupportComment) && end - ptr >= 2 && ptr[1] == '/')
+        {
+            const uint8_t* lineEnd = (const uint8_t*)memchr(ptr, '\n', (size_t)(end - ptr));
+            ptr = lineEnd ? lineEnd + 1 : end;
+        }
+        else if (c == '/' && (validator->flags & JsonParseFlags_SupportComment) && end - ptr >= 2 && ptr[1] == '*')
+        {
+            const uint8_t* star = ptr + 2;
+            while ((star = (const uint8_t*)memchr(star, '*', (size_t)(end - star))) != NULL && (star + 1 >= end || star[1] != '/'))
+            {
+                star++;
+            }
+
+            if (!star)
+            {
+                validator->cursor = ptr;
+                return false;
+            }
+            ptr = star + 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    validator->cursor = ptr;
+    return true;
+}
+
+/* @funcdef: JsonValidator_String */
+static JsonError JsonValidator_String(JsonValidator* validator)
+{
+    const uint8_t* ptr = validator->cursor + 1;
+    const uint8_t* end = validator->end;
+    while (ptr < end)
+    {
+        // Plain ASCII needs no check, the kernel jumps to the next byte that does
+        ptr += JsonKernels_Call(validator->kernels, scanText)(ptr, (int32_t)(end - ptr));
+        if (ptr >= end)
+        {
+            break;
+        }
+
+        const uint8_t c = *ptr;
+        if (c == '"')
+        {
+            validator->cursor = ptr + 1;
+            return JsonError_None;
+        }
+        else if (c == '\\')
+        {
+            validator->cursor = ptr;
+            if (end - ptr < 2)
+            {
+                break;
+            }
+
+            if (ptr[1] == 'u')
+            {
+                for (int32_t i = 2; i < 6; i++)
+                {
+                    if (ptr + i >= end || !JsonParser_IsCharClass(ptr[i], JsonCharClass_Hex))
+                    {
+                        return JsonError_UnknownToken;
+                    }
+                }
+                ptr += 6;
+            }
+            else if (strchr("\"\\/bfnrt", ptr[1]) && ptr[1] != 0)
+            {
+                ptr += 2;
+            }
+            else
+            {
+                return JsonError_UnknownToken;
+            }
+        }
+        else if (c < 0x20)
+        {
+            validator->cursor = ptr;
+            return JsonError_UnexpectedToken;
+        }
+        else if (c < 0x80)
+        {
+            ptr++;
+        }
+        else
+        {
+            const int32_t length = JsonValidator_Utf8Length(ptr, end);
+            if (length == 0)
+            {
+                validator->cursor = ptr;
+                return JsonError_InvalidValue;
+            }
+            ptr += length;
+        }
+    }
+
+    validator->cursor = end;
+    return JsonError_UnmatchToken;
+}
+
+/* -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? */
+static JsonError JsonValidator_Number(JsonValidator* validator)
+{
+    const uint8_t* ptr = validator->cursor;
+    const uint8_t* end = validator->end;
+
+    ptr += *ptr == '-';
+    if (ptr < end && *ptr == '0')
+    {
+        ptr++;
+    }
+    else if (ptr < end && *ptr >= '1' && *ptr <= '9')
+    {
+        while (ptr < end && *ptr >= '0' && *ptr <= '9')
+        {
+            ptr++;
+        }
+    }
+    else
+    {
+        validator->cursor = ptr;
+        return JsonError_UnexpectedToken;
+    }
+
+    if (ptr < end && *ptr == '.')
+    {
+        const uint8_t* digits = ++ptr;
+        while (ptr < end && *ptr >= '0' && *ptr <= '9')
+        {
+            ptr++;
+        }
+
+        if (ptr == digits)
+        {
+            validator->cursor = ptr;
+            return JsonError_UnexpectedToken;
+        }
+    }
+
+    if (ptr < end && (*ptr == 'e' || *ptr == 'E'))
+    {
+        ptr++;
+        ptr += ptr < end && (*ptr == '+' || *ptr == '-');
+
+        const uint8_t* digits = ptr;
+        while (ptr < end && *ptr >= '0' && *ptr <= '9')
+        {
+            ptr++;
+        }
+
+        if (ptr == digits)
+        {
+            validator->cursor = ptr;
+            return JsonError_UnexpectedToken;
+        }
+    }
+
+    validator->cursor = ptr;
+    return JsonError_None;
+}
+
+/* @funcdef: JsonValidator_Scalar */
+static JsonError JsonValidator_Scalar(JsonValidator* validator)
+{
+    const uint8_t c = *validator->cursor;
+    if (c == '"')
+    {
+        return JsonValidator_String(validator);
+    }
+    else if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        return JsonValidator_Number(validator);
+    }
+
+    const char*   literal = c == 't' ? "true" : c == 'f' ? "false" : c == 'n' ? "null" : NULL;
+    const int32_t length  = c == 'f' ? 5 : 4;
+    if (!literal)
+    {
+        return JsonError_UnexpectedToken;
+    }
+
+    if (validator->end - validator->cursor < length || memcmp(validator->cursor, literal, (size_t)length) != 0)
+    {
+        return JsonError_UnknownToken;
+    }
+
+    validator->cursor += length;
+    return JsonError_None;
+}
+
+/* Walk the grammar with an explicit bit stack of containers, set bits are objects */
+static JsonError JsonValidator_Run(JsonValidator* validator)
+{
+    uint64_t stack[(JSON_VALIDATE_MAX_DEPTH + 63) / 64];
+    int32_t  depth = 0;
+
+    if (!JsonValidator_SkipSpace(validator))
+    {
+        return JsonError_UnmatchToken;
+    }
+
+    if (validator->cursor == validator->end)
+    {
+        return JsonError_WrongFormat;
+    }
+
+    if (!(validator->flags & JsonParseFlags_NoStrictTopLevel) && *validator->cursor != '{' && *validator->cursor != '[')
+    {
+        return JsonError_WrongFormat;
+    }
+
+    // Each round reads one value (with its key in objects), then the separators up to the next value
+    bool member = false;
+    for (;;)
+    {
+        if (member)
+        {
+            if (!JsonValidator_SkipSpace(validator))
+            {
+                return JsonError_UnmatchToken;
+            }
+
+            if (validator->cursor == validator->end || *validator->cursor != '"')
+            {
+                return JsonError_UnexpectedToken;
+            }
+
+            const JsonError error = JsonValidator_String(validator);
+            if (error != JsonError_None)
+            {
+                return error;
+            }
+
+            if (!JsonValidator_SkipSpace(validator))
+            {
+                return JsonError_UnmatchToken;
+            }
+
+            if (validator->cursor == validator->end || *validator->cursor != ':')
+            {
+                return JsonError_UnexpectedToken;
+            }
+            validator->cursor++;
+        }
+
+        if (!JsonValidator_SkipSpace(validator))
+        {
+            return JsonError_UnmatchToken;
+        }
+
+        if (validator->cursor == validator->end)
+        {
+            return JsonError_UnmatchToken;
+        }
+
+        const uint8_t c = *validator->cursor;
+        if (c == '{' || c == '[')
+        {
+            if (depth == JSON_VALIDATE_MAX_DEPTH)
+            {
+                return JsonError_OutOfMemory;
+            }
+
+            const uint64_t bit = (uint64_t)1 << (depth & 63);
+            stack[depth >> 6] = c == '{' ? stack[depth >> 6] | bit : stack[depth >> 6] & ~bit;
+            depth++;
+            validator->cursor++;
+
+            if (!JsonValidator_SkipSpace(validator))
+            {
+                return JsonError_UnmatchToken;
+            }
+
+            // Empty containers close right away, otherwise the first member or element follows
+            if (validator->cursor >= validator->end || *validator->cursor != (c == '{' ? '}' : ']'))
+            {
+                member = c == '{';
+                continue;
+            }
+
+            depth--;
+            validator->cursor++;
+        }
+        else
+        {
+            const JsonError error = JsonValidator_Scalar(validator);
+            if (error != JsonError_None)
+            {
+                return error;
+            }
+        }
+
+        // After a value: a comma, or the end of one or more containers
+        for (;;)
+        {
+            if (!JsonValidator_SkipSpace(validator))
+            {
+                return JsonError_UnmatchToken;
+            }
+
+            if (depth == 0)
+            {
+                return validator->cursor == validator->end ? JsonError_None : JsonError_WrongFormat;
+            }
+
+            if (validator->cursor == validator->end)
+            {
+                return JsonError_UnmatchToken;
+            }
+
+            const bool    inObject = (stack[(depth - 1) >> 6] >> ((depth - 1) & 63)) & 1;
+            const uint8_t next     = *validator->cursor;
+            if (next == (inObject ? '}' : ']'))
+            {
+                depth--;
+                validator->cursor++;
+            }
+            else if (next == ',')
+            {
+                validator->cursor++;
+                member = inObject;
+                break;
+            }
+            else
+            {
+                return next == '}' || next == ']' ? JsonError_UnmatchToken : JsonError_UnexpectedToken;
+            }
+        }
+    }
+}
+
+/* @funcdef: JsonValidate */
+JsonError JsonValidate(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, int32_t* outErrorOffset)
+{
+    JsonValidator validator;
+    validator.cursor  = (const uint8_t*)jsonCode;
+    validator.end     = (const uint8_t*)jsonCode + (jsonCode && jsonCodeLength > 0 ? jsonCodeLength : 0);
+    validator.flags   = flags;
+    validator.kernels = JsonKernels_Get();
+
+    const JsonError error = JsonValidator_Run(&validator);
+    if (outErrorOffset)
+    {
+        *outErrorOffset = error == JsonError_None ? -1 : (int32_t)(validator.cursor - (const uint8_t*)jsonCode);
+    }
+
+    return error;
+}
+
+/* @funcdef: JsonContinueParse */
+//JsonResult JsonContinueParse(JsonParser* parser, Json* outValue)
+//{
+//    JSON_ASSERT(outValue, "outValue mustnot be null");
+//
+//    // Validate json input
+//    if (!jsonCode || jsonCodeLength <= 0)
+//    {
+//        const JsonResult result = { JsonError_WrongFormat, "Json code is empty", 0 };
+//        return result;
+//    }
+//
+//    // Create new allocator
+//    JsonAllocator allocator;
+//    if (!JsonAllocator_Init(&allocator, buffer, bufferSize))
+//    {
+//        const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", 0 };
+//        return result;
+//    }
+//
+//    // Create parser
+//    JsonParser parser;
+//    if (!JsonParser_Init(&parser, jsonCode, jsonCodeLength, allocator, flags))
+//    {
+//        const JsonResult result = { JsonError_InternalFatal, "Wrong behaviour when create new parser", 0 };
+//        return result;
+//    }
+//
+//    // Parse the top level
+//    Json* value = JsonState_ParseTopLevel(&parser);
+//    JSON_ASSERT(value, "value mustnot be null");
+//    *outValue = *value;
+//
+//    // Done!
+//    JsonResult result;
+//    result.error = parser.errnum;
+//    result.message = parser.errmsg;
+//    result.memoryUsage = (int32_t)(parser.allocator.lowerMarker - (uint8_t*)buffer);
+//    return result;
+//}
+
+/* @funcdef: JsonGetNumber */
+double JsonGetNumber(const Json value)
+{
+    if (value.type != JsonType_Number)
+    {
+        return 0;
+    }
+
+    return value.length < 0 ? JsonParser_ConvertNumber(value.rawNumber, -value.length) : value.number;
+}
+
+/* @funcdef: JsonGetInt64 */
+bool JsonGetInt64(const Json value, int64_t* outResult)
+{
+    JSON_ASSERT(outResult, "outResult mustnot be null");
+
+    if (value.type != JsonType_Number)
+    {
+        *outResult = 0;
+        return false;
+    }
+
+    // Integer text is converted exactly, beyond the 53 bits of a double
+    if (value.length < 0)
+    {
+        const char* text = value.rawNumber;
+        const char* end  = text - value.length;
+
+        const bool negative = *text == '-';
+        if (negative)
+        {
+            text++;
+        }
+
+        uint64_t integer = 0;
+        while (text < end && *text >= '0' && *text <= '9')
+        {
+            const uint64_t digit = (uint64_t)(*text++ - '0');
+            if (integer > (UINT64_MAX - digit) / 10)
+            {
+                break;
+            }
+            integer = integer * 10 + digit;
+        }
+
+        if (text == end)
+        {
+            const uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+            if (integer <= limit)
+            {
+                *outResult = negative ? (int64_t)(0 - integer) : (int64_t)integer;
+                return true;
+            }
+        }
+    }
+
+    const double number = JsonGetNumber(value);
+    if (number >= -9223372036854775808.0 && number < 9223372036854775808.0 && number == (double)(int64_t)number)
+    {
+        *outResult = (int64_t)number;
+        return true;
+    }
+
+    *outResult = 0;
+    return false;
+}
+
+/* @funcdef: JsonCopyString */
+int32_t JsonCopyString(const Json value, char* buffer, int32_t bufferSize)
+{
+    JSON_ASSERT(buffer || bufferSize <= 0, "buffer mustnot be null");
+
+    int32_t length = 0;
+    if (value.type == JsonType_String)
+    {
+        const int32_t capacity = bufferSize > 0 ? bufferSize - 1 : 0;
+        if (value.length < 0)
+        {
+            length = JsonString_Unescape(value.string, -value.length, buffer, capacity);
+        }
+        else
+        {
+            length = value.length;
+            if (length > 0)
+            {
+                memcpy(buffer, value.string, (size_t)(length < capacity ? length : capacity));
+            }
+        }
+    }
+
+    if (bufferSize > 0)
+    {
+        buffer[length < bufferSize - 1 ? length : bufferSize - 1] = 0;
+    }
+
+    return length;
+}
+
+/* Strings compare by their decoded bytes, lazy strings may still hold escapes */
+static bool JsonEquals_String(const Json a, const Json b)
+{
+    if (a.length >= 0 && b.length >= 0)
+    {
+        return a.length == b.length && (a.length == 0 || memcmp(a.string, b.string, a.length) == 0);
+    }
+
+    const char* rawA = a.string;
+    const char* rawB = b.string;
+    const char* endA = rawA + (a.length < 0 ? -a.length : a.length);
+    const char* endB = rawB + (b.length < 0 ? -b.length : b.length);
+
+    char    bytesA[4], bytesB[4];
+    int32_t countA = 0, countB = 0;
+    int32_t indexA = 0, indexB = 0;
+    while (true)
+    {
+        // Refill the decoded bytes of each side, a count of -1 marks the end of the string
+        if (indexA == countA)
+        {
+            countA = -1;
+            if (rawA < endA)
+            {
+                rawA += JsonString_DecodeNext(rawA, endA, a.length < 0, bytesA, &countA);
+            }
+            indexA = 0;
+        }
+
+        if (indexB == countB)
+        {
+            countB = -1;
+            if (rawB < endB)
+            {
+                rawB += JsonString_DecodeNext(rawB, endB, b.length < 0, bytesB, &countB);
+            }
+            indexB = 0;
+        }
+
+        if (countA < 0 || countB < 0)
+        {
+            return countA < 0 && countB < 0;
+        }
+
+        if (bytesA[indexA++] != bytesB[indexB++])
+        {
+            return false;
+        }
+    }
+}
+
+/* Packed and unpacked arrays of the same numbers are equal */
+static bool JsonEquals_PackedArray(const Json a, const Json b)
+{
+    if (!JsonIsArray(a) || !JsonIsArray(b) || a.length != b.length)
+    {
+        return false;
+    }
+
+    for (int32_t i = 0, n = a.length; i < n; i++)
+    {
+        if (!JsonEquals(JsonArrayGet(a, i), JsonArrayGet(b, i)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* @funcdef: JsonEquals */
+bool JsonEquals(const Json a, const Json b)
+{
+    if (a.type != b.type)
+    {
+        const bool packed = a.type == JsonType_Int32Array || a.type == JsonType_NumberArray
+                         || b.type == JsonType_Int32Array || b.type == JsonType_NumberArray;
+        return packed && JsonEquals_PackedArray(a, b);
+    }
+
+    switch (a.type)
+    {
+    case JsonType_Null:
+        return true;
+
+    case JsonType_Number:
+        return JsonGetNumber(a) == JsonGetNumber(b);
+
+    case JsonType_Boolean:
+        return a.boolean == b.boolean;
+
+    case JsonType_Array:
+        if (a.length != b.length)
+        {
+            return false;
+        }
+
+        for (int32_t i = 0, n = a.length; i < n; i++)
+        {
+            if (!JsonEquals(a.array[i], b.array[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+
+    case JsonType_Int32Array:
+    case JsonType_NumberArray:
+        return JsonEquals_PackedArray(a, b);
+
+    case JsonType_Object:
+        if (a.length != b.length)
+        {
+            return false;
+        }
+
+        for (int32_t i = 0, n = a.length; i < n; i++)
+        {
+            // The parser stores the empty key as NULL
+            const char* nameA = a.object[i].name ? a.object[i].name : "";
+            const char* nameB = b.object[i].name ? b.object[i].name : "";
+            if (strcmp(nameA, nameB) != 0)
+            {
+                return false;
+            }
+
+            if (!JsonEquals(a.object[i].value, b.object[i].value))
+            {
+                return false;
+            }
+        }
+
+        return true;
+
+    case JsonType_String:
+        return JsonEquals_String(a, b);
+
+    default:
+        JSON_ASSERT(false, "invalid json type");
+        break;
+    }
+
+    return false;
+}
+
+/* Exact key match, the parser stores the empty key as NULL */
+static bool JsonObjectMember_NameEquals(const char* name, const char* key, int32_t keyLength)
+{
+    if (!name)
+    {
+        return keyLength == 0;
+    }
+
+    // Member names carry no length, strncmp stops at their terminator where a memcmp of keyLength bytes could read past it
+    return strncmp(name, key, keyLength) == 0 && name[keyLength] == 0;
+}
+
+/* @funcdef: JsonFind */
+bool JsonFind(const Json parent, const char* name, Json* outResult)
+{
+    JSON_ASSERT(outResult, "outResult mustnot be null");
+    JSON_ASSERT(JsonValidType(parent), "invalid json type");
+    JSON_ASSERT(name, "Attempt using nullptr as string");
+
+    if (parent.type == JsonType_Object)
+    {
+        const int32_t nameLength = (int32_t)strlen(name);
+        for (int32_t i = 0, n = parent.length; i < n; i++)
+        {
+            const JsonObjectMember* member = &parent.object[i];
+            JSON_ASSERT(member && JsonValidType(member->value), "invalid json type");
+
+            if (JsonObjectMember_NameEquals(member->name, name, nameLength))
+            {
+                *outResult = member->value;
+                return true;
+            }
+        }
+    }
+
+    *outResult = JSON_NULL;
+    return false;
+}
+
+/* Append the values of every member named name under value, pruning subtrees by their key summary */
+static void JsonFindAll_Walk(const Json value, const char* name, int32_t nameLength, uint64_t bits, bool summaries, Json* results, int32_t maxResults, int32_t* count)
+{
+    if (value.type != JsonType_Object && value.type != JsonType_Array)
+    {
+        return;
+    }
+
+    if (summaries && (JsonKeySummary_Get(value) & bits) != bits)
+    {
+        return;
+    }
+
+    for (int32_t i = 0; i < value.length; i++)
+    {
+        if (value.type == JsonType_Object)
+        {
+            const JsonObjectMember* member = &value.object[i];
+            if (JsonObjectMember_NameEquals(member->name, name, nameLength))
+            {
+                if (*count < maxResults)
+                {
+                    results[*count] = member->value;
+                }
+                (*count)++;
+            }
+
+            JsonFindAll_Walk(member->value, name, nameLength, bits, summaries, results, maxResults, count);
+        }
+        else
+        {
+            JsonFindAll_Walk(value.array[i], name, nameLength, bits, summaries, results, maxResults, count);
+        }
+    }
+}
+
+/* @funcdef: JsonFindAll */
+int32_t JsonFindAll(const Json root, const char* name, JsonParseFlags flags, Json* outResults, int32_t maxResults)
+{
+    JSON_ASSERT(name, "Attempt using nullptr as string");
+    JSON_ASSERT(outResults || maxResults == 0, "outResults mustnot be null");
+
+    const int32_t nameLength = (int32_t)strlen(name);
+    const bool    summaries  = (flags & JsonParseFlags_KeySummary) != 0;
+
+    int32_t count = 0;
+    JsonFindAll_Walk(root, name, nameLength, JsonKeySummary_Bits(name, nameLength), summaries, outResults, maxResults, &count);
+    return count;
+}
+
+/* @funcdef: JsonFindWithType */
+JsonError JsonFindWithType(const Json parent, const char* name, JsonType type, Json* outResult)
+{
+    JSON_ASSERT(outResult, "outResult mustnot be null");
+    JSON_ASSERT(JsonValidType(parent), "invalid json type");
+    JSON_ASSERT(name, "Attempt using nullptr as string");
+
+    if (parent.type == JsonType_Object)
+    {
+        const int32_t nameLength = (int32_t)strlen(name);
+        for (int32_t i = 0, n = parent.length; i < n; i++)
+        {
+            const JsonObjectMember* member = &parent.object[i];
+            JSON_ASSERT(member && JsonValidType(member->value), "invalid json type");
+
+            if (JsonObjectMember_NameEquals(member->name, name, nameLength))
+            {
+                *outResult = member->value;
+                return member->value.type == type ? JsonError_None : JsonError_WrongType;
+            }
+        }
+
+
+        *outResult = JSON_NULL;
+        return JsonError_MissingField;
+    }
+
+    *outResult = JSON_NULL;
+    return JsonError_WrongType;
+}
+
+/* Validate up front, so the conversion loops have no branches and can be vectorized */
+static JsonError JsonArray_CheckNumbers(const Json array, int32_t count)
+{
+    if (count < 0)
+    {
+        return JsonError_InvalidValue;
+    }
+
+    if (!JsonIsArray(array))
+    {
+        return JsonError_WrongType;
+    }
+
+    if (array.length < count)
+    {
+        return JsonError_MissingField;
+    }
+
+    if (array.type == JsonType_Array)
+    {
+        for (int32_t i = 0; i < count; i++)
+        {
+            if (array.array[i].type != JsonType_Number)
+            {
+                return JsonError_WrongType;
+            }
+        }
+    }
+
+    return JsonError_None;
+}
+
+/* @funcdef: JsonArrayToInt32 */
+JsonError JsonArrayToInt32(const Json array, int32_t* outValues, int32_t count)
+{
+    JSON_ASSERT(outValues || count <= 0, "outValues mustnot be null");
+
+    const JsonError error = JsonArray_CheckNumbers(array, count);
+    if (error != JsonError_None)
+    {
+        return error;
+    }
+
+    switch (array.type)
+    {
+    case JsonType_Int32Array:
+        memcpy(outValues, array.int32Array, count * sizeof(int32_t));
+        break;
+
+    case JsonType_NumberArray:
+        {
+            // Casting NaN, fractions or out of range values is undefined or lossy, so every element is checked first
+            // The clamp keeps the cast defined and the check has no early exit, neither loop branches per element
+            bool exact = true;
+            for (int32_t i = 0; i < count; i++)
+            {
+                const double number  = array.numberArray[i];
+                const double lower   = number >= -2147483648.0 ? number : -2147483648.0;    // NaN goes to the bound too
+                const double clamped = lower <= 2147483647.0 ? lower : 2147483647.0;
+                exact = exact & (clamped == number) & (clamped == (double)(int32_t)clamped);
+            }
+
+            if (!exact)
+            {
+                for (int32_t i = 0; i < count && JsonParser_IsInt32(array.numberArray[i]); i++)
+                {
+                    outValues[i] = (int32_t)array.numberArray[i];
+                }
+                return JsonError_InvalidValue;
+            }
+
+            for (int32_t i = 0; i < count; i++)
+            {
+                outValues[i] = (int32_t)array.numberArray[i];
+            }
+        }
+        break;
+
+    default:
+        for (int32_t i = 0; i < count; i++)
+        {
+            const double number = JsonGetNumber(array.array[i]);
+            if (!JsonParser_IsInt32(number))
+            {
+                return JsonError_InvalidValue;
+            }
+            outValues[i] = (int32_t)number;
+        }
+        break;
+    }
+
+    return JsonError_None;
+}
+
+/* @funcdef: JsonArrayToFloat */
+JsonError JsonArrayToFloat(const Json array, float* outValues, int32_t count)
+{
+    JSON_ASSERT(outValues || count <= 0, "outValues mustnot be null");
+
+    const JsonError error = JsonArray_CheckNumbers(array, count);
+    if (error != JsonError_None)
+    {
+        return error;
+    }
+
+    switch (array.type)
+    {
+    case JsonType_Int32Array:
+        for (int32_t i = 0; i < count; i++)
+        {
+            outValues[i] = (float)array.int32Array[i];
+        }
+        break;
+
+    case JsonType_NumberArray:
+        for (int32_t i = 0; i < count; i++)
+        {
+            outValues[i] = (float)array.numberArray[i];
+        }
+        break;
+
+    default:
+        for (int32_t i = 0; i < count; i++)
+        {
+            outValues[i] = (float)JsonGetNumber(array.array[i]);
+        }
+        break;
+    }
+
+    return JsonError_None;
+}
+
+/* @funcdef: JsonArrayToDouble */
+JsonError JsonArrayToDouble(const Json array, double* outValues, int32_t count)
+{
+    JSON_ASSERT(outValues || count <= 0, "outValues mustnot be null");
+
+    const JsonError error = JsonArray_CheckNumbers(array, count);
+    if (error != JsonError_None)
+    {
+        return error;
+    }
+
+    switch (array.type)
+    {
+    case JsonType_Int32Array:
+        for (int32_t i = 0; i < count; i++)
+        {
+            outValues[i] = (double)array.int32Array[i];
+        }
+        break;
+
+    case JsonType_NumberArray:
+        memcpy(outValues, array.numberArray, count * sizeof(double));
+        break;
+
+    default:
+        for (int32_t i = 0; i < count; i++)
+        {
+            outValues[i] = JsonGetNumber(array.array[i]);
+        }
+        break;
+    }
+
+    return JsonError_None;
+}
+
+/* Size of a value of a column or struct field type */
+static int32_t JsonField_Size(JsonColumnType type)
+{
+    switch (type)
+    {
+    case JsonColumnType_Int32:      return (int32_t)sizeof(int32_t);
+    case JsonColumnType_Float:      return (int32_t)sizeof(float);
+    case JsonColumnType_Double:     return (int32_t)sizeof(double);
+    case JsonColumnType_Boolean:    return (int32_t)sizeof(bool);
+    case JsonColumnType_String:     return (int32_t)sizeof(const char*);
+    case JsonColumnType_Value:      return (int32_t)sizeof(Json);
+    default:                        return 0;
+    }
+}
+
+/* Lazy strings end at their closing quote or still hold escapes, decoded strings are null-terminated */
+static bool JsonField_IsDecodedString(const Json value)
+{
+    return value.length == 0 || (value.length > 0 && value.string[value.length] == 0);
+}
+
+/* Type checked write of value to dst (can be NULL to only check), false when value has another type */
+static bool JsonField_Write(void* dst, JsonColumnType type, const Json value)
+{
+    switch (type)
+    {
+    case JsonColumnType_Int32:
+        if (value.type != JsonType_Number || !JsonParser_IsInt32(JsonGetNumber(value))) return false;
+        if (dst) *(int32_t*)dst = (int32_t)JsonGetNumber(value);
+        return true;
+
+    case JsonColumnType_Float:
+        if (value.type != JsonType_Number) return false;
+        if (dst) *(float*)dst = (float)JsonGetNumber(value);
+        return true;
+
+    case JsonColumnType_Double:
+        if (value.type != JsonType_Number) return false;
+        if (dst) *(double*)dst = JsonGetNumber(value);
+        return true;
+
+    case JsonColumnType_Boolean:
+        if (value.type != JsonType_Boolean) return false;
+        if (dst) *(bool*)dst = value.boolean;
+        return true;
+
+    case JsonColumnType_String:
+        if (value.type != JsonType_String || !JsonField_IsDecodedString(value)) return false;
+        if (dst) *(const char**)dst = value.length > 0 ? value.string : "";
+        return true;
+
+    case JsonColumnType_Value:
+        if (dst) *(Json*)dst = value;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static void JsonField_Clear(void* dst, JsonColumnType type)
+{
+    if (dst)
+    {
+        switch (type)
+        {
+        case JsonColumnType_Int32:      *(int32_t*)dst     = 0;            break;
+        case JsonColumnType_Float:      *(float*)dst       = 0;            break;
+        case JsonColumnType_Double:     *(double*)dst      = 0;            break;
+        case JsonColumnType_Boolean:    *(bool*)dst        = false;        break;
+        case JsonColumnType_String:     *(const char**)dst = NULL;         break;
+        case JsonColumnType_Value:      *(Json*)dst        = JSON_NULL;    break;
+        default:                                                           break;
+        }
+    }
+}
+
+static bool JsonColumn_Write(const JsonColumn* column, JsonColumnType type, int32_t row, const Json value)
+{
+    return JsonField_Write(column->values ? (uint8_t*)column->values + row * JsonField_Size(type) : NULL, type, value);
+}
+
+static void JsonColumn_Clear(const JsonColumn* column, JsonColumnType type, int32_t row)
+{
+    JsonField_Clear(column->values ? (uint8_t*)column->values + row * JsonField_Size(type) : NULL, type);
+}
+
+/* @funcdef: JsonExtractColumns */
+JsonError JsonExtractColumns(const Json array, const JsonColumnSpec* specs, int32_t specCount, JsonColumn* columns)
+{
+    JSON_ASSERT(specs && columns, "specs and columns mustnot be null");
+
+    if (array.type != JsonType_Array)
+    {
+        return JsonError_WrongType;
+    }
+
+    if (specCount > JSON_MAX_COLUMNS)
+    {
+        return JsonError_InvalidValue;
+    }
+
+    // Nested structs have no column layout, they belong to struct bindings
+    for (int32_t j = 0; j < specCount; j++)
+    {
+        if (specs[j].type == JsonColumnType_Struct)
+        {
+            return JsonError_InvalidValue;
+        }
+    }
+
+    // Objects of one array usually share their key order, so remember where each field was found in the previous row
+    int32_t nameLengths[JSON_MAX_COLUMNS];
+    int32_t hints[JSON_MAX_COLUMNS];
+    for (int32_t j = 0; j < specCount; j++)
+    {
+        nameLengths[j] = (int32_t)strlen(specs[j].name);
+        hints[j]       = j;
+    }
+
+    for (int32_t i = 0, n = array.length; i < n; i++)
+    {
+        const Json row = array.array[i];
+
+        for (int32_t j = 0; j < specCount; j++)
+        {
+            const JsonColumn* column = &columns[j];
+
+            int32_t found = -1;
+            if (row.type == JsonType_Object)
+            {
+                const int32_t hint = hints[j];
+                if (hint < row.length && JsonObjectMember_NameEquals(row.object[hint].name, specs[j].name, nameLengths[j]))
+                {
+                    found = hint;
+                }
+                else
+                {
+                    for (int32_t k = 0; k < row.length; k++)
+                    {
+                        if (JsonObjectMember_NameEquals(row.object[k].name, specs[j].name, nameLengths[j]))
+                        {
+                            found = hints[j] = k;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            const bool present = found >= 0 && JsonColumn_Write(column, specs[j].type, i, row.object[found].value);
+            if (!present)
+            {
+                JsonColumn_Clear(column, specs[j].type, i);
+            }
+
+            if (column->presence)
+            {
+                const uint8_t bit = (uint8_t)(1u << (i & 7));
+                column->presence[i >> 3] = present ? (column->presence[i >> 3] | bit) : (column->presence[i >> 3] & ~bit);
+            }
+        }
+    }
+
+    return JsonError_None;
+}
+
+// -------------------------------------------------------------------
+// Queries: JSONPath subset compiled to a plan
+// -------------------------------------------------------------------
+
+#define JSON_QUERY_BATCH 64
+
+/* Characters ending a key of a query */
+static bool JsonQuery_IsKeyEnd(char c)
+{
+    return c == 0 || c == '.' || c == '[' || c == ']' || c == '(' || c == ')' || c == '=' || c == '!' || c == '<' || c == '>' || JsonParser_IsCharClass(c, JsonCharClass_Space);
+}
+
+/* Move past a number literal, -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? like JSON, NULL when it is not one */
+static const char* JsonQuery_ScanNumber(const char* c)
+{
+    c += *c == '-';
+    if (*c == '0')
+    {
+        c++;
+    }
+    else if (*c >= '1' && *c <= '9')
+    {
+        while (*c >= '0' && *c <= '9') c++;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if (*c == '.')
+    {
+        const char* digits = ++c;
+        while (*c >= '0' && *c <= '9') c++;
+        if (c == digits)
+        {
+            return NULL;
+        }
+    }
+
+    if (*c == 'e' || *c == 'E')
+    {
+        c++;
+        c += *c == '+' || *c == '-';
+
+        const char* digits = c;
+        while (*c >= '0' && *c <= '9') c++;
+        if (c == digits)
+        {
+            return NULL;
+        }
+    }
+
+    return c;
+}
+
+/* Compile `?(@.a.b op literal)`, c points at '?' and is left at the closing ')' */
+static JsonError JsonQuery_CompileFilter(JsonQuery* query, const char** cursor)
+{
+    const char* c = *cursor;
+    if (query->filterCount >= JSON_QUERY_MAX_FILTERS)
+    {
+        return JsonError_OutOfMemory;
+    }
+
+    JsonQueryFilter* filter = &query->filters[query->filterCount];
+    filter->keyCount       = 0;
+    filter->literalType    = JsonType_Null;
+    filter->literalNumber  = 0;
+    filter->literalBoolean = false;
+    filter->literalOffset  = 0;
+    filter->literalLength  = 0;
+
+    if (c[0] != '?' || c[1] != '(')
+    {
+        return JsonError_WrongFormat;
+    }
+
+    for (c += 2; JsonParser_IsCharClass(*c, JsonCharClass_Space); c++);
+    if (*c++ != '@')
+    {
+        return JsonError_WrongFormat;
+    }
+
+    // Relative member keys
+    while (*c == '.')
+    {
+        const char* key = ++c;
+        while (!JsonQuery_IsKeyEnd(*c))
+        {
+            c++;
+        }
+
+        const int32_t keyLength = (int32_t)(c - key);
+        if (keyLength == 0)
+        {
+            return JsonError_WrongFormat;
+        }
+        
+        if (filter->keyCount >= JSON_QUERY_MAX_FILTER_KEYS)
+        {
+            return JsonError_OutOfMemory;
+        }
+
+        const int32_t offset = JsonPath_AddName(&query->path, key, keyLength);
+        if (offset < 0)
+        {
+            return JsonError_OutOfMemory;
+        }
+
+        filter->keyOffsets[filter->keyCount] = offset;
+        filter->keyLengths[filter->keyCount] = keyLength;
+        filter->keyCount++;
+    }
+
+    for (; JsonParser_IsCharClass(*c, JsonCharClass_Space); c++);
+
+    // Comparison
+    static const struct { const char* token; JsonQueryOp op; } ops[] = {
+        { "==", JsonQueryOp_Equal        }, { "!=", JsonQueryOp_NotEqual     },
+        { "<=", JsonQueryOp_LessEqual    }, { ">=", JsonQueryOp_GreaterEqual },
+        { "<",  JsonQueryOp_Less         }, { ">",  JsonQueryOp_Greater      },
+    };
+
+    filter->op = JsonQueryOp_Exists;
+    for (int32_t i = 0; i < (int32_t)(sizeof(ops) / sizeof(ops[0])); i++)
+    {
+        const size_t length = strlen(ops[i].token);
+        if (strncmp(c, ops[i].token, length) == 0)
+        {
+            filter->op = ops[i].op;
+            c += length;
+            break;
+        }
+    }
+
+    if (filter->op == JsonQueryOp_Exists && *c != ')')
+    {
+        return JsonError_WrongFormat;
+    }
+
+    // Literal
+    if (filter->op != JsonQueryOp_Exists)
+    {
+        for (; JsonParser_IsCharClass(*c, JsonCharClass_Space); c++);
+
+        if (*c == '\'' || *c == '"')
+        {
+            const char  quote   = *c++;
+            const char* literal = c;
+            while (*c && *c != quote)
+            {
+                c++;
+            }
+
+            if (*c != quote)
+            {
+                return JsonError_WrongFormat;
+            }
+
+            filter->literalType   = JsonType_String;
+            filter->literalLength = (int32_t)(c - literal);
+            filter->literalOffset = JsonPath_AddName(&query->path, literal, filter->literalLength);
+            if (filter->literalOffset < 0)
+            {
+                return JsonError_OutOfMemory;
+            }
+            c++;
+        }
+        else if (*c == '-' || (*c >= '0' && *c <= '9'))
+        {
+            const char* literal = c;
+            c = JsonQuery_ScanNumber(c);
+            if (!c)
+            {
+                return JsonError_WrongFormat;
+            }
+
+            filter->literalType   = JsonType_Number;
+            filter->literalNumber = JsonParser_ConvertNumber(literal, (int32_t)(c - literal));
+        }
+        else if (strncmp(c, "true", 4) == 0 || strncmp(c, "false", 5) == 0)
+        {
+            filter->literalType    = JsonType_Boolean;
+            filter->literalBoolean = *c == 't';
+            c += *c == 't' ? 4 : 5;
+        }
+        else if (strncmp(c, "null", 4) == 0)
+        {
+            filter->literalType = JsonType_Null;
+            c += 4;
+        }
+        else
+        {
+            return JsonError_WrongFormat;
+        }
+
+        // Only numbers are ordered
+        if (filter->op != JsonQueryOp_Equal && filter->op != JsonQueryOp_NotEqual && filter->literalType != JsonType_Number)
+        {
+            return JsonError_UnsupportedToken;
+        }
+
+        for (; JsonParser_IsCharClass(*c, JsonCharClass_Space); c++);
+    }
+
+    if (*c != ')')
+    {
+        return JsonError_WrongFormat;
+    }
+
+    const JsonError error = JsonPath_AddSegment(&query->path, JSON_PATH_FILTER, "", 0);
+    if (error != JsonError_None)
+    {
+        return error;
+    }
+
+    query->path.segments[query->path.count - 1].keyOffset = query->filterCount++;
+    *cursor = c;
+    return JsonError_None;
+}
+
+/* @funcdef: JsonQueryCompile */
+JsonError JsonQueryCompile(const char* query, JsonQuery* outQuery)
+{
+    JSON_ASSERT(query, "query mustnot be null");
+    JSON_ASSERT(outQuery, "outQuery mustnot be null");
+
+    JsonPath* path = &outQuery->path;
+    path->count          = 0;
+    path->namesLength    = 0;
+    outQuery->filterCount = 0;
+
+    const char* c = query;
+
+    // `$.a`, `$[0]` or a bare `a`
+    bool expectKey = false;
+    if (*c == '$')
+    {
+        c++;
+    }
+    else if (*c != '.' && *c != '[')
+    {
+        expectKey = *c != 0;
+    }
+
+    while (*c || expectKey)
+    {
+        JsonError error;
+        if (expectKey || *c == '.')
+        {
+            c += !expectKey;
+            expectKey = false;
+
+            const char* key = c;
+            while (!JsonQuery_IsKeyEnd(*c))
+            {
+                c++;
+            }
+
+            const int32_t keyLength = (int32_t)(c - key);
+            if (keyLength == 0)
+            {
+                return JsonError_WrongFormat;
+            }
+
+            const bool any = keyLength == 1 && key[0] == '*';
+            error = JsonPath_AddSegment(path, any ? JSON_PATH_ANY : JSON_PATH_KEY, key, any ? 0 : keyLength);
+        }
+        else if (*c == '[')
+        {
+            c++;
+            if (*c == '?')
+            {
+                error = JsonQuery_CompileFilter(outQuery, &c);
+                c++;
+            }
+            else if (*c == '\'' || *c == '"')
+            {
+                const char  quote = *c++;
+                const char* key   = c;
+                while (*c && *c != quote)
+                {
+                    c++;
+                }
+
+                if (*c != quote)
+                {
+                    return JsonError_WrongFormat;
+                }
+
+                error = JsonPath_AddSegment(path, JSON_PATH_KEY, key, (int32_t)(c++ - key));
+            }
+            else if (*c == '*')
+            {
+                c++;
+                error = JsonPath_AddSegment(path, JSON_PATH_ANY, "", 0);
+            }
+            else if (*c >= '0' && *c <= '9')
+            {
+                int32_t index = 0;
+                while (*c >= '0' && *c <= '9')
+                {
+                    if (index > (INT32_MAX - 9) / 10)
+                    {
+                        return JsonError_WrongFormat;
+                    }
+
+                    index = index * 10 + (*c++ - '0');
+                }
+                error = JsonPath_AddSegment(path, index, "", 0);
+            }
+            else
+            {
+                return JsonError_WrongFormat;
+            }
+
+            if (error == JsonError_None && *c != ']')
+            {
+                return JsonError_WrongFormat;
+            }
+            c++;
+        }
+        else
+        {
+            return JsonError_WrongFormat;
+        }
+
+        if (error != JsonError_None)
+        {
+            return error;
+        }
+    }
+
+    return JsonError_None;
+}
+
+/* Element of an array (any subtype) or member value of an object */
+static Json JsonQuery_Child(const Json container, int32_t index)
+{
+    return container.type == JsonType_Object ? container.object[index].value : JsonArrayGet(container, index);
+}
+
+/* Field of a filter, the member position of each key is hinted from the previous element */
+static bool JsonQuery_GetField(const JsonQuery* query, const JsonQueryFilter* filter, const Json element, int32_t* hints, Json* outField)
+{
+    Json current = element;
+    for (int32_t i = 0; i < filter->keyCount; i++)
+    {
+        if (current.type != JsonType_Object)
+        {
+            return false;
+        }
+
+        const char*   key       = query->path.names + filter->keyOffsets[i];
+        const int32_t keyLength = filter->keyLengths[i];
+
+        int32_t found = hints[i];
+        if (found >= current.length || !JsonObjectMember_NameEquals(current.object[found].name, key, keyLength))
+        {
+            found = -1;
+            for (int32_t k = 0; k < current.length; k++)
+            {
+                if (JsonObjectMember_NameEquals(current.object[k].name, key, keyLength))
+                {
+                    found = hints[i] = k;
+                    break;
+                }
+            }
+
+            if (found < 0)
+            {
+                return false;
+            }
+        }
+
+        current = current.object[found].value;
+    }
+
+    *outField = current;
+    return true;
+}
+
+/* Evaluate a filter over a batch of gathered fields, bit i is set when fields[i] passes */
+static uint64_t JsonQuery_TestBatch(const JsonQuery* query, const JsonQueryFilter* filter, const Json* fields, int32_t count, uint64_t present)
+{
+    if (filter->op == JsonQueryOp_Exists)
+    {
+        return present;
+    }
+
+    uint64_t equal = 0;
+    if (filter->literalType == JsonType_Number)
+    {
+        // Unpack the numbers once, then every op is a branch-free loop over plain doubles
+        double   numbers[JSON_QUERY_BATCH];
+        uint64_t isNumber = 0;
+        for (int32_t i = 0; i < count; i++)
+        {
+            const bool number = ((present >> i) & 1) && fields[i].type == JsonType_Number;
+            numbers[i] = number ? JsonGetNumber(fields[i]) : 0;
+            isNumber  |= (uint64_t)number << i;
+        }
+
+        const double literal = filter->literalNumber;
+
+        uint64_t result = 0;
+        switch (filter->op)
+        {
+        case JsonQueryOp_Less:          for (int32_t i = 0; i < count; i++) result |= (uint64_t)(numbers[i] <  literal) << i; return result & isNumber;
+        case JsonQueryOp_LessEqual:     for (int32_t i = 0; i < count; i++) result |= (uint64_t)(numbers[i] <= literal) << i; return result & isNumber;
+        case JsonQueryOp_Greater:       for (int32_t i = 0; i < count; i++) result |= (uint64_t)(numbers[i] >  literal) << i; return result & isNumber;
+        case JsonQueryOp_GreaterEqual:  for (int32_t i = 0; i < count; i++) result |= (uint64_t)(numbers[i] >= literal) << i; return result & isNumber;
+        default:                        for (int32_t i = 0; i < count; i++) result |= (uint64_t)(numbers[i] == literal) << i; break;
+        }
+
+        equal = result & isNumber;
+    }
+    else
+    {
+        Json literal;
+        literal.type   = filter->literalType;
+        literal.length = filter->literalLength;
+        if (literal.type == JsonType_String)
+        {
+            literal.string = query->path.names + filter->literalOffset;
+        }
+        else
+        {
+            literal.boolean = filter->literalBoolean;
+        }
+
+        for (int32_t i = 0; i < count; i++)
+        {
+            if (((present >> i) & 1) && fields[i].type == literal.type)
+            {
+                const bool match = literal.type == JsonType_String  ? JsonEquals_String(fields[i], literal)
+                                 : literal.type == JsonType_Boolean ? fields[i].boolean == literal.boolean
+                                 : true;
+                equal |= (uint64_t)match << i;
+            }
+        }
+    }
+
+    return filter->op == JsonQueryOp_NotEqual ? present & ~equal : equal;
+}
+
+/* Apply the plan from step on value, matches are appended to results */
+static void JsonQuery_Walk(const JsonQuery* query, int32_t step, const Json value, Json* results, int32_t maxResults, int32_t* count)
+{
+    if (step == query->path.count)
+    {
+        if (*count < maxResults)
+        {
+            results[*count] = value;
+        }
+        (*count)++;
+        return;
+    }
+
+    const JsonPathSegment* segment = &query->path.segments[step];
+    switch (segment->index)
+    {
+    case JSON_PATH_KEY:
+        if (value.type == JsonType_Object)
+        {
+            const char* key = query->path.names + segment->keyOffset;
+            for (int32_t i = 0; i < value.length; i++)
+            {
+                if (JsonObjectMember_NameEquals(value.object[i].name, key, segment->keyLength))
+                {
+                    JsonQuery_Walk(query, step + 1, value.object[i].value, results, maxResults, count);
+                    break;
+                }
+            }
+        }
+        break;
+
+    case JSON_PATH_ANY:
+        if (value.type == JsonType_Object || JsonIsArray(value))
+        {
+            for (int32_t i = 0; i < value.length; i++)
+            {
+                JsonQuery_Walk(query, step + 1, JsonQuery_Child(value, i), results, maxResults, count);
+            }
+        }
+        break;
+
+    case JSON_PATH_FILTER:
+        if (value.type == JsonType_Object || JsonIsArray(value))
+        {
+            const JsonQueryFilter* filter = &query->filters[segment->keyOffset];
+
+            int32_t hints[JSON_QUERY_MAX_FILTER_KEYS] = { 0 };
+            for (int32_t first = 0; first < value.length; first += JSON_QUERY_BATCH)
+            {
+                const int32_t batch = value.length - first < JSON_QUERY_BATCH ? value.length - first : JSON_QUERY_BATCH;
+
+                // Gather the filtered field of the whole batch, then test it at once
+                Json     fields[JSON_QUERY_BATCH];
+                uint64_t present = 0;
+                for (int32_t i = 0; i < batch; i++)
+                {
+                    if (JsonQuery_GetField(query, filter, JsonQuery_Child(value, first + i), hints, &fields[i]))
+                    {
+                        present |= (uint64_t)1 << i;
+                    }
+                }
+
+                const uint64_t selected = JsonQuery_TestBatch(query, filter, fields, batch, present);
+                for (int32_t i = 0; i < batch; i++)
+                {
+                    if ((selected >> i) & 1)
+                    {
+                        JsonQuery_Walk(query, step + 1, JsonQuery_Child(value, first + i), results, maxResults, count);
+                    }
+                }
+            }
+        }
+        break;
+
+    default:
+        if (JsonIsArray(value) && segment->index < value.length)
+        {
+            JsonQuery_Walk(query, step + 1, JsonArrayGet(value, segment->index), results, maxResults, count);
+        }
+        break;
+    }
+}
+
+/* @funcdef: JsonQueryRun */
+int32_t JsonQueryRun(const JsonQuery* query, const Json root, Json* outResults, int32_t maxResults)
+{
+    JSON_ASSERT(query, "query mustnot be null");
+    JSON_ASSERT(outResults || maxResults == 0, "outResults mustnot be null");
+
+    int32_t count = 0;
+    JsonQuery_Walk(query, 0, root, outResults, maxResults, &count);
+    return count;
+}
+
+// -------------------------------------------------------------------
+// Struct bindings: JsonStructDesc
+// -------------------------------------------------------------------
+
+/* Slot of a key hash in the perfect hash table of a struct */
+static int32_t JsonStructDesc_Slot(uint32_t hash, uint32_t seed, int32_t shift)
+{
+    return (int32_t)(((hash ^ seed) * 2654435761u) >> shift);
+}
+
+/* @funcdef: JsonStructDescInit */
+JsonError JsonStructDescInit(JsonStructDesc* desc)
+{
+    JSON_ASSERT(desc, "desc mustnot be null");
+
+    if (desc->fieldCount <= 0 || desc->fieldCount > JSON_STRUCT_MAX_FIELDS)
+    {
+        return JsonError_InvalidValue;
+    }
+
+    uint32_t hashes[JSON_STRUCT_MAX_FIELDS];
+    for (int32_t i = 0; i < desc->fieldCount; i++)
+    {
+        hashes[i] = JsonString_Hash(desc->fields[i].name, (int32_t)strlen(desc->fields[i].name));
+    }
+
+    // Table of 4 slots per field, so a seed without collision is found after a few tries
+    int32_t bits = 1;
+    while ((1 << bits) < desc->fieldCount * 4 && (1 << bits) < JSON_STRUCT_TABLE_SIZE)
+    {
+        bits++;
+    }
+
+    for (uint32_t seed = 1; seed < (1u << 16); seed++)
+    {
+        memset(desc->table, -1, sizeof(desc->table));
+
+        int32_t i;
+        for (i = 0; i < desc->fieldCount; i++)
+        {
+            const int32_t slot = JsonStructDesc_Slot(hashes[i], seed, 32 - bits);
+            if (desc->table[slot] >= 0)
+            {
+                break;
+            }
+            desc->table[slot] = (int8_t)i;
+        }
+
+        if (i == desc->fieldCount)
+        {
+            desc->seed  = seed;
+            desc->shift = 32 - bits;
+
+            // Nested bindings, self references are already initialized at this point
+            for (i = 0; i < desc->fieldCount; i++)
+            {
+                JsonStructDesc* nested = desc->fields[i].desc;
+                if (nested && nested->shift == 0)
+                {
+                    const JsonError error = JsonStructDescInit(nested);
+                    if (error != JsonError_None)
+                    {
+                        return error;
+                    }
+                }
+            }
+
+            return JsonError_None;
+        }
+    }
+
+    // Only duplicated keys never separate
+    memset(desc->table, -1, sizeof(desc->table));
+    desc->shift = 0;
+    return JsonError_InvalidValue;
+}
+
+/* Zero a field of a struct binding, nested structs are cleared field by field */
+static void JsonStructDesc_ClearField(const JsonFieldDesc* field, uint8_t* base)
+{
+    if (field->countOffset >= 0)
+    {
+        *(void**)(base + field->offset)        = NULL;
+        *(int32_t*)(base + field->countOffset) = 0;
+    }
+    else if (field->type == JsonColumnType_Struct)
+    {
+        for (int32_t i = 0; i < field->desc->fieldCount; i++)
+        {
+            JsonStructDesc_ClearField(&field->desc->fields[i], base + field->offset);
+        }
+    }
+    else
+    {
+        JsonField_Clear(base + field->offset, field->type);
+    }
+}
+
+/* Key of a binding field, key is not null-terminated */
+static bool JsonStructDesc_KeyEquals(const JsonFieldDesc* field, const char* key, int32_t keyLength)
+{
+    return strncmp(field->name, key, keyLength) == 0 && field->name[keyLength] == 0;
+}
+
+/* @funcdef: JsonDecodeStruct */
+JsonError JsonDecodeStruct(const Json object, const JsonStructDesc* desc, void* outStruct)
+{
+    JSON_ASSERT(desc && desc->shift > 0, "desc must be initialized by JsonStructDescInit");
+    JSON_ASSERT(outStruct, "outStruct mustnot be null");
+
+    if (object.type != JsonType_Object)
+    {
+        return JsonError_WrongType;
+    }
+
+    JsonError error = JsonError_None;
+    uint32_t  seen  = 0;
+
+    // One pass over the members, each key goes straight to its field
+    for (int32_t i = 0; i < object.length; i++)
+    {
+        const JsonObjectMember* member = &object.object[i];
+
+        const char*   name   = member->name ? member->name : "";
+        const int32_t length = (int32_t)strlen(name);
+        const int32_t index  = desc->table[JsonStructDesc_Slot(JsonString_Hash(name, length), desc->seed, desc->shift)];
+        if (index < 0 || (seen & (1u << index)))
+        {
+            continue;
+        }
+
+        const JsonFieldDesc* field = &desc->fields[index];
+        if (strcmp(field->name, name) != 0)
+        {
+            continue;
+        }
+
+        // Null is a missing value for optional fields
+        if (member->value.type == JsonType_Null && !field->required && field->type != JsonColumnType_Value)
+        {
+            continue;
+        }
+
+        seen |= 1u << index;
+
+        uint8_t*  dst        = (uint8_t*)outStruct + field->offset;
+        JsonError fieldError = JsonError_None;
+        if (field->countOffset >= 0)
+        {
+            fieldError = JsonError_InvalidValue;
+        }
+        else if (field->type == JsonColumnType_Struct)
+        {
+            fieldError = JsonDecodeStruct(member->value, field->desc, dst);
+        }
+        else if (!JsonField_Write(dst, field->type, member->value))
+        {
+            fieldError = JsonError_WrongType;
+        }
+
+        if (fieldError != JsonError_None)
+        {
+            // A nested object keeps what could be decoded
+            if (field->type != JsonColumnType_Struct || member->value.type != JsonType_Object)
+            {
+                JsonStructDesc_ClearField(field, (uint8_t*)outStruct);
             }
-            else
+
+            error = error == JsonError_None ? fieldError : error;
+        }
+    }
+
+    for (int32_t i = 0; i < desc->fieldCount; i++)
+    {
+        if (!(seen & (1u << i)))
+        {
+            JsonStructDesc_ClearField(&desc->fields[i], (uint8_t*)outStruct);
+            if (desc->fields[i].required && error == JsonError_None)
             {
-                JsonParser_Panic(parser, JsonType_Null, JsonError_UnexpectedToken, "Unexpected token '%c'", c);
+                error = JsonError_MissingField;
+            }
+        }
+    }
+
+    return error;
+}
+
+/* View over the elements of an array field, NULL elements are null, element types without a Json array subtype would need storage */
+static JsonError JsonStructDesc_EncodeArray(const void* value, const JsonFieldDesc* field, Json* outValue)
+{
+    const void*   elements = *(const void* const*)((const uint8_t*)value + field->offset);
+    const int32_t count    = *(const int32_t*)((const uint8_t*)value + field->countOffset);
+
+    *outValue = JSON_NULL;
+    if (!elements)
+    {
+        return JsonError_None;
+    }
+
+    switch (field->type)
+    {
+    case JsonColumnType_Int32:
+        outValue->type       = JsonType_Int32Array;
+        outValue->int32Array = (const int32_t*)elements;
+        break;
+
+    case JsonColumnType_Double:
+        outValue->type        = JsonType_NumberArray;
+        outValue->numberArray = (const double*)elements;
+        break;
+
+    case JsonColumnType_Value:
+        outValue->type  = JsonType_Array;
+        outValue->array = (Json*)elements;
+        break;
+
+    default:
+        return JsonError_InvalidValue;
+    }
+
+    outValue->length = count;
+    return JsonError_None;
+}
+
+/* Members of the fields of value, nested structs take theirs after the ones of their parent */
+static JsonError JsonStructDesc_Encode(const void* value, const JsonStructDesc* desc, JsonObjectMember* members, int32_t memberCapacity, int32_t* outUsed, Json* outObject)
+{
+    if (memberCapacity < desc->fieldCount)
+    {
+        return JsonError_OutOfMemory;
+    }
+
+    int32_t used = desc->fieldCount;
+    for (int32_t i = 0; i < desc->fieldCount; i++)
+    {
+        const JsonFieldDesc* field = &desc->fields[i];
+        const uint8_t*       src   = (const uint8_t*)value + field->offset;
+
+        members[i].name  = field->name;
+        members[i].value = JSON_NULL;
+
+        Json fieldValue = JSON_NULL;
+        if (field->countOffset >= 0)
+        {
+            const JsonError error = JsonStructDesc_EncodeArray(value, field, &fieldValue);
+            if (error != JsonError_None)
+            {
+                return error;
+            }
+
+            members[i].value = fieldValue;
+            continue;
+        }
+
+        switch (field->type)
+        {
+        case JsonColumnType_Int32:
+            fieldValue.type   = JsonType_Number;
+            fieldValue.number = *(const int32_t*)src;
+            break;
+
+        case JsonColumnType_Float:
+            fieldValue.type   = JsonType_Number;
+            fieldValue.number = *(const float*)src;
+            break;
+
+        case JsonColumnType_Double:
+            fieldValue.type   = JsonType_Number;
+            fieldValue.number = *(const double*)src;
+            break;
+
+        case JsonColumnType_Boolean:
+            fieldValue = *(const bool*)src ? JSON_TRUE : JSON_FALSE;
+            break;
+
+        case JsonColumnType_String:
+            if (*(const char* const*)src)
+            {
+                fieldValue.type   = JsonType_String;
+                fieldValue.string = *(const char* const*)src;
+                fieldValue.length = (int32_t)strlen(fieldValue.string);
+            }
+            break;
+
+        case JsonColumnType_Value:
+            fieldValue = *(const Json*)src;
+            break;
+
+        case JsonColumnType_Struct:
+            {
+                int32_t         nested = 0;
+                const JsonError error  = JsonStructDesc_Encode(src, field->desc, members + used, memberCapacity - used, &nested, &fieldValue);
+                if (error != JsonError_None)
+                {
+                    return error;
+                }
+                used += nested;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        members[i].value = fieldValue;
+    }
+
+    outObject->type   = JsonType_Object;
+    outObject->length = desc->fieldCount;
+    outObject->object = members;
+    *outUsed          = used;
+    return JsonError_None;
+}
+
+/* @funcdef: JsonEncodeStruct */
+JsonError JsonEncodeStruct(const void* value, const JsonStructDesc* desc, JsonObjectMember* members, int32_t memberCapacity, Json* outObject)
+{
+    JSON_ASSERT(value, "value mustnot be null");
+    JSON_ASSERT(desc, "desc mustnot be null");
+    JSON_ASSERT(outObject, "outObject mustnot be null");
+
+    int32_t         used  = 0;
+    const JsonError error = JsonStructDesc_Encode(value, desc, members, memberCapacity, &used, outObject);
+    if (error != JsonError_None)
+    {
+        *outObject = JSON_NULL;
+    }
+
+    return error;
+}
+
+static void JsonParser_ParseStructObject(JsonParser* parser, const JsonStructDesc* desc, uint8_t* base);
+
+/* Value of a field, or of one element of an array field, written at dst */
+static void JsonParser_ParseStructValue(JsonParser* parser, const JsonFieldDesc* field, uint8_t* dst)
+{
+    const int c = JsonParser_SkipSpace(parser);
+    switch (field->type)
+    {
+    case JsonColumnType_Struct:
+        if (c != '{')
+        {
+            JsonParser_Panic(parser, JsonType_Object, JsonError_WrongType, "Field '%s' expects <object>", field->name);
+        }
+        JsonParser_ParseStructObject(parser, field->desc, dst);
+        break;
+
+    case JsonColumnType_String:
+        if (c != '"')
+        {
+            JsonParser_Panic(parser, JsonType_String, JsonError_WrongType, "Field '%s' expects <string>", field->name);
+        }
+        {
+            // The decoder leaves empty strings NULL, which would read as a missing field
+            const char* string = JsonParser_ParseStringNoToken(parser, NULL);
+            *(const char**)dst = string ? string : "";
+        }
+        break;
+
+    case JsonColumnType_Value:
+        JsonParser_ParseSingle(parser, (Json*)dst);
+        break;
+
+    default:
+        {
+            // Scalars build no nodes, containers are rejected before they are parsed
+            Json value = JSON_NULL;
+            if (c != '[' && c != '{' && c != '"')
+            {
+                JsonParser_ParseSingle(parser, &value);
+            }
+
+            if (!JsonField_Write(dst, field->type, value))
+            {
+                JsonParser_Panic(parser, JsonType_Null, JsonError_WrongType, "Field '%s' expects <%s>", field->name, field->type == JsonColumnType_Boolean ? "boolean" : field->type == JsonColumnType_Int32 ? "int32" : "number");
+            }
+        }
+        break;
+    }
+}
+
+/* @funcdef: JsonParser_ParseStructArray */
+static void JsonParser_ParseStructArray(JsonParser* parser, const JsonFieldDesc* field, uint8_t* base)
+{
+    const int32_t itemSize = field->type == JsonColumnType_Struct ? field->desc->size : JsonField_Size(field->type);
+
+    if (JsonParser_SkipSpace(parser) != '[')
+    {
+        JsonParser_Panic(parser, JsonType_Array, JsonError_WrongType, "Field '%s' expects <array>", field->name);
+    }
+    JsonParser_MatchChar(parser, JsonType_Array, '[');
+
+    // Elements are decoded in place on the upper stack, then moved down once their count is known
+    uint8_t* items = NULL;
+    int32_t  count = 0;
+    while (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != ']')
+    {
+        if (count > 0)
+        {
+            JsonParser_MatchChar(parser, JsonType_Array, ',');
+        }
+
+        items = (uint8_t*)JsonArray_Grow(items, count + 1, itemSize, &parser->allocator);
+        if (!items)
+        {
+            JsonParser_Panic(parser, JsonType_Array, JsonError_OutOfMemory, "Not enough memory for field '%s'", field->name);
+        }
+
+        JsonParser_ParseStructValue(parser, field, items + count * itemSize);
+        JsonArray_GetHeader(items)->count = ++count;
+    }
+
+    JsonParser_SkipSpace(parser);
+    JsonParser_MatchChar(parser, JsonType_Array, ']');
+
+    void* array = NULL;
+    if (count > 0)
+    {
+        array = JsonAllocator_AllocLower(&parser->allocator, NULL, 0, count * itemSize);
+        if (!array)
+        {
+            JsonParser_Panic(parser, JsonType_Array, JsonError_OutOfMemory, "Not enough memory for field '%s'", field->name);
+        }
+
+        memcpy(array, items, (size_t)count * itemSize);
+        JsonAllocator_FreeUpper(&parser->allocator, JsonArray_GetHeader(items), (int32_t)sizeof(JsonArray) + JsonArray_GetSize(items) * itemSize);
+    }
+
+    *(void**)(base + field->offset)        = array;
+    *(int32_t*)(base + field->countOffset) = count;
+}
+
+/* @funcdef: JsonParser_ParseStructObject */
+static void JsonParser_ParseStructObject(JsonParser* parser, const JsonStructDesc* desc, uint8_t* base)
+{
+    JSON_ASSERT(desc->shift > 0, "desc must be initialized by JsonStructDescInit");
+
+    JsonParser_MatchChar(parser, JsonType_Object, '{');
+
+    uint32_t seen  = 0;
+    int32_t  count = 0;
+    while (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != '}')
+    {
+        if (count++ > 0)
+        {
+            JsonParser_MatchChar(parser, JsonType_Object, ',');
+        }
+
+        if (JsonParser_SkipSpace(parser) != '"')
+        {
+            JsonParser_Panic(parser, JsonType_Object, JsonError_UnexpectedToken, "Expected <string> for <member-key> of <object>");
+        }
+
+        // Keys are matched on the source text, escaped ones are decoded on the stack
+        int32_t     rawLength;
+        bool        escaped;
+        const char* key       = JsonParser_ScanString(parser, &rawLength, &escaped);
+        int32_t     keyLength = rawLength;
+
+        char decoded[JSON_PATH_MAX_NAMES];
+        if (escaped)
+        {
+            keyLength = JsonString_Unescape(key, rawLength, decoded, JSON_PATH_MAX_NAMES);
+            key       = keyLength <= JSON_PATH_MAX_NAMES ? decoded : NULL;
+        }
+
+        JsonParser_SkipSpace(parser);
+        JsonParser_MatchChar(parser, JsonType_Object, ':');
+
+        const int32_t        index = key ? desc->table[JsonStructDesc_Slot(JsonString_Hash(key, keyLength), desc->seed, desc->shift)] : -1;
+        const JsonFieldDesc* field = index >= 0 ? &desc->fields[index] : NULL;
+        if (!field || (seen & (1u << index)) || !JsonStructDesc_KeyEquals(field, key, keyLength))
+        {
+            JsonParser_SkipValue(parser);
+            continue;
+        }
+
+        // Null is a missing value for optional fields
+        if (field->type != JsonColumnType_Value && JsonParser_SkipSpace(parser) == 'n')
+        {
+            Json value;
+            JsonParser_ParseLiteral(parser, &value);
+            if (field->required)
+            {
+                JsonParser_Panic(parser, JsonType_Null, JsonError_WrongType, "Field '%s' is null", field->name);
+            }
+            continue;
+        }
+
+        seen |= 1u << index;
+        if (field->countOffset >= 0)
+        {
+            JsonParser_ParseStructArray(parser, field, base);
+        }
+        else
+        {
+            JsonParser_ParseStructValue(parser, field, base + field->offset);
+        }
+    }
+
+    JsonParser_SkipSpace(parser);
+    JsonParser_MatchChar(parser, JsonType_Object, '}');
+
+    for (int32_t i = 0; i < desc->fieldCount; i++)
+    {
+        if (!(seen & (1u << i)))
+        {
+            JsonStructDesc_ClearField(&desc->fields[i], base);
+            if (desc->fields[i].required)
+            {
+                JsonParser_Panic(parser, JsonType_Object, JsonError_MissingField, "Missing field '%s'", desc->fields[i].name);
+            }
+        }
+    }
+}
+
+/* @funcdef: JsonParseStruct */
+JsonResult JsonParseStruct(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonStructDesc* desc, void* buffer, int32_t bufferSize, void* outStruct)
+{
+    JSON_ASSERT(desc, "desc mustnot be null");
+    JSON_ASSERT(outStruct, "outStruct mustnot be null");
+
+    if (!jsonCode || jsonCodeLength <= 0)
+    {
+        const JsonResult result = { JsonError_WrongFormat, "Json code is empty", 0 };
+        return result;
+    }
+
+    JsonAllocator allocator;
+    if (!JsonAllocator_Init(&allocator, buffer, bufferSize))
+    {
+        const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", 0 };
+        return result;
+    }
+
+    JsonParser parser;
+    JsonParser_Init(&parser, jsonCode, jsonCodeLength, allocator, flags);
+
+    if (setjmp(parser.errjmp) == 0)
+    {
+        if (JsonParser_SkipSpace(&parser) == '{')
+        {
+            JsonParser_ParseStructObject(&parser, desc, (uint8_t*)outStruct);
+
+            JsonParser_SkipSpace(&parser);
+            if (!JsonParser_IsAtEnd(&parser))
+            {
+                JsonParser_Panic(&parser, JsonType_Null, JsonError_WrongFormat, "JSON is not well-formed. JSON is start with <object>.");
+            }
+        }
+        else
+        {
+            JsonParser_SetError(&parser, JsonType_Null, JsonError_WrongFormat, "JSON must be starting with '{' to be parsed into a struct, first character is '%c'", JsonParser_PeekChar(&parser));
+        }
+    }
+
+    JsonResult result;
+    result.error             = parser.errnum;
+    result.message           = parser.errmsg;
+    result.memoryUsage       = (int32_t)(parser.allocator.lowerMarker - (uint8_t*)buffer);
+    result.stringMemoryUsage = 0;
+    return result;
+}
+
+/* @funcdef: JsonPathResolve */
+JsonError JsonPathResolve(const Json root, const JsonPath* path, Json* outResult)
+{
+    JSON_ASSERT(path, "path mustnot be null");
+    JSON_ASSERT(outResult, "outResult mustnot be null");
+
+    Json current = root;
+    for (int32_t i = 0; i < path->count; i++)
+    {
+        const JsonPathSegment* segment = &path->segments[i];
+        if (segment->index == JSON_PATH_ANY)
+        {
+            return JsonError_InvalidValue;
+        }
+
+        if (current.type == JsonType_Object && (segment->index == JSON_PATH_KEY || segment->keyLength > 0))
+        {
+            // Key lengths are known, so a member only costs a bounded strncmp and no strlen
+            const char* key   = path->names + segment->keyOffset;
+            int32_t     found = -1;
+            for (int32_t k = 0; k < current.length; k++)
+            {
+                if (JsonObjectMember_NameEquals(current.object[k].name, key, segment->keyLength))
+                {
+                    found = k;
+                    break;
+                }
+            }
+
+            if (found < 0)
+            {
+                return JsonError_MissingField;
+            }
+
+            current = current.object[found].value;
+        }
+        else if (JsonIsArray(current) && segment->index >= 0)
+        {
+            if (segment->index >= current.length)
+            {
+                return JsonError_MissingField;
             }
+
+            current = JsonArrayGet(current, segment->index);
+        }
+        else
+        {
+            return JsonError_MissingField;
+        }
+    }
+
+    *outResult = current;
+    return JsonError_None;
+}
+
+// -------------------------------------------------------------------
+// Parallel parsing: worker threads
+// -------------------------------------------------------------------
+
+#if defined(JSON_NO_THREADS)
+typedef int                 JsonMutex;
+typedef int                 JsonCond;
+#elif defined(_WIN32)
+typedef CRITICAL_SECTION    JsonMutex;
+typedef CONDITION_VARIABLE  JsonCond;
+#else
+typedef pthread_mutex_t     JsonMutex;
+typedef pthread_cond_t      JsonCond;
+#endif
+
+typedef void (*JsonWorkerFunc)(void* context, int32_t workerIndex);
+
+/* Start arguments of one worker thread */
+typedef struct JsonWorker
+{
+    JsonWorkerFunc  func;
+    void*           context;
+    int32_t         index;
+} JsonWorker;
+
+static void JsonMutex_Init(JsonMutex* mutex)
+{
+#if defined(JSON_NO_THREADS)
+    (void)mutex;
+#elif defined(_WIN32)
+    InitializeCriticalSection(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+static void JsonMutex_Destroy(JsonMutex* mutex)
+{
+#if defined(JSON_NO_THREADS)
+    (void)mutex;
+#elif defined(_WIN32)
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+static void JsonMutex_Lock(JsonMutex* mutex)
+{
+#if defined(JSON_NO_THREADS)
+    (void)mutex;
+#elif defined(_WIN32)
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+static void JsonMutex_Unlock(JsonMutex* mutex)
+{
+#if defined(JSON_NO_THREADS)
+    (void)mutex;
+#elif defined(_WIN32)
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+static void JsonCond_Init(JsonCond* cond)
+{
+#if defined(JSON_NO_THREADS)
+    (void)cond;
+#elif defined(_WIN32)
+    InitializeConditionVariable(cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+static void JsonCond_Destroy(JsonCond* cond)
+{
+#if defined(JSON_NO_THREADS) || defined(_WIN32)
+    (void)cond;
+#else
+    pthread_cond_destroy(cond);
+#endif
+}
+
+static void JsonCond_Wait(JsonCond* cond, JsonMutex* mutex)
+{
+#if defined(JSON_NO_THREADS)
+    (void)cond; (void)mutex;
+    JSON_ASSERT(false, "a single thread has nobody to wait for");
+#elif defined(_WIN32)
+    SleepConditionVariableCS(cond, mutex, INFINITE);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+static void JsonCond_Broadcast(JsonCond* cond)
+{
+#if defined(JSON_NO_THREADS)
+    (void)cond;
+#elif defined(_WIN32)
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+#if !defined(JSON_NO_THREADS)
+#  if defined(_WIN32)
+static DWORD WINAPI JsonWorker_Main(LPVOID argument)
+#  else
+static void* JsonWorker_Main(void* argument)
+#  endif
+{
+    const JsonWorker* worker = (const JsonWorker*)argument;
+    worker->func(worker->context, worker->index);
+    return 0;
+}
+#endif
+
+#if !defined(JSON_NO_THREADS)
+/* Number of CPUs the process may run on, at least 1 */
+static int32_t JsonWorkers_HardwareCount(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int32_t)info.dwNumberOfProcessors : 1;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int32_t)count : 1;
+#endif
+}
+#endif
+
+/* Clamp a requested thread count, 0 or less means one per CPU */
+static int32_t JsonWorkers_Count(int32_t threadCount)
+{
+#if defined(JSON_NO_THREADS)
+    (void)threadCount;
+    return 1;
+#else
+    if (threadCount <= 0)
+    {
+        threadCount = JsonWorkers_HardwareCount();
+    }
+    return threadCount < JSON_MAX_THREADS ? threadCount : JSON_MAX_THREADS;
+#endif
+}
+
+/* Run func on count workers and wait for all of them, worker 0 is the calling thread
+   Workers whose thread cannot be started are skipped, func must let the others take over their work */
+static void JsonWorkers_Run(int32_t count, JsonWorkerFunc func, void* context)
+{
+    JsonWorker workers[JSON_MAX_THREADS];
+#if defined(JSON_NO_THREADS)
+    (void)workers;
+    count = 1;
+#elif defined(_WIN32)
+    HANDLE     threads[JSON_MAX_THREADS];
+    bool       started[JSON_MAX_THREADS];
+#else
+    pthread_t  threads[JSON_MAX_THREADS];
+    bool       started[JSON_MAX_THREADS];
+#endif
+
+    for (int32_t i = 1; i < count; i++)
+    {
+        workers[i].func    = func;
+        workers[i].context = context;
+        workers[i].index   = i;
+
+#if defined(_WIN32) && !defined(JSON_NO_THREADS)
+        threads[i] = CreateThread(NULL, 0, JsonWorker_Main, &workers[i], 0, NULL);
+        started[i] = threads[i] != NULL;
+#elif !defined(JSON_NO_THREADS)
+        started[i] = pthread_create(&threads[i], NULL, JsonWorker_Main, &workers[i]) == 0;
+#endif
+    }
+
+    func(context, 0);
+
+    for (int32_t i = 1; i < count; i++)
+    {
+#if defined(_WIN32) && !defined(JSON_NO_THREADS)
+        if (started[i])
+        {
+            WaitForSingleObject(threads[i], INFINITE);
+            CloseHandle(threads[i]);
         }
-        else
+#elif !defined(JSON_NO_THREADS)
+        if (started[i])
         {
-            break;
+            pthread_join(threads[i], NULL);
         }
+#endif
     }
-    
-    return JsonParser_PeekChar(parser);
 }
 
-/* All parse functions declaration */
+// -------------------------------------------------------------------
+// Parallel parsing: NDJSON / JSON Lines
+// -------------------------------------------------------------------
 
-static void JsonParser_ParseArray(JsonParser* parser, Json* outValue);
-static void JsonParser_ParseSingle(JsonParser* parser, Json* outValue);
-static void JsonParser_ParseObject(JsonParser* parser, Json* outValue);
-static void JsonParser_ParseNumber(JsonParser* parser, Json* outValue);
-static void JsonParser_ParseString(JsonParser* parser, Json* outValue);
+/* Parsed record waiting for its chunk's turn, kept at the end of the worker arena */
+typedef struct JsonLineRecord
+{
+    Json        value;
+    JsonResult  result;
+    int64_t     offset;
+} JsonLineRecord;
 
-/* @funcdef: JsonParser_ParseNumber */
-static void JsonParser_ParseNumber(JsonParser* parser, Json* outValue)
+/* Shared state of JsonParseLines */
+typedef struct JsonLinesJob
 {
-    int c = JsonParser_SkipSpace(parser);
-    if (c > 0)
+    const char*         input;
+    int64_t             length;
+    JsonParseFlags      flags;
+    JsonLineHandler     handler;
+    void*               user;
+
+    uint8_t*            arenas;
+    int32_t             arenaSize;
+
+    int64_t             chunkSize;
+    int64_t             chunkCount;
+
+    JsonMutex           mutex;
+    JsonCond            turnChanged;
+    int64_t             nextChunk;      /* Next chunk to claim, chunks are claimed in input order */
+    int64_t             turn;           /* Chunk whose records are handed over now, ordered mode only */
+    bool                stopped;
+} JsonLinesJob;
+
+/* Start of the first line starting at or after offset, lines belong to the chunk their first byte is in
+   JSON strings cannot hold a raw line feed, so every line feed ends a record and quotes need no tracking */
+static int64_t JsonLinesJob_LineStart(const JsonLinesJob* job, int64_t offset)
+{
+    if (offset <= 0)
     {
-		int sign = 1;
-		
-		if (c == '+')
-		{
-			c = JsonParser_NextChar(parser);
-			JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "JSON does not support number start with '+'");
-		}
-		else if (c == '-')
-		{
-			sign = -1;
-			c = JsonParser_NextChar(parser);
-		}
-		else if (c == '0')
-		{
-			c = JsonParser_NextChar(parser);
-			if (!isspace(c) && !ispunct(c))
-			{
-				JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "JSON does not support number start with '0' (only standalone '0' is accepted)");
-			}
-		}
-		else if (!isdigit(c))
-		{
-			JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Unexpected '%c'", c);
-		}
+        return 0;
+    }
+    if (offset >= job->length)
+    {
+        return job->length;
+    }
 
-		int    dot    = 0;
-        int    exp    = 0;
-        int    expsgn = 0;
-        int    exppow = 0;
-        int    expchk = 0;
-		int    numpow = 1;
-		double number = 0;
+    const char* lineFeed = (const char*)memchr(job->input + offset - 1, '\n', (size_t)(job->length - offset + 1));
+    return lineFeed ? (int64_t)(lineFeed - job->input) + 1 : job->length;
+}
 
-		while (c > 0)
-		{
-            if (c == 'e')
+/* Hand a record to the user, false when the parsing must stop */
+static bool JsonLinesJob_Deliver(JsonLinesJob* job, const JsonLineRecord* record)
+{
+    if (!job->handler(job->user, record->offset, record->value, &record->result))
+    {
+        JsonMutex_Lock(&job->mutex);
+        job->stopped = true;
+        JsonCond_Broadcast(&job->turnChanged);
+        JsonMutex_Unlock(&job->mutex);
+        return false;
+    }
+    return true;
+}
+
+/* Wait until chunk is the one to hand its records over, false when the parsing stopped meanwhile */
+static bool JsonLinesJob_WaitTurn(JsonLinesJob* job, int64_t chunk)
+{
+    JsonMutex_Lock(&job->mutex);
+    while (job->turn != chunk && !job->stopped)
+    {
+        JsonCond_Wait(&job->turnChanged, &job->mutex);
+    }
+    const bool stopped = job->stopped;
+    JsonMutex_Unlock(&job->mutex);
+    return !stopped;
+}
+
+/* Parse one line into memory, blank lines give false */
+static bool JsonLinesJob_ParseLine(const JsonLinesJob* job, int64_t start, int64_t end, void* memory, int32_t memorySize, JsonLineRecord* outRecord)
+{
+    // Carriage returns of CRLF files are whitespace, a line of whitespace only is blank
+    int64_t first = start;
+    while (first < end && JsonParser_IsCharClass(job->input[first], JsonCharClass_Space))
+    {
+        first++;
+    }
+    if (first == end)
+    {
+        return false;
+    }
+
+    outRecord->offset = start;
+    if (end - start > INT32_MAX)
+    {
+        const JsonResult result = { JsonError_WrongFormat, "Line is too long", 0 };
+        outRecord->value  = JSON_NULL;
+        outRecord->result = result;
+        return true;
+    }
+
+    outRecord->result = JsonParse(job->input + start, (int32_t)(end - start), (JsonParseFlags)(job->flags & ~JsonParseFlags_UnorderedLines), memory, memorySize, &outRecord->value);
+    return true;
+}
+
+/* Parse the lines of one chunk, in ordered mode records are kept in the arena until the previous chunks are done */
+static void JsonLinesJob_RunChunk(JsonLinesJob* job, int64_t chunk, uint8_t* arena)
+{
+    const bool    ordered = !(job->flags & JsonParseFlags_UnorderedLines);
+    const int64_t end     = JsonLinesJob_LineStart(job, (chunk + 1) * job->chunkSize);
+
+    JsonLineRecord* records = (JsonLineRecord*)(arena + job->arenaSize) - 1;
+    int32_t         pending = 0;
+    int32_t         used    = 0;
+
+    // The oldest running chunk hands its records over right away
+    JsonMutex_Lock(&job->mutex);
+    bool myTurn = !ordered || job->turn == chunk;
+    JsonMutex_Unlock(&job->mutex);
+
+    for (int64_t start = JsonLinesJob_LineStart(job, chunk * job->chunkSize); start < end; )
+    {
+        const char*   lineFeed = (const char*)memchr(job->input + start, '\n', (size_t)(end - start));
+        const int64_t lineEnd  = lineFeed ? (int64_t)(lineFeed - job->input) : end;
+
+        // Records pile up from the end of the arena, the values of their lines from the start
+        JsonLineRecord record;
+        const int32_t  memorySize = (int32_t)((uint8_t*)(records - pending) - (arena + used));
+        if (!myTurn && memorySize > 0)
+        {
+            // Blank lines give no record, they never need the turn
+            if (!JsonLinesJob_ParseLine(job, start, lineEnd, arena + used, memorySize, &record))
             {
-                if (exp)
-                {
-                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Too many 'e' are presented in a <number>");
-                }
-                else if (dot && numpow == 1)
-                {
-                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken,
-                                "'.' is presented in number token, but require a digit after '.' ('%c')", c);
-                }
-                else
-                {
-                    exp    = 1;
-                    expchk = 0;
-                }
+                start = lineEnd + 1;
+                continue;
             }
-			else if (c == '.')
-			{
-                if (exp)
-                {
-                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Cannot has '.' after 'e' is presented in a <number>");
-                }
-				else if (dot)
-				{
-					JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Too many '.' are presented in a <number>");
-				}
-				else
-				{
-					dot = 1;
-				}
-			}
-            else if (exp && (c == '-' || c == '+'))
+
+            if (record.result.error == JsonError_None)
             {
-                if (expchk)
-                {
-                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "'%c' is presented after digits are presented of exponent part", c);
-                }
-                else if (expsgn)
+                records[-pending++] = record;
+                used += record.result.memoryUsage;
+                start = lineEnd + 1;
+                continue;
+            }
+
+            // Errors are handed over with their message, which lives in the arena until the next line is parsed.
+            // An out of memory is never delivered from here: the line gets the whole arena once the turn comes.
+            if (record.result.error != JsonError_OutOfMemory)
+            {
+                myTurn = JsonLinesJob_WaitTurn(job, chunk);
+                for (int32_t i = 0; myTurn && i < pending; i++)
                 {
-                    JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Too many signed characters are presented after 'e'");
+                    myTurn = JsonLinesJob_Deliver(job, &records[-i]);
                 }
-                else
+                if (!myTurn || !JsonLinesJob_Deliver(job, &record))
                 {
-                    expsgn = (c == '-' ? -1 : 1);
+                    return;
                 }
+
+                pending = 0;
+                used    = 0;
+                start   = lineEnd + 1;
+                continue;
             }
-			else if (!isdigit(c))
-			{
-				break;
-			}
-			else
-			{
-                if (exp)
-                {
-                    expchk = 1;
-                    exppow = exppow * 10 + (c - '0');
-                }
-                else
+        }
+
+        if (!myTurn)
+        {
+            // The arena is full: hand the pending records over, then keep the turn for the rest of the chunk
+            if (!JsonLinesJob_WaitTurn(job, chunk))
+            {
+                return;
+            }
+            for (int32_t i = 0; i < pending; i++)
+            {
+                if (!JsonLinesJob_Deliver(job, &records[-i]))
                 {
-                    if (dot)
-                    {
-                        numpow *= 10;
-                        number += (c - '0') / (double)numpow;
-                    }
-                    else
-                    {
-                        number = number * 10 + (c - '0');
-                    }
+                    return;
                 }
-			}
+            }
 
-			c = JsonParser_NextChar(parser);
-		}
+            myTurn  = true;
+            pending = 0;
+            used    = 0;
+        }
 
-        if (exp && !expchk)
+        if (JsonLinesJob_ParseLine(job, start, lineEnd, arena, job->arenaSize, &record) && !JsonLinesJob_Deliver(job, &record))
         {
-            JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "'e' is presented in number token, but require a digit after 'e' ('%c')", (char)c);
+            return;
         }
-		if (dot && numpow == 1)
-		{
-			JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "'.' is presented in number token, but require a digit after '.' ('%c')", (char)c);
-		}
-		else
-		{
-            if (exp)
+        start = lineEnd + 1;
+
+        JsonMutex_Lock(&job->mutex);
+        const bool stopped = job->stopped;
+        JsonMutex_Unlock(&job->mutex);
+        if (stopped)
+        {
+            return;
+        }
+    }
+
+    if (ordered)
+    {
+        if (!myTurn && !JsonLinesJob_WaitTurn(job, chunk))
+        {
+            return;
+        }
+        for (int32_t i = 0; i < pending; i++)
+        {
+            if (!JsonLinesJob_Deliver(job, &records[-i]))
             {
-                int i;
-                double tmp = 1;
-                for (i = 0; i < exppow; i++)
-                {
-                    tmp *= 10;
-                }
-                
-                if (expsgn < 0)
-                {
-                    number /= tmp;
-                }
-                else
-                {
-                    number *= tmp;
-                }
+                return;
             }
+        }
 
-            Json value;
-            value.type = JsonType_Number;
-            value.length = 0;
-            value.number = sign * number;
+        JsonMutex_Lock(&job->mutex);
+        job->turn = chunk + 1;
+        JsonCond_Broadcast(&job->turnChanged);
+        JsonMutex_Unlock(&job->mutex);
+    }
+}
 
-            *outValue = value;
-		}
+/* Worker of JsonParseLines: claim the next chunk until there is none left */
+static void JsonLinesJob_Work(void* context, int32_t workerIndex)
+{
+    JsonLinesJob* job   = (JsonLinesJob*)context;
+    uint8_t*      arena = job->arenas + (size_t)workerIndex * (size_t)job->arenaSize;
+
+    while (true)
+    {
+        JsonMutex_Lock(&job->mutex);
+        const int64_t chunk   = job->nextChunk++;
+        const bool    stopped = job->stopped;
+        JsonMutex_Unlock(&job->mutex);
+
+        if (stopped || chunk >= job->chunkCount)
+        {
+            return;
+        }
+
+        JsonLinesJob_RunChunk(job, chunk, arena);
+    }
+}
+
+/* @funcdef: JsonParseLines */
+JsonError JsonParseLines(const char* input, int64_t inputLength, JsonParseFlags flags, int32_t threadCount, JsonLineHandler handler, void* user, void* buffer, int64_t bufferSize)
+{
+    JSON_ASSERT(handler, "handler mustnot be null");
+
+    if (!input || inputLength <= 0)
+    {
+        return JsonError_None;
+    }
+
+    // Each arena is aligned like the nodes and must at least hold a few records next to a small value
+    const int64_t minArenaSize = 64 * (int64_t)sizeof(JsonLineRecord);
+    const int64_t misalign     = (int64_t)((uintptr_t)buffer & (sizeof(Json) - 1));
+    const int64_t adjustment   = (misalign != 0) * ((int64_t)sizeof(Json) - misalign);
+    const int64_t usableSize   = buffer && bufferSize > adjustment ? bufferSize - adjustment : 0;
+
+    int32_t workers = JsonWorkers_Count(threadCount);
+    while (workers > 1 && usableSize / workers < minArenaSize)
+    {
+        workers--;
     }
-    else
+    if (usableSize < minArenaSize)
     {
-        JsonParser_Panic(parser, JsonType_Number, JsonError_UnexpectedToken, "Reached the end of json!");
+        return JsonError_OutOfMemory;
     }
+
+    JsonLinesJob job;
+    job.input       = input;
+    job.length      = inputLength;
+    job.flags       = flags;
+    job.handler     = handler;
+    job.user        = user;
+    job.arenas      = (uint8_t*)buffer + adjustment;
+    job.arenaSize   = (int32_t)((usableSize / workers < INT32_MAX ? usableSize / workers : INT32_MAX) & ~((int64_t)sizeof(Json) - 1));
+
+    // A few chunks per worker keep them busy when line lengths vary
+    job.chunkSize   = inputLength / ((int64_t)workers * 8);
+    job.chunkSize   = job.chunkSize > 64 * 1024 ? job.chunkSize : 64 * 1024;
+    job.chunkCount  = (inputLength + job.chunkSize - 1) / job.chunkSize;
+
+    job.nextChunk   = 0;
+    job.turn        = 0;
+    job.stopped     = false;
+    JsonMutex_Init(&job.mutex);
+    JsonCond_Init(&job.turnChanged);
+
+    JsonWorkers_Run(workers, JsonLinesJob_Work, &job);
+
+    JsonCond_Destroy(&job.turnChanged);
+    JsonMutex_Destroy(&job.mutex);
+    return job.stopped ? JsonError_InvalidValue : JsonError_None;
 }
 
-/* @funcdef: JsonParser_ParseArray */
-static void JsonParser_ParseArray(JsonParser* parser, Json* outValue)
+// -------------------------------------------------------------------
+// Parallel parsing: one large document
+// -------------------------------------------------------------------
+
+#define JSON_SPLIT_MAX_SEGMENTS     (JSON_MAX_THREADS * 4)
+#define JSON_SPLIT_MIN_SIZE         (1 << 20)   /* Smaller documents are not worth the threads */
+#define JSON_SPLIT_MAX_SEGMENT_SIZE (1 << 28)   /* Keeps the scanning kernels in int32_t range */
+#define JSON_SPLIT_MIN_ARENA_SIZE   (64 * 1024)
+
+/* Scanned slice of the top level body */
+typedef struct JsonSplitSegment
 {
-    if (JsonParser_SkipSpace(parser) > 0)
-    {
-	    JsonParser_MatchChar(parser, JsonType_Array, '[');
+    int64_t     start;
+    int64_t     end;
+
+    /* Pass 1: quote parity and depth changes, for both possible string states at the start */
+    bool        flipsString;
+    int64_t     depthOutside;
+    int64_t     depthInside;
+
+    /* Reconciled state at the start */
+    bool        inString;
+    int64_t     depth;
+
+    /* Pass 2: separators of the top level items */
+    int64_t     commas;
+    int64_t     firstComma;     /* -1 when none */
+    bool        broken;         /* The top level closes before the end of the input */
+} JsonSplitSegment;
+
+/* Items of the top level parsed by one worker */
+typedef struct JsonSplitPart
+{
+    int64_t     start;
+    int64_t     end;
+    int64_t     firstItem;
+    int64_t     itemCount;
 
-        JsonTempArray(Json, 64) values = JsonTempArray_Init(NULL);
-	    while (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != ']')
-	    {
-	        if (values.count > 0)
-	        {
-                JsonParser_MatchChar(parser, JsonType_Array, ',');
-	        }
-	    
-            Json value;
-            JsonParser_ParseSingle(parser, &value);
+    bool        allNumbers;
+    bool        allInt32;
+    uint64_t    summary;
 
-            JsonTempArray_Push(&values, value, &parser->allocator);
-	    }
+    JsonError   error;
+    const char* message;
+} JsonSplitPart;
 
-	    JsonParser_SkipSpace(parser);
-	    JsonParser_MatchChar(parser, JsonType_Array, ']');
+/* Shared state of JsonParseParallel */
+typedef struct JsonSplitJob
+{
+    const char*         input;
+    int64_t             bodyStart;      /* Just after the top level bracket */
+    int64_t             bodyEnd;        /* The closing bracket */
+    JsonParseFlags      flags;
+    bool                isObject;
 
-        outValue->type   = JsonType_Array;
-        outValue->length = JsonTempArray_GetCount(&values);
-        outValue->array  = (Json*)JsonTempArray_ToBuffer(&values, &parser->allocator);
+    JsonSplitSegment    segments[JSON_SPLIT_MAX_SEGMENTS];
+    int32_t             segmentCount;
 
-        JsonTempArray_Free(&values, &parser->allocator);
+    JsonSplitPart       parts[JSON_SPLIT_MAX_SEGMENTS];
+    int32_t             partCount;
+
+    uint8_t*            items;          /* Json or JsonObjectMember of the top level */
+    JsonAllocator       allocators[JSON_MAX_THREADS];
+
+    JsonMutex           mutex;
+    int32_t             pass;
+    int32_t             next;           /* Next segment or part to claim in the running pass */
+    bool                failed;
+} JsonSplitJob;
+
+/* Quotes are escaped by an odd run of backslashes, which only exists inside strings of valid JSON */
+static bool JsonSplitJob_IsEscaped(const JsonSplitJob* job, int64_t position)
+{
+    int64_t start = position;
+    while (start > job->bodyStart && job->input[start - 1] == '\\')
+    {
+        start--;
     }
+    return ((position - start) & 1) != 0;
 }
 
-/* JsonState_ParseSingle */
-static void JsonParser_ParseSingle(JsonParser* parser, Json* outValue)
+/* Pass 1: follow quotes and brackets without knowing whether the segment starts in a string
+   Both string states flip on every quote, so one walk counts the brackets for both of them */
+static void JsonSplitJob_ScanParity(const JsonSplitJob* job, JsonSplitSegment* segment, const JsonKernels* kernels)
 {
-    if (JsonParser_SkipSpace(parser) > 0)
+    const uint8_t* input = (const uint8_t*)job->input;
+
+    bool    inString     = false;
+    int64_t depthOutside = 0;
+    int64_t depthInside  = 0;
+    for (int64_t cursor = segment->start; cursor < segment->end; cursor++)
     {
-	    int c = JsonParser_PeekChar(parser);
-	
-	    switch (c)
-	    {
-	    case '[':
-	        JsonParser_ParseArray(parser, outValue);
+        cursor += JsonKernels_Call(kernels, scanStructural)(input + cursor, (int32_t)(segment->end - cursor));
+        if (cursor >= segment->end)
+        {
             break;
-	    
-	    case '{':
-	        JsonParser_ParseObject(parser, outValue);
+        }
+
+        int64_t* depth = inString ? &depthInside : &depthOutside;
+        switch (input[cursor])
+        {
+        case '"':
+            inString ^= !JsonSplitJob_IsEscaped(job, cursor);
             break;
-	    
-	    case '"':
-	        JsonParser_ParseString(parser, outValue);
+
+        case '[': case '{':
+            (*depth)++;
             break;
 
-	    case '+': case '-': case '0': 
-        case '1': case '2': case '3': 
-        case '4': case '5': case '6': 
-        case '7': case '8': case '9':
-	        JsonParser_ParseNumber(parser, outValue);
+        case ']': case '}':
+            (*depth)--;
+            break;
+        }
+    }
+
+    segment->flipsString  = inString;
+    segment->depthOutside = depthOutside;
+    segment->depthInside  = depthInside;
+}
+
+/* Pass 2: from the reconciled start state, count the commas between top level items */
+static void JsonSplitJob_ScanCommas(const JsonSplitJob* job, JsonSplitSegment* segment, const JsonKernels* kernels)
+{
+    const uint8_t* input = (const uint8_t*)job->input;
+
+    bool    inString   = segment->inString;
+    int64_t depth      = segment->depth;
+    int64_t commas     = 0;
+    int64_t firstComma = -1;
+    for (int64_t cursor = segment->start; cursor < segment->end; cursor++)
+    {
+        // Only the top level needs every byte, strings and nested containers are skipped by the kernels
+        if (inString)
+        {
+            cursor += JsonKernels_Call(kernels, scanString)(input + cursor, (int32_t)(segment->end - cursor));
+        }
+        else if (depth > 1)
+        {
+            cursor += JsonKernels_Call(kernels, scanStructural)(input + cursor, (int32_t)(segment->end - cursor));
+        }
+        if (cursor >= segment->end)
+        {
             break;
+        }
 
+        switch (input[cursor])
+        {
+        case '"':
+            inString ^= !JsonSplitJob_IsEscaped(job, cursor);
+            break;
 
-        case '/':
-            if (parser->flags & JsonParseFlags_SupportComment)
-            {
-                JsonParser_SkipComments(parser);
-                JsonParser_ParseSingle(parser, outValue);
-            }
-            else
+        case '[': case '{':
+            depth += !inString;
+            break;
+
+        case ']': case '}':
+            depth -= !inString;
+            if (depth < 1)
             {
-                JsonParser_Panic(parser, JsonType_String, JsonError_UnknownToken, "Unknown token '%c'", c);
+                segment->broken = true;
+                return;
             }
             break;
-	    
-        default:
-	    {
-	        int length = 0;
-	        while (c > 0 && isalpha(c))
-	        {
-                length++;
-                c = JsonParser_NextChar(parser);
-	        }
 
-	        const char* token = parser->buffer + parser->cursor - length;
-            if (length == 4 && strncmp(token, "null", length) == 0)
+        case ',':
+            if (!inString && depth == 1)
             {
-                *outValue = JSON_NULL;
+                firstComma = firstComma < 0 ? cursor : firstComma;
+                commas++;
             }
-            else if (length == 4 && strncmp(token, "true", length) == 0)
-	        {
-                *outValue = JSON_TRUE;
-	        }
-	        else if (length == 5 && strncmp(token, "false", length) == 0)
-	        {
-                *outValue = JSON_FALSE;
-	        }
-	        else
-	        {
-                char tmp[256];
-                tmp[length] = 0;
-                while (length--)
-                {
-                    tmp[length] = token[length]; 
-                }
-
-                JsonParser_Panic(parser, JsonType_Null, JsonError_UnexpectedToken, "Unexpected token '%s'", tmp);
-	        }
-	    } break;
-	    /* END OF SWITCH STATEMENT */
+            break;
         }
     }
+
+    segment->commas     = commas;
+    segment->firstComma = firstComma;
+    segment->broken     = false;
 }
 
-static char* JsonParser_ParseStringNoToken(JsonParser* parser, int32_t* outLength)
+/* Pass 3: parse the items of a part straight into their slots of the top level */
+static void JsonSplitJob_ParsePart(JsonSplitJob* job, JsonSplitPart* part, JsonAllocator* allocator)
 {
-    JsonParser_MatchChar(parser, JsonType_String, '"');
-
-    int32_t i;
-    int32_t c0, c1;
-    int32_t length = 0;
+    JsonParser parser;
+    JsonParser_Init(&parser, job->input + part->start, (int32_t)(part->end - part->start), *allocator, job->flags);
 
-    JsonTempArray(char, 2048) buffer = JsonTempArray_Init(NULL);
-    while (!JsonParser_IsAtEnd(parser) && (c0 = JsonParser_PeekChar(parser)) != '"')
+    if (setjmp(parser.errjmp) == 0)
     {
-        if (c0 == '\\')
-        {
-            c0 = JsonParser_NextChar(parser);
-            switch (c0)
-            {
-            case 'n':
-                JsonTempArray_Push(&buffer, '\n', &parser->allocator);
-                length++;
-                break;
+        const bool packNumbers = !job->isObject && (job->flags & JsonParseFlags_PackNumberArrays);
+        const bool keySummary  = (job->flags & JsonParseFlags_KeySummary) != 0;
 
-            case 't':
-                JsonTempArray_Push(&buffer, '\t', &parser->allocator);
-                length++;
-                break;
+        bool     allNumbers = packNumbers;
+        bool     allInt32   = packNumbers;
+        uint64_t summary    = 0;
 
-            case 'r':
-                JsonTempArray_Push(&buffer, '\r', &parser->allocator);
-                length++;
-                break;
+        // Every part but the first starts with the comma in front of its first item
+        const int64_t count = part->itemCount;
+        for (int64_t i = 0; i < count; i++)
+        {
+            if (i > 0 || part->start != job->bodyStart)
+            {
+                JsonParser_SkipSpace(&parser);
+                JsonParser_MatchChar(&parser, job->isObject ? JsonType_Object : JsonType_Array, ',');
+            }
 
-            case 'b':
-                JsonTempArray_Push(&buffer, '\b', &parser->allocator);
-                length++;
-                break;
+            Json value;
+            if (job->isObject)
+            {
+                if (JsonParser_SkipSpace(&parser) != '"')
+                {
+                    JsonParser_Panic(&parser, JsonType_Object, JsonError_UnexpectedToken, "Expected <string> for <member-key> of <object>");
+                }
 
-            case '\\':
-                JsonTempArray_Push(&buffer, '\\', &parser->allocator);
-                length++;
-                break;
+                JsonObjectMember* member = (JsonObjectMember*)job->items + part->firstItem + i;
+                member->name = JsonParser_ParseStringNoToken(&parser, 0);
 
-            case '"':
-                JsonTempArray_Push(&buffer, '\"', &parser->allocator);
-                length++;
-                break;
+                JsonParser_SkipSpace(&parser);
+                JsonParser_MatchChar(&parser, JsonType_Object, ':');
 
-            case 'u':
-                c1 = 0;
-                for (i = 0; i < 4; i++)
+                if (JsonParser_SkipSpace(&parser) <= 0)
                 {
-                    if (isxdigit((c0 = JsonParser_NextChar(parser))))
-                    {
-                        c1 = c1 * 10 + (isdigit(c0) ? c0 - '0' : c0 < 'a' ? c0 - 'A' : c0 - 'a');
-                    }
-                    else
-                    {
-                        JsonParser_Panic(parser, JsonType_String, JsonError_UnknownToken, "Expected hexa character in unicode character");
-                    }
+                    JsonParser_Panic(&parser, JsonType_Object, JsonError_WrongFormat, "Expected <value> of <object>");
                 }
+                JsonParser_ParseSingle(&parser, &member->value);
+                value = member->value;
 
-                if (c1 <= 0x7F)
-                {
-                    JsonTempArray_Push(&buffer, (char)c1, &parser->allocator);
-                }
-                else if (c1 <= 0x7FF)
-                {
-                    char c2 = (char)(0xC0 | (c1 >> 6));            /* 110xxxxx */
-                    char c3 = (char)(0x80 | (c1 & 0x3F));          /* 10xxxxxx */
-                    JsonTempArray_Push(&buffer, c2, &parser->allocator);
-                    JsonTempArray_Push(&buffer, c3, &parser->allocator);
-                }
-                else if (c1 <= 0xFFFF)
+                if (keySummary)
                 {
-                    char c2 = (char)(0xE0 | (c1 >> 12));           /* 1110xxxx */
-                    char c3 = (char)(0x80 | ((c1 >> 6) & 0x3F));   /* 10xxxxxx */
-                    char c4 = (char)(0x80 | (c1 & 0x3F));          /* 10xxxxxx */
-                    JsonTempArray_Push(&buffer, c2, &parser->allocator);
-                    JsonTempArray_Push(&buffer, c3, &parser->allocator);
-                    JsonTempArray_Push(&buffer, c4, &parser->allocator);
+                    summary |= JsonKeySummary_Bits(member->name, member->name ? (int32_t)strlen(member->name) : 0);
                 }
-                else if (c1 <= 0x10FFFF)
+            }
+            else
+            {
+                if (JsonParser_SkipSpace(&parser) <= 0)
                 {
-                    char c2 = 0xF0 | (c1 >> 18);           /* 11110xxx */
-                    char c3 = 0x80 | ((c1 >> 12) & 0x3F);  /* 10xxxxxx */
-                    char c4 = 0x80 | ((c1 >> 6) & 0x3F);   /* 10xxxxxx */
-                    char c5 = 0x80 | (c1 & 0x3F);          /* 10xxxxxx */
-                    JsonTempArray_Push(&buffer, c2, &parser->allocator);
-                    JsonTempArray_Push(&buffer, c3, &parser->allocator);
-                    JsonTempArray_Push(&buffer, c4, &parser->allocator);
-                    JsonTempArray_Push(&buffer, c5, &parser->allocator);
+                    JsonParser_Panic(&parser, JsonType_Array, JsonError_WrongFormat, "Expected <value> of <array>");
                 }
-                
-                length++;
-                break;
 
-            default:
-                JsonParser_Panic(parser, JsonType_String, JsonError_UnknownToken, "Unknown escape character");
-                break;
+                Json* item = (Json*)job->items + part->firstItem + i;
+                JsonParser_ParseSingle(&parser, item);
+                value = *item;
             }
-        }
-        else
-        {
-            switch (c0)
-            {
-            case '\r':
-            case '\n':
-                JsonParser_Panic(parser, JsonType_String, JsonError_UnexpectedToken, "Unexpected newline characters '%c'", c0);
-                break;
 
-            default:
-                JsonTempArray_Push(&buffer, (char)c0, &parser->allocator);
-                break;
+            if (allNumbers)
+            {
+                JsonParser_UpdatePackable(value, &allNumbers, &allInt32);
+            }
+            if (keySummary)
+            {
+                summary |= JsonKeySummary_Get(value);
             }
         }
 
-        JsonParser_NextChar(parser);
-    }
-
-    JsonParser_MatchChar(parser, JsonType_String, '"');
-    if (buffer.count > 0)
-    {
-        if (outLength) *outLength = length;
-        JsonTempArray_Push(&buffer, 0, &parser->allocator);
-
-        char* string = (char*)JsonTempArray_ToBuffer(&buffer, &parser->allocator);
-        JsonTempArray_Free(&buffer, &parser->allocator);
+        if (JsonParser_SkipSpace(&parser) > 0)
+        {
+            JsonParser_Panic(&parser, JsonType_Null, JsonError_UnexpectedToken, "Unexpected token '%c'", JsonParser_PeekChar(&parser));
+        }
 
-        return string;
-    }
-    else
-    {
-        if (outLength) *outLength = 0;
-        return NULL;
+        part->allNumbers = allNumbers;
+        part->allInt32   = allInt32;
+        part->summary    = summary;
     }
-}
-
-/* @funcdef: JsonParser_ParseString */
-static void JsonParser_ParseString(JsonParser* parser, Json* outValue)
-{
-    if (JsonParser_SkipSpace(parser) > 0)
-    {
-        int length;
-        const char* string = JsonParser_ParseStringNoToken(parser, &length);
 
-        outValue->type   = JsonType_String;
-        outValue->string = string;
-        outValue->length = length;
-    }
+    part->error   = parser.errnum;
+    part->message = parser.errmsg;
+    *allocator    = parser.allocator;
 }
 
-/* @funcdef: JsonParser_ParseObject */
-static void JsonParser_ParseObject(JsonParser* parser, Json* outValue)
+/* Worker of JsonParseParallel: claim the segments or parts of the running pass until there is none left */
+static void JsonSplitJob_Work(void* context, int32_t workerIndex)
 {
-    if (JsonParser_SkipSpace(parser) > 0)
+    JsonSplitJob*      job     = (JsonSplitJob*)context;
+    const JsonKernels* kernels = JsonKernels_Get();
+
+    while (true)
     {
-        JsonParser_MatchChar(parser, JsonType_Object, '{');
+        JsonMutex_Lock(&job->mutex);
+        const int32_t index  = job->next++;
+        const bool    failed = job->failed;
+        JsonMutex_Unlock(&job->mutex);
 
-        JsonTempArray(JsonObjectMember, 32) values = JsonTempArray_Init(NULL);
-        while (JsonParser_SkipSpace(parser) > 0 && JsonParser_PeekChar(parser) != '}')
+        if (job->pass == 0 && index < job->segmentCount)
         {
-            if (values.count > 0)
-            {
-                JsonParser_MatchChar(parser, JsonType_Object, ',');
-            }
+            JsonSplitJob_ScanParity(job, &job->segments[index], kernels);
+        }
+        else if (job->pass == 1 && index < job->segmentCount)
+        {
+            JsonSplitJob_ScanCommas(job, &job->segments[index], kernels);
+        }
+        else if (job->pass == 2 && index < job->partCount && !failed)
+        {
+            JsonSplitPart* part = &job->parts[index];
+            JsonSplitJob_ParsePart(job, part, &job->allocators[workerIndex]);
 
-            if (JsonParser_SkipSpace(parser) != '"')
+            if (part->error != JsonError_None)
             {
-                JsonParser_Panic(parser, JsonType_Object, JsonError_UnexpectedToken, "Expected <string> for <member-key> of <object>");
+                JsonMutex_Lock(&job->mutex);
+                job->failed = true;
+                JsonMutex_Unlock(&job->mutex);
             }
+        }
+        else
+        {
+            return;
+        }
+    }
+}
 
-            const char* name = JsonParser_ParseStringNoToken(parser, 0);
+/* Run one pass of the job on every worker */
+static void JsonSplitJob_RunPass(JsonSplitJob* job, int32_t pass, int32_t workers)
+{
+    job->pass = pass;
+    job->next = 0;
+    JsonWorkers_Run(workers, JsonSplitJob_Work, job);
+}
 
-            JsonParser_SkipSpace(parser);
-            JsonParser_MatchChar(parser, JsonType_Object, ':');
+/* Cut the body in segments and find their string and depth state, false when the body is not a list of items */
+static bool JsonSplitJob_Index(JsonSplitJob* job, int32_t workers)
+{
+    const int64_t bodyLength = job->bodyEnd - job->bodyStart;
 
-            Json value;
-            JsonParser_ParseSingle(parser, &value);
+    int64_t count = (int64_t)workers * 4;
+    count = count > (bodyLength + JSON_SPLIT_MAX_SEGMENT_SIZE - 1) / JSON_SPLIT_MAX_SEGMENT_SIZE ? count : (bodyLength + JSON_SPLIT_MAX_SEGMENT_SIZE - 1) / JSON_SPLIT_MAX_SEGMENT_SIZE;
+    count = count < JSON_SPLIT_MAX_SEGMENTS ? count : JSON_SPLIT_MAX_SEGMENTS;
+    count = count < bodyLength ? count : (bodyLength > 0 ? bodyLength : 1);
+    if (bodyLength / count > JSON_SPLIT_MAX_SEGMENT_SIZE)
+    {
+        return false;
+    }
 
-            /* Well done */
-            JsonObjectMember member;
-            member.name  = name;
-            member.value = value;
-            JsonTempArray_Push(&values, member, &parser->allocator);
-        }
+    job->segmentCount = (int32_t)count;
+    for (int32_t i = 0; i < job->segmentCount; i++)
+    {
+        job->segments[i].start = job->bodyStart + bodyLength * i / count;
+        job->segments[i].end   = job->bodyStart + bodyLength * (i + 1) / count;
+    }
 
-        JsonParser_SkipSpace(parser);
-        JsonParser_MatchChar(parser, JsonType_Object, '}');
+    JsonSplitJob_RunPass(job, 0, workers);
 
-        outValue->type   = JsonType_Object;
-        outValue->length = JsonTempArray_GetCount(&values);
-        outValue->object = (JsonObjectMember*)JsonTempArray_ToBuffer(&values, &parser->allocator);
+    // The body starts outside of strings, right inside the top level
+    bool    inString = false;
+    int64_t depth    = 1;
+    for (int32_t i = 0; i < job->segmentCount; i++)
+    {
+        JsonSplitSegment* segment = &job->segments[i];
+        segment->inString = inString;
+        segment->depth    = depth;
 
-        JsonTempArray_Free(&values, &parser->allocator);
+        depth    += inString ? segment->depthInside : segment->depthOutside;
+        inString ^= segment->flipsString;
     }
-}
-         
-/* Internal parsing function
- */
-static Json* JsonState_ParseTopLevel(JsonParser* parser)
-{
-    JSON_ASSERT(parser, "parser mustnot be null");
-
-    Json* value = (Json*)JsonAllocator_AllocLower(&parser->allocator, NULL, 0, sizeof(Json));
-    value->type = JsonType_Null;
-
-    // Skip meta comment in header of the file
-    if (parser->flags & JsonParseFlags_SupportComment)
+    if (inString || depth != 1)
     {
-        JsonParser_SkipSpace(parser);
-        JsonParser_SkipComments(parser);
+        return false;
     }
 
-    // Use setjmp for quick exit when parse error happend
-    if (setjmp(parser->errjmp) == 0)
+    JsonSplitJob_RunPass(job, 1, workers);
+
+    for (int32_t i = 0; i < job->segmentCount; i++)
     {
-        // Just parse value from the top level
-        if (parser->flags & JsonParseFlags_NoStrictTopLevel)
+        if (job->segments[i].broken)
         {
-            JsonParser_ParseSingle(parser, value);
+            return false;
         }
-        // Make sure the toplevel is JsonType_Object
-        else if (JsonParser_SkipSpace(parser) == '{')
-        {
-            JsonParser_ParseObject(parser, value);
+    }
+    return true;
+}
 
-            JsonParser_SkipSpace(parser);
-            if (!JsonParser_IsAtEnd(parser))
-            {
-                JsonParser_Panic(parser, JsonType_Null, JsonError_WrongFormat, "JSON is not well-formed. JSON is start with <object>.");
-            }
-        }
-        // Make sure the toplevel is JsonType_Array
-        else if (JsonParser_SkipSpace(parser) == '[')
-        {
-            JsonParser_ParseArray(parser, value);
+/* Group the segments in parts starting at a top level comma, returns the number of items or -1 when there are too many */
+static int64_t JsonSplitJob_Partition(JsonSplitJob* job)
+{
+    // A body of whitespace only has no item, otherwise every top level comma starts one more
+    int64_t first = job->bodyStart;
+    while (first < job->bodyEnd && JsonParser_IsCharClass(job->input[first], JsonCharClass_Space))
+    {
+        first++;
+    }
+    int64_t items = first < job->bodyEnd;
 
-            JsonParser_SkipSpace(parser);
-            if (!JsonParser_IsAtEnd(parser))
+    job->partCount = 0;
+    JsonSplitPart* part = NULL;
+    for (int32_t i = 0; i < job->segmentCount; i++)
+    {
+        const JsonSplitSegment* segment = &job->segments[i];
+        if (i == 0 || segment->firstComma >= 0)
+        {
+            if (part)
             {
-                JsonParser_Panic(parser, JsonType_Null, JsonError_WrongFormat, "JSON is not well-formed. JSON is start with <array>.");
+                part->end       = i == 0 ? job->bodyStart : segment->firstComma;
+                part->itemCount = items - part->firstItem;
             }
+
+            part = &job->parts[job->partCount++];
+            memset(part, 0, sizeof(*part));
+            part->start     = i == 0 ? job->bodyStart : segment->firstComma;
+            part->firstItem = i == 0 ? 0 : items;
         }
-        else
+        items += segment->commas;
+    }
+    part->end       = job->bodyEnd;
+    part->itemCount = items - part->firstItem;
+
+    for (int32_t i = 0; i < job->partCount; i++)
+    {
+        if (job->parts[i].end - job->parts[i].start > INT32_MAX)
         {
-            JsonParser_SetError(parser, JsonType_Null, JsonError_WrongFormat, "JSON must be starting with '{' or '[', first character is '%c'", JsonParser_PeekChar(parser));
+            return -1;
         }
     }
+    return items <= INT32_MAX ? items : -1;
+}
 
-    return value;
+/* Documents the split cannot handle go through the serial parser, which also words the errors */
+static JsonResult JsonParseParallel_Serial(const char* jsonCode, int64_t jsonCodeLength, JsonParseFlags flags, void* buffer, int64_t bufferSize, Json* outValue)
+{
+    if (jsonCodeLength > INT32_MAX)
+    {
+        const JsonResult result = { JsonError_WrongFormat, "JSON is not well-formed, or is a top level value larger than 2 GB", 0, 0 };
+        *outValue = JSON_NULL;
+        return result;
+    }
+
+    const int32_t size = bufferSize < INT32_MAX ? (int32_t)bufferSize : INT32_MAX;
+    return JsonParse(jsonCode, (int32_t)jsonCodeLength, flags, buffer, size, outValue);
 }
 
-/* @funcdef: JsonParse */
-JsonResult JsonParse(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, void* buffer, int32_t bufferSize, Json* outValue)
+/* @funcdef: JsonParseParallel */
+JsonResult JsonParseParallel(const char* jsonCode, int64_t jsonCodeLength, JsonParseFlags flags, int32_t threadCount, void* buffer, int64_t bufferSize, Json* outValue)
 {
     JSON_ASSERT(outValue, "outValue mustnot be null");
 
-    // Validate json input
-    if (!jsonCode || jsonCodeLength <= 0)
+    const int32_t workers = JsonWorkers_Count(threadCount);
+    if (!jsonCode || jsonCodeLength <= 0 || (jsonCodeLength <= INT32_MAX && (workers == 1 || jsonCodeLength < JSON_SPLIT_MIN_SIZE)))
     {
-        //const JsonResult result = { JsonError_WrongFormat, "Json code is empty", NULL, 0 };
-        const JsonResult result = { JsonError_WrongFormat, "Json code is empty", 0 };
-        return result;
+        return JsonParseParallel_Serial(jsonCode, jsonCodeLength, flags, buffer, bufferSize, outValue);
     }
-    
-    // Create new allocator
-    JsonAllocator allocator;
-    if (!JsonAllocator_Init(&allocator, buffer, bufferSize))
+
+    // Comments may hide quotes and brackets from the scan, and only a top level container has items to split
+    int64_t first = 0;
+    int64_t last  = jsonCodeLength - 1;
+    while (first < last && JsonParser_IsCharClass(jsonCode[first], JsonCharClass_Space))
     {
-        //const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", NULL, 0 };
-        const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", 0 };
-        return result;
+        first++;
+    }
+    while (last > first && JsonParser_IsCharClass(jsonCode[last], JsonCharClass_Space))
+    {
+        last--;
+    }
+    if ((flags & JsonParseFlags_SupportComment) || !((jsonCode[first] == '[' && jsonCode[last] == ']') || (jsonCode[first] == '{' && jsonCode[last] == '}')))
+    {
+        return JsonParseParallel_Serial(jsonCode, jsonCodeLength, flags, buffer, bufferSize, outValue);
     }
 
-    // Create parser
-    JsonParser parser;
-    if (!JsonParser_Init(&parser, jsonCode, jsonCodeLength, allocator, flags))
+    // No allocation: the job lives at the end of the buffer, the top level items at its start and the arenas in between
+    const uintptr_t mask     = sizeof(Json) - 1;
+    uint8_t*        start    = (uint8_t*)(((uintptr_t)buffer + mask) & ~mask);
+    uint8_t*        jobStart = (uint8_t*)(((uintptr_t)buffer + (uintptr_t)bufferSize - sizeof(JsonSplitJob)) & ~mask);
+    if (!buffer || bufferSize < (int64_t)sizeof(JsonSplitJob) + JSON_SPLIT_MIN_ARENA_SIZE || jobStart < start + JSON_SPLIT_MIN_ARENA_SIZE)
     {
-        //const JsonResult result = { JsonError_InternalFatal, "Wrong behaviour when create new parser", NULL, 0 };
-        const JsonResult result = { JsonError_InternalFatal, "Wrong behaviour when create new parser", 0 };
+        const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", 0, 0 };
+        *outValue = JSON_NULL;
         return result;
     }
-    
-    // Parse the top level
-    Json* value = JsonState_ParseTopLevel(&parser);
-    JSON_ASSERT(value, "value mustnot be null");
-    *outValue = *value;
-
-    // Done!
-	JsonResult result;
-	result.error = parser.errnum;
-	result.message = parser.errmsg;
 
-    //result.parser = NULL;
-	result.memoryUsage = (int32_t)(parser.allocator.lowerMarker - (uint8_t*)buffer);
-    return result;
-}
+    JsonSplitJob* job = (JsonSplitJob*)jobStart;
+    job->input      = jsonCode;
+    job->bodyStart  = first + 1;
+    job->bodyEnd    = last;
+    job->flags      = flags;
+    job->isObject   = jsonCode[first] == '{';
+    job->failed     = false;
+    JsonMutex_Init(&job->mutex);
+
+    const int64_t count = JsonSplitJob_Index(job, workers) ? JsonSplitJob_Partition(job) : -1;
+    if (count < 0)
+    {
+        JsonMutex_Destroy(&job->mutex);
+        return JsonParseParallel_Serial(jsonCode, jsonCodeLength, flags, buffer, bufferSize, outValue);
+    }
 
-/* @funcdef: JsonContinueParse */
-//JsonResult JsonContinueParse(JsonParser* parser, Json* outValue)
-//{
-//    JSON_ASSERT(outValue, "outValue mustnot be null");
-//
-//    // Validate json input
-//    if (!jsonCode || jsonCodeLength <= 0)
-//    {
-//        const JsonResult result = { JsonError_WrongFormat, "Json code is empty", 0 };
-//        return result;
-//    }
-//
-//    // Create new allocator
-//    JsonAllocator allocator;
-//    if (!JsonAllocator_Init(&allocator, buffer, bufferSize))
-//    {
-//        const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", 0 };
-//        return result;
-//    }
-//
-//    // Create parser
-//    JsonParser parser;
-//    if (!JsonParser_Init(&parser, jsonCode, jsonCodeLength, allocator, flags))
-//    {
-//        const JsonResult result = { JsonError_InternalFatal, "Wrong behaviour when create new parser", 0 };
-//        return result;
-//    }
-//
-//    // Parse the top level
-//    Json* value = JsonState_ParseTopLevel(&parser);
-//    JSON_ASSERT(value, "value mustnot be null");
-//    *outValue = *value;
-//
-//    // Done!
-//    JsonResult result;
-//    result.error = parser.errnum;
-//    result.message = parser.errmsg;
-//    result.memoryUsage = (int32_t)(parser.allocator.lowerMarker - (uint8_t*)buffer);
-//    return result;
-//}
+    // The top level gets its final block up front, the parts write their items straight into it
+    const int64_t slotSize   = (flags & JsonParseFlags_KeySummary) ? (int64_t)sizeof(Json) : 0;
+    const int64_t itemSize   = job->isObject ? (int64_t)sizeof(JsonObjectMember) : (int64_t)sizeof(Json);
+    const int64_t itemsSize  = (slotSize + count * itemSize + (int64_t)mask) & ~(int64_t)mask;
+    const int64_t arenasSize = (int64_t)(jobStart - start) - itemsSize;
 
-/* @funcdef: JsonEquals */
-bool JsonEquals(const Json a, const Json b)
-{
-    if (a.type != b.type)
+    int32_t arenaCount = workers;
+    while (arenaCount > 1 && arenasSize / arenaCount < JSON_SPLIT_MIN_ARENA_SIZE)
     {
-        return false;
+        arenaCount--;
     }
+    if (arenasSize < JSON_SPLIT_MIN_ARENA_SIZE)
+    {
+        JsonMutex_Destroy(&job->mutex);
 
-    switch (a.type)
+        const JsonResult result = { JsonError_OutOfMemory, "Buffer is too small", 0, 0 };
+        *outValue = JSON_NULL;
+        return result;
+    }
+
+    const int64_t arenaSize = (arenasSize / arenaCount < INT32_MAX ? arenasSize / arenaCount : INT32_MAX) & ~(int64_t)mask;
+    for (int32_t i = 0; i < arenaCount; i++)
     {
-    case JsonType_Null:
-        return true;
+        JsonAllocator_Init(&job->allocators[i], start + itemsSize + arenaSize * i, (int32_t)arenaSize);
+    }
 
-    case JsonType_Number:
-        return a.number == b.number;
+    job->items = start + slotSize;
+    JsonSplitJob_RunPass(job, 2, arenaCount);
+    JsonMutex_Destroy(&job->mutex);
 
-    case JsonType_Boolean:
-        return a.boolean == b.boolean;
+    // Malformed input, or an arena too small for its parts: the serial parser gives the same result as JsonParse would
+    if (job->failed)
+    {
+        const JsonSplitPart* failedPart = job->parts;
+        while (failedPart->error == JsonError_None)
+        {
+            failedPart++;
+        }
 
-    case JsonType_Array: {
-        int32_t n;
-        if ((n = a.length) == a.length)
+        if (jsonCodeLength <= INT32_MAX)
         {
-            for (int32_t i = 0; i < n; i++)
-            {
-                if (!JsonEquals(a.array[i], b.array[i]))
-                {
-                    return false;
-                }
-            }
+            return JsonParseParallel_Serial(jsonCode, jsonCodeLength, flags, buffer, bufferSize, outValue);
         }
 
-        return true;
+        const JsonResult result = { failedPart->error, failedPart->message, 0, 0 };
+        *outValue = JSON_NULL;
+        return result;
+    }
+
+    bool     allNumbers = !job->isObject && (flags & JsonParseFlags_PackNumberArrays) && count > 0;
+    bool     allInt32   = allNumbers;
+    uint64_t summary    = 0;
+    for (int32_t i = 0; i < job->partCount; i++)
+    {
+        allNumbers = allNumbers && job->parts[i].allNumbers;
+        allInt32   = allInt32 && job->parts[i].allInt32;
+        summary   |= job->parts[i].summary;
     }
 
-    case JsonType_Object: {
-        int32_t n;
-        if ((n = a.length) == b.length)
+    outValue->type   = job->isObject ? JsonType_Object : JsonType_Array;
+    outValue->length = (int32_t)count;
+    outValue->array  = (Json*)job->items;
+
+    if (allNumbers)
+    {
+        // Packed numbers are smaller than the items they come from, so they are packed in place
+        if (allInt32)
         {
-            for (int32_t i = 0; i < n; i++)
+            for (int32_t i = 0; i < (int32_t)count; i++)
             {
-                if (strncmp(a.object[i].name, b.object[i].name, n) != 0)
-                {
-                    return false;
-                }
+                const int32_t number = (int32_t)JsonGetNumber(outValue->array[i]);
+                ((int32_t*)job->items)[i] = number;
+            }
 
-                if (!JsonEquals(a.object[i].value, b.object[i].value))
-                {
-                    return false;
-                }
+            outValue->type       = JsonType_Int32Array;
+            outValue->int32Array = (int32_t*)job->items;
+        }
+        else
+        {
+            for (int32_t i = 0; i < (int32_t)count; i++)
+            {
+                const double number = JsonGetNumber(outValue->array[i]);
+                ((double*)job->items)[i] = number;
             }
+
+            outValue->type        = JsonType_NumberArray;
+            outValue->numberArray = (double*)job->items;
         }
+    }
+    else if (slotSize > 0 && count > 0)
+    {
+        memset(start, 0, sizeof(Json));
+        *JsonKeySummary_Slot(job->items) = summary;
+    }
 
-        return true;
+    // Packing in place frees the tail of the items block
+    const int64_t packedSize  = allInt32 ? (int64_t)sizeof(int32_t) : (int64_t)sizeof(double);
+    int64_t       memoryUsage = allNumbers ? (slotSize + count * packedSize + (int64_t)mask) & ~(int64_t)mask : itemsSize;
+    for (int32_t i = 0; i < arenaCount; i++)
+    {
+        memoryUsage += job->allocators[i].lowerMarker - job->allocators[i].buffer;
     }
 
-    case JsonType_String:
-        return a.length == b.length && strncmp(a.string, b.string, a.length) == 0;
+    JsonResult result;
+    result.error             = JsonError_None;
+    result.message           = "Success!";
+    result.memoryUsage       = memoryUsage < INT32_MAX ? (int32_t)memoryUsage : INT32_MAX;
+    result.stringMemoryUsage = 0;
+    return result;
+}
 
-    default:
-        JSON_ASSERT(false, "invalid json type");
-        break;
+// -------------------------------------------------------------------
+// Parallel parsing: batches of files
+// -------------------------------------------------------------------
+
+#define JSON_FILES_MIN_ARENA_SIZE   (64 * 1024)
+#define JSON_FILES_SIZE_BATCH       64          /* Files measured per claim of the first pass */
+
+/* File of the batch, sorted largest first */
+typedef struct JsonFileEntry
+{
+    int64_t     size;           /* -1 when the file cannot be measured */
+    int32_t     index;          /* Position in the paths of the caller */
+} JsonFileEntry;
+
+/* Files of one worker: its share of the sorted entries, entry = worker + k * workerCount for k in [head, tail)
+   The owner takes from the head, the largest files, thieves take from the tail */
+typedef struct JsonFileQueue
+{
+    JsonMutex   mutex;
+    int32_t     head;
+    int32_t     tail;
+} JsonFileQueue;
+
+/* Shared state of JsonParseFiles */
+typedef struct JsonFilesJob
+{
+    const char* const*  paths;
+    int32_t             count;
+    JsonParseFlags      flags;
+    JsonFileHandler     handler;
+    void*               user;
+
+    JsonFileEntry*      entries;
+    uint8_t*            arenas;
+    int32_t             arenaSize;
+    int32_t             workerCount;
+    JsonFileQueue       queues[JSON_MAX_THREADS];
+
+    JsonMutex           mutex;
+    int32_t             pass;
+    int32_t             next;           /* Next entry to measure in the first pass */
+    bool                stopped;
+} JsonFilesJob;
+
+/* Size of a file in bytes, -1 when it cannot be found */
+static int64_t JsonFiles_Size(const char* path)
+{
+#if defined(_WIN32)
+    struct __stat64 info;
+    return _stat64(path, &info) == 0 ? (int64_t)info.st_size : -1;
+#else
+    struct stat info;
+    return stat(path, &info) == 0 ? (int64_t)info.st_size : -1;
+#endif
+}
+
+/* Largest files first, so the long parses start early and the short ones fill the tail */
+static int JsonFiles_CompareEntries(const void* a, const void* b)
+{
+    const JsonFileEntry* entryA = (const JsonFileEntry*)a;
+    const JsonFileEntry* entryB = (const JsonFileEntry*)b;
+    if (entryA->size != entryB->size)
+    {
+        return entryA->size < entryB->size ? 1 : -1;
     }
+    return entryA->index - entryB->index;
+}
 
-    return false;
+/* Take the next entry of a queue, from the head for its owner or from the tail for a thief, -1 when it is empty */
+static int32_t JsonFilesJob_Take(JsonFilesJob* job, int32_t queueIndex, bool steal)
+{
+    JsonFileQueue* queue = &job->queues[queueIndex];
+
+    int32_t k = -1;
+    JsonMutex_Lock(&queue->mutex);
+    if (queue->head < queue->tail)
+    {
+        k = steal ? --queue->tail : queue->head++;
+    }
+    JsonMutex_Unlock(&queue->mutex);
+
+    return k < 0 ? -1 : queueIndex + k * job->workerCount;
 }
 
-/* @funcdef: JsonFind */
-bool JsonFind(const Json parent, const char* name, Json* outResult)
+/* Read a file at the end of the arena and parse it into the rest of the arena, then hand it over */
+static bool JsonFilesJob_ParseFile(JsonFilesJob* job, const JsonFileEntry* entry, uint8_t* arena)
 {
-    JSON_ASSERT(outResult, "outResult mustnot be null");
-    JSON_ASSERT(JsonValidType(parent), "invalid json type");
-    JSON_ASSERT(name, "Attempt using nullptr as string");
+    Json       value  = JSON_NULL;
+    JsonResult result = { JsonError_None, "Success!", 0, 0 };
 
-    if (parent.type == JsonType_Object)
+    FILE* file = entry->size >= 0 ? fopen(job->paths[entry->index], "rb") : NULL;
+    if (!file)
     {
-        const int32_t nameLength = (int32_t)strlen(name);
-        for (int32_t i = 0, n = parent.length; i < n; i++)
+        result.error   = JsonError_FileUnreadable;
+        result.message = "Cannot open the file";
+    }
+    else if (entry->size > job->arenaSize - JSON_FILES_MIN_ARENA_SIZE / 2)
+    {
+        result.error   = JsonError_OutOfMemory;
+        result.message = "File is too large for the buffer of a worker";
+    }
+    else
+    {
+        char*        text   = (char*)arena + job->arenaSize - entry->size;
+        const size_t length = fread(text, 1, (size_t)entry->size, file);
+        if (length != (size_t)entry->size)
         {
-            const JsonObjectMember* member = &parent.object[i];
-            JSON_ASSERT(member && JsonValidType(member->value), "invalid json type");
-
-            if (strncmp(name, member->name, nameLength) == 0)
-            {
-                *outResult = member->value;
-                return true;
-            }
+            result.error   = JsonError_FileUnreadable;
+            result.message = "Cannot read the file";
+        }
+        else
+        {
+            result = JsonParse(text, (int32_t)length, job->flags, arena, (int32_t)(text - (char*)arena), &value);
         }
     }
 
-    *outResult = JSON_NULL;
-    return false;
+    if (file)
+    {
+        fclose(file);
+    }
+
+    if (!job->handler(job->user, entry->index, value, &result))
+    {
+        JsonMutex_Lock(&job->mutex);
+        job->stopped = true;
+        JsonMutex_Unlock(&job->mutex);
+        return false;
+    }
+    return true;
 }
 
-/* @funcdef: JsonFindWithType */
-JsonError JsonFindWithType(const Json parent, const char* name, JsonType type, Json* outResult)
+/* Worker of JsonParseFiles: measure the files, then parse its own queue and steal from the others when it runs dry */
+static void JsonFilesJob_Work(void* context, int32_t workerIndex)
 {
-    JSON_ASSERT(outResult, "outResult mustnot be null");
-    JSON_ASSERT(JsonValidType(parent), "invalid json type");
-    JSON_ASSERT(name, "Attempt using nullptr as string");
+    JsonFilesJob* job = (JsonFilesJob*)context;
 
-    if (parent.type == JsonType_Object)
+    if (job->pass == 0)
     {
-        const int32_t nameLength = (int32_t)strlen(name);
-        for (int32_t i = 0, n = parent.length; i < n; i++)
+        while (true)
         {
-            const JsonObjectMember* member = &parent.object[i];
-            JSON_ASSERT(member && JsonValidType(member->value), "invalid json type");
+            JsonMutex_Lock(&job->mutex);
+            const int32_t first = job->next;
+            job->next = first < job->count - JSON_FILES_SIZE_BATCH ? first + JSON_FILES_SIZE_BATCH : job->count;
+            const int32_t last = job->next;
+            JsonMutex_Unlock(&job->mutex);
 
-            if (strncmp(name, member->name, nameLength) == 0)
+            if (first >= last)
             {
-                *outResult = member->value;
-                return member->value.type == type ? JsonError_None : JsonError_WrongType;
+                return;
             }
+
+            for (int32_t i = first; i < last; i++)
+            {
+                job->entries[i].size  = JsonFiles_Size(job->paths[i]);
+                job->entries[i].index = i;
+            }
+        }
+    }
+
+    uint8_t* arena = job->arenas + (size_t)workerIndex * (size_t)job->arenaSize;
+    while (true)
+    {
+        JsonMutex_Lock(&job->mutex);
+        const bool stopped = job->stopped;
+        JsonMutex_Unlock(&job->mutex);
+        if (stopped)
+        {
+            return;
         }
 
+        int32_t entry = JsonFilesJob_Take(job, workerIndex, false);
+        for (int32_t i = 1; entry < 0 && i < job->workerCount; i++)
+        {
+            entry = JsonFilesJob_Take(job, (workerIndex + i) % job->workerCount, true);
+        }
 
-        *outResult = JSON_NULL;
-        return JsonError_MissingField;
+        if (entry < 0 || !JsonFilesJob_ParseFile(job, &job->entries[entry], arena))
+        {
+            return;
+        }
     }
+}
 
-    *outResult = JSON_NULL;
-    return JsonError_WrongType;
+/* @funcdef: JsonParseFiles */
+JsonError JsonParseFiles(const char* const* paths, int32_t count, JsonParseFlags flags, int32_t threadCount, JsonFileHandler handler, void* user, void* buffer, int64_t bufferSize)
+{
+    JSON_ASSERT(paths || count <= 0, "paths mustnot be null");
+    JSON_ASSERT(handler, "handler mustnot be null");
+
+    if (count <= 0)
+    {
+        return JsonError_None;
+    }
+
+    // The sorted entries go first in the buffer, then one arena per worker, each reused for all of its files
+    const uintptr_t mask         = sizeof(Json) - 1;
+    uint8_t*        start        = (uint8_t*)(((uintptr_t)buffer + mask) & ~mask);
+    const int64_t   entriesSize  = ((int64_t)count * (int64_t)sizeof(JsonFileEntry) + (int64_t)mask) & ~(int64_t)mask;
+    const int64_t   arenasSize   = buffer ? bufferSize - (int64_t)(start - (uint8_t*)buffer) - entriesSize : 0;
+
+    int32_t workers = JsonWorkers_Count(threadCount);
+    workers = workers < count ? workers : count;
+    while (workers > 1 && arenasSize / workers < JSON_FILES_MIN_ARENA_SIZE)
+    {
+        workers--;
+    }
+    if (arenasSize < JSON_FILES_MIN_ARENA_SIZE)
+    {
+        return JsonError_OutOfMemory;
+    }
+
+    JsonFilesJob job;
+    job.paths       = paths;
+    job.count       = count;
+    job.flags       = flags;
+    job.handler     = handler;
+    job.user        = user;
+    job.entries     = (JsonFileEntry*)start;
+    job.arenas      = start + entriesSize;
+    job.arenaSize   = (int32_t)((arenasSize / workers < INT32_MAX ? arenasSize / workers : INT32_MAX) & ~(int64_t)mask);
+    job.workerCount = workers;
+    job.stopped     = false;
+    JsonMutex_Init(&job.mutex);
+
+    // Measuring is I/O too, so the workers share it before the largest files are dealt first
+    job.pass = 0;
+    job.next = 0;
+    JsonWorkers_Run(workers, JsonFilesJob_Work, &job);
+    qsort(job.entries, (size_t)count, sizeof(JsonFileEntry), JsonFiles_CompareEntries);
+
+    for (int32_t i = 0; i < workers; i++)
+    {
+        JsonMutex_Init(&job.queues[i].mutex);
+        job.queues[i].head = 0;
+        job.queues[i].tail = (count - i + workers - 1) / workers;
+    }
+
+    job.pass = 1;
+    JsonWorkers_Run(workers, JsonFilesJob_Work, &job);
+
+    for (int32_t i = 0; i < workers; i++)
+    {
+        JsonMutex_Destroy(&job.queues[i].mutex);
+    }
+    JsonMutex_Destroy(&job.mutex);
+
+    return job.stopped ? JsonError_InvalidValue : JsonError_None;
 }
 
 // -------------------------------------------------------------------
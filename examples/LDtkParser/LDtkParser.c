@@ -294,8 +294,28 @@ static LDtkError LDtkReadEnums(const Json jsonDefs, Allocator* allocator, LDtkWo
     return error;
 }
 
+#define LDTK_TILESET_FIELDS(FIELD)                                          \
+    FIELD(LDtkTileset, id,          "uid",                  Int32,  true)   \
+    FIELD(LDtkTileset, name,        "identifier",           String, true)   \
+    FIELD(LDtkTileset, path,        "relPath",              String, false)  \
+    FIELD(LDtkTileset, width,       "pxWid",                Int32,  true)   \
+    FIELD(LDtkTileset, height,      "pxHei",                Int32,  true)   \
+    FIELD(LDtkTileset, tileSize,    "tileGridSize",         Int32,  true)   \
+    FIELD(LDtkTileset, spacing,     "spacing",              Int32,  true)   \
+    FIELD(LDtkTileset, padding,     "padding",              Int32,  true)   \
+    FIELD(LDtkTileset, tagsEnumId,  "tagsSourceEnumUid",    Int32,  false)
+
+static const JsonFieldDesc  LDtkTilesetFields[] = { LDTK_TILESET_FIELDS(JSON_FIELD) };
+static JsonStructDesc       LDtkTilesetDesc     = JSON_STRUCT_DESC(LDtkTileset, LDtkTilesetFields);
+
 static LDtkError LDtkReadTilesets(const Json jsonDefs, Allocator* allocator, LDtkWorld* world)
 {
+    if (LDtkTilesetDesc.shift == 0 && JsonStructDescInit(&LDtkTilesetDesc) != JsonError_None)
+    {
+        const LDtkError error = { LDtkErrorCode_InternalError, "Invalid tileset binding" };
+        return error;
+    }
+
     const Json jsonTilesets;
     if (!JsonFind(jsonDefs, "tilesets", (Json*)&jsonTilesets))
     {
@@ -308,49 +328,12 @@ static LDtkError LDtkReadTilesets(const Json jsonDefs, Allocator* allocator, LDt
     for (int32_t i = 0; i < tilesetCount; i++)
     {
         LDtkTileset* tileset = &tilesets[i];
-        const Json jsonTileset = jsonTilesets.array[i];
-
-        const Json jsonUid;
-        JsonFind(jsonTileset, "uid", (Json*)&jsonUid);
-        tileset->id = (int32_t)jsonUid.number;
 		tileset->index = i;
 
-        const Json jsonIdentifier;
-        JsonFind(jsonTileset, "identifier", (Json*)&jsonIdentifier);
-        tileset->name = jsonIdentifier.string;
-
-        const Json jsonRelPath;
-        JsonFind(jsonTileset, "relPath", (Json*)&jsonRelPath);
-        tileset->path = jsonRelPath.string;
-
-        const Json jsonPxWid;
-        JsonFind(jsonTileset, "pxWid", (Json*)&jsonPxWid);
-        tileset->width = (int32_t)jsonPxWid.number;
-
-        const Json jsonPxHei;
-        JsonFind(jsonTileset, "pxHei", (Json*)&jsonPxHei);
-        tileset->height = (int32_t)jsonPxHei.number;
-
-        const Json jsonTileGridSize;
-        JsonFind(jsonTileset, "tileGridSize", (Json*)&jsonTileGridSize);
-        tileset->tileSize = (int32_t)jsonTileGridSize.number;
-
-        const Json jsonSpacing;
-        JsonFind(jsonTileset, "spacing", (Json*)&jsonSpacing);
-        tileset->spacing = (int32_t)jsonSpacing.number;
-
-        const Json jsonPadding;
-        JsonFind(jsonTileset, "padding", (Json*)&jsonPadding);
-        tileset->padding = (int32_t)jsonPadding.number;
-
-        const Json jsonTagsSourceEnumUid;
-        if (JsonFind(jsonTileset, "tagsSourceEnumUid", (Json*)&jsonTagsSourceEnumUid))
+        if (JsonDecodeStruct(jsonTilesets.array[i], &LDtkTilesetDesc, tileset) != JsonError_None)
         {
-            tileset->tagsEnumId = (int32_t)jsonTagsSourceEnumUid.number;
-        }
-        else
-        {
-            tileset->tagsEnumId = 0;
+            const LDtkError error = { LDtkErrorCode_InvalidWorldProperties, "'defs.tilesets' has missing or invalid properties" };
+            return error;
         }
     }
 
@@ -764,22 +747,17 @@ static LDtkError LDtkReadLayer(const Json json, Allocator* allocator, LDtkLevel*
 		    int32_t tileId = (int32_t)jsonTileId.number;
 
 		    Json jsonD;
-		    if (JsonFindWithType(jsonTile, "d", JsonType_Array, &jsonD) != JsonError_None)
-		    {
-			    const LDtkError error = { LDtkErrorCode_UnnameError, "" };
-			    return error;
-		    }
-
-		    Json jsonCoordId = jsonD.array[coordIdIndex];
-		    if (jsonCoordId.type != JsonType_Number)
+		    int32_t d[2];
+		    if (!JsonFind(jsonTile, "d", &jsonD) || JsonArrayToInt32(jsonD, d, coordIdIndex + 1) != JsonError_None)
 		    {
 			    const LDtkError error = { LDtkErrorCode_UnnameError, "" };
 			    return error;
 		    }
-		    int32_t coordId = (int32_t)jsonCoordId.number;
+		    int32_t coordId = d[coordIdIndex];
 
 		    Json jsonPx;
-		    if (JsonFindWithType(jsonTile, "px", JsonType_Array, &jsonPx) != JsonError_None)
+		    int32_t px[2];
+		    if (!JsonFind(jsonTile, "px", &jsonPx) || JsonArrayToInt32(jsonPx, px, 2) != JsonError_None)
 		    {
 			    const LDtkError error = { LDtkErrorCode_UnnameError, "" };
 			    return error;
@@ -787,34 +765,21 @@ static LDtkError LDtkReadLayer(const Json json, Allocator* allocator, LDtkLevel*
 
             // Parse fields to create LDtkTile
 
-		    Json jsonX = jsonPx.array[0];
-		    Json jsonY = jsonPx.array[1];
-		    if (jsonX.type != JsonType_Number || jsonY.type != JsonType_Number)
-		    {
-			    const LDtkError error = { LDtkErrorCode_UnnameError, "" };
-			    return error;
-		    }
-		    int32_t x = (int32_t)jsonX.number;
-		    int32_t y = (int32_t)jsonY.number;
+		    int32_t x = px[0];
+		    int32_t y = px[1];
 		    int32_t worldX = level->worldX + x;
 		    int32_t worldY = level->worldY + y;
 
 		    Json jsonSrc;
-		    if (JsonFindWithType(jsonTile, "src", JsonType_Array, &jsonSrc) != JsonError_None)
+		    int32_t src[2];
+		    if (!JsonFind(jsonTile, "src", &jsonSrc) || JsonArrayToInt32(jsonSrc, src, 2) != JsonError_None)
 		    {
 			    const LDtkError error = { LDtkErrorCode_UnnameError, "" };
 			    return error;
 		    }
 
-		    Json jsonTextureX = jsonSrc.array[0];
-		    Json jsonTextureY = jsonSrc.array[1];
-		    if (jsonTextureX.type != JsonType_Number || jsonTextureY.type != JsonType_Number)
-		    {
-			    const LDtkError error = { LDtkErrorCode_UnnameError, "" };
-			    return error;
-		    }
-		    int32_t textureX = (int32_t)jsonTextureX.number;
-		    int32_t textureY = (int32_t)jsonTextureY.number;
+		    int32_t textureX = src[0];
+		    int32_t textureY = src[1];
 
 		    Json jsonF;
 		    if (JsonFindWithType(jsonTile, "f", JsonType_Number, &jsonF) != JsonError_None)
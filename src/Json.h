@@ -17,6 +17,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 
 // -------------------------------------------------------------------
@@ -32,6 +33,10 @@ typedef enum JsonType
     JsonType_Number,
     JsonType_String,
     JsonType_Boolean,
+
+    /* Array subtypes, homogeneous number arrays packed by JsonParseFlags_PackNumberArrays */
+    JsonType_Int32Array,
+    JsonType_NumberArray,
 } JsonType;
 
 /// JSON error code
@@ -56,6 +61,7 @@ typedef enum JsonError
     JsonError_OutOfMemory,
     JsonError_InvalidValue,
     JsonError_InternalFatal,
+    JsonError_FileUnreadable,
 
 } JsonError;
 
@@ -67,29 +73,199 @@ typedef struct JsonResult
 
     //JsonParser*     parser;
     int32_t         memoryUsage;
+    int32_t         stringMemoryUsage;  // Bytes used in the string buffer, 0 when strings share the main buffer
 } JsonResult;
 
 /// Json parse flags
 typedef enum JsonParseFlags
 {
     JsonParseFlags_None             = 0,
-    JsonParseFlags_SupportComment   = 1 << 0,
+    JsonParseFlags_SupportComment   = 1 << 0,   // Allow // and /* */ comments wherever whitespace is allowed
     JsonParseFlags_NoStrictTopLevel = 1 << 1,
+    JsonParseFlags_PackNumberArrays = 1 << 2,   // Store all-number arrays as int32_t[] or double[] instead of Json[], with LazyNumbers only arrays of int32 integer literals
+    JsonParseFlags_LazyNumbers      = 1 << 3,   // Keep numbers as raw text of the source, read them with JsonGetNumber/JsonGetInt64, PackNumberArrays never drops that text
+    JsonParseFlags_LazyStrings      = 1 << 4,   // Keep string values as slices of the source, read them with JsonCopyString
+    JsonParseFlags_KeySummary       = 1 << 5,   // Keep a bloom filter of the keys of each object/array subtree, used by JsonFindAll
+    JsonParseFlags_UnorderedLines   = 1 << 6,   // JsonParseLines hands records over as soon as they are parsed, from several threads at once
 
     JsonParseFlags_Default          = JsonParseFlags_None,
 } JsonParseFlags;
 
+/// Typed column for JsonExtractColumns
+typedef enum JsonColumnType
+{
+    JsonColumnType_Int32,       // int32_t, numbers that are not an exact int32_t do not match
+    JsonColumnType_Float,       // float
+    JsonColumnType_Double,      // double
+    JsonColumnType_Boolean,     // bool
+    JsonColumnType_String,      // const char*, never NULL for a present empty string, non-empty lazy strings do not match (use Value and JsonCopyString)
+    JsonColumnType_Value,       // Json
+    JsonColumnType_Struct,      // Nested struct of a JsonFieldDesc, struct bindings only
+} JsonColumnType;
+
+/// Field to extract from each object of an array
+typedef struct JsonColumnSpec
+{
+    const char*     name;
+    JsonColumnType  type;
+} JsonColumnSpec;
+
+/// Output of one field: contiguous values, plus a bitmap with bit i set when row i has the field with a matching type
+typedef struct JsonColumn
+{
+    void*           values;     // Row count elements of the column type, missing rows are zeroed, can be NULL
+    uint8_t*        presence;   // (rowCount + 7) / 8 bytes, can be NULL
+} JsonColumn;
+
+#define JSON_MAX_COLUMNS 64
+
+#define JSON_STRUCT_MAX_FIELDS      32
+#define JSON_STRUCT_TABLE_SIZE      128
+
+typedef struct JsonStructDesc JsonStructDesc;
+
+/// Field of a struct binding, usually declared with JSON_FIELD
+typedef struct JsonFieldDesc
+{
+    const char*     name;       // JSON key
+    JsonColumnType  type;       // C type of the field (of the elements for arrays), same set as columns
+    int32_t         offset;     // offsetof the field in the struct, a pointer to the elements for arrays
+    bool            required;   // Decoding fails with JsonError_MissingField when the key is absent
+    int32_t         countOffset;// offsetof the int32_t element count of an array field, -1 for single values
+    JsonStructDesc* desc;       // Binding of JsonColumnType_Struct fields
+} JsonFieldDesc;
+
+/// Struct binding: fields plus a perfect hash of their keys built by JsonStructDescInit
+struct JsonStructDesc
+{
+    const JsonFieldDesc*    fields;
+    int32_t                 fieldCount;
+    int32_t                 size;                           // sizeof the struct, for arrays of it
+
+    uint32_t                seed;
+    int32_t                 shift;                          // 0 until JsonStructDescInit succeeded
+    int8_t                  table[JSON_STRUCT_TABLE_SIZE];  // Field index of each hash slot, -1 when empty
+};
+
+/// X-macro entry: #define MY_FIELDS(FIELD) FIELD(MyStruct, member, "key", Int32, true) ..., then { MY_FIELDS(JSON_FIELD) }
+#define JSON_FIELD(STRUCT, MEMBER, KEY, TYPE, REQUIRED) \
+    { KEY, JsonColumnType_##TYPE, (int32_t)offsetof(STRUCT, MEMBER), REQUIRED, -1, NULL },
+
+/// Nested struct, DESC is the JsonStructDesc of the member type
+#define JSON_FIELD_STRUCT(STRUCT, MEMBER, KEY, DESC, REQUIRED) \
+    { KEY, JsonColumnType_Struct, (int32_t)offsetof(STRUCT, MEMBER), REQUIRED, -1, &(DESC) },
+
+/// Array of TYPE, MEMBER points to the elements and COUNT is their int32_t count (decoded by JsonParseStruct only)
+#define JSON_FIELD_ARRAY(STRUCT, MEMBER, COUNT, KEY, TYPE, REQUIRED) \
+    { KEY, JsonColumnType_##TYPE, (int32_t)offsetof(STRUCT, MEMBER), REQUIRED, (int32_t)offsetof(STRUCT, COUNT), NULL },
+
+/// Array of structs described by DESC (decoded by JsonParseStruct only, not encoded)
+#define JSON_FIELD_STRUCT_ARRAY(STRUCT, MEMBER, COUNT, KEY, DESC, REQUIRED) \
+    { KEY, JsonColumnType_Struct, (int32_t)offsetof(STRUCT, MEMBER), REQUIRED, (int32_t)offsetof(STRUCT, COUNT), &(DESC) },
+
+/// Initializer of a JsonStructDesc from a JsonFieldDesc array
+#define JSON_STRUCT_DESC(STRUCT, FIELDS) { FIELDS, (int32_t)(sizeof(FIELDS) / sizeof((FIELDS)[0])), (int32_t)sizeof(STRUCT), 0, 0, { 0 } }
+
+#ifndef JSON_EVENTS_MAX_DEPTH
+#define JSON_EVENTS_MAX_DEPTH       1024    // Nesting levels of JsonParseEvents, one bit each on the stack
+#endif
+
+#ifndef JSON_VALIDATE_MAX_DEPTH
+#define JSON_VALIDATE_MAX_DEPTH     1024    // Nesting levels of JsonValidate, one bit each on the stack
+#endif
+
+#ifndef JSON_SKIP_MAX_DEPTH
+#define JSON_SKIP_MAX_DEPTH         1024    // Nesting levels of subtrees skipped by JsonParseProjected and JsonParseStruct, one bit each on the stack
+#endif
+
+#ifndef JSON_MAX_THREADS
+#define JSON_MAX_THREADS            64      // Workers of the parallel parsers, the calling thread included
+#endif
+
+#define JSON_PATH_MAX_DEPTH         16
+#define JSON_PATH_MAX_NAMES         128     // Bytes of all keys of one path
+#define JSON_PROJECTION_MAX_PATHS   16
+
+#define JSON_PATH_KEY               -1      // JsonPathSegment.index of a member key
+#define JSON_PATH_ANY               -2      // JsonPathSegment.index of `*` and `[*]`, matches any member or element
+
+/// One step of a path: a member key or an array index
+typedef struct JsonPathSegment
+{
+    int32_t         index;      // Array index, JSON_PATH_KEY or JSON_PATH_ANY
+    int32_t         keyOffset;  // Member key in JsonPath.names, JSON Pointer index tokens keep their key too
+    int32_t         keyLength;
+} JsonPathSegment;
+
+/// Compiled path, self-contained so it can be copied and reused
+typedef struct JsonPath
+{
+    int32_t         count;
+    int32_t         namesLength;
+    JsonPathSegment segments[JSON_PATH_MAX_DEPTH];
+    char            names[JSON_PATH_MAX_NAMES];
+} JsonPath;
+
+/// Set of paths for JsonParseProjected
+typedef struct JsonProjection
+{
+    int32_t         count;
+    JsonPath        paths[JSON_PROJECTION_MAX_PATHS];
+} JsonProjection;
+
+#define JSON_QUERY_MAX_FILTERS      4
+#define JSON_QUERY_MAX_FILTER_KEYS  4
+
+#define JSON_PATH_FILTER            -3      // JsonPathSegment.index of `[?(...)]` in a query, keyOffset is the filter index
+
+/// Comparison of a query filter
+typedef enum JsonQueryOp
+{
+    JsonQueryOp_Exists,         // [?(@.field)]
+    JsonQueryOp_Equal,
+    JsonQueryOp_NotEqual,
+    JsonQueryOp_Less,
+    JsonQueryOp_LessEqual,
+    JsonQueryOp_Greater,
+    JsonQueryOp_GreaterEqual,
+} JsonQueryOp;
+
+/// Compiled `[?(@.a.b op literal)]`, ordering ops only take number literals
+typedef struct JsonQueryFilter
+{
+    JsonQueryOp     op;
+    int32_t         keyCount;                               // Member keys from the element, 0 tests the element itself
+    int32_t         keyOffsets[JSON_QUERY_MAX_FILTER_KEYS]; // In JsonQuery.path.names
+    int32_t         keyLengths[JSON_QUERY_MAX_FILTER_KEYS];
+
+    JsonType        literalType;                            // Number, String, Boolean or Null
+    double          literalNumber;
+    bool            literalBoolean;
+    int32_t         literalOffset;                          // String literal in JsonQuery.path.names
+    int32_t         literalLength;
+} JsonQueryFilter;
+
+/// Compiled query plan for JsonQueryRun
+typedef struct JsonQuery
+{
+    JsonPath        path;
+    int32_t         filterCount;
+    JsonQueryFilter filters[JSON_QUERY_MAX_FILTERS];
+} JsonQuery;
+
 typedef struct Json             Json;
 //typedef struct JsonParser       JsonParser;
 typedef struct JsonObjectMember JsonObjectMember;
+typedef struct JsonHandler      JsonHandler;
 
 struct Json
 {
     JsonType                type;       // Type of value: number, boolean, string, array, object
-    int32_t                 length;     // Length of value, always 1 on primitive types, UTF8 string length
+    int32_t                 length;     // Length of value, 0 on null, boolean and decoded numbers, UTF8 string length in bytes (negative raw length for escaped lazy strings), negative raw text length of lazy numbers
     union
     {
         double              number;
+        const char*         rawNumber;      // JsonType_Number with length < 0, slice of the source, not null-terminated
         bool                boolean;
 
         const char*         string;
@@ -97,6 +273,9 @@ struct Json
         Json*               array;
 
         JsonObjectMember*   object;
+
+        const int32_t*      int32Array;     // JsonType_Int32Array
+        const double*       numberArray;    // JsonType_NumberArray
     };
 };
 
@@ -106,6 +285,32 @@ struct JsonObjectMember
     Json                    value;
 };
 
+/// Events of JsonParseEvents, any callback can be NULL, return false to stop parsing
+/// Keys and strings are lazy strings (see JsonParseFlags_LazyStrings), numbers follow JsonParseFlags_LazyNumbers
+struct JsonHandler
+{
+    bool (*onStartObject)(void* user);
+    bool (*onEndObject)(void* user);
+    bool (*onStartArray)(void* user);
+    bool (*onEndArray)(void* user);
+
+    bool (*onKey)(void* user, const Json name);
+    bool (*onString)(void* user, const Json value);
+    bool (*onNumber)(void* user, const Json value);
+    bool (*onBoolean)(void* user, bool value);
+    bool (*onNull)(void* user);
+};
+
+/// Receives the records of JsonParseLines, offset is where the line starts in the input
+/// result->error tells whether the line parsed, the value and the message are valid until the callback returns
+/// Return false to stop
+typedef bool (*JsonLineHandler)(void* user, int64_t offset, const Json value, const JsonResult* result);
+
+/// Receives the documents of JsonParseFiles, index is the position of the file in paths
+/// Called from the worker threads, several at once. The value and the message are valid until the callback returns
+/// Return false to stop
+typedef bool (*JsonFileHandler)(void* user, int32_t index, const Json value, const JsonResult* result);
+
 // -------------------------------------------------------------------
 // Constants
 // -------------------------------------------------------------------
@@ -114,9 +319,24 @@ struct JsonObjectMember
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 #endif
 
-JSON_CONST Json JSON_NULL     = { JsonType_Null   , 0             };
-JSON_CONST Json JSON_TRUE     = { JsonType_Boolean, 0, { true  }  };
-JSON_CONST Json JSON_FALSE    = { JsonType_Boolean, 0, { false }  };
+// The union starts with number, so booleans need a designated initializer
+#if !defined(__cplusplus) || __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+JSON_CONST Json JSON_NULL     = { JsonType_Null   , 0                       };
+JSON_CONST Json JSON_TRUE     = { JsonType_Boolean, 0, { .boolean = true  } };
+JSON_CONST Json JSON_FALSE    = { JsonType_Boolean, 0, { .boolean = false } };
+#else
+// C++ before C++20 has none, and cannot switch the union member in a constant expression
+static inline Json JsonMakeBoolean(bool value)
+{
+    Json result = { JsonType_Boolean, 0 };
+    result.boolean = value;
+    return result;
+}
+
+JSON_CONST Json JSON_NULL     = { JsonType_Null   , 0 };
+static const Json JSON_TRUE   = JsonMakeBoolean(true);
+static const Json JSON_FALSE  = JsonMakeBoolean(false);
+#endif
 
 #if defined(__GNUC__)
 #pragma GCC diagnostic warning "-Wmissing-field-initializers"
@@ -127,16 +347,159 @@ JSON_CONST Json JSON_FALSE    = { JsonType_Boolean, 0, { false }  };
 // -------------------------------------------------------------------
 
 JSON_API JsonResult JsonParse(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, void* buffer, int32_t bufferSize, Json* outValue);
+
+/// Parse with strings byte-packed into stringBuffer, so buffer only holds the nodes
+JSON_API JsonResult JsonParseWithStringBuffer(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, void* buffer, int32_t bufferSize, void* stringBuffer, int32_t stringBufferSize, Json* outValue);
 //JSON_API JsonResult JsonContinueParse(JsonParser* parser, Json* outValue);
 
+/// Compile a dotted path like `defs.layers[3].gridSize` (optional `$.` root, `*` and `[*]` wildcards for projections)
+JSON_API JsonError  JsonPathCompile(const char* path, JsonPath* outPath);
+
+/// Compile an RFC 6901 JSON Pointer like `/defs/layers/3/gridSize`, with `~0` and `~1` escapes
+JSON_API JsonError  JsonPointerCompile(const char* pointer, JsonPath* outPath);
+
+/// Follow a compiled path from root, JsonError_MissingField when a step does not exist
+/// Wildcards are not resolved (JsonError_InvalidValue), use a projection or a query for them
+JSON_API JsonError  JsonPathResolve(const Json root, const JsonPath* path, Json* outResult);
+
+/// Build the key dispatch of a struct binding and of its nested bindings, JsonError_InvalidValue on duplicated keys or too many fields
+JSON_API JsonError  JsonStructDescInit(JsonStructDesc* desc);
+
+/// Decode an object in one pass over its members, fields without their key are zeroed, other struct memory is untouched
+/// JsonError_WrongType when a key holds another type (null is missing for optional fields), JsonError_MissingField for absent required keys
+/// Array fields need an arena, they are cleared with JsonError_InvalidValue here, use JsonParseStruct
+JSON_API JsonError  JsonDecodeStruct(const Json object, const JsonStructDesc* desc, void* outStruct);
+
+/// Object of the fields of value, members gets one entry per field and strings reference the struct
+/// Nested structs are objects whose members follow the ones of their parent in members
+/// Int32, Double and Value array fields are views over their elements, other array fields fail with JsonError_InvalidValue unless NULL (null)
+JSON_API JsonError  JsonEncodeStruct(const void* value, const JsonStructDesc* desc, JsonObjectMember* members, int32_t memberCapacity, Json* outObject);
+
+/// Parse an object straight into outStruct without building Json nodes, only decoded strings, arrays and Value fields go to buffer
+/// Unknown keys are skipped like unselected subtrees of JsonParseProjected, type errors stop parsing with JsonError_WrongType
+/// Missing and null optional fields are zeroed, so a NULL string is absent and an empty one is ""
+JSON_API JsonResult JsonParseStruct(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonStructDesc* desc, void* buffer, int32_t bufferSize, void* outStruct);
+
+/// Compile a JSONPath subset: `$`, `.key`, `['key']`, `[n]`, `*`, `[*]` and filters `[?(@.a.b op literal)]`
+/// op is one of == != < <= > >= (or none to test existence), literal is a number, 'string', true, false or null
+JSON_API JsonError  JsonQueryCompile(const char* query, JsonQuery* outQuery);
+
+/// Run a compiled query from root, writes at most maxResults matches in document order, returns the total match count
+JSON_API int32_t    JsonQueryRun(const JsonQuery* query, const Json root, Json* outResults, int32_t maxResults);
+
+/// Compile dotted paths like `defs.tilesets[*].uid`, `levels[0]` or `*` into a projection
+JSON_API JsonError  JsonProjectionCompile(const char* const* paths, int32_t pathCount, JsonProjection* outProjection);
+
+/// Parse only the subtrees selected by the projection, everything else is skipped without allocation
+/// Skipped subtrees are only checked for matching brackets (up to JSON_SKIP_MAX_DEPTH levels) and quotes, unselected array elements before a selected index are null
+JSON_API JsonResult JsonParseProjected(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonProjection* projection, void* buffer, int32_t bufferSize, Json* outValue);
+
+/// Parse without building a DOM, emitting events straight from the tokenizer (constant memory, no buffer)
+/// Nesting deeper than JSON_EVENTS_MAX_DEPTH fails with JsonError_OutOfMemory
+/// The message lives in thread local storage, it is valid until the next JsonParseEvents call on the same thread (any thread with JSON_NO_THREADS)
+JSON_API JsonResult JsonParseEvents(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonHandler* handler, void* user);
+
+/// Check grammar and UTF-8 of strings without allocating, up to JSON_VALIDATE_MAX_DEPTH levels of nesting
+/// Stricter than JsonParse: strict RFC 8259 plus UTF-8, so raw control characters in strings, malformed UTF-8 and a NUL after the value fail here only
+/// outErrorOffset (can be NULL) receives the byte offset of the first error
+JSON_API JsonError  JsonValidate(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, int32_t* outErrorOffset);
+
+/// Name of the scanning kernels picked for the running CPU: "scalar", "sse4.2", "avx2" or "avx512"
+/// The JSON_FORCE_KERNEL environment variable picks one of them instead, when the CPU supports it
+JSON_API const char* JsonKernelName(void);
+
+/// Parse newline-delimited JSON (NDJSON, JSON Lines) on threadCount threads, the calling thread included (0 for one per CPU)
+/// buffer is split into one arena per thread (at most 2 GB each), each arena must hold the largest record. Blank lines are skipped
+/// Records reach handler in input order, one at a time, unless JsonParseFlags_UnorderedLines is given
+/// Returns JsonError_InvalidValue when handler stopped the parsing, JsonError_OutOfMemory when buffer is too small to be split
+JSON_API JsonError  JsonParseLines(const char* input, int64_t inputLength, JsonParseFlags flags, int32_t threadCount, JsonLineHandler handler, void* user, void* buffer, int64_t bufferSize);
+
+/// Parse one large document whose top level is an array or object on threadCount threads, the calling thread included (0 for one per CPU)
+/// The top level items are split between the threads, each parses into its own slice of buffer, so the document may be larger than 2 GB
+/// Small documents, documents with comments and other top level values are parsed by JsonParse. memoryUsage stops at INT32_MAX
+JSON_API JsonResult JsonParseParallel(const char* jsonCode, int64_t jsonCodeLength, JsonParseFlags flags, int32_t threadCount, void* buffer, int64_t bufferSize, Json* outValue);
+
+/// Read and parse many files on threadCount threads, the calling thread included (0 for one per CPU), largest files first
+/// buffer holds the file list and one arena per thread, reused for each of its files. Workers that run out of files take some from the others
+/// Every file reaches handler, unreadable ones with JsonError_FileUnreadable. Returns JsonError_InvalidValue when handler stopped the parsing
+JSON_API JsonError  JsonParseFiles(const char* const* paths, int32_t count, JsonParseFlags flags, int32_t threadCount, JsonFileHandler handler, void* user, void* buffer, int64_t bufferSize);
+
 JSON_API bool       JsonEquals(const Json a, const Json b);
 
 JSON_API bool       JsonFind(const Json parent, const char* name, Json* outResult);
 JSON_API JsonError  JsonFindWithType(const Json parent, const char* name, JsonType type, Json* outResult);
 
+/// Values of every member named name at any depth (`$..name`) in document order, returns the total count
+/// Pass the flags root was parsed with, subtrees are pruned by their key summary with JsonParseFlags_KeySummary
+JSON_API int32_t    JsonFindAll(const Json root, const char* name, JsonParseFlags flags, Json* outResults, int32_t maxResults);
+
+/// Convert the first count elements of a number array (any subtype) into outValues
+/// JsonError_WrongType when an element is not a number, JsonError_MissingField when the array is shorter than count
+/// JsonError_InvalidValue when count is negative, nothing is written then
+/// JsonArrayToInt32 gives JsonError_InvalidValue when an element is not an exact int32_t, outValues is then filled up to that element
+JSON_API JsonError  JsonArrayToInt32(const Json array, int32_t* outValues, int32_t count);
+JSON_API JsonError  JsonArrayToFloat(const Json array, float* outValues, int32_t count);
+JSON_API JsonError  JsonArrayToDouble(const Json array, double* outValues, int32_t count);
+
+/// Walk an array of objects once, writing each field of specs into its own column (structure-of-arrays)
+/// JsonError_InvalidValue for more than JSON_MAX_COLUMNS specs or a JsonColumnType_Struct spec
+JSON_API JsonError  JsonExtractColumns(const Json array, const JsonColumnSpec* specs, int32_t specCount, JsonColumn* columns);
+
 static inline bool JsonValidType(const Json json)
 {
-    return json.type >= JsonType_Null && json.type <= JsonType_Boolean;
+    return json.type >= JsonType_Null && json.type <= JsonType_NumberArray;
+}
+
+/// Number value, lazy numbers (length < 0) are converted from their raw text on each call, any other length reads .number
+JSON_API double     JsonGetNumber(const Json value);
+
+/// Integer value, exact for integer text of lazy numbers, false when the number is not an int64
+JSON_API bool       JsonGetInt64(const Json value, int64_t* outResult);
+
+/// Decoded, null-terminated copy of a string, returns the full decoded length (like snprintf)
+/// Lazy strings are not null-terminated (length >= 0) or still hold their escapes (length < 0, -length raw bytes)
+JSON_API int32_t    JsonCopyString(const Json value, char* buffer, int32_t bufferSize);
+
+/// Any array subtype: Json[], int32_t[] or double[]
+static inline bool JsonIsArray(const Json json)
+{
+    return json.type == JsonType_Array || json.type == JsonType_Int32Array || json.type == JsonType_NumberArray;
+}
+
+/// Number element of any array subtype, 0 when the element is not a number
+static inline double JsonArrayGetNumber(const Json array, int32_t index)
+{
+    switch (array.type)
+    {
+    case JsonType_Int32Array:
+        return array.int32Array[index];
+
+    case JsonType_NumberArray:
+        return array.numberArray[index];
+
+    case JsonType_Array:
+        return JsonGetNumber(array.array[index]);
+
+    default:
+        return 0;
+    }
+}
+
+/// Element of any array subtype, packed elements are returned as JsonType_Number values
+static inline Json JsonArrayGet(const Json array, int32_t index)
+{
+    if (array.type == JsonType_Array)
+    {
+        return array.array[index];
+    }
+
+    Json result = JSON_NULL;
+    if (array.type == JsonType_Int32Array || array.type == JsonType_NumberArray)
+    {
+        result.type   = JsonType_Number;
+        result.number = JsonArrayGetNumber(array, index);
+    }
+    return result;
 }
 
 /* END OF EXTERN "C" */
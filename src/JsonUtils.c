@@ -2,143 +2,1408 @@
 #include "JsonUtils.h"
 #endif // __JSON_UTILS_H__
 
-/* @funcdef: Json_write */
-void JsonWrite(const Json value, FILE* out)
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef JSON_ASSERT
+#define JSON_ASSERT(cond, msg, ...) assert((cond) && (msg))
+#endif
+
+/* Record the first error of a writer */
+static void JsonWriter_SetError(JsonWriter* writer, JsonError error)
+{
+    if (writer->error == JsonError_None)
+    {
+        writer->error = error;
+    }
+}
+
+/* Hand the buffered output to the sink */
+static bool JsonWriter_Flush(JsonWriter* writer)
+{
+    if (writer->stopped)
+    {
+        return false;
+    }
+
+    if (writer->used > 0 && !writer->sink(writer->user, writer->buffer, writer->used))
+    {
+        writer->stopped = true;
+        JsonWriter_SetError(writer, JsonError_InvalidValue);
+    }
+
+    writer->used = 0;
+    return !writer->stopped;
+}
+
+/* Make room for at least required bytes, fixed buffers drop the rest of the output */
+static bool JsonWriter_MakeRoom(JsonWriter* writer, int32_t required)
+{
+    if (writer->sink)
+    {
+        return JsonWriter_Flush(writer);
+    }
+
+    // Capacities are doubled up to INT32_MAX - 1, which leaves room for the null terminator
+    if (writer->grow && writer->capacity < INT32_MAX - 1)
+    {
+        int32_t capacity = writer->capacity <= 0 ? JSON_STRINGIFY_CHUNK_SIZE : writer->capacity >= INT32_MAX / 2 ? INT32_MAX - 1 : writer->capacity * 2;
+        while (capacity - writer->used < required && capacity < INT32_MAX - 1)
+        {
+            capacity = capacity >= INT32_MAX / 2 ? INT32_MAX - 1 : capacity * 2;
+        }
+
+        // One more byte for the null terminator
+        char* buffer = (char*)writer->grow(writer->user, writer->buffer, capacity + 1);
+        if (buffer)
+        {
+            writer->buffer   = buffer;
+            writer->capacity = capacity;
+            return true;
+        }
+    }
+
+    JsonWriter_SetError(writer, JsonError_OutOfMemory);
+    return false;
+}
+
+/* @funcdef: JsonWriter_Write */
+static void JsonWriter_Write(JsonWriter* writer, const char* data, int32_t length)
+{
+    writer->length += length;
+
+    while (length > 0)
+    {
+        int32_t room = writer->capacity - writer->used;
+        if (room == 0)
+        {
+            if (!JsonWriter_MakeRoom(writer, length))
+            {
+                return;
+            }
+            room = writer->capacity - writer->used;
+        }
+
+        const int32_t count = length < room ? length : room;
+        memcpy(writer->buffer + writer->used, data, (size_t)count);
+        writer->used += count;
+        data         += count;
+        length       -= count;
+    }
+}
+
+/* @funcdef: JsonWriter_WriteChar */
+static void JsonWriter_WriteChar(JsonWriter* writer, char c)
+{
+    if (writer->used < writer->capacity)
+    {
+        writer->buffer[writer->used++] = c;
+        writer->length++;
+    }
+    else
+    {
+        JsonWriter_Write(writer, &c, 1);
+    }
+}
+
+/* Check 8 bytes at once for quotes, backslashes and control characters, may report false positives past the first hit */
+static bool JsonWriter_NeedsEscape(uint64_t word)
+{
+    const uint64_t ones      = 0x0101010101010101ull;
+    const uint64_t highs     = 0x8080808080808080ull;
+    const uint64_t quote     = word ^ (ones * '"');
+    const uint64_t backslash = word ^ (ones * '\\');
+
+    return ((((word - ones * 0x20) & ~word) | ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash)) & highs) != 0;
+}
+
+/* Two characters escapes of control characters, the others are written as \u00XX */
+static const char JsonWriter_ShortEscapes[32] = {
+    0,   0,   0,   0,   0,   0,   0,   0,   'b', 't', 'n', 0,   'f', 'r', 0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+/* @funcdef: JsonWriter_WriteString */
+static void JsonWriter_WriteString(JsonWriter* writer, const char* string, int32_t length)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    JsonWriter_WriteChar(writer, '"');
+
+    const char* end = string + length;
+    const char* run = string;
+    const char* ptr = string;
+    while (ptr < end)
+    {
+        // Clean blocks are copied with the surrounding run
+        if (end - ptr >= 8)
+        {
+            uint64_t word;
+            memcpy(&word, ptr, sizeof(word));
+            if (!JsonWriter_NeedsEscape(word))
+            {
+                ptr += 8;
+                continue;
+            }
+        }
+
+        const uint8_t c = (uint8_t)*ptr;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            ptr++;
+            continue;
+        }
+
+        JsonWriter_Write(writer, run, (int32_t)(ptr - run));
+
+        char escape[6] = { '\\', (char)c, 'u', '0', '0', 0 };
+        if (c >= 0x20)
+        {
+            JsonWriter_Write(writer, escape, 2);
+        }
+        else if (JsonWriter_ShortEscapes[c])
+        {
+            escape[1] = JsonWriter_ShortEscapes[c];
+            JsonWriter_Write(writer, escape, 2);
+        }
+        else
+        {
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[4] = hexDigits[c >> 4];
+            escape[5] = hexDigits[c & 15];
+            JsonWriter_Write(writer, escape, 6);
+        }
+
+        run = ++ptr;
+    }
+
+    JsonWriter_Write(writer, run, (int32_t)(end - run));
+    JsonWriter_WriteChar(writer, '"');
+}
+
+// -----------------------------------------------------------------------
+// Number formatting, Grisu2 shortest round-trip digits
+// -----------------------------------------------------------------------
+
+/* Floating point number f * 2^e with a 64 bits significand */
+typedef struct JsonDiyFp
+{
+    uint64_t    f;
+    int32_t     e;
+} JsonDiyFp;
+
+/* Normalized powers of ten 10^-348, 10^-340, ..., 10^340 */
+static const JsonDiyFp JsonNumber_CachedPowers[] = {
+        { 0xfa8fd5a0081c0288ull, -1220 }, { 0xbaaee17fa23ebf76ull, -1193 }, { 0x8b16fb203055ac76ull, -1166 },
+        { 0xcf42894a5dce35eaull, -1140 }, { 0x9a6bb0aa55653b2dull, -1113 }, { 0xe61acf033d1a45dfull, -1087 },
+        { 0xab70fe17c79ac6caull, -1060 }, { 0xff77b1fcbebcdc4full, -1034 }, { 0xbe5691ef416bd60cull, -1007 },
+        { 0x8dd01fad907ffc3cull,  -980 }, { 0xd3515c2831559a83ull,  -954 }, { 0x9d71ac8fada6c9b5ull,  -927 },
+        { 0xea9c227723ee8bcbull,  -901 }, { 0xaecc49914078536dull,  -874 }, { 0x823c12795db6ce57ull,  -847 },
+        { 0xc21094364dfb5637ull,  -821 }, { 0x9096ea6f3848984full,  -794 }, { 0xd77485cb25823ac7ull,  -768 },
+        { 0xa086cfcd97bf97f4ull,  -741 }, { 0xef340a98172aace5ull,  -715 }, { 0xb23867fb2a35b28eull,  -688 },
+        { 0x84c8d4dfd2c63f3bull,  -661 }, { 0xc5dd44271ad3cdbaull,  -635 }, { 0x936b9fcebb25c996ull,  -608 },
+        { 0xdbac6c247d62a584ull,  -582 }, { 0xa3ab66580d5fdaf6ull,  -555 }, { 0xf3e2f893dec3f126ull,  -529 },
+        { 0xb5b5ada8aaff80b8ull,  -502 }, { 0x87625f056c7c4a8bull,  -475 }, { 0xc9bcff6034c13053ull,  -449 },
+        { 0x964e858c91ba2655ull,  -422 }, { 0xdff9772470297ebdull,  -396 }, { 0xa6dfbd9fb8e5b88full,  -369 },
+        { 0xf8a95fcf88747d94ull,  -343 }, { 0xb94470938fa89bcfull,  -316 }, { 0x8a08f0f8bf0f156bull,  -289 },
+        { 0xcdb02555653131b6ull,  -263 }, { 0x993fe2c6d07b7facull,  -236 }, { 0xe45c10c42a2b3b06ull,  -210 },
+        { 0xaa242499697392d3ull,  -183 }, { 0xfd87b5f28300ca0eull,  -157 }, { 0xbce5086492111aebull,  -130 },
+        { 0x8cbccc096f5088ccull,  -103 }, { 0xd1b71758e219652cull,   -77 }, { 0x9c40000000000000ull,   -50 },
+        { 0xe8d4a51000000000ull,   -24 }, { 0xad78ebc5ac620000ull,     3 }, { 0x813f3978f8940984ull,    30 },
+        { 0xc097ce7bc90715b3ull,    56 }, { 0x8f7e32ce7bea5c70ull,    83 }, { 0xd5d238a4abe98068ull,   109 },
+        { 0x9f4f2726179a2245ull,   136 }, { 0xed63a231d4c4fb27ull,   162 }, { 0xb0de65388cc8ada8ull,   189 },
+        { 0x83c7088e1aab65dbull,   216 }, { 0xc45d1df942711d9aull,   242 }, { 0x924d692ca61be758ull,   269 },
+        { 0xda01ee641a708deaull,   295 }, { 0xa26da3999aef774aull,   322 }, { 0xf209787bb47d6b85ull,   348 },
+        { 0xb454e4a179dd1877ull,   375 }, { 0x865b86925b9bc5c2ull,   402 }, { 0xc83553c5c8965d3dull,   428 },
+        { 0x952ab45cfa97a0b3ull,   455 }, { 0xde469fbd99a05fe3ull,   481 }, { 0xa59bc234db398c25ull,   508 },
+        { 0xf6c69a72a3989f5cull,   534 }, { 0xb7dcbf5354e9beceull,   561 }, { 0x88fcf317f22241e2ull,   588 },
+        { 0xcc20ce9bd35c78a5ull,   614 }, { 0x98165af37b2153dfull,   641 }, { 0xe2a0b5dc971f303aull,   667 },
+        { 0xa8d9d1535ce3b396ull,   694 }, { 0xfb9b7cd9a4a7443cull,   720 }, { 0xbb764c4ca7a44410ull,   747 },
+        { 0x8bab8eefb6409c1aull,   774 }, { 0xd01fef10a657842cull,   800 }, { 0x9b10a4e5e9913129ull,   827 },
+        { 0xe7109bfba19c0c9dull,   853 }, { 0xac2820d9623bf429ull,   880 }, { 0x80444b5e7aa7cf85ull,   907 },
+        { 0xbf21e44003acdd2dull,   933 }, { 0x8e679c2f5e44ff8full,   960 }, { 0xd433179d9c8cb841ull,   986 },
+        { 0x9e19db92b4e31ba9ull,  1013 }, { 0xeb96bf6ebadf77d9ull,  1039 }, { 0xaf87023b9bf0ee6bull,  1066 },
+};
+
+static const uint64_t JsonNumber_Pow10[] = {
+    1ull,                   10ull,                  100ull,                 1000ull,
+    10000ull,               100000ull,              1000000ull,             10000000ull,
+    100000000ull,           1000000000ull,          10000000000ull,         100000000000ull,
+    1000000000000ull,       10000000000000ull,      100000000000000ull,     1000000000000000ull,
+    10000000000000000ull,   100000000000000000ull,  1000000000000000000ull, 10000000000000000000ull,
+};
+
+/* @funcdef: JsonDiyFp_Multiply */
+static JsonDiyFp JsonDiyFp_Multiply(JsonDiyFp x, JsonDiyFp y)
+{
+    const uint64_t a = x.f >> 32, b = x.f & 0xFFFFFFFFu;
+    const uint64_t c = y.f >> 32, d = y.f & 0xFFFFFFFFu;
+
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+
+    // Rounded upper half of the 128 bits product
+    const uint64_t middle = (bd >> 32) + (ad & 0xFFFFFFFFu) + (bc & 0xFFFFFFFFu) + (1u << 31);
+
+    const JsonDiyFp result = { ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64 };
+    return result;
+}
+
+/* @funcdef: JsonDiyFp_Normalize */
+static JsonDiyFp JsonDiyFp_Normalize(JsonDiyFp x)
+{
+    while (!(x.f & (1ull << 63)))
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+
+    return x;
+}
+
+/* Round the last digit toward w while it stays in the rounding interval */
+static void JsonNumber_GrisuRound(char* buffer, int32_t length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while (rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
+    {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+/* @funcdef: JsonNumber_DigitGen */
+static int32_t JsonNumber_DigitGen(JsonDiyFp w, JsonDiyFp upper, uint64_t delta, char* buffer, int32_t* k)
+{
+    const JsonDiyFp one      = { 1ull << -upper.e, upper.e };
+    const uint64_t  distance = upper.f - w.f;
+
+    uint32_t p1     = (uint32_t)(upper.f >> -one.e);
+    uint64_t p2     = upper.f & (one.f - 1);
+    int32_t  kappa  = 1;
+    int32_t  length = 0;
+    while (kappa < 10 && p1 >= JsonNumber_Pow10[kappa])
+    {
+        kappa++;
+    }
+
+    // Integral part
+    while (kappa > 0)
+    {
+        const uint32_t digit = p1 / (uint32_t)JsonNumber_Pow10[kappa - 1];
+        p1 %= (uint32_t)JsonNumber_Pow10[kappa - 1];
+        if (digit || length)
+        {
+            buffer[length++] = (char)('0' + digit);
+        }
+        kappa--;
+
+        const uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            JsonNumber_GrisuRound(buffer, length, delta, rest, JsonNumber_Pow10[kappa] << -one.e, distance);
+            return length;
+        }
+    }
+
+    // Fractional part
+    for (;;)
+    {
+        p2    *= 10;
+        delta *= 10;
+
+        const char digit = (char)(p2 >> -one.e);
+        if (digit || length)
+        {
+            buffer[length++] = (char)('0' + digit);
+        }
+        p2 &= one.f - 1;
+        kappa--;
+
+        if (p2 < delta)
+        {
+            *k += kappa;
+            JsonNumber_GrisuRound(buffer, length, delta, p2, one.f, -kappa < 20 ? distance * JsonNumber_Pow10[-kappa] : 0);
+            return length;
+        }
+    }
+}
+
+/* Shortest digits of a positive finite number, value is digits * 10^k */
+static int32_t JsonNumber_Grisu2(double value, char* buffer, int32_t* k)
+{
+    const uint64_t hidden = 1ull << 52;
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const int32_t biasedExponent = (int32_t)((bits >> 52) & 0x7FF);
+    const uint64_t significand   = bits & (hidden - 1);
+
+    JsonDiyFp v;
+    v.f = biasedExponent ? significand + hidden : significand;
+    v.e = biasedExponent ? biasedExponent - 1075 : -1074;
+
+    // Boundaries of the rounding interval, lower is closer when the significand is a power of two
+    JsonDiyFp upper = { (v.f << 1) + 1, v.e - 1 };
+    while (!(upper.f & (hidden << 1)))
+    {
+        upper.f <<= 1;
+        upper.e--;
+    }
+    upper.f <<= 10;
+    upper.e  -= 10;
+
+    JsonDiyFp lower;
+    if (v.f == hidden)
+    {
+        lower.f = (v.f << 2) - 1;
+        lower.e = v.e - 2;
+    }
+    else
+    {
+        lower.f = (v.f << 1) - 1;
+        lower.e = v.e - 1;
+    }
+    lower.f <<= lower.e - upper.e;
+    lower.e   = upper.e;
+
+    // Cached power that brings the upper boundary exponent into [-60, -32], ceil without libm
+    const double  dk    = (-61 - upper.e) * 0.30102999566398114 + 347;
+    int32_t       ik    = (int32_t)dk;
+    ik += dk - ik > 0.0;
+    const int32_t index = (ik >> 3) + 1;
+
+    const JsonDiyFp cached = JsonNumber_CachedPowers[index];
+    *k = 348 - index * 8;
+
+    const JsonDiyFp w  = JsonDiyFp_Multiply(JsonDiyFp_Normalize(v), cached);
+    JsonDiyFp       wp = JsonDiyFp_Multiply(upper, cached);
+    JsonDiyFp       wm = JsonDiyFp_Multiply(lower, cached);
+    wm.f++;
+    wp.f--;
+
+    return JsonNumber_DigitGen(w, wp, wp.f - wm.f, buffer, k);
+}
+
+/* @funcdef: JsonNumber_WriteInteger */
+static int32_t JsonNumber_WriteInteger(uint64_t value, char* buffer)
+{
+    char    digits[20];
+    int32_t count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    for (int32_t i = 0; i < count; i++)
+    {
+        buffer[i] = digits[count - 1 - i];
+    }
+
+    return count;
+}
+
+/* Shortest text that parses back to the same finite number, buffer needs 25 bytes */
+static int32_t JsonNumber_Format(double number, char* buffer)
+{
+    int32_t length = 0;
+    if (number < 0 || (number == 0 && 1 / number < 0))
+    {
+        buffer[length++] = '-';
+        number = -number;
+    }
+
+    // Integers below 2^53 are exact in both directions
+    if (number < 9007199254740992.0 && (double)(uint64_t)number == number)
+    {
+        return length + JsonNumber_WriteInteger((uint64_t)number, buffer + length);
+    }
+
+    char*         digits = buffer + length;
+    int32_t       k;
+    const int32_t count  = JsonNumber_Grisu2(number, digits, &k);
+
+    // Decimal point position, digits * 10^k = 0.digits * 10^point
+    const int32_t point = count + k;
+    if (k >= 0 && point <= 21)
+    {
+        // 1234e7 -> 12340000000
+        memset(digits + count, '0', (size_t)k);
+        return length + point;
+    }
+    else if (point > 0 && point <= 21)
+    {
+        // 1234e-2 -> 12.34
+        memmove(digits + point + 1, digits + point, (size_t)(count - point));
+        digits[point] = '.';
+        return length + count + 1;
+    }
+    else if (point > -6 && point <= 0)
+    {
+        // 1234e-6 -> 0.001234
+        const int32_t offset = 2 - point;
+        memmove(digits + offset, digits, (size_t)count);
+        digits[0] = '0';
+        digits[1] = '.';
+        memset(digits + 2, '0', (size_t)(offset - 2));
+        return length + count + offset;
+    }
+
+    // 1e30, 1234e30 -> 1.234e33
+    int32_t end = 1;
+    if (count > 1)
+    {
+        memmove(digits + 2, digits + 1, (size_t)(count - 1));
+        digits[1] = '.';
+        end = count + 1;
+    }
+
+    int32_t exponent = point - 1;
+    digits[end++] = 'e';
+    if (exponent < 0)
+    {
+        digits[end++] = '-';
+        exponent = -exponent;
+    }
+
+    return length + end + JsonNumber_WriteInteger((uint64_t)exponent, digits + end);
+}
+
+/* Text of a number, JSON has no representation of nan and infinities so they are written as null */
+static int32_t JsonWriter_FormatNumber(double number, char* text)
+{
+    if (number != number || number - number != 0)
+    {
+        memcpy(text, "null", 4);
+        return 4;
+    }
+
+    return JsonNumber_Format(number, text);
+}
+
+/* @funcdef: JsonWriter_WriteNumber */
+static void JsonWriter_WriteNumber(JsonWriter* writer, double number)
+{
+    char text[32];
+    JsonWriter_Write(writer, text, JsonWriter_FormatNumber(number, text));
+}
+
+/* Line break and indentation of pretty output, containers kept on one line only get a space after their commas */
+static void JsonWriter_WriteNewLine(JsonWriter* writer, bool afterComma)
+{
+    static const char    spaces[]  = "                                                                ";
+    static const int32_t spaceRun  = (int32_t)sizeof(spaces) - 1;
+
+    if (!(writer->flags & JsonStringifyFlags_Pretty))
+    {
+        return;
+    }
+
+    if (writer->singleLine)
+    {
+        if (afterComma)
+        {
+            JsonWriter_WriteChar(writer, ' ');
+        }
+        return;
+    }
+
+    JsonWriter_WriteChar(writer, '\n');
+    writer->lineStart = writer->length;
+
+    for (int32_t indent = writer->depth * writer->options.indent; indent > 0; indent -= spaceRun)
+    {
+        JsonWriter_Write(writer, spaces, indent < spaceRun ? indent : spaceRun);
+    }
+}
+
+/* Escaped length of a string with its quotes, -1 when it is longer than limit */
+static int32_t JsonWriter_MeasureString(const char* string, int32_t length, int32_t limit)
+{
+    int32_t total = length + 2;
+    for (int32_t i = 0; i < length && total <= limit; i++)
+    {
+        const uint8_t c = (uint8_t)string[i];
+        if (c == '"' || c == '\\')
+        {
+            total += 1;
+        }
+        else if (c < 0x20)
+        {
+            total += JsonWriter_ShortEscapes[c] ? 1 : 5;
+        }
+    }
+
+    return total <= limit ? total : -1;
+}
+
+/* Length of a value written on one pretty line, -1 as soon as it is longer than limit */
+static int32_t JsonWriter_MeasureLine(const Json value, int32_t limit)
 {
-    int i, n;
+    char    text[32];
+    int32_t length = 0;
 
     switch (value.type)
     {
     case JsonType_Null:
-        fprintf(out, "null");
+        length = 4;
         break;
 
-    case JsonType_Number:
-        fprintf(out, "%lf", value.number);
+    case JsonType_Boolean:
+        length = value.boolean ? 4 : 5;
         break;
 
-    case JsonType_Boolean:
-        fprintf(out, "%s", value.boolean ? "true" : "false");
+    case JsonType_Number:
+        length = value.length < 0 ? -value.length : JsonWriter_FormatNumber(value.number, text);
         break;
 
     case JsonType_String:
-        fprintf(out, "\"%s\"", value.string);
-        break;
+        return value.length < 0 ? (2 - value.length <= limit ? 2 - value.length : -1) : JsonWriter_MeasureString(value.string, value.string ? value.length : 0, limit);
 
     case JsonType_Array:
-        fprintf(out, "[");
-        for (i = 0, n = value.length; i < n; i++)
+    case JsonType_Object:
+    case JsonType_Int32Array:
+    case JsonType_NumberArray:
+        length = 2;
+        for (int32_t i = 0, n = value.length; i < n && length <= limit; i++)
         {
-            JsonWrite(value.array[i], out);
-            if (i < n - 1)
+            length += i > 0 ? 2 : 0;
+
+            int32_t itemLength;
+            if (value.type == JsonType_Array)
             {
-                fprintf(out, ",");
+                itemLength = JsonWriter_MeasureLine(value.array[i], limit - length);
             }
-        }
-        fprintf(out, "]");
-        break;
+            else if (value.type == JsonType_Object)
+            {
+                const char*   name       = value.object[i].name;
+                const int32_t nameLength = JsonWriter_MeasureString(name, name ? (int32_t)strlen(name) : 0, limit - length);
+                if (nameLength < 0)
+                {
+                    return -1;
+                }
 
-    case JsonType_Object:
-        fprintf(out, "{");
-        for (i = 0, n = value.length; i < n; i++)
-        {
-            fprintf(out, "\"%s\" : ", value.object[i].name);
-            JsonWrite(value.object[i].value, out);
-            if (i < n - 1)
+                length    += nameLength + 3;
+                itemLength = JsonWriter_MeasureLine(value.object[i].value, limit - length);
+            }
+            else
+            {
+                itemLength = JsonWriter_FormatNumber(JsonArrayGetNumber(value, i), text);
+            }
+
+            if (itemLength < 0)
             {
-                fprintf(out, ",");
+                return -1;
             }
+            length += itemLength;
         }
-        fprintf(out, "}");
         break;
 
     default:
         break;
     }
-}          
 
-/* @funcdef: JsonPrint */
-void JsonPrint(const Json value, FILE* out)
+    return length <= limit ? length : -1;
+}
+
+/* Start of an array or object, which stays on the current line when it fits in lineWidth */
+static bool JsonWriter_BeginLine(JsonWriter* writer, const Json value)
+{
+    const bool singleLine = writer->singleLine;
+    if (!singleLine && (writer->flags & JsonStringifyFlags_Pretty) && writer->options.lineWidth > 0 && value.length > 0)
+    {
+        writer->singleLine = JsonWriter_MeasureLine(value, writer->options.lineWidth - (writer->length - writer->lineStart)) >= 0;
+    }
+
+    return singleLine;
+}
+
+/* @funcdef: JsonWriter_WriteValue */
+static void JsonWriter_WriteValue(JsonWriter* writer, const Json value)
 {
-    int i, n;
-    static int indent = 0;
+    const bool pretty = (writer->flags & JsonStringifyFlags_Pretty) != 0;
 
     switch (value.type)
     {
     case JsonType_Null:
-        fprintf(out, "null");
+        JsonWriter_Write(writer, "null", 4);
         break;
 
     case JsonType_Number:
-        fprintf(out, "%lf", value.number);
+        if (value.length < 0)
+        {
+            JsonWriter_Write(writer, value.rawNumber, -value.length);
+        }
+        else
+        {
+            JsonWriter_WriteNumber(writer, value.number);
+        }
         break;
 
     case JsonType_Boolean:
-        fprintf(out, "%s", value.boolean ? "true" : "false");
+        if (value.boolean)
+        {
+            JsonWriter_Write(writer, "true", 4);
+        }
+        else
+        {
+            JsonWriter_Write(writer, "false", 5);
+        }
         break;
 
     case JsonType_String:
-        fprintf(out, "\"%s\"", value.string);
+        if (value.length < 0)
+        {
+            // Escaped lazy strings are still in their source form
+            JsonWriter_WriteChar(writer, '"');
+            JsonWriter_Write(writer, value.string, -value.length);
+            JsonWriter_WriteChar(writer, '"');
+        }
+        else
+        {
+            JsonWriter_WriteString(writer, value.string, value.string ? value.length : 0);
+        }
         break;
 
     case JsonType_Array:
-        fprintf(out, "[\n");
-
-        indent++;
-        for (i = 0, n = value.length; i < n; i++)
+        if (value.length > 0)
         {
-            int j, m;
-            for (j = 0, m = indent * 4; j < m; j++)
-            {
-                fputc(' ', out);
-            }
+            const bool singleLine = JsonWriter_BeginLine(writer, value);
 
-            JsonPrint(value.array[i], out);
-            if (i < n - 1)
+            JsonWriter_WriteChar(writer, '[');
+            writer->depth++;
+            for (int32_t i = 0, n = value.length; i < n; i++)
             {
-                fputc(',', out);
+                if (i > 0)
+                {
+                    JsonWriter_WriteChar(writer, ',');
+                }
+
+                JsonWriter_WriteNewLine(writer, i > 0);
+                JsonWriter_WriteValue(writer, value.array[i]);
             }
-            fprintf(out, "\n");
-        }
-        indent--;
+            writer->depth--;
 
-        for (i = 0, n = indent * 4; i < n; i++)
+            JsonWriter_WriteNewLine(writer, false);
+            JsonWriter_WriteChar(writer, ']');
+            writer->singleLine = singleLine;
+        }
+        else
         {
-            fprintf(out, " ");
+            JsonWriter_Write(writer, "[]", 2);
         }
-        fputc(']', out);
         break;
 
-    case JsonType_Object:
-        fprintf(out, "{\n");
-
-        indent++;
-        for (i = 0, n = value.length; i < n; i++)
+    case JsonType_Int32Array:
+    case JsonType_NumberArray:
+        // Packed numbers stay on one line
+        JsonWriter_WriteChar(writer, '[');
+        for (int32_t i = 0, n = value.length; i < n; i++)
         {
-            int j, m;
-            for (j = 0, m = indent * 4; j < m; j++)
+            if (i > 0)
             {
-                fputc(' ', out);
+                JsonWriter_Write(writer, ", ", pretty ? 2 : 1);
             }
 
-            fprintf(out, "\"%s\" : ", value.object[i].name);
-            JsonPrint(value.object[i].value, out);
-            if (i < n - 1)
-            {
-                fputc(',', out);
-            }
-            fputc('\n', out);
+            JsonWriter_WriteNumber(writer, JsonArrayGetNumber(value, i));
         }
-        indent--;
+        JsonWriter_WriteChar(writer, ']');
+        break;
 
-        for (i = 0, n = indent * 4; i < n; i++)
+    case JsonType_Object:
+        if (value.length > 0)
         {
-            fputc(' ', out);
+            const bool singleLine = JsonWriter_BeginLine(writer, value);
+
+            JsonWriter_WriteChar(writer, '{');
+            writer->depth++;
+            for (int32_t i = 0, n = value.length; i < n; i++)
+            {
+                if (i > 0)
+                {
+                    JsonWriter_WriteChar(writer, ',');
+                }
+
+                const char* name = value.object[i].name;
+                JsonWriter_WriteNewLine(writer, i > 0);
+                JsonWriter_WriteString(writer, name, name ? (int32_t)strlen(name) : 0);
+                JsonWriter_Write(writer, pretty ? " : " : ":", pretty ? 3 : 1);
+                JsonWriter_WriteValue(writer, value.object[i].value);
+            }
+            writer->depth--;
+
+            JsonWriter_WriteNewLine(writer, false);
+            JsonWriter_WriteChar(writer, '}');
+            writer->singleLine = singleLine;
+        }
+        else
+        {
+            JsonWriter_Write(writer, "{}", 2);
         }
-        fputc('}', out);
         break;
 
     default:
         break;
     }
 }
+
+/* The innermost open container is an object */
+static bool JsonWriter_InObject(const JsonWriter* writer)
+{
+    return writer->depth > 0 && ((writer->objects[(writer->depth - 1) >> 6] >> ((writer->depth - 1) & 63)) & 1);
+}
+
+/* Separator and indentation in front of a key or a value, false when the item is not allowed at this point */
+static bool JsonWriter_BeginItem(JsonWriter* writer, bool isKey)
+{
+    const bool inObject = JsonWriter_InObject(writer);
+
+    bool allowed;
+    if (writer->depth == 0)
+    {
+        allowed = !isKey && !writer->hasItems;
+    }
+    else if (inObject)
+    {
+        allowed = isKey != writer->afterKey;
+    }
+    else
+    {
+        allowed = !isKey;
+    }
+
+    if (!allowed)
+    {
+        JsonWriter_SetError(writer, JsonError_UnexpectedToken);
+        return false;
+    }
+
+    // The separator of a member value is written with its key
+    if (writer->afterKey)
+    {
+        writer->afterKey = false;
+        return true;
+    }
+
+    if (writer->depth > 0)
+    {
+        if (writer->hasItems)
+        {
+            JsonWriter_WriteChar(writer, ',');
+        }
+        JsonWriter_WriteNewLine(writer, writer->hasItems);
+    }
+
+    return true;
+}
+
+/* @funcdef: JsonWriter_WriteKeySeparator */
+static void JsonWriter_WriteKeySeparator(JsonWriter* writer)
+{
+    if (writer->flags & JsonStringifyFlags_Pretty)
+    {
+        JsonWriter_Write(writer, " : ", 3);
+    }
+    else
+    {
+        JsonWriter_WriteChar(writer, ':');
+    }
+}
+
+/* @funcdef: JsonWriter_Begin */
+static bool JsonWriter_Begin(JsonWriter* writer, bool isObject)
+{
+    if (writer->depth >= JSON_WRITER_MAX_DEPTH)
+    {
+        JsonWriter_SetError(writer, JsonError_OutOfMemory);
+        return false;
+    }
+
+    if (!JsonWriter_BeginItem(writer, false))
+    {
+        return false;
+    }
+
+    JsonWriter_WriteChar(writer, isObject ? '{' : '[');
+    const uint64_t bit = (uint64_t)1 << (writer->depth & 63);
+    writer->objects[writer->depth >> 6] = isObject ? writer->objects[writer->depth >> 6] | bit : writer->objects[writer->depth >> 6] & ~bit;
+    writer->hasItems = false;
+    writer->depth++;
+    return true;
+}
+
+/* @funcdef: JsonWriter_End */
+static bool JsonWriter_End(JsonWriter* writer, bool isObject)
+{
+    if (writer->depth == 0 || writer->afterKey || JsonWriter_InObject(writer) != isObject)
+    {
+        JsonWriter_SetError(writer, JsonError_UnmatchToken);
+        return false;
+    }
+
+    writer->depth--;
+    if (writer->hasItems)
+    {
+        JsonWriter_WriteNewLine(writer, false);
+    }
+
+    JsonWriter_WriteChar(writer, isObject ? '}' : ']');
+    writer->hasItems = true;
+    return true;
+}
+
+/* @funcdef: JsonWriterInit */
+void JsonWriterInit(JsonWriter* writer, JsonStringifyFlags flags, char* buffer, int32_t bufferSize)
+{
+    JSON_ASSERT(writer, "writer mustnot be null");
+    JSON_ASSERT(buffer || bufferSize <= 0, "buffer mustnot be null");
+
+    memset(writer, 0, sizeof(*writer));
+    writer->buffer         = bufferSize > 0 ? buffer : NULL;   // A buffer without room is never written, not even the null terminator
+    writer->capacity       = bufferSize > 0 ? bufferSize - 1 : 0;
+    writer->flags          = flags;
+    writer->options.indent = 4;
+}
+
+/* @funcdef: JsonWriterInitWithSink */
+void JsonWriterInitWithSink(JsonWriter* writer, JsonStringifyFlags flags, char* buffer, int32_t bufferSize, JsonSink sink, void* user)
+{
+    JSON_ASSERT(buffer && bufferSize > 0, "sink writers need a buffer");
+    JSON_ASSERT(sink, "sink mustnot be null");
+
+    JsonWriterInit(writer, flags, buffer, bufferSize);
+    writer->capacity = bufferSize;
+    writer->sink     = sink;
+    writer->user     = user;
+}
+
+/* @funcdef: JsonWriterInitWithGrow */
+void JsonWriterInitWithGrow(JsonWriter* writer, JsonStringifyFlags flags, char* buffer, int32_t bufferSize, JsonGrow grow, void* user)
+{
+    JSON_ASSERT(grow, "grow mustnot be null");
+
+    JsonWriterInit(writer, flags, buffer, bufferSize);
+    writer->grow = grow;
+    writer->user = user;
+}
+
+/* @funcdef: JsonWriterSetPrintOptions */
+void JsonWriterSetPrintOptions(JsonWriter* writer, const JsonPrintOptions* options)
+{
+    JSON_ASSERT(options, "options mustnot be null");
+    JSON_ASSERT(options->indent >= 0, "indent mustnot be negative");
+
+    writer->flags  |= JsonStringifyFlags_Pretty;
+    writer->options = *options;
+}
+
+/* @funcdef: JsonWriterBeginObject */
+bool JsonWriterBeginObject(JsonWriter* writer)
+{
+    return JsonWriter_Begin(writer, true);
+}
+
+/* @funcdef: JsonWriterEndObject */
+bool JsonWriterEndObject(JsonWriter* writer)
+{
+    return JsonWriter_End(writer, true);
+}
+
+/* @funcdef: JsonWriterBeginArray */
+bool JsonWriterBeginArray(JsonWriter* writer)
+{
+    return JsonWriter_Begin(writer, false);
+}
+
+/* @funcdef: JsonWriterEndArray */
+bool JsonWriterEndArray(JsonWriter* writer)
+{
+    return JsonWriter_End(writer, false);
+}
+
+/* @funcdef: JsonWriterKey */
+bool JsonWriterKey(JsonWriter* writer, const char* key, int32_t length)
+{
+    if (!JsonWriter_BeginItem(writer, true))
+    {
+        return false;
+    }
+
+    JsonWriter_WriteString(writer, key, key ? (length < 0 ? (int32_t)strlen(key) : length) : 0);
+    JsonWriter_WriteKeySeparator(writer);
+
+    writer->afterKey = true;
+    writer->hasItems = true;
+    return true;
+}
+
+/* @funcdef: JsonWriterString */
+bool JsonWriterString(JsonWriter* writer, const char* string, int32_t length)
+{
+    if (!JsonWriter_BeginItem(writer, false))
+    {
+        return false;
+    }
+
+    JsonWriter_WriteString(writer, string, string ? (length < 0 ? (int32_t)strlen(string) : length) : 0);
+    writer->hasItems = true;
+    return true;
+}
+
+/* @funcdef: JsonWriterNumber */
+bool JsonWriterNumber(JsonWriter* writer, double number)
+{
+    if (!JsonWriter_BeginItem(writer, false))
+    {
+        return false;
+    }
+
+    JsonWriter_WriteNumber(writer, number);
+    writer->hasItems = true;
+    return true;
+}
+
+/* @funcdef: JsonWriterBoolean */
+bool JsonWriterBoolean(JsonWriter* writer, bool value)
+{
+    if (!JsonWriter_BeginItem(writer, false))
+    {
+        return false;
+    }
+
+    JsonWriter_Write(writer, value ? "true" : "false", value ? 4 : 5);
+    writer->hasItems = true;
+    return true;
+}
+
+/* @funcdef: JsonWriterNull */
+bool JsonWriterNull(JsonWriter* writer)
+{
+    if (!JsonWriter_BeginItem(writer, false))
+    {
+        return false;
+    }
+
+    JsonWriter_Write(writer, "null", 4);
+    writer->hasItems = true;
+    return true;
+}
+
+/* @funcdef: JsonWriterValue */
+bool JsonWriterValue(JsonWriter* writer, const Json value)
+{
+    if (!JsonWriter_BeginItem(writer, false))
+    {
+        return false;
+    }
+
+    JsonWriter_WriteValue(writer, value);
+    writer->hasItems = true;
+    return true;
+}
+
+/* @funcdef: JsonWriterFinish */
+JsonError JsonWriterFinish(JsonWriter* writer)
+{
+    if (writer->depth > 0 || !writer->hasItems)
+    {
+        JsonWriter_SetError(writer, JsonError_UnmatchToken);
+    }
+
+    if (writer->sink)
+    {
+        JsonWriter_Flush(writer);
+    }
+    else
+    {
+        if (!writer->buffer && writer->grow)
+        {
+            JsonWriter_MakeRoom(writer, 0);
+        }
+
+        if (writer->buffer)
+        {
+            writer->buffer[writer->used] = 0;
+        }
+    }
+
+    return writer->error;
+}
+
+/* Skip whitespace, and comments with JsonParseFlags_SupportComment, runs of 8 spaces are skipped at once, NULL on an unterminated comment */
+static const char* JsonWriter_SkipSpace(const char* ptr, const char* end, JsonParseFlags flags)
+{
+    while (ptr < end)
+    {
+        uint64_t word;
+        if (end - ptr >= 8 && (memcpy(&word, ptr, sizeof(word)), word == 0x2020202020202020ull))
+        {
+            ptr += 8;
+        }
+        else if (*ptr == ' ' || *ptr == '\t' || *ptr == '\n' || *ptr == '\r')
+        {
+            ptr++;
+        }
+        else if ((flags & JsonParseFlags_SupportComment) && *ptr == '/' && end - ptr >= 2 && ptr[1] == '/')
+        {
+            const char* lineEnd = (const char*)memchr(ptr, '\n', (size_t)(end - ptr));
+            ptr = lineEnd ? lineEnd + 1 : end;
+        }
+        else if ((flags & JsonParseFlags_SupportComment) && *ptr == '/' && end - ptr >= 2 && ptr[1] == '*')
+        {
+            const char* star = ptr + 2;
+            while ((star = (const char*)memchr(star, '*', (size_t)(end - star))) != NULL && (star + 1 >= end || star[1] != '/'))
+            {
+                star++;
+            }
+
+            if (!star)
+            {
+                return NULL;
+            }
+            ptr = star + 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return ptr;
+}
+
+/* Move ptr past the string token starting at it, escapes are checked and control characters are rejected */
+static JsonError JsonWriter_ScanString(const char** ptr, const char* end)
+{
+    const char* cursor = *ptr + 1;
+    while (cursor < end)
+    {
+        uint64_t word;
+        if (end - cursor >= 8 && (memcpy(&word, cursor, sizeof(word)), !JsonWriter_NeedsEscape(word)))
+        {
+            cursor += 8;
+        }
+        else if (*cursor == '"')
+        {
+            *ptr = cursor + 1;
+            return JsonError_None;
+        }
+        else if (*cursor == '\\')
+        {
+            if (end - cursor < 2)
+            {
+                break;
+            }
+
+            if (cursor[1] == 'u')
+            {
+                for (int32_t i = 2; i < 6; i++)
+                {
+                    const char h = cursor + i < end ? cursor[i] : 0;
+                    if (!((h >= '0' && h <= '9') || (h >= 'a' && h <= 'f') || (h >= 'A' && h <= 'F')))
+                    {
+                        *ptr = cursor;
+                        return JsonError_UnknownToken;
+                    }
+                }
+                cursor += 6;
+            }
+            else if (cursor[1] != 0 && strchr("\"\\/bfnrt", cursor[1]))
+            {
+                cursor += 2;
+            }
+            else
+            {
+                *ptr = cursor;
+                return JsonError_UnknownToken;
+            }
+        }
+        else if ((uint8_t)*cursor < 0x20)
+        {
+            *ptr = cursor;
+            return JsonError_UnexpectedToken;
+        }
+        else
+        {
+            cursor++;
+        }
+    }
+
+    *ptr = end;
+    return JsonError_UnmatchToken;
+}
+
+/* Move ptr past the number or literal token starting at it, following the JSON grammar */
+static JsonError JsonWriter_ScanScalar(const char** ptr, const char* end)
+{
+    const char* cursor = *ptr;
+    if (*cursor == 't' || *cursor == 'f' || *cursor == 'n')
+    {
+        const char*   literal = *cursor == 't' ? "true" : *cursor == 'f' ? "false" : "null";
+        const int32_t length  = (int32_t)strlen(literal);
+        if (end - cursor < length || memcmp(cursor, literal, (size_t)length) != 0)
+        {
+            return JsonError_UnknownToken;
+        }
+        cursor += length;
+    }
+    else
+    {
+        // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        cursor += *cursor == '-';
+        if (cursor < end && *cursor == '0')
+        {
+            cursor++;
+        }
+        else if (cursor < end && *cursor >= '1' && *cursor <= '9')
+        {
+            while (cursor < end && *cursor >= '0' && *cursor <= '9') cursor++;
+        }
+        else
+        {
+            return JsonError_UnknownToken;
+        }
+
+        if (cursor < end && *cursor == '.')
+        {
+            const char* digits = ++cursor;
+            while (cursor < end && *cursor >= '0' && *cursor <= '9') cursor++;
+            if (cursor == digits)
+            {
+                return JsonError_UnknownToken;
+            }
+        }
+
+        if (cursor < end && (*cursor == 'e' || *cursor == 'E'))
+        {
+            cursor++;
+            cursor += cursor < end && (*cursor == '+' || *cursor == '-');
+
+            const char* digits = cursor;
+            while (cursor < end && *cursor >= '0' && *cursor <= '9') cursor++;
+            if (cursor == digits)
+            {
+                return JsonError_UnknownToken;
+            }
+        }
+    }
+
+    // The token must not run into another one, like 1.2.3, 0x12 or nullnull
+    if (cursor < end && !strchr(" \t\r\n,:]}/", *cursor))
+    {
+        return JsonError_UnknownToken;
+    }
+
+    *ptr = cursor;
+    return JsonError_None;
+}
+
+/* Rewrite JSON text token by token through writer, strings, numbers and literals are checked and copied as they are */
+static JsonError JsonWriter_Reformat(JsonWriter* writer, const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags)
+{
+    const char* ptr       = jsonCode;
+    const char* end       = jsonCode + jsonCodeLength;
+    bool        separated = true;   // A key or value may come next
+    bool        opened    = false;  // The last token opened a container
+    bool        needColon = false;
+
+    while ((ptr = JsonWriter_SkipSpace(ptr, end, flags)) != NULL && ptr < end)
+    {
+        const char c = *ptr;
+        if (needColon != (c == ':'))
+        {
+            return JsonError_UnexpectedToken;
+        }
+
+        if (c == ':')
+        {
+            needColon = false;
+            separated = true;
+            ptr++;
+        }
+        else if (c == ',')
+        {
+            if (separated || writer->depth == 0)
+            {
+                return JsonError_UnexpectedToken;
+            }
+
+            separated = true;
+            ptr++;
+        }
+        else if (c == '{' || c == '[')
+        {
+            if (writer->depth >= JSON_WRITER_MAX_DEPTH)
+            {
+                return JsonError_OutOfMemory;
+            }
+
+            if (!separated || !JsonWriter_Begin(writer, c == '{'))
+            {
+                return JsonError_UnexpectedToken;
+            }
+
+            opened = true;
+            ptr++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (separated && !opened)
+            {
+                return JsonError_UnexpectedToken;
+            }
+
+            if (!JsonWriter_End(writer, c == '}'))
+            {
+                return JsonError_UnmatchToken;
+            }
+
+            separated = false;
+            opened    = false;
+            ptr++;
+        }
+        else
+        {
+            const char* token = ptr;
+            const bool  isKey = c == '"' && !writer->afterKey && JsonWriter_InObject(writer);
+
+            JsonError error = JsonError_UnknownToken;
+            if (c == '"')
+            {
+                error = JsonWriter_ScanString(&ptr, end);
+            }
+            else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n')
+            {
+                error = JsonWriter_ScanScalar(&ptr, end);
+            }
+
+            if (error != JsonError_None)
+            {
+                return error;
+            }
+
+            if (!separated || !JsonWriter_BeginItem(writer, isKey))
+            {
+                return JsonError_UnexpectedToken;
+            }
+
+            JsonWriter_Write(writer, token, (int32_t)(ptr - token));
+            if (isKey)
+            {
+                JsonWriter_WriteKeySeparator(writer);
+            }
+
+            writer->afterKey = isKey;
+            writer->hasItems = true;
+            needColon        = isKey;
+            separated        = false;
+            opened           = false;
+        }
+    }
+
+    return ptr ? JsonError_None : JsonError_UnmatchToken;
+}
+
+/* @funcdef: JsonMinify */
+JsonError JsonMinify(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, char* out, int32_t bufferSize, int32_t* outLength)
+{
+    JsonWriter writer;
+    JsonWriterInit(&writer, JsonStringifyFlags_None, out, bufferSize);
+
+    const JsonError error       = JsonWriter_Reformat(&writer, jsonCode, jsonCodeLength, flags);
+    const JsonError finishError = JsonWriterFinish(&writer);
+    if (outLength)
+    {
+        *outLength = writer.length;
+    }
+
+    return error != JsonError_None ? error : finishError;
+}
+
+/* @funcdef: JsonReformat */
+JsonError JsonReformat(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonPrintOptions* options, char* out, int32_t bufferSize, int32_t* outLength)
+{
+    JsonWriter writer;
+    JsonWriterInit(&writer, JsonStringifyFlags_Pretty, out, bufferSize);
+    JsonWriterSetPrintOptions(&writer, options);
+
+    const JsonError error       = JsonWriter_Reformat(&writer, jsonCode, jsonCodeLength, flags);
+    const JsonError finishError = JsonWriterFinish(&writer);
+    if (outLength)
+    {
+        *outLength = writer.length;
+    }
+
+    return error != JsonError_None ? error : finishError;
+}
+
+/* @funcdef: JsonStringify */
+int32_t JsonStringify(const Json value, JsonStringifyFlags flags, char* out, int32_t bufferSize)
+{
+    JsonWriter writer;
+    JsonWriterInit(&writer, flags, out, bufferSize);
+    JsonWriterValue(&writer, value);
+    JsonWriterFinish(&writer);
+    return writer.length;
+}
+
+/* @funcdef: JsonStringifyToSink */
+int32_t JsonStringifyToSink(const Json value, JsonStringifyFlags flags, JsonSink sink, void* user)
+{
+    char chunk[JSON_STRINGIFY_CHUNK_SIZE];
+
+    JsonWriter writer;
+    JsonWriterInitWithSink(&writer, flags, chunk, (int32_t)sizeof(chunk), sink, user);
+    JsonWriterValue(&writer, value);
+    return JsonWriterFinish(&writer) == JsonError_None ? writer.length : -1;
+}
+
+/* @funcdef: JsonStringifyPretty */
+int32_t JsonStringifyPretty(const Json value, const JsonPrintOptions* options, char* out, int32_t bufferSize)
+{
+    JsonWriter writer;
+    JsonWriterInit(&writer, JsonStringifyFlags_Pretty, out, bufferSize);
+    JsonWriterSetPrintOptions(&writer, options);
+    JsonWriterValue(&writer, value);
+    JsonWriterFinish(&writer);
+    return writer.length;
+}
+
+/* @funcdef: JsonStringifyPrettyToSink */
+int32_t JsonStringifyPrettyToSink(const Json value, const JsonPrintOptions* options, JsonSink sink, void* user)
+{
+    char chunk[JSON_STRINGIFY_CHUNK_SIZE];
+
+    JsonWriter writer;
+    JsonWriterInitWithSink(&writer, JsonStringifyFlags_Pretty, chunk, (int32_t)sizeof(chunk), sink, user);
+    JsonWriterSetPrintOptions(&writer, options);
+    JsonWriterValue(&writer, value);
+    return JsonWriterFinish(&writer) == JsonError_None ? writer.length : -1;
+}
+
+/* Sink of JsonWrite and JsonPrint */
+static bool JsonWriter_WriteFile(void* user, const char* data, int32_t length)
+{
+    return fwrite(data, 1, (size_t)length, (FILE*)user) == (size_t)length;
+}
+
+/* @funcdef: JsonWrite */
+void JsonWrite(const Json value, FILE* out)
+{
+    JsonStringifyToSink(value, JsonStringifyFlags_None, JsonWriter_WriteFile, out);
+}
+
+/* @funcdef: JsonPrint */
+void JsonPrint(const Json value, FILE* out)
+{
+    JsonStringifyToSink(value, JsonStringifyFlags_Pretty, JsonWriter_WriteFile, out);
+}
+
+/* @funcdef: JsonPrintWithOptions */
+void JsonPrintWithOptions(const Json value, const JsonPrintOptions* options, FILE* out)
+{
+    JsonStringifyPrettyToSink(value, options, JsonWriter_WriteFile, out);
+}
@@ -4,7 +4,108 @@
 #include "Json.h"
 #include <stdio.h>
 
-JSON_API void JsonPrint(const Json value, FILE* out);
-JSON_API void JsonWrite(const Json value, FILE* out);
+typedef enum JsonStringifyFlags
+{
+    JsonStringifyFlags_None         = 0,
+    JsonStringifyFlags_Pretty       = 1 << 0,   // Members and elements on their own lines, indented by 4 spaces
+} JsonStringifyFlags;
+
+/// Layout of pretty output
+typedef struct JsonPrintOptions
+{
+    int32_t     indent;         // Spaces per nesting level
+    int32_t     lineWidth;      // Arrays and objects that fit in the rest of the line stay on it, 0 to always break them
+} JsonPrintOptions;
+
+#ifndef JSON_STRINGIFY_CHUNK_SIZE
+#define JSON_STRINGIFY_CHUNK_SIZE   4096    // Output buffer of JsonStringifyToSink, first size of growable writers
+#endif
+
+#ifndef JSON_WRITER_MAX_DEPTH
+#define JSON_WRITER_MAX_DEPTH       1024    // Nesting levels of JsonWriter, JsonMinify and JsonReformat, one bit each
+#endif
+
+/// Receives the output in chunks, return false to stop writing
+typedef bool  (*JsonSink)(void* user, const char* data, int32_t length);
+
+/// Resizes a writer buffer like realloc, buffer is NULL on the first call, return NULL on failure
+typedef void* (*JsonGrow)(void* user, void* buffer, int32_t size);
+
+/// Streaming writer, commas, separators and escaping are handled, misplaced calls fail and set error
+typedef struct JsonWriter
+{
+    char*       buffer;
+    int32_t     capacity;       // Output bytes of buffer, buffer and growable writers keep one more for the null terminator
+    int32_t     used;
+    int32_t     length;         // Bytes written so far, including what a full fixed buffer dropped
+
+    JsonSink    sink;
+    JsonGrow    grow;
+    void*       user;
+    bool        stopped;        // The sink refused output
+
+    JsonError   error;          // First error, later calls are still validated
+    int32_t     flags;
+    JsonPrintOptions options;   // Pretty layout, lineWidth only applies to JsonWriterValue
+    int32_t     lineStart;      // Output length at the last line break
+    bool        singleLine;     // Writing a container that fits on the current line
+    int32_t     depth;
+    uint64_t    objects[(JSON_WRITER_MAX_DEPTH + 63) / 64];   // Bit per nesting level, set for objects
+    bool        hasItems;       // Current container has an item, or the root is written at depth 0
+    bool        afterKey;       // A key waits for its value
+} JsonWriter;
+
+JSON_API void       JsonPrint(const Json value, FILE* out);
+JSON_API void       JsonPrintWithOptions(const Json value, const JsonPrintOptions* options, FILE* out);
+JSON_API void       JsonWrite(const Json value, FILE* out);
+
+/// Serialize value into out, returns the full output length like snprintf, out is always null-terminated when bufferSize > 0
+JSON_API int32_t    JsonStringify(const Json value, JsonStringifyFlags flags, char* out, int32_t bufferSize);
+
+/// Serialize value through sink in JSON_STRINGIFY_CHUNK_SIZE chunks, returns the output length or -1 when the sink stopped
+JSON_API int32_t    JsonStringifyToSink(const Json value, JsonStringifyFlags flags, JsonSink sink, void* user);
+
+/// Pretty variants of JsonStringify and JsonStringifyToSink with a custom layout
+JSON_API int32_t    JsonStringifyPretty(const Json value, const JsonPrintOptions* options, char* out, int32_t bufferSize);
+JSON_API int32_t    JsonStringifyPrettyToSink(const Json value, const JsonPrintOptions* options, JsonSink sink, void* user);
+
+/// Write into a fixed buffer, output past bufferSize - 1 is dropped but still counted in length, JsonWriterFinish reports JsonError_OutOfMemory
+JSON_API void       JsonWriterInit(JsonWriter* writer, JsonStringifyFlags flags, char* buffer, int32_t bufferSize);
+
+/// Write through sink, the whole buffer is handed over each time it fills up
+JSON_API void       JsonWriterInitWithSink(JsonWriter* writer, JsonStringifyFlags flags, char* buffer, int32_t bufferSize, JsonSink sink, void* user);
+
+/// Write into a buffer that is enlarged with grow, buffer may start as NULL
+JSON_API void       JsonWriterInitWithGrow(JsonWriter* writer, JsonStringifyFlags flags, char* buffer, int32_t bufferSize, JsonGrow grow, void* user);
+
+/// Rewrite JSON text without whitespace, comments are dropped with JsonParseFlags_SupportComment
+/// Numbers, literals and string escapes are checked, UTF-8 is not (see JsonValidate), a single value is accepted as the root
+/// Nesting deeper than JSON_WRITER_MAX_DEPTH fails with JsonError_OutOfMemory
+/// outLength receives the full output length, the output is null-terminated when bufferSize > 0
+JSON_API JsonError  JsonMinify(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, char* out, int32_t bufferSize, int32_t* outLength);
+
+/// Rewrite JSON text with the layout of options, see JsonMinify, line width is not applied
+JSON_API JsonError  JsonReformat(const char* jsonCode, int32_t jsonCodeLength, JsonParseFlags flags, const JsonPrintOptions* options, char* out, int32_t bufferSize, int32_t* outLength);
+
+/// Enable pretty output with a custom layout, the default is 4 spaces of indent without line width
+JSON_API void       JsonWriterSetPrintOptions(JsonWriter* writer, const JsonPrintOptions* options);
+
+JSON_API bool       JsonWriterBeginObject(JsonWriter* writer);
+JSON_API bool       JsonWriterEndObject(JsonWriter* writer);
+JSON_API bool       JsonWriterBeginArray(JsonWriter* writer);
+JSON_API bool       JsonWriterEndArray(JsonWriter* writer);
+
+/// Keys and strings are escaped, length < 0 for null-terminated text
+JSON_API bool       JsonWriterKey(JsonWriter* writer, const char* key, int32_t length);
+JSON_API bool       JsonWriterString(JsonWriter* writer, const char* string, int32_t length);
+JSON_API bool       JsonWriterNumber(JsonWriter* writer, double number);
+JSON_API bool       JsonWriterBoolean(JsonWriter* writer, bool value);
+JSON_API bool       JsonWriterNull(JsonWriter* writer);
+
+/// Write a whole parsed value
+JSON_API bool       JsonWriterValue(JsonWriter* writer, const Json value);
+
+/// Check that the root value is complete, flush the sink or null-terminate the buffer, returns the first error
+JSON_API JsonError  JsonWriterFinish(JsonWriter* writer);
 
 #endif // __JSON_UTILS_H__
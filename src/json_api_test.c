@@ -0,0 +1,1729 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Json.h"
+#include "JsonUtils.h"
+
+static int testFailures = 0;
+
+#define TEST_CHECK(cond)                                                            \
+    do                                                                              \
+    {                                                                               \
+        if (!(cond))                                                                \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailures++;                                                         \
+        }                                                                           \
+    } while (0)
+
+static char testBuffer[1024 * 1024];
+static char testBuffer2[1024 * 1024];
+
+/* Parse a literal into the given buffer, failing the test on error */
+static Json Test_Parse(const char* json, JsonParseFlags flags, void* buffer, int32_t bufferSize)
+{
+    Json value = JSON_NULL;
+    const JsonResult result = JsonParse(json, (int32_t)strlen(json), flags, buffer, bufferSize, &value);
+    if (result.error != JsonError_None)
+    {
+        fprintf(stderr, "cannot parse '%s': %s\n", json, result.message);
+        testFailures++;
+    }
+    return value;
+}
+
+/* Equality of two parsed literals */
+static bool Test_Equals(const char* a, const char* b)
+{
+    return JsonEquals(Test_Parse(a, JsonParseFlags_Default, testBuffer, sizeof(testBuffer)),
+                      Test_Parse(b, JsonParseFlags_Default, testBuffer2, sizeof(testBuffer2)));
+}
+
+// -------------------------------------------------------------------
+// String region
+// -------------------------------------------------------------------
+
+/* Check that containers of value are Json-aligned inside [nodes, nodesEnd) and strings are inside [strings, stringsEnd) */
+static bool Test_CheckLayout(const Json value, const void* nodes, const void* nodesEnd, const char* strings, const char* stringsEnd)
+{
+    if (value.type == JsonType_String)
+    {
+        return value.length == 0 || (value.string >= strings && value.string + value.length < stringsEnd && value.string[value.length] == 0);
+    }
+
+    if ((value.type != JsonType_Array && value.type != JsonType_Object) || value.length == 0)
+    {
+        return true;
+    }
+
+    const void* items = value.type == JsonType_Array ? (const void*)value.array : (const void*)value.object;
+    if ((uintptr_t)items % sizeof(Json) != 0 || items < nodes || items >= nodesEnd)
+    {
+        return false;
+    }
+
+    for (int32_t i = 0; i < value.length; i++)
+    {
+        const char* name = value.type == JsonType_Object ? value.object[i].name : NULL;
+        if (name && (name < strings || name + strlen(name) >= stringsEnd))
+        {
+            return false;
+        }
+
+        if (!Test_CheckLayout(value.type == JsonType_Array ? value.array[i] : value.object[i].value, nodes, nodesEnd, strings, stringsEnd))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void Test_StringBuffer(void)
+{
+    static Json nodes[64];
+    static char strings[64];
+
+    // Keys and values are byte-packed in parse order, escaped ones shrink to their decoded length
+    const char*   json   = "[\"a\",\"bc\",{\"def\":\"ghij\",\"k\":[1,\"\"]},\"a\\u00e9\",[[\"x\"]]]";
+    const int32_t length = (int32_t)strlen(json);
+
+    Json       value;
+    JsonResult result = JsonParseWithStringBuffer(json, length, JsonParseFlags_Default, nodes, sizeof(nodes), strings, sizeof(strings), &value);
+    TEST_CHECK(result.error == JsonError_None && result.stringMemoryUsage == 22);
+    TEST_CHECK(memcmp(strings, "a\0bc\0def\0ghij\0k\0a\xc3\xa9\0x", 22) == 0);
+    TEST_CHECK(value.array[0].string == strings && value.array[3].string == strings + 16);
+
+    // The nodes alone are dense, no padding is left by strings between them: 10 values and 2 members rounded up to 3 values
+    TEST_CHECK(result.memoryUsage == 13 * (int32_t)sizeof(Json));
+    TEST_CHECK(Test_CheckLayout(value, nodes, (const char*)nodes + result.memoryUsage, strings, strings + result.stringMemoryUsage));
+
+    // Running out of either region fails the parse
+    TEST_CHECK(JsonParseWithStringBuffer(json, length, JsonParseFlags_Default, nodes, sizeof(nodes), strings, 21, &value).error == JsonError_OutOfMemory);
+    TEST_CHECK(JsonParseWithStringBuffer(json, length, JsonParseFlags_Default, nodes, sizeof(nodes), strings, 0, &value).error == JsonError_OutOfMemory);
+    TEST_CHECK(JsonParseWithStringBuffer(json, length, JsonParseFlags_Default, nodes, result.memoryUsage - (int32_t)sizeof(Json), strings, sizeof(strings), &value).error == JsonError_OutOfMemory);
+
+    // Without a string region, strings are packed behind the nodes, and the next nodes are aligned again
+    const JsonResult shared = JsonParseWithStringBuffer(json, length, JsonParseFlags_Default, testBuffer, sizeof(testBuffer), NULL, 0, &value);
+    TEST_CHECK(shared.error == JsonError_None && shared.stringMemoryUsage == 0);
+    TEST_CHECK(shared.memoryUsage >= result.memoryUsage + result.stringMemoryUsage);
+    TEST_CHECK(Test_CheckLayout(value, testBuffer, testBuffer + shared.memoryUsage, testBuffer, testBuffer + shared.memoryUsage));
+    TEST_CHECK(strcmp(value.array[2].object[0].name, "def") == 0 && strcmp(value.array[3].string, "a\xc3\xa9") == 0);
+    TEST_CHECK(strcmp(value.array[4].array[0].array[0].string, "x") == 0);
+}
+
+// -------------------------------------------------------------------
+// JsonEquals
+// -------------------------------------------------------------------
+
+static void Test_Equality(void)
+{
+    TEST_CHECK( Test_Equals("[1,2]", "[1,2]"));
+    TEST_CHECK(!Test_Equals("[1,2]", "[1]"));
+    TEST_CHECK(!Test_Equals("[1]", "[1,2]"));
+    TEST_CHECK(!Test_Equals("[1,2]", "[2,1]"));
+
+    TEST_CHECK( Test_Equals("{\"abc\":1}", "{\"abc\":1}"));
+    TEST_CHECK(!Test_Equals("{\"abc\":1}", "{\"abd\":1}"));
+    TEST_CHECK(!Test_Equals("{\"abc\":1}", "{\"ab\":1}"));
+    TEST_CHECK(!Test_Equals("{\"a\":1,\"b\":2}", "{\"a\":1}"));
+    TEST_CHECK(!Test_Equals("{\"a\":1}", "{\"a\":2}"));
+
+    // Empty keys are stored as NULL
+    TEST_CHECK( Test_Equals("{\"\":1}", "{\"\":1}"));
+    TEST_CHECK(!Test_Equals("{\"\":1}", "{\"a\":1}"));
+    TEST_CHECK(!Test_Equals("{\"a\":1}", "{\"\":1}"));
+
+    // Packed arrays compare by their numbers
+    const Json packed = Test_Parse("[1,2,3]", JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    const Json plain  = Test_Parse("[1,2,3]", JsonParseFlags_Default, testBuffer2, sizeof(testBuffer2));
+    TEST_CHECK(JsonEquals(packed, plain) && JsonEquals(plain, packed));
+}
+
+// -------------------------------------------------------------------
+// Packed number arrays
+// -------------------------------------------------------------------
+
+static void Test_PackedArrays(void)
+{
+    Json array = Test_Parse("[1,-2,2147483647]", JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(array.type == JsonType_Int32Array && array.length == 3 && array.int32Array[1] == -2);
+
+    array = Test_Parse("[1,2.5,2147483648]", JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(array.type == JsonType_NumberArray && array.length == 3 && array.numberArray[1] == 2.5);
+
+    array = Test_Parse("[1,\"2\"]", JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(array.type == JsonType_Array);
+
+    // Negative zero does not fit an int32_t[], it packs as doubles and keeps its sign
+    array = Test_Parse("[-0,1]", JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(array.type == JsonType_NumberArray && signbit(array.numberArray[0]));
+
+    array = Test_Parse("[0,-1,-0.0]", JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(array.type == JsonType_NumberArray && signbit(array.numberArray[2]));
+
+    array = Test_Parse("[0,-1]", JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(array.type == JsonType_Int32Array && array.int32Array[0] == 0);
+}
+
+// -------------------------------------------------------------------
+// Typed array extraction
+// -------------------------------------------------------------------
+
+static void Test_ArrayConversion(void)
+{
+    int32_t ints[4];
+    double  doubles[4];
+    for (int flags = 0; flags < 2; flags++)
+    {
+        const JsonParseFlags parseFlags = flags ? JsonParseFlags_PackNumberArrays : JsonParseFlags_Default;
+
+        Json array = Test_Parse("[1,-2,2147483647,-2147483648]", parseFlags, testBuffer, sizeof(testBuffer));
+        TEST_CHECK(JsonArrayToInt32(array, ints, 4) == JsonError_None);
+        TEST_CHECK(ints[0] == 1 && ints[1] == -2 && ints[2] == 2147483647 && ints[3] == (-2147483647 - 1));
+        TEST_CHECK(JsonArrayToInt32(array, ints, 5) == JsonError_MissingField);
+
+        array = Test_Parse("[1,2.5]", parseFlags, testBuffer, sizeof(testBuffer));
+        ints[0] = 0;
+        TEST_CHECK(JsonArrayToInt32(array, ints, 2) == JsonError_InvalidValue && ints[0] == 1);
+        TEST_CHECK(JsonArrayToDouble(array, doubles, 2) == JsonError_None && doubles[1] == 2.5);
+
+        array = Test_Parse("[1,2147483648]", parseFlags, testBuffer, sizeof(testBuffer));
+        TEST_CHECK(JsonArrayToInt32(array, ints, 2) == JsonError_InvalidValue);
+
+        array = Test_Parse("[1,-1e300]", parseFlags, testBuffer, sizeof(testBuffer));
+        TEST_CHECK(JsonArrayToInt32(array, ints, 2) == JsonError_InvalidValue);
+
+        array = Test_Parse("[1,\"2\"]", parseFlags, testBuffer, sizeof(testBuffer));
+        TEST_CHECK(JsonArrayToInt32(array, ints, 2) == JsonError_WrongType);
+
+        array = Test_Parse("[-0,1]", parseFlags, testBuffer, sizeof(testBuffer));
+        TEST_CHECK(JsonArrayToInt32(array, ints, 2) == JsonError_None && ints[0] == 0 && ints[1] == 1);
+    }
+
+    // NaN is never an int32_t, the elements before it are still written
+    const double numbers[3] = { 3, -4, NAN };
+    Json packed;
+    packed.type        = JsonType_NumberArray;
+    packed.length      = 3;
+    packed.numberArray = numbers;
+    TEST_CHECK(JsonArrayToInt32(packed, ints, 3) == JsonError_InvalidValue && ints[0] == 3 && ints[1] == -4);
+    TEST_CHECK(JsonArrayToInt32(packed, ints, 2) == JsonError_None);
+
+    // A negative count is rejected before anything is copied, for every array subtype
+    const int32_t small[2] = { 5, 6 };
+    Json packedInts;
+    packedInts.type       = JsonType_Int32Array;
+    packedInts.length     = 2;
+    packedInts.int32Array = small;
+    const Json plain = Test_Parse("[1,2]", JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonArrayToInt32(packed, ints, -1) == JsonError_InvalidValue);
+    TEST_CHECK(JsonArrayToInt32(packedInts, ints, -1) == JsonError_InvalidValue);
+    TEST_CHECK(JsonArrayToDouble(packed, doubles, -1) == JsonError_InvalidValue);
+    TEST_CHECK(JsonArrayToDouble(packedInts, doubles, -1) == JsonError_InvalidValue);
+    TEST_CHECK(JsonArrayToFloat(plain, NULL, -1) == JsonError_InvalidValue);
+    TEST_CHECK(JsonArrayToInt32(plain, NULL, 0) == JsonError_None);
+}
+
+// -------------------------------------------------------------------
+// Columns and key lookup
+// -------------------------------------------------------------------
+
+static void Test_Columns(void)
+{
+    const Json rows = Test_Parse("[{\"x\":1,\"xy\":9},{\"x\":1.5},{\"xy\":3,\"x\":-4},{\"x\":4294967296},{\"\":1}]", JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+
+    const JsonColumnSpec spec = { "x", JsonColumnType_Int32 };
+    int32_t    values[5];
+    uint8_t    presence[1] = { 0 };
+    JsonColumn column = { values, presence };
+    TEST_CHECK(JsonExtractColumns(rows, &spec, 1, &column) == JsonError_None);
+    TEST_CHECK(values[0] == 1 && values[1] == 0 && values[2] == -4 && values[3] == 0 && values[4] == 0);
+    TEST_CHECK(presence[0] == 0x05);
+
+    // Keys match exactly, never by prefix
+    Json found;
+    TEST_CHECK(JsonFind(rows.array[0], "x", &found) && found.number == 1);
+    TEST_CHECK(!JsonFind(rows.array[1], "xy", &found));
+    TEST_CHECK(JsonFind(rows.array[2], "x", &found) && found.number == -4);
+    TEST_CHECK(!JsonFind(rows.array[4], "x", &found));
+    TEST_CHECK(JsonFind(rows.array[4], "", &found) && found.number == 1);
+
+    // String columns hold decoded strings, empty ones included, lazy ones are read from a Value column
+    const char*          strings   = "[{\"s\":\"hello\"},{\"s\":\"a\\nb\"},{\"s\":\"\"}]";
+    const JsonColumnSpec specs[2]  = { { "s", JsonColumnType_String }, { "s", JsonColumnType_Value } };
+    const char*          texts[3];
+    Json                 raws[3];
+    JsonColumn           columns[2] = { { texts, presence }, { raws, NULL } };
+
+    const Json decoded = Test_Parse(strings, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonExtractColumns(decoded, specs, 2, columns) == JsonError_None && presence[0] == 0x07);
+    TEST_CHECK(strcmp(texts[0], "hello") == 0 && strcmp(texts[1], "a\nb") == 0 && strcmp(texts[2], "") == 0);
+
+    const Json lazy = Test_Parse(strings, JsonParseFlags_LazyStrings, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonExtractColumns(lazy, specs, 2, columns) == JsonError_None && presence[0] == 0x04);
+    TEST_CHECK(texts[0] == NULL && texts[1] == NULL && strcmp(texts[2], "") == 0);
+
+    char text[8];
+    TEST_CHECK(JsonCopyString(raws[0], text, sizeof(text)) == 5 && strcmp(text, "hello") == 0);
+    TEST_CHECK(JsonCopyString(raws[1], text, sizeof(text)) == 3 && strcmp(text, "a\nb") == 0);
+
+    // Nested structs only exist in struct bindings
+    const JsonColumnSpec nested = { "x", JsonColumnType_Struct };
+    presence[0] = 0xff;
+    TEST_CHECK(JsonExtractColumns(rows, &nested, 1, &column) == JsonError_InvalidValue && presence[0] == 0xff);
+}
+
+// -------------------------------------------------------------------
+// Lazy numbers
+// -------------------------------------------------------------------
+
+static void Test_LazyNumbers(void)
+{
+    const char* json  = "[9007199254740993,-9223372036854775808,9223372036854775807,9223372036854775808,1.5,1e3,-0,12345678901234567890]";
+    const Json  value = Test_Parse(json, JsonParseFlags_LazyNumbers, testBuffer, sizeof(testBuffer));
+
+    // Raw text is kept as is
+    TEST_CHECK(value.array[0].type == JsonType_Number && value.array[0].length == -16);
+    TEST_CHECK(strncmp(value.array[0].rawNumber, "9007199254740993", 16) == 0);
+
+    // Integers above 2^53 are exact from the text, the double rounds them
+    int64_t integer = 0;
+    TEST_CHECK(JsonGetInt64(value.array[0], &integer) && integer == 9007199254740993LL);
+    TEST_CHECK(JsonGetNumber(value.array[0]) == 9007199254740992.0);
+    TEST_CHECK(JsonGetInt64(value.array[1], &integer) && integer == INT64_MIN);
+    TEST_CHECK(JsonGetInt64(value.array[2], &integer) && integer == INT64_MAX);
+    TEST_CHECK(!JsonGetInt64(value.array[3], &integer));
+    TEST_CHECK(!JsonGetInt64(value.array[4], &integer) && JsonGetNumber(value.array[4]) == 1.5);
+    TEST_CHECK(JsonGetInt64(value.array[5], &integer) && integer == 1000);
+    TEST_CHECK(JsonGetInt64(value.array[6], &integer) && integer == 0 && signbit(JsonGetNumber(value.array[6])));
+    TEST_CHECK(!JsonGetInt64(value.array[7], &integer));
+    TEST_CHECK(JsonGetNumber(value.array[7]) == 12345678901234567890.0);
+
+    // Decoded numbers round above 2^53
+    const Json decoded = Test_Parse(json, JsonParseFlags_Default, testBuffer2, sizeof(testBuffer2));
+    TEST_CHECK(JsonGetInt64(decoded.array[0], &integer) && integer == 9007199254740992LL);
+
+    // Stringify echoes the raw text, so nothing is lost on a round trip
+    char text[256];
+    TEST_CHECK(JsonStringify(value, JsonStringifyFlags_None, text, sizeof(text)) == (int32_t)strlen(json) && strcmp(text, json) == 0);
+
+    const Json object = Test_Parse("{\"a\":1.10,\"b\":[2E+2]}", JsonParseFlags_LazyNumbers, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonStringify(object, JsonStringifyFlags_None, text, sizeof(text)) > 0 && strcmp(text, "{\"a\":1.10,\"b\":[2E+2]}") == 0);
+    TEST_CHECK(JsonGetNumber(object.object[0].value) == 1.1 && JsonGetInt64(object.object[1].value.array[0], &integer) && integer == 200);
+
+    // Packing never drops the raw text, only arrays of int32 integer literals are packed
+    static const struct { const char* text; JsonType type; } packed[] = {
+        { "[12345678901234567890,1]",   JsonType_Array },
+        { "[1,2147483648]",             JsonType_Array },
+        { "[1.0,2]",                    JsonType_Array },
+        { "[1e0]",                      JsonType_Array },
+        { "[-0,1]",                     JsonType_Array },
+        { "[1,-2,2147483647]",          JsonType_Int32Array },
+    };
+
+    for (int32_t i = 0; i < (int32_t)(sizeof(packed) / sizeof(packed[0])); i++)
+    {
+        const Json array = Test_Parse(packed[i].text, JsonParseFlags_LazyNumbers | JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+        TEST_CHECK(array.type == packed[i].type);
+        TEST_CHECK(JsonStringify(array, JsonStringifyFlags_None, text, sizeof(text)) > 0 && strcmp(text, packed[i].text) == 0);
+    }
+
+    // Numbers built by hand are never lazy, whatever their length
+    Json number;
+    number.type   = JsonType_Number;
+    number.length = 1;
+    number.number = 3.0;
+    TEST_CHECK(JsonGetNumber(number) == 3.0 && JsonGetInt64(number, &integer) && integer == 3);
+    TEST_CHECK(JsonStringify(number, JsonStringifyFlags_None, text, sizeof(text)) == 1 && strcmp(text, "3") == 0);
+
+    Json numbers[2] = { number, number };
+    numbers[1].length = 0;
+    numbers[1].number = -0.5;
+
+    Json array;
+    array.type   = JsonType_Array;
+    array.length = 2;
+    array.array  = numbers;
+    TEST_CHECK(JsonStringify(array, JsonStringifyFlags_None, text, sizeof(text)) > 0 && strcmp(text, "[3,-0.5]") == 0);
+
+    const JsonPrintOptions options = { 2, 80 };
+    TEST_CHECK(JsonStringifyPretty(array, &options, text, sizeof(text)) > 0 && strcmp(text, "[3, -0.5]") == 0);
+}
+
+// -------------------------------------------------------------------
+// Lazy strings
+// -------------------------------------------------------------------
+
+static void Test_LazyStrings(void)
+{
+    const char* json  = "[\"abc\",\"a\\nb\",\"\\u00e9x\",\"\",\"a\\tb\",\"ab\\u0063\",\"a\\/b\"]";
+    const Json  lazy  = Test_Parse(json, JsonParseFlags_LazyStrings, testBuffer, sizeof(testBuffer));
+    const Json  plain = Test_Parse(json, JsonParseFlags_Default, testBuffer2, sizeof(testBuffer2));
+
+    // Plain slices keep their length, escaped ones the negative raw length
+    TEST_CHECK(lazy.array[0].length == 3 && strncmp(lazy.array[0].string, "abc", 3) == 0);
+    TEST_CHECK(lazy.array[1].length == -4 && strncmp(lazy.array[1].string, "a\\nb", 4) == 0);
+    TEST_CHECK(lazy.array[2].length == -7 && lazy.array[3].length == 0);
+
+    char text[16];
+    TEST_CHECK(JsonCopyString(lazy.array[0], text, sizeof(text)) == 3 && strcmp(text, "abc") == 0);
+    TEST_CHECK(JsonCopyString(lazy.array[1], text, sizeof(text)) == 3 && strcmp(text, "a\nb") == 0);
+    TEST_CHECK(JsonCopyString(lazy.array[2], text, sizeof(text)) == 3 && strcmp(text, "\xc3\xa9x") == 0);
+    TEST_CHECK(JsonCopyString(lazy.array[3], text, sizeof(text)) == 0 && text[0] == 0);
+    TEST_CHECK(JsonCopyString(lazy.array[4], text, sizeof(text)) == 3 && strcmp(text, "a\tb") == 0);
+    TEST_CHECK(JsonCopyString(lazy.array[6], text, sizeof(text)) == 3 && strcmp(text, "a/b") == 0);
+
+    // Truncated copies still return the full decoded length
+    TEST_CHECK(JsonCopyString(lazy.array[1], text, 2) == 3 && strcmp(text, "a") == 0);
+    TEST_CHECK(JsonCopyString(lazy.array[2], text, 2) == 3);
+    TEST_CHECK(JsonCopyString(lazy.array[5], NULL, 0) == 3);
+    TEST_CHECK(JsonCopyString(lazy.array[0], text, 1) == 3 && text[0] == 0);
+
+    // Lazy strings equal their decoded value, whichever side holds the escapes
+    for (int32_t i = 0; i < lazy.length; i++)
+    {
+        TEST_CHECK(JsonEquals(lazy.array[i], plain.array[i]) && JsonEquals(plain.array[i], lazy.array[i]));
+        TEST_CHECK(JsonEquals(lazy.array[i], lazy.array[i]));
+    }
+    TEST_CHECK(JsonEquals(lazy, plain));
+    TEST_CHECK(!JsonEquals(lazy.array[1], plain.array[0]) && !JsonEquals(plain.array[0], lazy.array[1]));
+    TEST_CHECK(JsonEquals(lazy.array[5], plain.array[0]) && JsonEquals(lazy.array[0], lazy.array[5]));
+    TEST_CHECK(!JsonEquals(lazy.array[3], plain.array[0]));
+
+    const Json other = Test_Parse("[\"a\\nc\",\"a\\nbc\",\"a\\n\"]", JsonParseFlags_LazyStrings, testBuffer2, sizeof(testBuffer2));
+    TEST_CHECK(!JsonEquals(lazy.array[1], other.array[0]));
+    TEST_CHECK(!JsonEquals(lazy.array[1], other.array[1]) && !JsonEquals(other.array[1], lazy.array[1]));
+    TEST_CHECK(!JsonEquals(lazy.array[1], other.array[2]) && !JsonEquals(other.array[2], lazy.array[1]));
+}
+
+// -------------------------------------------------------------------
+// Events parsing
+// -------------------------------------------------------------------
+
+/* Events are recorded as one letter each */
+typedef struct TestEvents
+{
+    char    trace[256];
+    int32_t count;
+    int32_t stopAt;
+} TestEvents;
+
+static bool TestEvents_Add(TestEvents* events, char c)
+{
+    if (events->count < (int32_t)sizeof(events->trace) - 1)
+    {
+        events->trace[events->count] = c;
+    }
+    return ++events->count != events->stopAt;
+}
+
+static bool TestEvents_StartObject(void* user)           { return TestEvents_Add((TestEvents*)user, '{'); }
+static bool TestEvents_EndObject(void* user)             { return TestEvents_Add((TestEvents*)user, '}'); }
+static bool TestEvents_StartArray(void* user)            { return TestEvents_Add((TestEvents*)user, '['); }
+static bool TestEvents_EndArray(void* user)              { return TestEvents_Add((TestEvents*)user, ']'); }
+static bool TestEvents_Key(void* user, const Json name)  { (void)name; return TestEvents_Add((TestEvents*)user, 'k'); }
+static bool TestEvents_String(void* user, const Json v)  { (void)v; return TestEvents_Add((TestEvents*)user, 's'); }
+static bool TestEvents_Number(void* user, const Json v)  { (void)v; return TestEvents_Add((TestEvents*)user, 'n'); }
+static bool TestEvents_Boolean(void* user, bool v)       { return TestEvents_Add((TestEvents*)user, v ? 't' : 'f'); }
+static bool TestEvents_Null(void* user)                  { return TestEvents_Add((TestEvents*)user, '0'); }
+
+static const JsonHandler TestEventsHandler = {
+    TestEvents_StartObject, TestEvents_EndObject, TestEvents_StartArray, TestEvents_EndArray,
+    TestEvents_Key, TestEvents_String, TestEvents_Number, TestEvents_Boolean, TestEvents_Null
+};
+
+static JsonResult Test_Events(const char* json, JsonParseFlags flags, int32_t stopAt, TestEvents* events)
+{
+    memset(events, 0, sizeof(*events));
+    events->stopAt = stopAt;
+    return JsonParseEvents(json, (int32_t)strlen(json), flags, &TestEventsHandler, events);
+}
+
+static void Test_ParseEvents(void)
+{
+    TestEvents events;
+
+    TEST_CHECK(Test_Events("{\"a\":[1,\"x\",true,false,null,{}],\"b\":[]}", JsonParseFlags_Default, 0, &events).error == JsonError_None);
+    TEST_CHECK(strcmp(events.trace, "{k[nstf0{}]k[]}") == 0);
+
+    TEST_CHECK(Test_Events("[ /* a */ 1, // b\n [ /* c */ 2 ] ]", JsonParseFlags_SupportComment, 0, &events).error == JsonError_None);
+    TEST_CHECK(strcmp(events.trace, "[n[n]]") == 0);
+
+    TEST_CHECK(Test_Events("[1,{\"a\":2}]", JsonParseFlags_Default, 3, &events).error == JsonError_InvalidValue);
+    TEST_CHECK(strcmp(events.trace, "[n{") == 0);
+
+    // Errors carry the parser message with its position
+    JsonResult result = Test_Events("[1,\n 2,]", JsonParseFlags_Default, 0, &events);
+    TEST_CHECK(result.error != JsonError_None);
+    TEST_CHECK(strstr(result.message, "line 2") != NULL);
+
+    TEST_CHECK(Test_Events("[1,2", JsonParseFlags_Default, 0, &events).error == JsonError_UnmatchToken);
+    TEST_CHECK(Test_Events("{\"a\" 1}", JsonParseFlags_Default, 0, &events).error == JsonError_UnmatchToken);
+    TEST_CHECK(Test_Events("{\"a\":1,}", JsonParseFlags_Default, 0, &events).error == JsonError_UnexpectedToken);
+    TEST_CHECK(Test_Events("[1] 2", JsonParseFlags_Default, 0, &events).error == JsonError_WrongFormat);
+
+    // Nesting past JSON_EVENTS_MAX_DEPTH fails instead of exhausting the native stack
+    const int32_t deep = 2000000;
+    char* text = (char*)malloc(2 * deep + 1);
+    memset(text, '[', deep);
+    memset(text + deep, ']', deep);
+    text[2 * deep] = 0;
+    TEST_CHECK(Test_Events(text, JsonParseFlags_Default, 0, &events).error == JsonError_OutOfMemory);
+
+    memset(text + JSON_EVENTS_MAX_DEPTH, ']', JSON_EVENTS_MAX_DEPTH);
+    text[2 * JSON_EVENTS_MAX_DEPTH] = 0;
+    TEST_CHECK(Test_Events(text, JsonParseFlags_Default, 0, &events).error == JsonError_None);
+    TEST_CHECK(events.count == 2 * JSON_EVENTS_MAX_DEPTH);
+
+    memset(text, '[', JSON_EVENTS_MAX_DEPTH + 1);
+    memset(text + JSON_EVENTS_MAX_DEPTH + 1, ']', JSON_EVENTS_MAX_DEPTH + 1);
+    text[2 * JSON_EVENTS_MAX_DEPTH + 2] = 0;
+    result = Test_Events(text, JsonParseFlags_Default, 0, &events);
+    TEST_CHECK(result.error == JsonError_OutOfMemory && strstr(result.message, "deeper") != NULL);
+    free(text);
+}
+
+// -------------------------------------------------------------------
+// Projected parsing
+// -------------------------------------------------------------------
+
+/* Parse json with a projection of the given paths, returns the parse error and checks the result equals expected */
+static JsonError Test_Project(const char* json, const char* const* paths, int32_t pathCount, JsonParseFlags flags, const char* expected)
+{
+    JsonProjection projection;
+    TEST_CHECK(JsonProjectionCompile(paths, pathCount, &projection) == JsonError_None);
+
+    Json value = JSON_NULL;
+    const JsonResult result = JsonParseProjected(json, (int32_t)strlen(json), flags, &projection, testBuffer, sizeof(testBuffer), &value);
+    if (result.error == JsonError_None && expected)
+    {
+        TEST_CHECK(JsonEquals(value, Test_Parse(expected, JsonParseFlags_Default, testBuffer2, sizeof(testBuffer2))));
+    }
+    return result.error;
+}
+
+static void Test_Projection(void)
+{
+    static const char* const member[]   = { "b" };
+    static const char* const index[]    = { "a[2]" };
+    static const char* const elements[] = { "a[*].x" };
+    static const char* const several[]  = { "a[3]", "c" };
+    static const char* const any[]      = { "*" };
+
+    // Brackets and braces inside skipped strings do not end the subtree
+    TEST_CHECK(Test_Project("{\"a\":{\"s\":\"]}\\\"}\",\"t\":[\"}\",\"]]\"]},\"b\":1}", member, 1, JsonParseFlags_Default, "{\"b\":1}") == JsonError_None);
+    TEST_CHECK(Test_Project("{\"a\":[\"[\",\"{\",{\"]\":\"}\"}],\"b\":[1,2]}", member, 1, JsonParseFlags_Default, "{\"b\":[1,2]}") == JsonError_None);
+    TEST_CHECK(Test_Project("{\"a\":[1 /* ] */, 2 // }\n],\"b\":true}", member, 1, JsonParseFlags_SupportComment, "{\"b\":true}") == JsonError_None);
+    TEST_CHECK(Test_Project("{\"a\":[1,/*/ ] */2],\"b\":7}", member, 1, JsonParseFlags_SupportComment, "{\"b\":7}") == JsonError_None);
+
+    // Unselected elements before a selected index are null, the ones after it are dropped
+    TEST_CHECK(Test_Project("{\"a\":[{\"x\":1},[2],{\"x\":3,\"y\":4},5,6]}", index, 1, JsonParseFlags_Default, "{\"a\":[null,null,{\"x\":3,\"y\":4}]}") == JsonError_None);
+    TEST_CHECK(Test_Project("{\"a\":[1,2]}", index, 1, JsonParseFlags_Default, "{\"a\":[]}") == JsonError_None);
+    TEST_CHECK(Test_Project("{\"c\":\"z\",\"a\":[0,1,2,3,4]}", several, 2, JsonParseFlags_Default, "{\"c\":\"z\",\"a\":[null,null,null,3]}") == JsonError_None);
+
+    // Wildcards keep every element, each one projected on the rest of the path
+    TEST_CHECK(Test_Project("{\"a\":[{\"x\":1,\"y\":2},{\"y\":1},{\"x\":[3],\"z\":{}}],\"b\":0}", elements, 1, JsonParseFlags_Default, "{\"a\":[{\"x\":1},{},{\"x\":[3]}]}") == JsonError_None);
+    TEST_CHECK(Test_Project("{\"a\":1,\"b\":[1,{\"c\":2}]}", any, 1, JsonParseFlags_Default, "{\"a\":1,\"b\":[1,{\"c\":2}]}") == JsonError_None);
+    TEST_CHECK(Test_Project("[1,[2],3]", any, 1, JsonParseFlags_Default, "[1,[2],3]") == JsonError_None);
+
+    // Malformed skipped subtrees are still reported
+    TEST_CHECK(Test_Project("{\"a\":{\"s\":\"abc},\"b\":1}", member, 1, JsonParseFlags_Default, NULL) == JsonError_WrongFormat);
+    TEST_CHECK(Test_Project("{\"a\":\"x", member, 1, JsonParseFlags_Default, NULL) == JsonError_WrongFormat);
+    TEST_CHECK(Test_Project("{\"a\":[1,[2]", member, 1, JsonParseFlags_Default, NULL) == JsonError_WrongFormat);
+    TEST_CHECK(Test_Project("{\"a\":[1,2}}],\"b\":1}", member, 1, JsonParseFlags_Default, NULL) != JsonError_None);
+    TEST_CHECK(Test_Project("{\"a\":[1,[2],\"b\":1}", member, 1, JsonParseFlags_Default, NULL) != JsonError_None);
+    TEST_CHECK(Test_Project("{\"a\":[1 /* ], \"b\":1}", member, 1, JsonParseFlags_SupportComment, NULL) != JsonError_None);
+    TEST_CHECK(Test_Project("{\"a\":[1,2],\"b\":1", member, 1, JsonParseFlags_Default, NULL) != JsonError_None);
+
+    // Closers must match their openers, and skipping is bounded like the other bit stacks
+    TEST_CHECK(Test_Project("{\"a\":[1}],\"b\":1}", member, 1, JsonParseFlags_Default, NULL) == JsonError_UnmatchToken);
+    TEST_CHECK(Test_Project("{\"a\":{\"x\":1]},\"b\":1}", member, 1, JsonParseFlags_Default, NULL) == JsonError_UnmatchToken);
+    TEST_CHECK(Test_Project("{\"a\":[{\"x\":\"]}\"},[]],\"b\":1}", member, 1, JsonParseFlags_Default, "{\"b\":1}") == JsonError_None);
+
+    for (int32_t depth = JSON_SKIP_MAX_DEPTH; depth <= JSON_SKIP_MAX_DEPTH + 1; depth++)
+    {
+        int32_t length = snprintf(testBuffer2, sizeof(testBuffer2), "{\"a\":");
+        memset(testBuffer2 + length, '[', depth);
+        memset(testBuffer2 + length + depth, ']', depth);
+        snprintf(testBuffer2 + length + 2 * depth, sizeof(testBuffer2) - length - 2 * depth, ",\"b\":1}");
+        TEST_CHECK(Test_Project(testBuffer2, member, 1, JsonParseFlags_Default, NULL) == (depth > JSON_SKIP_MAX_DEPTH ? JsonError_OutOfMemory : JsonError_None));
+    }
+}
+
+// -------------------------------------------------------------------
+// Paths and JSON Pointers
+// -------------------------------------------------------------------
+
+/* Compile a dotted path and resolve it from root, returns the first error */
+static JsonError Test_ResolvePath(const char* text, const Json root, Json* outResult)
+{
+    JsonPath        path;
+    const JsonError error = JsonPathCompile(text, &path);
+    return error != JsonError_None ? error : JsonPathResolve(root, &path, outResult);
+}
+
+/* Compile a JSON Pointer and resolve it from root, returns the first error */
+static JsonError Test_ResolvePointer(const char* text, const Json root, Json* outResult)
+{
+    JsonPath        path;
+    const JsonError error = JsonPointerCompile(text, &path);
+    return error != JsonError_None ? error : JsonPathResolve(root, &path, outResult);
+}
+
+static void Test_Paths(void)
+{
+    const Json root = Test_Parse("{\"a\":[10,{\"b\":11},12],\"01\":13,\"\":{\"\":14},\"m~n\":15,\"c/d\":16,\"~1\":17,\"p\":[20,21,22],\"q\":[0.5,1.5]}",
+                                 JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+
+    Json result;
+    TEST_CHECK(Test_ResolvePath("a[1].b", root, &result) == JsonError_None && result.number == 11);
+    TEST_CHECK(Test_ResolvePath("$.a[2]", root, &result) == JsonError_None && result.number == 12);
+    TEST_CHECK(Test_ResolvePath("$[\"a\"]", root, &result) == JsonError_WrongFormat);
+    TEST_CHECK(Test_ResolvePath("$", root, &result) == JsonError_None && result.type == JsonType_Object);
+    TEST_CHECK(Test_ResolvePath("", root, &result) == JsonError_None && result.type == JsonType_Object);
+    TEST_CHECK(Test_ResolvePath("a[3]", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePath("a.b", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePath("a[*]", root, &result) == JsonError_InvalidValue);
+    TEST_CHECK(Test_ResolvePath("*", root, &result) == JsonError_InvalidValue);
+
+    // Packed arrays resolve to plain numbers
+    TEST_CHECK(Test_ResolvePath("p[2]", root, &result) == JsonError_None && result.type == JsonType_Number && result.number == 22);
+    TEST_CHECK(Test_ResolvePath("q[1]", root, &result) == JsonError_None && result.number == 1.5);
+    TEST_CHECK(Test_ResolvePath("p[3]", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePath("p[0].x", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePointer("/p/1", root, &result) == JsonError_None && result.number == 21);
+
+    // JSON Pointers: "" is the root and "/" the empty key
+    TEST_CHECK(Test_ResolvePointer("", root, &result) == JsonError_None && result.type == JsonType_Object);
+    TEST_CHECK(Test_ResolvePointer("/", root, &result) == JsonError_None && result.type == JsonType_Object && result.length == 1);
+    TEST_CHECK(Test_ResolvePointer("//", root, &result) == JsonError_None && result.number == 14);
+    TEST_CHECK(Test_ResolvePointer("/a/1/b", root, &result) == JsonError_None && result.number == 11);
+
+    // ~0 is '~' and ~1 is '/', decoded once from left to right
+    TEST_CHECK(Test_ResolvePointer("/m~0n", root, &result) == JsonError_None && result.number == 15);
+    TEST_CHECK(Test_ResolvePointer("/c~1d", root, &result) == JsonError_None && result.number == 16);
+    TEST_CHECK(Test_ResolvePointer("/~01", root, &result) == JsonError_None && result.number == 17);
+    TEST_CHECK(Test_ResolvePointer("/c/d", root, &result) == JsonError_MissingField);
+
+    // Indices are canonical, other tokens stay keys
+    TEST_CHECK(Test_ResolvePointer("/01", root, &result) == JsonError_None && result.number == 13);
+    TEST_CHECK(Test_ResolvePointer("/a/01", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePointer("/a/-", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePointer("/a/3", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePointer("/a/4294967296", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePointer("/a/99999999999999999999", root, &result) == JsonError_MissingField);
+    TEST_CHECK(Test_ResolvePath("a[4294967296]", root, &result) == JsonError_WrongFormat);
+
+    // Malformed paths and pointers
+    static const char* const badPaths[] = {
+        "a[0]b", "a[0]*", "a..b", "a.", ".a", "a.[0]", "a[", "a[]", "a[x]", "a[1", "a[-1]", "$a", "$.", "$..a", "$.[0]",
+    };
+
+    JsonPath path;
+    for (int32_t i = 0; i < (int32_t)(sizeof(badPaths) / sizeof(badPaths[0])); i++)
+    {
+        if (JsonPathCompile(badPaths[i], &path) != JsonError_WrongFormat)
+        {
+            fprintf(stderr, "path '%s' compiled\n", badPaths[i]);
+            testFailures++;
+        }
+    }
+
+    TEST_CHECK(JsonPointerCompile("a", &path) == JsonError_WrongFormat);
+    TEST_CHECK(JsonPointerCompile("/~", &path) == JsonError_WrongFormat);
+    TEST_CHECK(JsonPointerCompile("/~2", &path) == JsonError_WrongFormat);
+    TEST_CHECK(JsonPointerCompile("/a/~", &path) == JsonError_WrongFormat);
+
+    // Too many segments or key bytes
+    TEST_CHECK(JsonPathCompile("a.a.a.a.a.a.a.a.a.a.a.a.a.a.a.a", &path) == JsonError_None && path.count == JSON_PATH_MAX_DEPTH);
+    TEST_CHECK(JsonPathCompile("a.a.a.a.a.a.a.a.a.a.a.a.a.a.a.a.a", &path) == JsonError_OutOfMemory);
+    TEST_CHECK(JsonPointerCompile("/0/0/0/0/0/0/0/0/0/0/0/0/0/0/0/0/0", &path) == JsonError_OutOfMemory);
+
+    char longKey[JSON_PATH_MAX_NAMES + 2];
+    memset(longKey, 'k', sizeof(longKey) - 1);
+    longKey[0] = '/';
+    longKey[sizeof(longKey) - 1] = 0;
+    TEST_CHECK(JsonPointerCompile(longKey, &path) == JsonError_OutOfMemory);
+    TEST_CHECK(JsonPathCompile(longKey + 1, &path) == JsonError_OutOfMemory);
+}
+
+// -------------------------------------------------------------------
+// Queries
+// -------------------------------------------------------------------
+
+/* Compile and run a query, -1 when it does not compile */
+static int32_t Test_RunQuery(const char* query, const Json root, Json* results, int32_t maxResults)
+{
+    JsonQuery compiled;
+    if (JsonQueryCompile(query, &compiled) != JsonError_None)
+    {
+        fprintf(stderr, "cannot compile query '%s'\n", query);
+        return -1;
+    }
+    return JsonQueryRun(&compiled, root, results, maxResults);
+}
+
+/* Number of a member, NaN when it is missing */
+static double Test_Member(const Json object, const char* name)
+{
+    Json member;
+    return JsonFind(object, name, &member) && member.type == JsonType_Number ? member.number : NAN;
+}
+
+static void Test_Query(void)
+{
+    // 100 items cross the 64-element batch of filters, every 10th has a null tag
+    char    json[16 * 1024];
+    int32_t length = snprintf(json, sizeof(json), "{\"items\":[");
+    for (int32_t i = 0; i < 100; i++)
+    {
+        length += snprintf(json + length, sizeof(json) - length, "%s{\"id\":%d,\"v\":{\"w\":%d},\"name\":\"n%d\",\"on\":%s%s}",
+                           i > 0 ? "," : "", i, i * 10, i, i % 2 == 0 ? "true" : "false", i % 10 == 0 ? ",\"tag\":null" : "");
+    }
+    snprintf(json + length, sizeof(json) - length, "],\"groups\":[{\"kind\":\"a\",\"x\":1,\"y\":2},{\"kind\":\"b\",\"x\":1},{\"kind\":\"a\",\"z\":1}],\"a.b\":7}");
+
+    const Json root = Test_Parse(json, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+
+    Json results[128];
+    TEST_CHECK(Test_RunQuery("$.items[?(@.id >= 60)]", root, results, 128) == 40);
+    TEST_CHECK(Test_Member(results[0], "id") == 60 && Test_Member(results[39], "id") == 99);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.id < 65)].id", root, results, 128) == 65 && results[64].number == 64);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.id != 63)]", root, results, 128) == 99);
+
+    // Nested keys from the element
+    TEST_CHECK(Test_RunQuery("$.items[?(@.v.w == 700)].id", root, results, 128) == 1 && results[0].number == 70);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.v.missing)]", root, results, 128) == 0);
+
+    // String, boolean and null literals
+    TEST_CHECK(Test_RunQuery("$.items[?(@.name == 'n5')].id", root, results, 128) == 1 && results[0].number == 5);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.name == \"n77\")].id", root, results, 128) == 1 && results[0].number == 77);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.name == 'n')]", root, results, 128) == 0);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.on == true)]", root, results, 128) == 50 && Test_Member(results[1], "id") == 2);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.on == false)]", root, results, 128) == 50 && Test_Member(results[0], "id") == 1);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.on != true)]", root, results, 128) == 50);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.tag == null)].id", root, results, 128) == 10 && results[9].number == 90);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.tag != null)]", root, results, 128) == 0);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.tag)]", root, results, 128) == 10);
+    TEST_CHECK(Test_RunQuery("$.items[?(@.id == 'n5')]", root, results, 128) == 0);
+
+    // Chained filters, the second one runs over the members of each match
+    TEST_CHECK(Test_RunQuery("$.groups[?(@.kind == 'a')][?(@ == 1)]", root, results, 128) == 2);
+    TEST_CHECK(Test_RunQuery("$.groups[?(@.kind == 'a')][?(@.x)]", root, results, 128) == 0);
+    TEST_CHECK(Test_RunQuery("$.groups[?(@.x == 1)][?(@ == 'a')]", root, results, 128) == 1);
+
+    // Bracketed keys
+    TEST_CHECK(Test_RunQuery("$['items'][3]['name']", root, results, 128) == 1 && results[0].type == JsonType_String && strcmp(results[0].string, "n3") == 0);
+    TEST_CHECK(Test_RunQuery("$[\"a.b\"]", root, results, 128) == 1 && results[0].number == 7);
+    TEST_CHECK(Test_RunQuery("$.a.b", root, results, 128) == 0);
+    TEST_CHECK(Test_RunQuery("items[*]['id']", root, results, 128) == 100);
+
+    // More matches than results, the total is still returned
+    TEST_CHECK(Test_RunQuery("$.items[?(@.id >= 60)]", root, results, 5) == 40 && Test_Member(results[4], "id") == 64);
+    TEST_CHECK(Test_RunQuery("$.items[*]", root, NULL, 0) == 100);
+
+    // Packed arrays are filtered by their numbers
+    length = snprintf(json, sizeof(json), "{\"p\":[");
+    for (int32_t i = 0; i < 100; i++)
+    {
+        length += snprintf(json + length, sizeof(json) - length, "%s%d", i > 0 ? "," : "", (i * 37) % 100);
+    }
+    snprintf(json + length, sizeof(json) - length, "],\"d\":[0.5,1.5,2.5]}");
+
+    const Json packed = Test_Parse(json, JsonParseFlags_PackNumberArrays, testBuffer2, sizeof(testBuffer2));
+    TEST_CHECK(packed.object[0].value.type == JsonType_Int32Array && packed.object[1].value.type == JsonType_NumberArray);
+    TEST_CHECK(Test_RunQuery("$.p[?(@ >= 90)]", packed, results, 128) == 10 && results[0].type == JsonType_Number && results[0].number == 96);
+    TEST_CHECK(Test_RunQuery("$.p[?(@ == 99)]", packed, results, 128) == 1);
+    TEST_CHECK(Test_RunQuery("$.p[?(@ == '99')]", packed, results, 128) == 0);
+    TEST_CHECK(Test_RunQuery("$.p[70]", packed, results, 128) == 1 && results[0].number == (70 * 37) % 100);
+    TEST_CHECK(Test_RunQuery("$.p[100]", packed, results, 128) == 0);
+    TEST_CHECK(Test_RunQuery("$.d[?(@ > 1)]", packed, results, 128) == 2 && results[0].number == 1.5);
+    TEST_CHECK(Test_RunQuery("$.d[?(@ >= -1.5e-1)]", packed, results, 128) == 3);
+    TEST_CHECK(Test_RunQuery("$.d[?(@ < 25E-1)]", packed, results, 128) == 2);
+    TEST_CHECK(Test_RunQuery("$.d[?(@ == 0)]", packed, results, 128) == 0);
+
+    // Rejected queries
+    static const struct { const char* query; JsonError error; } rejected[] = {
+        { "$.items[?(@.name < 'x')]",           JsonError_UnsupportedToken },
+        { "$.items[?(@.on >= true)]",           JsonError_UnsupportedToken },
+        { "$.items[?(@.tag > null)]",           JsonError_UnsupportedToken },
+        { "$.items[?(@.id == )]",               JsonError_WrongFormat },
+        { "$.items[?(@.id == 1]",               JsonError_WrongFormat },
+        { "$.items[?(@.id == 'x)]",             JsonError_WrongFormat },
+        { "$.items[?(@.id 1)]",                 JsonError_WrongFormat },
+        { "$.items[?(@.id > -)]",               JsonError_WrongFormat },
+        { "$.items[?(@.id > 1e)]",              JsonError_WrongFormat },
+        { "$.items[?(@.id > 1e+)]",             JsonError_WrongFormat },
+        { "$.items[?(@.id > 1.2.3)]",           JsonError_WrongFormat },
+        { "$.items[?(@.id > 1.)]",              JsonError_WrongFormat },
+        { "$.items[?(@.id > 01)]",              JsonError_WrongFormat },
+        { "$.items[?(@.id > 1-2)]",             JsonError_WrongFormat },
+        { "$.items[?(id == 1)]",                JsonError_WrongFormat },
+        { "$.items[?(@..id)]",                  JsonError_WrongFormat },
+        { "$.items[?@.id]",                     JsonError_WrongFormat },
+        { "$..items",                           JsonError_WrongFormat },
+        { "$.items[1",                          JsonError_WrongFormat },
+        { "$.items['id]",                       JsonError_WrongFormat },
+        { "$.items[-1]",                        JsonError_WrongFormat },
+        { "$.items[99999999999]",               JsonError_WrongFormat },
+        { "$[?(@.a)][?(@.a)][?(@.a)][?(@.a)][?(@.a)]", JsonError_OutOfMemory },
+        { "$[?(@.a.b.c.d.e)]",                  JsonError_OutOfMemory },
+    };
+
+    for (int32_t i = 0; i < (int32_t)(sizeof(rejected) / sizeof(rejected[0])); i++)
+    {
+        JsonQuery query;
+        const JsonError error = JsonQueryCompile(rejected[i].query, &query);
+        if (error != rejected[i].error)
+        {
+            fprintf(stderr, "query '%s' compiled with error %d\n", rejected[i].query, (int)error);
+            testFailures++;
+        }
+    }
+}
+
+// -------------------------------------------------------------------
+// Key summaries
+// -------------------------------------------------------------------
+
+/* How the summary test document is parsed */
+typedef enum TestSummaryParse
+{
+    TestSummaryParse_Plain,
+    TestSummaryParse_StringBuffer,
+    TestSummaryParse_Projected,
+} TestSummaryParse;
+
+static Json Test_ParseSummary(const char* json, JsonParseFlags flags, TestSummaryParse mode, char* buffer, int32_t bufferSize)
+{
+    Json       value = JSON_NULL;
+    JsonResult result;
+    if (mode == TestSummaryParse_StringBuffer)
+    {
+        // Strings go to the second half of the buffer
+        result = JsonParseWithStringBuffer(json, (int32_t)strlen(json), flags, buffer, bufferSize / 2, buffer + bufferSize / 2, bufferSize / 2, &value);
+    }
+    else if (mode == TestSummaryParse_Projected)
+    {
+        static const char* const paths[] = { "a.list", "c[*].deep" };
+
+        JsonProjection projection;
+        TEST_CHECK(JsonProjectionCompile(paths, 2, &projection) == JsonError_None);
+        result = JsonParseProjected(json, (int32_t)strlen(json), flags, &projection, buffer, bufferSize, &value);
+    }
+    else
+    {
+        result = JsonParse(json, (int32_t)strlen(json), flags, buffer, bufferSize, &value);
+    }
+
+    TEST_CHECK(result.error == JsonError_None);
+    return value;
+}
+
+static void Test_KeySummary(void)
+{
+    const char* json = "{\"a\":{\"b\":{\"id\":1},\"list\":[{\"id\":2},{\"name\":\"x\\ny\"},[]]},\"nums\":[1,2,3],"
+                       "\"c\":[{\"deep\":{\"id\":3,\"f\":[0.5]}},{}],\"s\":\"id\",\"\":{\"id\":4},\"e\":{}}";
+
+    static const JsonParseFlags flagSets[] = {
+        JsonParseFlags_KeySummary,
+        JsonParseFlags_KeySummary | JsonParseFlags_PackNumberArrays,
+        JsonParseFlags_KeySummary | JsonParseFlags_LazyStrings | JsonParseFlags_LazyNumbers,
+        JsonParseFlags_KeySummary | JsonParseFlags_PackNumberArrays | JsonParseFlags_LazyStrings,
+    };
+    static const char* const names[] = { "id", "name", "deep", "", "nums", "f", "missing", "i", "ids" };
+
+    // Pruned walks find exactly what full walks over the same document find
+    for (int32_t mode = TestSummaryParse_Plain; mode <= TestSummaryParse_Projected; mode++)
+    {
+        for (int32_t f = 0; f < (int32_t)(sizeof(flagSets) / sizeof(flagSets[0])); f++)
+        {
+            const JsonParseFlags flags    = flagSets[f];
+            const Json           pruned   = Test_ParseSummary(json, flags, (TestSummaryParse)mode, testBuffer, sizeof(testBuffer));
+            const Json           full     = Test_ParseSummary(json, (JsonParseFlags)(flags & ~JsonParseFlags_KeySummary), (TestSummaryParse)mode, testBuffer2, sizeof(testBuffer2));
+            TEST_CHECK(JsonEquals(pruned, full));
+
+            for (int32_t i = 0; i < (int32_t)(sizeof(names) / sizeof(names[0])); i++)
+            {
+                Json          prunedResults[8], fullResults[8];
+                const int32_t count = JsonFindAll(pruned, names[i], flags, prunedResults, 8);
+                TEST_CHECK(count == JsonFindAll(full, names[i], JsonParseFlags_Default, fullResults, 8));
+                TEST_CHECK(count == JsonFindAll(pruned, names[i], JsonParseFlags_Default, NULL, 0));
+                for (int32_t k = 0; k < count && k < 8; k++)
+                {
+                    TEST_CHECK(JsonEquals(prunedResults[k], fullResults[k]));
+                }
+            }
+        }
+    }
+
+    // Matches come in document order, the total is returned past maxResults
+    const Json root = Test_ParseSummary(json, JsonParseFlags_KeySummary, TestSummaryParse_Plain, testBuffer, sizeof(testBuffer));
+
+    Json results[8];
+    TEST_CHECK(JsonFindAll(root, "id", JsonParseFlags_KeySummary, results, 8) == 4);
+    TEST_CHECK(results[0].number == 1 && results[1].number == 2 && results[2].number == 3 && results[3].number == 4);
+    TEST_CHECK(JsonFindAll(root, "id", JsonParseFlags_KeySummary, results, 2) == 4 && results[1].number == 2);
+    TEST_CHECK(JsonFindAll(root, "name", JsonParseFlags_KeySummary, results, 8) == 1 && strcmp(results[0].string, "x\ny") == 0);
+    TEST_CHECK(JsonFindAll(root, "", JsonParseFlags_KeySummary, results, 8) == 1 && results[0].type == JsonType_Object);
+    TEST_CHECK(JsonFindAll(root, "missing", JsonParseFlags_KeySummary, results, 8) == 0);
+
+    const Json projected = Test_ParseSummary(json, JsonParseFlags_KeySummary, TestSummaryParse_Projected, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonFindAll(projected, "id", JsonParseFlags_KeySummary, results, 8) == 2 && results[0].number == 2 && results[1].number == 3);
+    TEST_CHECK(JsonFindAll(projected, "nums", JsonParseFlags_KeySummary, results, 8) == 0);
+
+    // Values without keys are walked without a summary
+    const Json scalar = Test_Parse("[1,[2,[3]],\"id\"]", JsonParseFlags_KeySummary | JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonFindAll(scalar, "id", JsonParseFlags_KeySummary, results, 8) == 0);
+    TEST_CHECK(JsonFindAll(JSON_TRUE, "id", JsonParseFlags_KeySummary, results, 8) == 0);
+}
+
+// -------------------------------------------------------------------
+// Struct bindings
+// -------------------------------------------------------------------
+
+typedef struct TestPoint
+{
+    int32_t x;
+    double  y;
+} TestPoint;
+
+#define TEST_POINT_FIELDS(FIELD) FIELD(TestPoint, x, "x", Int32, true) FIELD(TestPoint, y, "y", Double, false)
+static const JsonFieldDesc TestPointFields[] = { TEST_POINT_FIELDS(JSON_FIELD) };
+static JsonStructDesc      TestPointDesc     = JSON_STRUCT_DESC(TestPoint, TestPointFields);
+
+typedef struct TestItem
+{
+    const char* name;
+    TestPoint   at;
+    bool        on;
+} TestItem;
+
+static const JsonFieldDesc TestItemFields[] = {
+    JSON_FIELD(TestItem, name, "name", String, true)
+    JSON_FIELD_STRUCT(TestItem, at, "at", TestPointDesc, false)
+    JSON_FIELD(TestItem, on, "on", Boolean, false)
+};
+static JsonStructDesc      TestItemDesc      = JSON_STRUCT_DESC(TestItem, TestItemFields);
+
+static void Test_StructBindings(void)
+{
+    const Json rows = Test_Parse("[{\"x\":1,\"xy\":9},{\"x\":1.5},{\"xy\":3,\"x\":-4},{\"x\":4294967296},{\"\":1}]", JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+
+    TestPoint point;
+    TEST_CHECK(JsonStructDescInit(&TestPointDesc) == JsonError_None);
+    TEST_CHECK(JsonDecodeStruct(rows.array[2], &TestPointDesc, &point) == JsonError_None && point.x == -4);
+    TEST_CHECK(JsonDecodeStruct(rows.array[1], &TestPointDesc, &point) == JsonError_WrongType);
+
+    // Decoding then encoding gives the same object back, nested structs included
+    const char* text = "{\"name\":\"a\\\"b\",\"at\":{\"x\":1,\"y\":2.5},\"on\":true}";
+    const Json  object = Test_Parse(text, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+
+    TestItem item;
+    TEST_CHECK(JsonStructDescInit(&TestItemDesc) == JsonError_None);
+    TEST_CHECK(JsonDecodeStruct(object, &TestItemDesc, &item) == JsonError_None);
+    TEST_CHECK(strcmp(item.name, "a\"b") == 0 && item.at.x == 1 && item.at.y == 2.5 && item.on);
+
+    JsonObjectMember members[5];
+    Json             encoded;
+    TEST_CHECK(JsonEncodeStruct(&item, &TestItemDesc, members, 5, &encoded) == JsonError_None);
+    TEST_CHECK(JsonEquals(encoded, object));
+    TEST_CHECK(JsonStringify(encoded, JsonStringifyFlags_None, testBuffer2, sizeof(testBuffer2)) > 0 && strcmp(testBuffer2, text) == 0);
+    TEST_CHECK(JsonEncodeStruct(&item, &TestItemDesc, members, 4, &encoded) == JsonError_OutOfMemory);
+
+    // Lazy strings are not null-terminated, so String fields reject them
+    const Json lazy = Test_Parse(text, JsonParseFlags_LazyStrings, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonDecodeStruct(lazy, &TestItemDesc, &item) == JsonError_WrongType && item.name == NULL && item.at.x == 1);
+
+    const Json empty = Test_Parse("{\"name\":\"\"}", JsonParseFlags_LazyStrings, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonDecodeStruct(empty, &TestItemDesc, &item) == JsonError_None && strcmp(item.name, "") == 0);
+}
+
+// -------------------------------------------------------------------
+// Parsing into structs
+// -------------------------------------------------------------------
+
+typedef struct TestShape
+{
+    const char* name;
+    TestPoint   origin;
+    int32_t*    ids;
+    int32_t     idCount;
+    TestPoint*  points;
+    int32_t     pointCount;
+    Json        meta;
+} TestShape;
+
+static const JsonFieldDesc TestShapeFields[] = {
+    JSON_FIELD(TestShape, name, "name", String, true)
+    JSON_FIELD_STRUCT(TestShape, origin, "origin", TestPointDesc, false)
+    JSON_FIELD_ARRAY(TestShape, ids, idCount, "ids", Int32, false)
+    JSON_FIELD_STRUCT_ARRAY(TestShape, points, pointCount, "points", TestPointDesc, false)
+    JSON_FIELD(TestShape, meta, "meta", Value, false)
+};
+static JsonStructDesc      TestShapeDesc     = JSON_STRUCT_DESC(TestShape, TestShapeFields);
+
+typedef struct TestSeries
+{
+    int32_t*    ids;
+    int32_t     idCount;
+    double*     values;
+    int32_t     valueCount;
+    Json*       tags;
+    int32_t     tagCount;
+    float*      weights;
+    int32_t     weightCount;
+} TestSeries;
+
+static const JsonFieldDesc TestSeriesFields[] = {
+    JSON_FIELD_ARRAY(TestSeries, ids, idCount, "ids", Int32, false)
+    JSON_FIELD_ARRAY(TestSeries, values, valueCount, "values", Double, false)
+    JSON_FIELD_ARRAY(TestSeries, tags, tagCount, "tags", Value, false)
+    JSON_FIELD_ARRAY(TestSeries, weights, weightCount, "weights", Float, false)
+};
+static JsonStructDesc      TestSeriesDesc    = JSON_STRUCT_DESC(TestSeries, TestSeriesFields);
+
+/* JsonParseStruct into shape, which starts out filled with garbage */
+static JsonError Test_ParseShape(const char* text, TestShape* shape, int32_t bufferSize)
+{
+    memset(shape, 0x55, sizeof(*shape));
+    return JsonParseStruct(text, (int32_t)strlen(text), JsonParseFlags_Default, &TestShapeDesc, testBuffer2, bufferSize, shape).error;
+}
+
+static void Test_ParseStruct(void)
+{
+    TestPoint point;
+    const char* text = "{\"x\":2.5,\"y\":1}";
+    TEST_CHECK(JsonParseStruct(text, (int32_t)strlen(text), JsonParseFlags_Default, &TestPointDesc, testBuffer2, sizeof(testBuffer2), &point).error == JsonError_WrongType);
+
+    // Every kind of field, unknown keys are skipped whatever they hold
+    TestShape shape;
+    TEST_CHECK(JsonStructDescInit(&TestShapeDesc) == JsonError_None);
+    TEST_CHECK(Test_ParseShape("{\"skip\":{\"a\":[1,{\"b\":\"]}\"}]},\"name\":\"tri\",\"origin\":{\"y\":0.5,\"x\":1},\"ids\":[1,-2,3],"
+                               "\"points\":[{\"x\":0},{\"x\":1,\"y\":1},{\"y\":2,\"x\":2}],\"meta\":{\"k\":[true]},\"z\":null}", &shape, sizeof(testBuffer2)) == JsonError_None);
+    TEST_CHECK(strcmp(shape.name, "tri") == 0 && shape.origin.x == 1 && shape.origin.y == 0.5);
+    TEST_CHECK(shape.idCount == 3 && shape.ids[0] == 1 && shape.ids[1] == -2 && shape.ids[2] == 3);
+    TEST_CHECK(shape.pointCount == 3 && shape.points[0].x == 0 && shape.points[0].y == 0 && shape.points[1].y == 1 && shape.points[2].x == 2 && shape.points[2].y == 2);
+    TEST_CHECK(shape.meta.type == JsonType_Object && shape.meta.length == 1 && shape.meta.object[0].value.array[0].boolean);
+
+    // Missing and null optional fields are zeroed, empty strings are not NULL
+    TEST_CHECK(Test_ParseShape("{\"name\":\"\",\"origin\":null,\"ids\":null,\"points\":[]}", &shape, sizeof(testBuffer2)) == JsonError_None);
+    TEST_CHECK(shape.name && shape.name[0] == 0 && shape.origin.x == 0 && shape.origin.y == 0);
+    TEST_CHECK(shape.ids == NULL && shape.idCount == 0 && shape.points == NULL && shape.pointCount == 0 && shape.meta.type == JsonType_Null);
+
+    // Escaped keys are decoded before they are matched
+    TEST_CHECK(Test_ParseShape("{\"n\\u0061me\":\"a\\u00e9\",\"\\u006frigin\":{\"\\u0078\":7}}", &shape, sizeof(testBuffer2)) == JsonError_None);
+    TEST_CHECK(strcmp(shape.name, "a\xc3\xa9") == 0 && shape.origin.x == 7);
+
+    // Struct arrays grow on the upper stack, then move down once their count is known
+    int32_t length = snprintf(testBuffer, sizeof(testBuffer), "{\"name\":\"many\",\"points\":[");
+    for (int32_t i = 0; i < 1000; i++)
+    {
+        length += snprintf(testBuffer + length, sizeof(testBuffer) - length, "%s{\"x\":%d,\"y\":%d.5}", i > 0 ? "," : "", i, -i);
+    }
+    snprintf(testBuffer + length, sizeof(testBuffer) - length, "],\"ids\":[%d]}", 42);
+
+    memset(&shape, 0, sizeof(shape));
+    const JsonResult result = JsonParseStruct(testBuffer, (int32_t)strlen(testBuffer), JsonParseFlags_Default, &TestShapeDesc, testBuffer2, sizeof(testBuffer2), &shape);
+    TEST_CHECK(result.error == JsonError_None && result.memoryUsage >= 1000 * (int32_t)sizeof(TestPoint));
+    TEST_CHECK(shape.pointCount == 1000 && shape.points[999].x == 999 && shape.points[999].y == -999.5);
+    TEST_CHECK(shape.idCount == 1 && shape.ids[0] == 42 && (char*)shape.ids >= (char*)(shape.points + 1000));
+
+    bool ordered = true;
+    for (int32_t i = 0; i < shape.pointCount; i++)
+    {
+        ordered = ordered && shape.points[i].x == i;
+    }
+    TEST_CHECK(ordered);
+    TEST_CHECK(Test_ParseShape(testBuffer, &shape, 1000 * (int32_t)sizeof(TestPoint)) == JsonError_OutOfMemory);
+
+    // Errors
+    static const struct { const char* text; JsonError error; } rejected[] = {
+        { "{\"origin\":{\"x\":1}}",                     JsonError_MissingField },
+        { "{\"name\":\"a\",\"origin\":{\"y\":1}}",      JsonError_MissingField },
+        { "{\"name\":null}",                            JsonError_WrongType },
+        { "{\"name\":\"a\",\"origin\":{\"x\":null}}",   JsonError_WrongType },
+        { "{\"name\":1}",                               JsonError_WrongType },
+        { "{\"name\":\"a\",\"origin\":[1]}",            JsonError_WrongType },
+        { "{\"name\":\"a\",\"ids\":[1,\"2\"]}",         JsonError_WrongType },
+        { "{\"name\":\"a\",\"ids\":[1.5]}",             JsonError_WrongType },
+        { "{\"name\":\"a\",\"ids\":{}}",                JsonError_WrongType },
+        { "{\"name\":\"a\",\"points\":[1]}",            JsonError_WrongType },
+        { "{\"name\":\"a\"} x",                         JsonError_WrongFormat },
+        { "{\"name\":\"a\"},",                          JsonError_WrongFormat },
+        { "[{\"name\":\"a\"}]",                         JsonError_WrongFormat },
+        { "{\"name\":\"a\",\"ids\":[1,2}",              JsonError_UnmatchToken },
+        { "{\"name\":\"a\",\"skip\":[1}]}",            JsonError_UnmatchToken },
+        { "{\"name\":\"a\",\"skip\":{\"b\":[1}}}",       JsonError_UnmatchToken },
+    };
+
+    for (int32_t i = 0; i < (int32_t)(sizeof(rejected) / sizeof(rejected[0])); i++)
+    {
+        const JsonError error = Test_ParseShape(rejected[i].text, &shape, sizeof(testBuffer2));
+        if (error != rejected[i].error)
+        {
+            fprintf(stderr, "struct '%s' parsed with error %d\n", rejected[i].text, (int)error);
+            testFailures++;
+        }
+    }
+
+    // Int32, Double and Value arrays encode as views over their elements, the others cannot be encoded without storage
+    TestSeries series;
+    const char* seriesText = "{\"ids\":[1,-2],\"values\":[0.5,2.25],\"tags\":[\"a\",{\"b\":null}],\"weights\":null}";
+    TEST_CHECK(JsonStructDescInit(&TestSeriesDesc) == JsonError_None);
+    TEST_CHECK(JsonParseStruct(seriesText, (int32_t)strlen(seriesText), JsonParseFlags_Default, &TestSeriesDesc, testBuffer2, sizeof(testBuffer2), &series).error == JsonError_None);
+
+    JsonObjectMember members[4];
+    Json             encoded;
+    TEST_CHECK(JsonEncodeStruct(&series, &TestSeriesDesc, members, 4, &encoded) == JsonError_None);
+    TEST_CHECK(members[0].value.type == JsonType_Int32Array && members[0].value.int32Array == series.ids);
+    TEST_CHECK(members[1].value.type == JsonType_NumberArray && members[1].value.numberArray == series.values);
+    TEST_CHECK(JsonStringify(encoded, JsonStringifyFlags_None, testBuffer, sizeof(testBuffer)) > 0 && strcmp(testBuffer, seriesText) == 0);
+
+    const float weights[] = { 1.0f };
+    series.weights     = (float*)weights;
+    series.weightCount = 1;
+    TEST_CHECK(JsonEncodeStruct(&series, &TestSeriesDesc, members, 4, &encoded) == JsonError_InvalidValue && encoded.type == JsonType_Null);
+
+    TEST_CHECK(Test_ParseShape("{\"name\":\"a\",\"points\":[{\"x\":1}]}", &shape, sizeof(testBuffer2)) == JsonError_None);
+    JsonObjectMember shapeMembers[8];
+    TEST_CHECK(JsonEncodeStruct(&shape, &TestShapeDesc, shapeMembers, 8, &encoded) == JsonError_InvalidValue);
+}
+
+// -------------------------------------------------------------------
+// Serialization
+// -------------------------------------------------------------------
+
+/* Sink appending to testBuffer2, user is the write offset */
+static bool Test_SinkAppend(void* user, const char* data, int32_t length)
+{
+    int32_t* offset = (int32_t*)user;
+    if (*offset + length >= (int32_t)sizeof(testBuffer2))
+    {
+        return false;
+    }
+
+    memcpy(testBuffer2 + *offset, data, (size_t)length);
+    *offset += length;
+    testBuffer2[*offset] = 0;
+    return true;
+}
+
+static void Test_Stringify(void)
+{
+    // Every ASCII character and some UTF-8, starting at each offset of the 8 byte blocks
+    char source[256];
+    for (int32_t shift = 0; shift < 8; shift++)
+    {
+        int32_t length = 0;
+        for (int32_t i = 0; i < shift; i++)
+        {
+            source[length++] = 'a';
+        }
+        for (int32_t c = 1; c < 128; c++)
+        {
+            source[length++] = (char)c;
+        }
+        strcpy(source + length, "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+
+        Json element;
+        element.type   = JsonType_String;
+        element.length = length + 9;
+        element.string = source;
+
+        Json array;
+        array.type   = JsonType_Array;
+        array.length = 1;
+        array.array  = &element;
+        TEST_CHECK(JsonStringify(array, JsonStringifyFlags_None, testBuffer2, sizeof(testBuffer2)) > 0);
+
+        bool raw = false;
+        for (const char* c = testBuffer2; *c; c++)
+        {
+            raw = raw || (unsigned char)*c < 0x20;
+        }
+        TEST_CHECK(!raw && memcmp(testBuffer2 + 2 + shift, "\\u0001\\u0002", 12) == 0);
+
+        // The text also parses back to the same string
+        const Json value = Test_Parse(testBuffer2, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+        TEST_CHECK(value.type == JsonType_Array && value.length == 1 && strcmp(value.array[0].string, source) == 0);
+    }
+
+    // Short escapes where JSON has them, \u00XX for the other control characters
+    const char* escaped = "[\"\\\"\\\\\\b\\f\\n\\r\\t\\u0001\\u001f/\\u00e9\"]";
+    Json value = Test_Parse(escaped, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonStringify(value, JsonStringifyFlags_None, testBuffer2, sizeof(testBuffer2)) > 0);
+    TEST_CHECK(strcmp(testBuffer2, "[\"\\\"\\\\\\b\\f\\n\\r\\t\\u0001\\u001f/\xc3\xa9\"]") == 0);
+
+    // Sinks get the same text in chunks, fixed buffers keep a terminated prefix and report the full length
+    const char* text = "[\"a\\u0002b\",-1.5,true,null,{\"k\":[1,2,{}],\"\":\"\"}]";
+    value = Test_Parse(text, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+    const int32_t length = JsonStringify(value, JsonStringifyFlags_None, testBuffer2, sizeof(testBuffer2));
+    TEST_CHECK(length == (int32_t)strlen(text) && strcmp(testBuffer2, text) == 0);
+
+    char small[8];
+    TEST_CHECK(JsonStringify(value, JsonStringifyFlags_None, small, sizeof(small)) == length);
+    TEST_CHECK(strncmp(small, text, sizeof(small) - 1) == 0 && small[sizeof(small) - 1] == 0);
+
+    // A buffer without room is left alone, not even terminated
+    memset(small, '#', sizeof(small));
+    TEST_CHECK(JsonStringify(value, JsonStringifyFlags_None, small, 0) == length);
+    TEST_CHECK(small[0] == '#' && small[sizeof(small) - 1] == '#');
+
+    static char big[3 * JSON_STRINGIFY_CHUNK_SIZE];
+    memset(big, 'x', sizeof(big) - 1);
+    big[0] = '[';
+    big[1] = '"';
+    big[sizeof(big) - 3] = '"';
+    big[sizeof(big) - 2] = ']';
+    value = Test_Parse(big, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+
+    int32_t offset = 0;
+    TEST_CHECK(JsonStringifyToSink(value, JsonStringifyFlags_None, Test_SinkAppend, &offset) == (int32_t)strlen(big));
+    TEST_CHECK(offset == (int32_t)strlen(big) && strcmp(testBuffer2, big) == 0);
+
+    offset = (int32_t)sizeof(testBuffer2) - 16;
+    TEST_CHECK(JsonStringifyToSink(value, JsonStringifyFlags_None, Test_SinkAppend, &offset) == -1);
+
+    // Negative zero keeps its sign in packed arrays
+    value = Test_Parse("[-0,1]", JsonParseFlags_PackNumberArrays, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(JsonStringify(value, JsonStringifyFlags_None, small, sizeof(small)) == 6 && strcmp(small, "[-0,1]") == 0);
+}
+
+// -------------------------------------------------------------------
+// Number formatting
+// -------------------------------------------------------------------
+
+/* Text of one number written by JsonStringify */
+static const char* Test_FormatNumber(double number, char* buffer, int32_t bufferSize)
+{
+    Json value;
+    memset(&value, 0, sizeof(value));
+    value.type   = JsonType_Number;
+    value.number = number;
+    TEST_CHECK(JsonStringify(value, JsonStringifyFlags_None, buffer, bufferSize) > 0);
+    return buffer;
+}
+
+static void Test_NumberFormat(void)
+{
+    static const struct { double number; const char* text; } cases[] = {
+        { 0.0, "0" }, { -0.0, "-0" }, { 1.0, "1" }, { 100.0, "100" }, { 0.1, "0.1" }, { -2.5e-7, "-2.5e-7" },
+        { 1.0 / 3.0, "0.3333333333333333" }, { 1e21, "1e21" }, { 5e-324, "5e-324" },
+        { 1.7976931348623157e308, "1.7976931348623157e308" }, { 2.2250738585072014e-308, "2.2250738585072014e-308" },
+    };
+
+    char text[64];
+    for (int32_t i = 0; i < (int32_t)(sizeof(cases) / sizeof(cases[0])); i++)
+    {
+        TEST_CHECK(strcmp(Test_FormatNumber(cases[i].number, text, sizeof(text)), cases[i].text) == 0);
+    }
+
+    // Not representable in JSON
+    TEST_CHECK(strcmp(Test_FormatNumber(HUGE_VAL, text, sizeof(text)), "null") == 0);
+
+    // Random bit patterns are written and parsed back to the same double
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    for (int32_t i = 0; i < 100000; i++)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+        double   number;
+        uint64_t bits = state ^ (state >> 29);
+        memcpy(&number, &bits, sizeof(number));
+        if (number != number || number - number != 0)
+        {
+            continue;
+        }
+
+        char json[80] = "[";
+        strcat(json, Test_FormatNumber(number, text, sizeof(text)));
+        strcat(json, "]");
+
+        const Json     value = Test_Parse(json, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+        const double   back  = value.type == JsonType_Array && value.length == 1 ? value.array[0].number : 0;
+        uint64_t       backBits;
+        memcpy(&backBits, &back, sizeof(backBits));
+        if (backBits != bits)
+        {
+            fprintf(stderr, "number %s does not round-trip\n", json);
+            testFailures++;
+        }
+    }
+}
+
+// -------------------------------------------------------------------
+// Streaming writer
+// -------------------------------------------------------------------
+
+/* Grow callback over realloc */
+static void* Test_Grow(void* user, void* buffer, int32_t size)
+{
+    (*(int32_t*)user)++;
+    return realloc(buffer, (size_t)size);
+}
+
+static void Test_Writer(void)
+{
+    char       text[256];
+    JsonWriter writer;
+
+    JsonWriterInit(&writer, JsonStringifyFlags_None, text, sizeof(text));
+    TEST_CHECK(JsonWriterBeginObject(&writer));
+    TEST_CHECK(JsonWriterKey(&writer, "a", -1) && JsonWriterNumber(&writer, 1));
+    TEST_CHECK(JsonWriterKey(&writer, "b\"c", 3) && JsonWriterBeginArray(&writer));
+    TEST_CHECK(JsonWriterBoolean(&writer, true) && JsonWriterNull(&writer) && JsonWriterString(&writer, "x\ny", -1));
+    TEST_CHECK(JsonWriterValue(&writer, Test_Parse("{\"d\":[]}", JsonParseFlags_Default, testBuffer, sizeof(testBuffer))));
+    TEST_CHECK(JsonWriterEndArray(&writer) && JsonWriterEndObject(&writer));
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_None);
+    TEST_CHECK(strcmp(text, "{\"a\":1,\"b\\\"c\":[true,null,\"x\\ny\",{\"d\":[]}]}") == 0 && writer.length == (int32_t)strlen(text));
+
+    // Misplaced calls fail, the first error is kept and later calls are still checked
+    JsonWriterInit(&writer, JsonStringifyFlags_None, text, sizeof(text));
+    TEST_CHECK(!JsonWriterKey(&writer, "a", -1));
+    TEST_CHECK(JsonWriterBeginArray(&writer));
+    TEST_CHECK(!JsonWriterEndObject(&writer));
+    TEST_CHECK(JsonWriterEndArray(&writer));
+    TEST_CHECK(!JsonWriterNull(&writer));
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_UnexpectedToken);
+
+    JsonWriterInit(&writer, JsonStringifyFlags_None, text, sizeof(text));
+    TEST_CHECK(JsonWriterBeginObject(&writer));
+    TEST_CHECK(!JsonWriterNumber(&writer, 1));
+    TEST_CHECK(JsonWriterKey(&writer, "a", -1));
+    TEST_CHECK(!JsonWriterKey(&writer, "b", -1));
+    TEST_CHECK(!JsonWriterEndObject(&writer));
+    TEST_CHECK(JsonWriterNumber(&writer, 1) && JsonWriterEndObject(&writer));
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_UnexpectedToken);
+
+    JsonWriterInit(&writer, JsonStringifyFlags_None, text, sizeof(text));
+    TEST_CHECK(!JsonWriterEndArray(&writer));
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_UnmatchToken);
+
+    JsonWriterInit(&writer, JsonStringifyFlags_None, text, sizeof(text));
+    TEST_CHECK(JsonWriterBeginArray(&writer) && JsonWriterBeginObject(&writer));
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_UnmatchToken);
+
+    JsonWriterInit(&writer, JsonStringifyFlags_None, text, sizeof(text));
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_UnmatchToken);
+
+    JsonWriterInit(&writer, JsonStringifyFlags_None, testBuffer2, sizeof(testBuffer2));
+    for (int32_t i = 0; i < JSON_WRITER_MAX_DEPTH; i++)
+    {
+        JsonWriterBeginArray(&writer);
+    }
+    TEST_CHECK(writer.error == JsonError_None && !JsonWriterBeginArray(&writer));
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_OutOfMemory);
+
+    // Fixed buffers drop what does not fit and count it
+    char small[4];
+    JsonWriterInit(&writer, JsonStringifyFlags_None, small, sizeof(small));
+    TEST_CHECK(JsonWriterString(&writer, "abcdef", -1));
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_OutOfMemory && writer.length == 8 && strcmp(small, "\"ab") == 0);
+
+    // Growable buffers start empty and are enlarged on demand
+    int32_t grows = 0;
+    JsonWriterInitWithGrow(&writer, JsonStringifyFlags_None, NULL, 0, Test_Grow, &grows);
+    JsonWriterBeginArray(&writer);
+    for (int32_t i = 0; i < 2 * JSON_STRINGIFY_CHUNK_SIZE; i++)
+    {
+        JsonWriterNumber(&writer, i);
+    }
+    JsonWriterEndArray(&writer);
+    TEST_CHECK(JsonWriterFinish(&writer) == JsonError_None && grows >= 2);
+
+    const Json value = Test_Parse(writer.buffer, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+    TEST_CHECK(value.type == JsonType_Array && value.length == 2 * JSON_STRINGIFY_CHUNK_SIZE && value.array[value.length - 1].number == value.length - 1);
+    free(writer.buffer);
+}
+
+// -------------------------------------------------------------------
+// Pretty printing
+// -------------------------------------------------------------------
+
+/* Length of the longest line of text */
+static int32_t Test_LongestLine(const char* text)
+{
+    int32_t longest = 0;
+    for (const char* line = text; ; )
+    {
+        const char*   lineEnd = strchr(line, '\n');
+        const int32_t length  = lineEnd ? (int32_t)(lineEnd - line) : (int32_t)strlen(line);
+        longest = length > longest ? length : longest;
+        if (!lineEnd)
+        {
+            return longest;
+        }
+        line = lineEnd + 1;
+    }
+}
+
+static void Test_PrettyPrint(void)
+{
+    const Json value = Test_Parse("{\"a\":[1,2,{\"b\":\"x\"}],\"c\":{\"d\":[]},\"e\":[[1,2],[3,4]]}", JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+
+    // Containers stay on one line when they fit in the rest of it
+    static const struct { int32_t lineWidth; const char* text; } layouts[] = {
+        { 0,  "{\n  \"a\" : [\n    1,\n    2,\n    {\n      \"b\" : \"x\"\n    }\n  ],\n  \"c\" : {\n    \"d\" : []\n  },\n"
+              "  \"e\" : [\n    [\n      1,\n      2\n    ],\n    [\n      3,\n      4\n    ]\n  ]\n}" },
+        { 20, "{\n  \"a\" : [\n    1,\n    2,\n    {\"b\" : \"x\"}\n  ],\n  \"c\" : {\"d\" : []},\n  \"e\" : [\n    [1, 2],\n    [3, 4]\n  ]\n}" },
+        { 30, "{\n  \"a\" : [1, 2, {\"b\" : \"x\"}],\n  \"c\" : {\"d\" : []},\n  \"e\" : [[1, 2], [3, 4]]\n}" },
+        { 80, "{\"a\" : [1, 2, {\"b\" : \"x\"}], \"c\" : {\"d\" : []}, \"e\" : [[1, 2], [3, 4]]}" },
+    };
+
+    char text[512];
+    for (int32_t i = 0; i < (int32_t)(sizeof(layouts) / sizeof(layouts[0])); i++)
+    {
+        const JsonPrintOptions options = { 2, layouts[i].lineWidth };
+        TEST_CHECK(JsonStringifyPretty(value, &options, text, sizeof(text)) == (int32_t)strlen(layouts[i].text));
+        TEST_CHECK(strcmp(text, layouts[i].text) == 0);
+        TEST_CHECK(layouts[i].lineWidth == 0 || Test_LongestLine(text) <= layouts[i].lineWidth);
+    }
+
+    // The default layout indents by 4 spaces
+    TEST_CHECK(JsonStringify(value, JsonStringifyFlags_Pretty, text, sizeof(text)) > 0 && strncmp(text, "{\n    \"a\" : [\n        1,", 24) == 0);
+
+    // Writers keep their own layout state, interleaving them does not mix indents
+    char       other[512];
+    JsonWriter narrow, wide;
+    const JsonPrintOptions narrowOptions = { 1, 0 };
+    const JsonPrintOptions wideOptions   = { 8, 0 };
+    JsonWriterInit(&narrow, JsonStringifyFlags_None, text, sizeof(text));
+    JsonWriterInit(&wide, JsonStringifyFlags_None, other, sizeof(other));
+    JsonWriterSetPrintOptions(&narrow, &narrowOptions);
+    JsonWriterSetPrintOptions(&wide, &wideOptions);
+
+    JsonWriterBeginArray(&narrow);
+    JsonWriterBeginArray(&wide);
+    JsonWriterBeginArray(&narrow);
+    JsonWriterNumber(&wide, 1);
+    JsonWriterNumber(&narrow, 2);
+    JsonWriterEndArray(&wide);
+    JsonWriterEndArray(&narrow);
+    JsonWriterEndArray(&narrow);
+    TEST_CHECK(JsonWriterFinish(&narrow) == JsonError_None && strcmp(text, "[\n [\n  2\n ]\n]") == 0);
+    TEST_CHECK(JsonWriterFinish(&wide) == JsonError_None && strcmp(other, "[\n        1\n]") == 0);
+}
+
+// -------------------------------------------------------------------
+// Minify and reformat
+// -------------------------------------------------------------------
+
+static JsonError Test_Minify(const char* json, JsonParseFlags flags)
+{
+    int32_t length = -1;
+    const JsonError error = JsonMinify(json, (int32_t)strlen(json), flags, testBuffer, sizeof(testBuffer), &length);
+    TEST_CHECK(length >= 0);
+    return error;
+}
+
+static void Test_Reformat(void)
+{
+    // Same output as stringifying the parsed document
+    const char*            text    = " { \"a\" : [ 1, -2.5e+3, 0, 1E5, \"x\\\"y\\u00e9\" ] ,\n \"b\" : { \"c\" : [ true, false, null ], \"d\" : {} }, \"e\" : [] } ";
+    const JsonPrintOptions options = { 2, 0 };
+    static char            expected[4096];
+    int32_t                length  = -1;
+
+    Json value = Test_Parse(text, JsonParseFlags_LazyNumbers | JsonParseFlags_LazyStrings, testBuffer2, sizeof(testBuffer2));
+    const int32_t minifiedLength = JsonStringify(value, JsonStringifyFlags_None, expected, sizeof(expected));
+    TEST_CHECK(Test_Minify(text, JsonParseFlags_Default) == JsonError_None && strcmp(testBuffer, expected) == 0);
+
+    JsonStringifyPretty(value, &options, expected, sizeof(expected));
+    TEST_CHECK(JsonReformat(text, (int32_t)strlen(text), JsonParseFlags_Default, &options, testBuffer, sizeof(testBuffer), &length) == JsonError_None);
+    TEST_CHECK(strcmp(testBuffer, expected) == 0 && length == (int32_t)strlen(expected));
+
+    // Too small buffers keep the full length and a terminated prefix
+    char small[10];
+    TEST_CHECK(JsonMinify(text, (int32_t)strlen(text), JsonParseFlags_Default, small, sizeof(small), &length) == JsonError_OutOfMemory);
+    TEST_CHECK(length == minifiedLength && strlen(small) == sizeof(small) - 1);
+
+    // Comments are dropped with JsonParseFlags_SupportComment, and rejected without
+    const char* commented = "// header\n{ /* a */ \"a\" : [1, /**/ 2 ], // tail\n \"b\\\"\" : { } , \"c\": \"x // y\"} /* end */ ";
+    TEST_CHECK(Test_Minify(commented, JsonParseFlags_SupportComment) == JsonError_None);
+    TEST_CHECK(strcmp(testBuffer, "{\"a\":[1,2],\"b\\\"\":{},\"c\":\"x // y\"}") == 0);
+    TEST_CHECK(Test_Minify(commented, JsonParseFlags_Default) == JsonError_UnknownToken);
+    TEST_CHECK(JsonReformat(commented, (int32_t)strlen(commented), JsonParseFlags_SupportComment, &options, testBuffer, sizeof(testBuffer), &length) == JsonError_None);
+    TEST_CHECK(strcmp(testBuffer, "{\n  \"a\" : [\n    1,\n    2\n  ],\n  \"b\\\"\" : {},\n  \"c\" : \"x // y\"\n}") == 0);
+
+    TEST_CHECK(Test_Minify(" 12 ", JsonParseFlags_Default) == JsonError_None && strcmp(testBuffer, "12") == 0);
+
+    const char* bad[] = {
+        "", "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":1,}", "{1:2}", "[1]]", "[1", "\"abc", "[1]/* x", "{\"a\"}", "[,1]", "1 2", "[@]",
+        "[nul]", "[tru, fals]", "[nullnull]", "[truex]", "[1.2.3]", "[--1]", "[1e]", "[1e+]", "[1.]", "[.5]", "[01]", "[-]", "[+1]", "[1x]",
+        "{\"a\":0x12}", "[\"a\\q\"]", "[\"\\u12g4\"]", "[\"\\u12\"]", "[\"a\tb\"]",
+    };
+    for (int32_t i = 0; i < (int32_t)(sizeof(bad) / sizeof(bad[0])); i++)
+    {
+        const JsonError error = Test_Minify(bad[i], JsonParseFlags_SupportComment);
+        if (error == JsonError_None)
+        {
+            fprintf(stderr, "minify accepted '%s'\n", bad[i]);
+        }
+        TEST_CHECK(error != JsonError_None);
+    }
+
+    // Nesting is bounded by JSON_WRITER_MAX_DEPTH, not by a word of bits
+    char* deep = (char*)malloc(2 * JSON_WRITER_MAX_DEPTH + 3);
+    memset(deep, '[', JSON_WRITER_MAX_DEPTH);
+    memset(deep + JSON_WRITER_MAX_DEPTH, ']', JSON_WRITER_MAX_DEPTH);
+    deep[2 * JSON_WRITER_MAX_DEPTH] = 0;
+    TEST_CHECK(Test_Minify(deep, JsonParseFlags_Default) == JsonError_None && strcmp(testBuffer, deep) == 0);
+    const JsonPrintOptions flat = { 0, 0 };
+    TEST_CHECK(JsonReformat(deep, 2 * JSON_WRITER_MAX_DEPTH, JsonParseFlags_Default, &flat, testBuffer, sizeof(testBuffer), &length) == JsonError_None);
+
+    memset(deep, '[', JSON_WRITER_MAX_DEPTH + 1);
+    memset(deep + JSON_WRITER_MAX_DEPTH + 1, ']', JSON_WRITER_MAX_DEPTH + 1);
+    deep[2 * JSON_WRITER_MAX_DEPTH + 2] = 0;
+    TEST_CHECK(Test_Minify(deep, JsonParseFlags_Default) == JsonError_OutOfMemory);
+    free(deep);
+
+    // 70 levels, deeper than one word of bits
+    char seventy[2 * 70 + 2];
+    memset(seventy, '[', 70);
+    seventy[70] = '1';
+    memset(seventy + 71, ']', 70);
+    seventy[141] = 0;
+    TEST_CHECK(Test_Minify(seventy, JsonParseFlags_Default) == (JSON_WRITER_MAX_DEPTH >= 70 ? JsonError_None : JsonError_OutOfMemory));
+    TEST_CHECK(JSON_WRITER_MAX_DEPTH < 70 || strcmp(testBuffer, seventy) == 0);
+}
+
+// -------------------------------------------------------------------
+// Validation
+// -------------------------------------------------------------------
+
+static JsonError Test_Validate(const char* json, int32_t* outErrorOffset)
+{
+    return JsonValidate(json, (int32_t)strlen(json), JsonParseFlags_Default, outErrorOffset);
+}
+
+static void Test_Validation(void)
+{
+    const char* good[] = {
+        "{}", "[]", " [1, -0.5e+3, 0, 1E5, \"a\\u00e9\\n\\/\", true, false, null, {\"k\":[{}]}] ",
+        "{\"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\":\"\xef\xbf\xbf\"}", "[\"\xf4\x8f\xbf\xbf\"]", "[[[[[]]]]]",
+    };
+    for (int32_t i = 0; i < (int32_t)(sizeof(good) / sizeof(good[0])); i++)
+    {
+        int32_t offset = 0;
+        TEST_CHECK(Test_Validate(good[i], &offset) == JsonError_None && offset == -1);
+    }
+
+    const char* bad[] = {
+        "", " ", "1", "\"a\"", "[1] x", "[1,]", "[01]", "[1.]", "[.5]", "[1e]", "[-]", "[+1]", "[tru]", "[nulll]",
+        "{\"a\":1,}", "{\"a\" 1}", "{1:2}", "[1 2]", "[1]]", "[1}", "{\"a\":1]", "{,}", "[,]", "{\"a\":}",
+        "[\"a]", "[\"\\x\"]", "[\"\\u12g4\"]", "[\"\t\"]", "[/* c */ 1]",
+    };
+    for (int32_t i = 0; i < (int32_t)(sizeof(bad) / sizeof(bad[0])); i++)
+    {
+        int32_t offset = -1;
+        TEST_CHECK(Test_Validate(bad[i], &offset) != JsonError_None && offset >= 0 && offset <= (int32_t)strlen(bad[i]));
+    }
+
+    // Malformed UTF-8 is reported at the first byte of its sequence
+    const char* utf8[] = {
+        "[\"ab\x80\"]",                 // continuation byte without a lead byte
+        "[\"ab\xc3\"]",                 // truncated two byte sequence
+        "[\"ab\xe2\x82\"]",             // truncated three byte sequence
+        "[\"ab\xc0\xaf\"]",             // overlong '/'
+        "[\"ab\xe0\x80\xaf\"]",         // overlong three byte form
+        "[\"ab\xf0\x80\x80\xaf\"]",     // overlong four byte form
+        "[\"ab\xed\xa0\x80\"]",         // UTF-16 surrogate
+        "[\"ab\xf4\x90\x80\x80\"]",     // above U+10FFFF
+        "[\"ab\xf5\x80\x80\x80\"]",     // lead byte that never starts a sequence
+        "[\"ab\xff\"]",
+        "{\"ab\xc3\x28\":1}",           // keys are checked as well
+    };
+    for (int32_t i = 0; i < (int32_t)(sizeof(utf8) / sizeof(utf8[0])); i++)
+    {
+        int32_t offset = -1;
+        TEST_CHECK(Test_Validate(utf8[i], &offset) == JsonError_InvalidValue && offset == 4);
+    }
+
+    // JsonParse is more lenient, the validator alone rejects these
+    const char* lenient[] = { "[\"a\tb\"]", "[\"a\x01\"]", "[\"ab\xff\"]" };
+    for (int32_t i = 0; i < (int32_t)(sizeof(lenient) / sizeof(lenient[0])); i++)
+    {
+        Json value;
+        TEST_CHECK(JsonParse(lenient[i], (int32_t)strlen(lenient[i]), JsonParseFlags_Default, testBuffer, sizeof(testBuffer), &value).error == JsonError_None);
+        TEST_CHECK(Test_Validate(lenient[i], NULL) != JsonError_None);
+    }
+
+    int32_t offset = -1;
+    Json    value;
+    TEST_CHECK(JsonParse("[1]", 4, JsonParseFlags_Default, testBuffer, sizeof(testBuffer), &value).error == JsonError_None);
+    TEST_CHECK(JsonValidate("[1]", 4, JsonParseFlags_Default, &offset) == JsonError_WrongFormat && offset == 3);
+
+    TEST_CHECK(JsonValidate("1", 1, JsonParseFlags_NoStrictTopLevel, &offset) == JsonError_None);
+    TEST_CHECK(JsonValidate("// x\n[/* c */ 1 // y\n]", 22, JsonParseFlags_SupportComment, &offset) == JsonError_None);
+    TEST_CHECK(JsonValidate("[1 /* open", 10, JsonParseFlags_SupportComment, &offset) == JsonError_UnmatchToken && offset == 3);
+
+    // Comments stand wherever whitespace does, the validator and both parsers agree on every position
+    static const char* const commented[] = {
+        "[1,2]//e", "[1/*x*/,2]", "{/*x*/\"a\":1}", "{\"a\"/*x*/:1}", "{\"a\":/*x*/1/*y*/}", "/*x*/[/*y*/]/*z*/", "[1,//x\n2]",
+    };
+    static const char* const badComments[] = { "[1]/*x", "[1,/2]", "[1]/" };
+    const JsonHandler noEvents = { 0 };
+    for (int i = 0; i < (int)(sizeof(commented) / sizeof(commented[0])); i++)
+    {
+        const int32_t length = (int32_t)strlen(commented[i]);
+        TEST_CHECK(JsonValidate(commented[i], length, JsonParseFlags_SupportComment, NULL) == JsonError_None);
+        TEST_CHECK(JsonParse(commented[i], length, JsonParseFlags_SupportComment, testBuffer, sizeof(testBuffer), &value).error == JsonError_None);
+        TEST_CHECK(JsonParseEvents(commented[i], length, JsonParseFlags_SupportComment, &noEvents, NULL).error == JsonError_None);
+        TEST_CHECK(JsonValidate(commented[i], length, JsonParseFlags_Default, NULL) != JsonError_None);
+        TEST_CHECK(JsonParse(commented[i], length, JsonParseFlags_Default, testBuffer, sizeof(testBuffer), &value).error != JsonError_None);
+    }
+    for (int i = 0; i < (int)(sizeof(badComments) / sizeof(badComments[0])); i++)
+    {
+        const int32_t length = (int32_t)strlen(badComments[i]);
+        TEST_CHECK(JsonValidate(badComments[i], length, JsonParseFlags_SupportComment, NULL) != JsonError_None);
+        TEST_CHECK(JsonParse(badComments[i], length, JsonParseFlags_SupportComment, testBuffer, sizeof(testBuffer), &value).error != JsonError_None);
+        TEST_CHECK(JsonParseEvents(badComments[i], length, JsonParseFlags_SupportComment, &noEvents, NULL).error != JsonError_None);
+    }
+
+    // The bit stack holds exactly JSON_VALIDATE_MAX_DEPTH levels, whatever the macro is set to
+    char* deep = (char*)malloc(2 * JSON_VALIDATE_MAX_DEPTH + 2);
+    memset(deep, '[', JSON_VALIDATE_MAX_DEPTH);
+    memset(deep + JSON_VALIDATE_MAX_DEPTH, ']', JSON_VALIDATE_MAX_DEPTH);
+    TEST_CHECK(JsonValidate(deep, 2 * JSON_VALIDATE_MAX_DEPTH, JsonParseFlags_Default, NULL) == JsonError_None);
+
+    memset(deep, '[', JSON_VALIDATE_MAX_DEPTH + 1);
+    memset(deep + JSON_VALIDATE_MAX_DEPTH + 1, ']', JSON_VALIDATE_MAX_DEPTH + 1);
+    TEST_CHECK(JsonValidate(deep, 2 * JSON_VALIDATE_MAX_DEPTH + 2, JsonParseFlags_Default, &offset) == JsonError_OutOfMemory && offset == JSON_VALIDATE_MAX_DEPTH);
+    free(deep);
+}
+
+// -------------------------------------------------------------------
+// Tokenizer
+// -------------------------------------------------------------------
+
+static JsonError Test_ParseError(const char* json, JsonParseFlags flags)
+{
+    Json value;
+    return JsonParse(json, (int32_t)strlen(json), flags, testBuffer, sizeof(testBuffer), &value).error;
+}
+
+static void Test_Tokenizer(void)
+{
+    // Only the four RFC 8259 whitespace characters separate tokens
+    TEST_CHECK(Test_ParseError("[1,\v2]", JsonParseFlags_Default) == JsonError_UnexpectedToken);
+    TEST_CHECK(Test_ParseError("[1,\f2]", JsonParseFlags_Default) == JsonError_UnexpectedToken);
+    TEST_CHECK(Test_ParseError("[1,\t2,\r\n3 ]", JsonParseFlags_Default) == JsonError_None);
+
+    // Literals are compared as whole words, also when the input ends before four bytes
+    static const char* const literals[] = { "[tru]", "[truex]", "[fals]", "[nulll]", "[nul", "[t" };
+    for (int32_t i = 0; i < (int32_t)(sizeof(literals) / sizeof(literals[0])); i++)
+    {
+        TEST_CHECK(Test_ParseError(literals[i], JsonParseFlags_Default) != JsonError_None);
+    }
+    TEST_CHECK(Test_ParseError("nul", JsonParseFlags_NoStrictTopLevel) != JsonError_None);
+    TEST_CHECK(Test_ParseError("null", JsonParseFlags_NoStrictTopLevel) == JsonError_None);
+    TEST_CHECK(Test_ParseError("[true,false,null]", JsonParseFlags_Default) == JsonError_None);
+
+    // Bytes from 0x80 up are string content, not the end of the input
+    const char* utf8  = "[\"\xc3\xa9t\xc3\xa9\",\"\xff\x80\"]";
+    const Json  plain = Test_Parse(utf8, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+    const Json  lazy  = Test_Parse(utf8, JsonParseFlags_LazyStrings, testBuffer2, sizeof(testBuffer2));
+    TEST_CHECK(plain.length == 2 && strcmp(plain.array[0].string, "\xc3\xa9t\xc3\xa9") == 0 && strcmp(plain.array[1].string, "\xff\x80") == 0);
+    TEST_CHECK(lazy.length == 2 && lazy.array[0].length == 5 && strncmp(lazy.array[0].string, "\xc3\xa9t\xc3\xa9", 5) == 0);
+
+    // Numbers read the same whatever the decimal point of the C locale
+    static const char* const locales[] = { "de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "C" };
+    for (int32_t i = 0; i < (int32_t)(sizeof(locales) / sizeof(locales[0])); i++)
+    {
+        if (setlocale(LC_NUMERIC, locales[i]))
+        {
+            const Json numbers = Test_Parse("[1.5,-0.25e1,2.5E-3,0.1,123456.78901234567]", JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+            TEST_CHECK(numbers.length == 5 && numbers.array[0].number == 1.5 && numbers.array[1].number == -2.5 && numbers.array[2].number == 2.5e-3);
+            TEST_CHECK(numbers.length == 5 && numbers.array[3].number == 0.1 && numbers.array[4].number == 123456.78901234567);
+        }
+    }
+    setlocale(LC_NUMERIC, "C");
+}
+
+// -------------------------------------------------------------------
+// Unicode escapes
+// -------------------------------------------------------------------
+
+static void Test_Surrogates(void)
+{
+    // Unpaired surrogates decode to U+FFFD, a pair to its 4-byte code point
+    static const struct { const char* json; const char* decoded; } cases[] = {
+        { "[\"\\ud83d\\ude00\"]",           "\xf0\x9f\x98\x80" },
+        { "[\"\\uDBFF\\uDFFF\"]",           "\xf4\x8f\xbf\xbf" },
+        { "[\"\\ud800\\udc00\"]",           "\xf0\x90\x80\x80" },
+        { "[\"\\ud83dx\"]",                 "\xef\xbf\xbdx" },
+        { "[\"a\\ud83d\"]",                 "a\xef\xbf\xbd" },
+        { "[\"\\ude00\"]",                  "\xef\xbf\xbd" },
+        { "[\"\\ude00\\ud83d\"]",           "\xef\xbf\xbd\xef\xbf\xbd" },
+        { "[\"\\ud83d\\ud83d\\ude00\"]",    "\xef\xbf\xbd\xf0\x9f\x98\x80" },
+        { "[\"\\ud83d\\u0041\"]",           "\xef\xbf\xbd" "A" },
+        { "[\"\\ud83d\\n\"]",               "\xef\xbf\xbd\n" },
+        { "[\"\\u00e9\\u20ac\\uffff\"]",    "\xc3\xa9\xe2\x82\xac\xef\xbf\xbf" },
+    };
+
+    char text[32];
+    for (int32_t i = 0; i < (int32_t)(sizeof(cases) / sizeof(cases[0])); i++)
+    {
+        const int32_t length = (int32_t)strlen(cases[i].decoded);
+
+        const Json plain = Test_Parse(cases[i].json, JsonParseFlags_Default, testBuffer, sizeof(testBuffer));
+        const Json lazy  = Test_Parse(cases[i].json, JsonParseFlags_LazyStrings, testBuffer2, sizeof(testBuffer2));
+        TEST_CHECK(plain.type == JsonType_Array && plain.length == 1 && lazy.type == JsonType_Array && lazy.length == 1);
+
+        // Failed parses give null values, the checks below then fail instead of reading them
+        TEST_CHECK(plain.length == 1 && plain.array[0].length == length && memcmp(plain.array[0].string, cases[i].decoded, length) == 0);
+        TEST_CHECK(lazy.length == 1 && JsonCopyString(lazy.array[0], text, sizeof(text)) == length && strcmp(text, cases[i].decoded) == 0);
+        TEST_CHECK(plain.length == 1 && lazy.length == 1 && JsonEquals(plain.array[0], lazy.array[0]));
+        TEST_CHECK(JsonValidate(cases[i].json, (int32_t)strlen(cases[i].json), JsonParseFlags_Default, NULL) == JsonError_None);
+    }
+
+    // Escapes need four hex digits, lazy strings are checked as well
+    static const char* const malformed[] = { "[\"\\ud83\"]", "[\"\\ud83d\\ude0g\"]" };
+    for (int32_t i = 0; i < 2; i++)
+    {
+        Json value;
+        TEST_CHECK(JsonParse(malformed[i], (int32_t)strlen(malformed[i]), JsonParseFlags_Default, testBuffer, sizeof(testBuffer), &value).error != JsonError_None);
+        TEST_CHECK(JsonParse(malformed[i], (int32_t)strlen(malformed[i]), JsonParseFlags_LazyStrings, testBuffer, sizeof(testBuffer), &value).error != JsonError_None);
+    }
+}
+
+int main(void)
+{
+    Test_StringBuffer();
+    Test_Equality();
+    Test_PackedArrays();
+    Test_ArrayConversion();
+    Test_Columns();
+    Test_LazyNumbers();
+    Test_LazyStrings();
+    Test_ParseEvents();
+    Test_Projection();
+    Test_Paths();
+    Test_Query();
+    Test_KeySummary();
+    Test_StructBindings();
+    Test_ParseStruct();
+    Test_Stringify();
+    Test_NumberFormat();
+    Test_Writer();
+    Test_PrettyPrint();
+    Test_Reformat();
+    Test_Validation();
+    Test_Tokenizer();
+    Test_Surrogates();
+
+    if (testFailures > 0)
+    {
+        fprintf(stderr, "API tests failed: %d checks\n", testFailures);
+        return 1;
+    }
+
+    printf("API tests succeed.\n");
+    return 0;
+}
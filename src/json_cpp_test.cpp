@@ -0,0 +1,59 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <string.h>
+
+/* The single header library is meant to build as C++ as well */
+#define JSON_IMPL
+#include "../Json.h"
+
+static int testFailures = 0;
+
+#define TEST_CHECK(cond)                                                            \
+    do                                                                              \
+    {                                                                               \
+        if (!(cond))                                                                \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailures++;                                                         \
+        }                                                                           \
+    } while (0)
+
+static char testBuffer[64 * 1024];
+
+// -------------------------------------------------------------------
+// Constants
+// -------------------------------------------------------------------
+
+static void Test_Constants(void)
+{
+    TEST_CHECK(JSON_NULL.type == JsonType_Null);
+    TEST_CHECK(JSON_TRUE.type == JsonType_Boolean && JSON_TRUE.boolean == true);
+    TEST_CHECK(JSON_FALSE.type == JsonType_Boolean && JSON_FALSE.boolean == false);
+
+    const char* json  = "[true, false, null]";
+    Json        value = JSON_NULL;
+    const JsonResult result = JsonParse(json, (int32_t)strlen(json), JsonParseFlags_Default, testBuffer, sizeof(testBuffer), &value);
+    TEST_CHECK(result.error == JsonError_None && value.type == JsonType_Array && value.length == 3);
+    if (result.error == JsonError_None)
+    {
+        TEST_CHECK(JsonEquals(value.array[0], JSON_TRUE));
+        TEST_CHECK(JsonEquals(value.array[1], JSON_FALSE));
+        TEST_CHECK(JsonEquals(value.array[2], JSON_NULL));
+        TEST_CHECK(!JsonEquals(value.array[0], JSON_FALSE));
+    }
+}
+
+int main(void)
+{
+    Test_Constants();
+
+    if (testFailures > 0)
+    {
+        fprintf(stderr, "C++ tests failed: %d checks\n", testFailures);
+        return 1;
+    }
+
+    printf("C++ tests succeed.\n");
+    return 0;
+}
@@ -0,0 +1,172 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The kernels are internal, so the implementation is compiled into the test */
+#include "Json.c"
+
+static int testFailures = 0;
+
+#define TEST_CHECK(cond)                                                            \
+    do                                                                              \
+    {                                                                               \
+        if (!(cond))                                                                \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailures++;                                                         \
+        }                                                                           \
+    } while (0)
+
+#define TEST_ITERATIONS 200000
+#define TEST_MAX_LENGTH 260
+
+// -------------------------------------------------------------------
+// Byte-by-byte reference of each scan
+// -------------------------------------------------------------------
+
+typedef bool TestStopFunc(uint8_t c);
+
+static bool Test_StopString(uint8_t c)
+{
+    return c == '"' || c == '\\' || c == '\r' || c == '\n' || c == 0;
+}
+
+static bool Test_StopStructural(uint8_t c)
+{
+    return c == '"' || c == '{' || c == '}' || c == '[' || c == ']' || c == '/' || c == '\n';
+}
+
+static bool Test_StopText(uint8_t c)
+{
+    return c == '"' || c == '\\' || c < 0x20 || c >= 0x80;
+}
+
+static bool Test_IsSpace(uint8_t c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int32_t Test_Reference(const uint8_t* ptr, int32_t length, TestStopFunc* stop)
+{
+    int32_t i = 0;
+    while (i < length && !stop(ptr[i]))
+    {
+        i++;
+    }
+    return i;
+}
+
+// -------------------------------------------------------------------
+// Random buffers
+// -------------------------------------------------------------------
+
+static uint32_t testSeed = 1;
+
+static uint32_t Test_Random(void)
+{
+    testSeed = testSeed * 1103515245u + 12345u;
+    return testSeed >> 16;
+}
+
+/* Mostly plain text and spaces, with a varying density of bytes that stop some scan */
+static int32_t Test_RandomBuffer(uint8_t* buffer)
+{
+    static const char special[] = " \t\r\n\"\\{}[]/ab\x80\xff\x01,:0";
+
+    const int32_t  length  = (int32_t)(Test_Random() % TEST_MAX_LENGTH);
+    const uint32_t density = Test_Random() % 20 + 1;
+    for (int32_t i = 0; i < length; i++)
+    {
+        const uint32_t roll = Test_Random() % 100;
+        if (roll < density)
+        {
+            buffer[i] = (uint8_t)special[Test_Random() % (sizeof(special) - 1)];
+        }
+        else
+        {
+            buffer[i] = roll < density * 3 ? ' ' : 'x';
+        }
+    }
+    return length;
+}
+
+// -------------------------------------------------------------------
+// Differential test
+// -------------------------------------------------------------------
+
+/* Returns false on the first mismatch so a broken kernel reports a single buffer */
+static bool Test_CheckKernels(const JsonKernels* kernels, const uint8_t* buffer, int32_t length)
+{
+    const int32_t failures = testFailures;
+
+    // scanString may stop early at other control characters, the parser then looks at them one by one
+    const int32_t string = kernels->scanString(buffer, length);
+    TEST_CHECK(string <= Test_Reference(buffer, length, Test_StopString));
+    TEST_CHECK(string == length || Test_StopString(buffer[string]) || buffer[string] < 0x20);
+
+    TEST_CHECK(kernels->scanStructural(buffer, length) == Test_Reference(buffer, length, Test_StopStructural));
+    TEST_CHECK(kernels->scanText(buffer, length) == Test_Reference(buffer, length, Test_StopText));
+
+    int32_t lines = 0, lastLine = -1;
+    const int32_t space = kernels->skipSpace(buffer, length, &lines, &lastLine);
+
+    int32_t expectedSpace = 0, expectedLines = 0, expectedLastLine = -1;
+    while (expectedSpace < length && Test_IsSpace(buffer[expectedSpace]))
+    {
+        if (buffer[expectedSpace] == '\n')
+        {
+            expectedLines++;
+            expectedLastLine = expectedSpace;
+        }
+        expectedSpace++;
+    }
+    TEST_CHECK(space == expectedSpace && lines == expectedLines && lastLine == expectedLastLine);
+
+    if (testFailures != failures)
+    {
+        fprintf(stderr, "kernel %s failed on a buffer of %d bytes\n", kernels->name, length);
+        return false;
+    }
+    return true;
+}
+
+static void Test_Kernels(const JsonKernels* kernels)
+{
+    static uint8_t buffer[TEST_MAX_LENGTH];
+
+    testSeed = 1;
+    for (int32_t i = 0; i < TEST_ITERATIONS; i++)
+    {
+        const int32_t length = Test_RandomBuffer(buffer);
+        if (!Test_CheckKernels(kernels, buffer, length))
+        {
+            return;
+        }
+    }
+
+    printf("Kernel %s matches the reference.\n", kernels->name);
+}
+
+int main(void)
+{
+    Test_Kernels(&JsonKernels_Scalar);
+
+    // Vector kernels the CPU cannot run are skipped
+    const JsonKernels* supported[3];
+    const int32_t      count = JsonKernels_Supported(supported);
+    for (int32_t i = 0; i < count; i++)
+    {
+        Test_Kernels(supported[i]);
+    }
+
+    if (testFailures > 0)
+    {
+        fprintf(stderr, "Kernel tests failed: %d checks\n", testFailures);
+        return 1;
+    }
+
+    printf("Kernel tests succeed.\n");
+    return 0;
+}
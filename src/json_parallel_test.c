@@ -0,0 +1,886 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "Json.h"
+
+static int testFailures = 0;
+
+#define TEST_CHECK(cond)                                                            \
+    do                                                                              \
+    {                                                                               \
+        if (!(cond))                                                                \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailures++;                                                         \
+        }                                                                           \
+    } while (0)
+
+/* Handlers may run on several threads at once */
+#if defined(_WIN32)
+typedef CRITICAL_SECTION TestMutex;
+#define TestMutex_Init(mutex)       InitializeCriticalSection(mutex)
+#define TestMutex_Destroy(mutex)    DeleteCriticalSection(mutex)
+#define TestMutex_Lock(mutex)       EnterCriticalSection(mutex)
+#define TestMutex_Unlock(mutex)     LeaveCriticalSection(mutex)
+#else
+typedef pthread_mutex_t TestMutex;
+#define TestMutex_Init(mutex)       pthread_mutex_init(mutex, NULL)
+#define TestMutex_Destroy(mutex)    pthread_mutex_destroy(mutex)
+#define TestMutex_Lock(mutex)       pthread_mutex_lock(mutex)
+#define TestMutex_Unlock(mutex)     pthread_mutex_unlock(mutex)
+#endif
+
+static const int32_t testThreadCounts[] = { 1, 2, 3, 8, 0 };
+
+static void Test_SleepMs(int32_t milliseconds)
+{
+#if defined(_WIN32)
+    Sleep((DWORD)milliseconds);
+#else
+    usleep((useconds_t)milliseconds * 1000);
+#endif
+}
+
+/* Plain threads of the test itself, started without the library */
+#if defined(_WIN32)
+typedef HANDLE TestThread;
+
+static void Test_StartThread(TestThread* thread, DWORD (WINAPI* func)(void*), void* argument)
+{
+    *thread = CreateThread(NULL, 0, func, argument, 0, NULL);
+}
+
+static void Test_JoinThread(TestThread thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+#define TEST_THREAD_FUNC(name) static DWORD WINAPI name(void* argument)
+#define TEST_THREAD_RETURN     return 0
+#else
+typedef pthread_t TestThread;
+
+static void Test_StartThread(TestThread* thread, void* (*func)(void*), void* argument)
+{
+    pthread_create(thread, NULL, func, argument);
+}
+
+static void Test_JoinThread(TestThread thread)
+{
+    pthread_join(thread, NULL);
+}
+
+#define TEST_THREAD_FUNC(name) static void* name(void* argument)
+#define TEST_THREAD_RETURN     return NULL
+#endif
+
+/* Deterministic pseudo random numbers */
+static uint32_t testRandomState = 1;
+
+static uint32_t Test_Random(uint32_t range)
+{
+    testRandomState = testRandomState * 1103515245u + 12345u;
+    return (testRandomState >> 8) % range;
+}
+
+// -------------------------------------------------------------------
+// JsonParseLines
+// -------------------------------------------------------------------
+
+#define TEST_LINES_COUNT 20000
+
+/* What a run of JsonParseLines handed over */
+typedef struct TestLines
+{
+    TestMutex   mutex;
+    bool        ordered;
+    int32_t     inside;         // Handlers running right now
+    int32_t     stopAt;
+    int32_t     count;
+    int32_t     errors;
+    int64_t     lastOffset;
+    int64_t     offsets[TEST_LINES_COUNT + 1];
+    int32_t     ids[TEST_LINES_COUNT + 1];  // -1 for lines that do not parse
+} TestLines;
+
+/* The input and what each line holds */
+static char*   testLinesInput;
+static int64_t testLinesLength;
+static int64_t testLinesOffsets[TEST_LINES_COUNT + 1];
+static int32_t testLinesIds[TEST_LINES_COUNT + 1];
+static int32_t testLinesErrors;
+
+static TestLines testLines;
+
+static bool Test_OnLine(void* user, int64_t offset, const Json value, const JsonResult* result)
+{
+    TestLines* lines = (TestLines*)user;
+
+    TestMutex_Lock(&lines->mutex);
+    TEST_CHECK(!lines->ordered || (lines->inside == 0 && offset > lines->lastOffset));
+    lines->inside++;
+    lines->lastOffset = offset;
+
+    int32_t id = -1;
+    if (result->error != JsonError_None)
+    {
+        TEST_CHECK(result->message && result->message[0]);
+        lines->errors++;
+    }
+    else
+    {
+        Json member;
+        TEST_CHECK(value.type == JsonType_Object && JsonFind(value, "id", &member) && member.type == JsonType_Number);
+        id = (int32_t)member.number;
+        TEST_CHECK(JsonFind(value, "s", &member) && member.type == JsonType_String);
+    }
+
+    if (lines->count <= TEST_LINES_COUNT)
+    {
+        lines->offsets[lines->count] = offset;
+        lines->ids[lines->count]     = id;
+    }
+    lines->count++;
+
+    const bool goOn = lines->stopAt == 0 || lines->count < lines->stopAt;
+    lines->inside--;
+    TestMutex_Unlock(&lines->mutex);
+    return goOn;
+}
+
+/* Run JsonParseLines over the test input */
+static JsonError Test_ParseLines(JsonParseFlags flags, int32_t threadCount, int32_t stopAt, void* buffer, int32_t bufferSize)
+{
+    TestLines* lines = &testLines;
+    lines->ordered    = !(flags & JsonParseFlags_UnorderedLines);
+    lines->inside     = 0;
+    lines->stopAt     = stopAt;
+    lines->count      = 0;
+    lines->errors     = 0;
+    lines->lastOffset = -1;
+    return JsonParseLines(testLinesInput, testLinesLength, flags, threadCount, Test_OnLine, lines, buffer, bufferSize);
+}
+
+/* Lines sorted by offset, for runs that delivered them out of order */
+static void Test_SortLines(TestLines* lines)
+{
+    for (int32_t i = 1; i < lines->count; i++)
+    {
+        const int64_t offset = lines->offsets[i];
+        const int32_t id     = lines->ids[i];
+
+        int32_t k = i;
+        for (; k > 0 && lines->offsets[k - 1] > offset; k--)
+        {
+            lines->offsets[k] = lines->offsets[k - 1];
+            lines->ids[k]     = lines->ids[k - 1];
+        }
+        lines->offsets[k] = offset;
+        lines->ids[k]     = id;
+    }
+}
+
+static void Test_MakeLines(void)
+{
+    testLinesInput  = (char*)malloc((size_t)TEST_LINES_COUNT * 128);
+    testLinesLength = 0;
+    testLinesErrors = 0;
+
+    char* input = testLinesInput;
+    for (int32_t i = 0; i <= TEST_LINES_COUNT; i++)
+    {
+        // Blank lines are skipped
+        if (i % 997 == 5)
+        {
+            testLinesLength += sprintf(input + testLinesLength, "\n   \r\n");
+        }
+
+        testLinesOffsets[i] = testLinesLength;
+        testLinesIds[i]     = i;
+
+        const char* lineEnd = i == TEST_LINES_COUNT ? "" : (i & 1) ? "\r\n" : "\n";
+        if (i % 5003 == 7)
+        {
+            testLinesLength += sprintf(input + testLinesLength, "{\"id\":%d,\"s\":\"unterminated\n", i);
+            testLinesIds[i]  = -1;
+            testLinesErrors++;
+        }
+        else if (i % 13 == 0)
+        {
+            testLinesLength += sprintf(input + testLinesLength, "{\"id\":%d,\"s\":\"line \\\"%d\\\" \\n [{\",\"a\":[1,2,{\"x\":[true,null]}]}%s", i, i, lineEnd);
+        }
+        else
+        {
+            testLinesLength += sprintf(input + testLinesLength, "{\"id\":%d,\"s\":\"v%d\"}%s", i, i, lineEnd);
+        }
+    }
+}
+
+static void Test_Lines(void)
+{
+    static char buffer[1 << 24];
+    const int32_t bufferSizes[] = { 4096, 1 << 16, 1 << 24 };
+
+    Test_MakeLines();
+    TestMutex_Init(&testLines.mutex);
+
+    for (int32_t unordered = 0; unordered < 2; unordered++)
+    {
+        const JsonParseFlags flags = unordered ? JsonParseFlags_UnorderedLines : JsonParseFlags_Default;
+        for (int32_t t = 0; t < (int32_t)(sizeof(testThreadCounts) / sizeof(testThreadCounts[0])); t++)
+        {
+            for (int32_t b = 0; b < (int32_t)(sizeof(bufferSizes) / sizeof(bufferSizes[0])); b++)
+            {
+                TEST_CHECK(Test_ParseLines(flags, testThreadCounts[t], 0, buffer, bufferSizes[b]) == JsonError_None);
+                TEST_CHECK(testLines.count == TEST_LINES_COUNT + 1 && testLines.errors == testLinesErrors);
+
+                // Every line is handed over once, with its own value
+                Test_SortLines(&testLines);
+                bool same = true;
+                for (int32_t i = 0; i < testLines.count && i <= TEST_LINES_COUNT; i++)
+                {
+                    same = same && testLines.offsets[i] == testLinesOffsets[i] && testLines.ids[i] == testLinesIds[i];
+                }
+                if (!same)
+                {
+                    fprintf(stderr, "lines differ, unordered=%d threads=%d buffer=%d\n", unordered, testThreadCounts[t], bufferSizes[b]);
+                    testFailures++;
+                }
+            }
+        }
+
+        // Stopping
+        TEST_CHECK(Test_ParseLines(flags, 4, 1000, buffer, sizeof(buffer)) == JsonError_InvalidValue);
+        TEST_CHECK(unordered || testLines.count == 1000);
+    }
+
+    char small[16];
+    TEST_CHECK(Test_ParseLines(JsonParseFlags_Default, 2, 0, small, sizeof(small)) == JsonError_OutOfMemory);
+
+    testLines.count = 0;
+    TEST_CHECK(JsonParseLines("\n\n  \r\n", 6, JsonParseFlags_Default, 2, Test_OnLine, &testLines, buffer, sizeof(buffer)) == JsonError_None);
+    TEST_CHECK(JsonParseLines("", 0, JsonParseFlags_Default, 2, Test_OnLine, &testLines, buffer, sizeof(buffer)) == JsonError_None);
+    TEST_CHECK(testLines.count == 0);
+
+    TestMutex_Destroy(&testLines.mutex);
+    free(testLinesInput);
+}
+
+/* Ordered delivery of records split by blank lines, tracked per chunk of the input */
+#define TEST_SPARSE_COUNT       30000
+#define TEST_SPARSE_CHUNK_SIZE  (64 * 1024)     // Chunk size of JsonParseLines for inputs under 1 MB per worker
+
+typedef struct TestSparseLines
+{
+    int32_t     count;
+    int64_t     lastOffset;
+    int64_t     chunk;          // Chunk of the last record
+    const void* lastItems;      // Items of the last record
+    bool        buffered;       // Records of the chunk so far sat in distinct places of the arena
+    int32_t     bufferedChunks;
+    int32_t     earlyTurns;     // Chunks that took the turn after buffering some records
+} TestSparseLines;
+
+static bool Test_OnSparseLine(void* user, int64_t offset, const Json value, const JsonResult* result)
+{
+    TestSparseLines* lines = (TestSparseLines*)user;
+
+    Json member;
+    TEST_CHECK(result->error == JsonError_None && offset > lines->lastOffset);
+    TEST_CHECK(JsonFind(value, "id", &member) && member.number == lines->count);
+
+    // The chunk holding the turn parses each line at the start of its arena, a buffering chunk one after another
+    // Going from the latter to the former means the chunk waited for its turn although the arena had room
+    const int64_t chunk = offset / TEST_SPARSE_CHUNK_SIZE;
+    if (chunk == lines->chunk)
+    {
+        if (value.object != lines->lastItems && !lines->buffered)
+        {
+            lines->buffered = true;
+            lines->bufferedChunks++;
+        }
+        else if (value.object == lines->lastItems && lines->buffered)
+        {
+            lines->buffered = false;
+            lines->earlyTurns++;
+        }
+    }
+    else
+    {
+        lines->buffered = false;
+    }
+
+    lines->chunk      = chunk;
+    lines->lastItems  = value.object;
+    lines->lastOffset = offset;
+    lines->count++;
+
+    // Gives the other worker time to claim the next chunks while the first one holds the turn
+    if (offset == 0)
+    {
+        Test_SleepMs(50);
+    }
+    return true;
+}
+
+static void Test_SparseLines(void)
+{
+    static char buffer[1 << 24];
+
+    char* input = (char*)malloc((size_t)TEST_SPARSE_COUNT * 32);
+    int64_t length = 0;
+    for (int32_t i = 0; i < TEST_SPARSE_COUNT; i++)
+    {
+        length += sprintf(input + length, "{\"id\":%d}\n", i);
+        if (i % 5 == 2)
+        {
+            length += sprintf(input + length, (i & 1) ? "\r\n" : "\n");
+        }
+    }
+    TEST_CHECK(length > 3 * TEST_SPARSE_CHUNK_SIZE && length < 16 * TEST_SPARSE_CHUNK_SIZE);
+
+    TestSparseLines lines = { 0, -1, -1, NULL, false, 0, 0 };
+    TEST_CHECK(JsonParseLines(input, length, JsonParseFlags_Default, 2, Test_OnSparseLine, &lines, buffer, sizeof(buffer)) == JsonError_None);
+    TEST_CHECK(lines.count == TEST_SPARSE_COUNT);
+    TEST_CHECK(lines.bufferedChunks > 0 && lines.earlyTurns == 0);
+
+    free(input);
+}
+
+/* Holds the first record back so the next chunk is parsed before it has the turn */
+static bool Test_OnSlowLine(void* user, int64_t offset, const Json value, const JsonResult* result)
+{
+    if (offset == 0)
+    {
+        Test_SleepMs(50);
+    }
+    return Test_OnLine(user, offset, value, result);
+}
+
+/* A record that fits the whole arena, but not the part left beside a pending record slot, parses the same in every mode */
+static void Test_TightLines(void)
+{
+    static Json arena[1 << 14];
+    static char parseBuffer[1 << 18];
+
+    char* input = (char*)malloc(256 * 1024);
+    int32_t id     = 0;
+    int64_t length = 0;
+    while (length < TEST_SPARSE_CHUNK_SIZE)
+    {
+        length += sprintf(input + length, "{\"id\":%d,\"s\":\"v\"}\n", id++);
+    }
+
+    // The first line of the second chunk, parsed off-turn while the first chunk waits in the handler
+    const int64_t bigStart = length;
+    length += sprintf(input + length, "{\"id\":%d,\"s\":\"big\",\"a\":[0", id++);
+    for (int32_t i = 1; i < 1000; i++)
+    {
+        length += sprintf(input + length, ",%d", i);
+    }
+    length += sprintf(input + length, "]}\n");
+
+    // Smallest buffer the record parses into, rounded up to the arena alignment
+    int32_t low  = 0;
+    int32_t high = (int32_t)sizeof(parseBuffer);
+    while (low + 1 < high)
+    {
+        const int32_t middle = (low + high) / 2;
+        Json value;
+        if (JsonParse(input + bigStart, (int32_t)(length - bigStart), JsonParseFlags_Default, parseBuffer, middle, &value).error == JsonError_None)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle;
+        }
+    }
+    const int32_t arenaSize = (high + (int32_t)sizeof(Json) - 1) & ~((int32_t)sizeof(Json) - 1);
+    TEST_CHECK(2 * arenaSize <= (int32_t)sizeof(arena));
+
+    TestMutex_Init(&testLines.mutex);
+
+    for (int32_t unordered = 0; unordered < 2; unordered++)
+    {
+        const JsonParseFlags flags = unordered ? JsonParseFlags_UnorderedLines : JsonParseFlags_Default;
+
+        TestLines* lines = &testLines;
+        lines->ordered    = !unordered;
+        lines->inside     = 0;
+        lines->stopAt     = 0;
+        lines->count      = 0;
+        lines->errors     = 0;
+        lines->lastOffset = -1;
+        TEST_CHECK(JsonParseLines(input, length, flags, 2, Test_OnSlowLine, lines, arena, 2 * arenaSize) == JsonError_None);
+        TEST_CHECK(lines->count == id && lines->errors == 0);
+    }
+
+    TestMutex_Destroy(&testLines.mutex);
+    free(input);
+}
+
+// -------------------------------------------------------------------
+// JsonParseParallel
+// -------------------------------------------------------------------
+
+#define TEST_DOCUMENT_SIZE  (2 << 20)
+
+static char*   testDocument;
+static int64_t testDocumentLength;
+
+static void Test_Append(const char* text)
+{
+    const size_t length = strlen(text);
+    memcpy(testDocument + testDocumentLength, text, length + 1);
+    testDocumentLength += (int64_t)length;
+}
+
+/* Strings full of escaped quotes, backslashes and brackets, which the splitter must not take for structure */
+static void Test_AppendString(const char* prefix)
+{
+    static const char* const pieces[] = { "\\\"", "\\\\", "[{", "}],", "\\\\\\\"", "\\u00e9", "\\\"]", "abc" };
+
+    Test_Append("\"");
+    Test_Append(prefix);
+    for (uint32_t i = 0, n = Test_Random(6); i < n; i++)
+    {
+        Test_Append(pieces[Test_Random(sizeof(pieces) / sizeof(pieces[0]))]);
+    }
+    Test_Append("\"");
+}
+
+static void Test_AppendValue(int32_t depth)
+{
+    char number[32];
+    switch (Test_Random(depth > 3 ? 4 : 7))
+    {
+    case 0:
+        sprintf(number, "%d", (int32_t)Test_Random(100000) - 500);
+        Test_Append(number);
+        break;
+
+    case 1:
+        sprintf(number, "%d.25e-1", (int32_t)Test_Random(1000));
+        Test_Append(number);
+        break;
+
+    case 2:
+        Test_AppendString("");
+        break;
+
+    case 3:
+        Test_Append(Test_Random(2) ? "true" : "null");
+        break;
+
+    case 4:
+    case 5:
+        Test_Append("[");
+        for (uint32_t i = 0, n = Test_Random(4); i < n; i++)
+        {
+            Test_Append(i == 0 ? "" : Test_Random(2) ? "," : " ,\n ");
+            Test_AppendValue(depth + 1);
+        }
+        Test_Append("]");
+        break;
+
+    default:
+        Test_Append("{");
+        for (uint32_t i = 0, n = Test_Random(4); i < n; i++)
+        {
+            Test_Append(i == 0 ? "" : ",\n");
+            Test_AppendString("k");
+            Test_Append(" : ");
+            Test_AppendValue(depth + 1);
+        }
+        Test_Append("}");
+        break;
+    }
+}
+
+/* A top level array or object of random items */
+static void Test_MakeDocument(bool isObject, int64_t size)
+{
+    testDocumentLength = 0;
+    Test_Append(isObject ? " {\n" : "\n [ ");
+    for (int32_t i = 0; testDocumentLength < size; i++)
+    {
+        if (i > 0)
+        {
+            Test_Append(Test_Random(3) ? "," : " ,\r\n ");
+        }
+
+        if (isObject)
+        {
+            char key[32];
+            sprintf(key, "\"k%d\":", i);
+            Test_Append(key);
+        }
+        Test_AppendValue(0);
+    }
+    Test_Append(isObject ? "}\n" : " ]\r\n");
+}
+
+/* Parse the test document serially and in parallel, both must agree */
+static void Test_CompareParallel(JsonParseFlags flags, int32_t threadCount, void* buffer, int64_t bufferSize, void* serialBuffer, int32_t serialBufferSize)
+{
+    Json serial   = JSON_NULL;
+    Json parallel = JSON_NULL;
+    const JsonResult serialResult   = JsonParse(testDocument, (int32_t)testDocumentLength, flags, serialBuffer, serialBufferSize, &serial);
+    const JsonResult parallelResult = JsonParseParallel(testDocument, testDocumentLength, flags, threadCount, buffer, bufferSize, &parallel);
+
+    TEST_CHECK(serialResult.error == parallelResult.error);
+    TEST_CHECK(strcmp(serialResult.message, parallelResult.message) == 0);
+    if (serialResult.error == JsonError_None && parallelResult.error == JsonError_None)
+    {
+        TEST_CHECK(serial.type == parallel.type && serial.length == parallel.length && JsonEquals(serial, parallel));
+    }
+
+    // The top level summary joins the parts, it must not prune keys that are there
+    if ((flags & JsonParseFlags_KeySummary) && serialResult.error == JsonError_None && parallelResult.error == JsonError_None)
+    {
+        static const char* const names[] = { "k", "k0", "k7", "kabc", "missing" };
+        for (int32_t i = 0; i < (int32_t)(sizeof(names) / sizeof(names[0])); i++)
+        {
+            const int32_t count = JsonFindAll(serial, names[i], JsonParseFlags_Default, NULL, 0);
+            TEST_CHECK(JsonFindAll(serial, names[i], flags, NULL, 0) == count);
+            TEST_CHECK(JsonFindAll(parallel, names[i], flags, NULL, 0) == count);
+        }
+
+        TEST_CHECK(parallel.type != JsonType_Object || JsonFindAll(parallel, "k0", flags, NULL, 0) > 0);
+    }
+}
+
+static void Test_Parallel(void)
+{
+    const int32_t bufferSize = 1 << 26;
+    char* buffer       = (char*)malloc(bufferSize);
+    char* serialBuffer = (char*)malloc(bufferSize);
+    testDocument       = (char*)malloc(2 * TEST_DOCUMENT_SIZE);
+
+    const JsonParseFlags flagSets[] = { JsonParseFlags_Default, JsonParseFlags_KeySummary, JsonParseFlags_LazyStrings };
+    for (int32_t isObject = 0; isObject < 2; isObject++)
+    {
+        for (int32_t f = 0; f < (int32_t)(sizeof(flagSets) / sizeof(flagSets[0])); f++)
+        {
+            Test_MakeDocument(isObject != 0, TEST_DOCUMENT_SIZE);
+            for (int32_t t = 0; t < (int32_t)(sizeof(testThreadCounts) / sizeof(testThreadCounts[0])); t++)
+            {
+                Test_CompareParallel(flagSets[f], testThreadCounts[t], buffer, bufferSize, serialBuffer, bufferSize);
+            }
+        }
+    }
+
+    // Errors anywhere are reported like the serial parser does
+    const char* const breaks[] = { ",]", "\"", "[", "]", ",,", "{", "}", "x", "\\", "\"\\\"" };
+    for (int32_t i = 0; i < 2 * (int32_t)(sizeof(breaks) / sizeof(breaks[0])); i++)
+    {
+        Test_MakeDocument(i & 1, TEST_DOCUMENT_SIZE);
+
+        const char*   text   = breaks[i >> 1];
+        const size_t  length = strlen(text);
+        const int64_t offset = testDocumentLength / 2 + Test_Random(1000);
+        memmove(testDocument + offset + length, testDocument + offset, (size_t)(testDocumentLength - offset + 1));
+        memcpy(testDocument + offset, text, length);
+        testDocumentLength += (int64_t)length;
+
+        Test_CompareParallel(JsonParseFlags_Default, 4, buffer, bufferSize, serialBuffer, bufferSize);
+    }
+
+    Test_MakeDocument(false, TEST_DOCUMENT_SIZE);
+    Test_Append("  [1]");
+    Test_CompareParallel(JsonParseFlags_Default, 4, buffer, bufferSize, serialBuffer, bufferSize);
+
+    // Packed number arrays are joined across the parts
+    testDocumentLength = 0;
+    Test_Append("[");
+    for (int32_t i = 0; testDocumentLength < TEST_DOCUMENT_SIZE; i++)
+    {
+        char number[16];
+        sprintf(number, i ? ",%d" : "%d", i - 3000);
+        Test_Append(number);
+    }
+    Test_Append("]");
+
+    Json value;
+    const JsonResult packedResult = JsonParseParallel(testDocument, testDocumentLength, JsonParseFlags_PackNumberArrays, 4, buffer, bufferSize, &value);
+    TEST_CHECK(packedResult.error == JsonError_None);
+    TEST_CHECK(value.type == JsonType_Int32Array && value.int32Array[0] == -3000 && value.int32Array[value.length - 1] == value.length - 3001);
+
+    // The items freed by packing are not counted, the usage is the one of the serial parser
+    const JsonResult serialPackedResult = JsonParse(testDocument, (int32_t)testDocumentLength, JsonParseFlags_PackNumberArrays, serialBuffer, bufferSize, &value);
+    TEST_CHECK(serialPackedResult.error == JsonError_None && packedResult.memoryUsage >= value.length * (int32_t)sizeof(int32_t));
+    TEST_CHECK(packedResult.memoryUsage <= serialPackedResult.memoryUsage);
+
+    // Lazy numbers keep their text: a large integer leaves the array unpacked, as in the serial parser
+    const JsonParseFlags lazyPacked = (JsonParseFlags)(JsonParseFlags_PackNumberArrays | JsonParseFlags_LazyNumbers);
+    Test_CompareParallel(lazyPacked, 4, buffer, bufferSize, serialBuffer, bufferSize);
+    TEST_CHECK(JsonParseParallel(testDocument, testDocumentLength, lazyPacked, 4, buffer, bufferSize, &value).error == JsonError_None);
+    TEST_CHECK(value.type == JsonType_Int32Array);
+
+    testDocument[testDocumentLength - 1] = ',';
+    Test_Append("12345678901234567890]");
+    Test_CompareParallel(lazyPacked, 4, buffer, bufferSize, serialBuffer, bufferSize);
+    TEST_CHECK(JsonParseParallel(testDocument, testDocumentLength, lazyPacked, 4, buffer, bufferSize, &value).error == JsonError_None);
+    TEST_CHECK(value.type == JsonType_Array && value.array[value.length - 1].length == -20);
+    TEST_CHECK(strncmp(value.array[value.length - 1].rawNumber, "12345678901234567890", 20) == 0);
+
+    testDocumentLength -= 22;
+    Test_Append("]");
+
+    testDocument[testDocumentLength - 1] = ',';
+    Test_Append("1.5]");
+    TEST_CHECK(JsonParseParallel(testDocument, testDocumentLength, JsonParseFlags_PackNumberArrays, 4, buffer, bufferSize, &value).error == JsonError_None);
+    TEST_CHECK(value.type == JsonType_NumberArray && value.numberArray[3] == -2997 && value.numberArray[value.length - 1] == 1.5);
+
+    // Negative zero keeps its sign, so it is not packed as an int32_t
+    testDocumentLength -= 4;
+    Test_Append("-0]");
+    TEST_CHECK(JsonParseParallel(testDocument, testDocumentLength, JsonParseFlags_PackNumberArrays, 4, buffer, bufferSize, &value).error == JsonError_None);
+    TEST_CHECK(value.type == JsonType_NumberArray && value.numberArray[value.length - 1] == 0 && signbit(value.numberArray[value.length - 1]));
+
+    // Empty top level containers and too small buffers
+    memset(testDocument, ' ', TEST_DOCUMENT_SIZE);
+    testDocument[0]                      = '[';
+    testDocument[TEST_DOCUMENT_SIZE - 1] = ']';
+    TEST_CHECK(JsonParseParallel(testDocument, TEST_DOCUMENT_SIZE, JsonParseFlags_Default, 4, buffer, bufferSize, &value).error == JsonError_None);
+    TEST_CHECK(value.type == JsonType_Array && value.length == 0);
+
+    Test_MakeDocument(false, TEST_DOCUMENT_SIZE);
+    TEST_CHECK(JsonParseParallel(testDocument, testDocumentLength, JsonParseFlags_Default, 4, buffer, 200000, &value).error == JsonError_OutOfMemory);
+
+    free(testDocument);
+    free(serialBuffer);
+    free(buffer);
+}
+
+// -------------------------------------------------------------------
+// JsonParseFiles
+// -------------------------------------------------------------------
+
+#define TEST_FILES_COUNT 400
+
+/* What a run of JsonParseFiles handed over, per file */
+typedef struct TestFiles
+{
+    TestMutex   mutex;
+    int32_t     stopAt;
+    int32_t     calls;
+    int32_t     seen[TEST_FILES_COUNT];
+    JsonError   errors[TEST_FILES_COUNT];
+    int32_t     ids[TEST_FILES_COUNT];
+} TestFiles;
+
+static char*     testFilesPaths[TEST_FILES_COUNT];
+static TestFiles testFiles;
+
+/* Files are missing, unreadable (a directory), malformed or too large for small arenas at these indices */
+static bool Test_IsMissingFile(int32_t index)    { return index % 97 == 3; }
+static bool Test_IsDirectory(int32_t index)      { return index % 101 == 4; }
+static bool Test_IsMalformedFile(int32_t index)  { return index % 71 == 9; }
+static bool Test_IsLargeFile(int32_t index)      { return index % 43 == 0; }
+
+static bool Test_OnFile(void* user, int32_t index, const Json value, const JsonResult* result)
+{
+    TestFiles* files = (TestFiles*)user;
+
+    int32_t id = -1;
+    Json    member;
+    if (result->error == JsonError_None)
+    {
+        TEST_CHECK(JsonFind(value, "id", &member) && member.type == JsonType_Number);
+        id = (int32_t)member.number;
+        TEST_CHECK(JsonFind(value, "data", &member) && member.type == JsonType_Array);
+    }
+    else
+    {
+        TEST_CHECK(result->message && result->message[0]);
+    }
+
+    TestMutex_Lock(&files->mutex);
+    files->seen[index]++;
+    files->errors[index] = result->error;
+    files->ids[index]    = id;
+    files->calls++;
+    const bool goOn = files->stopAt == 0 || files->calls < files->stopAt;
+    TestMutex_Unlock(&files->mutex);
+    return goOn;
+}
+
+static JsonError Test_ParseFiles(int32_t count, int32_t threadCount, int32_t stopAt, void* buffer, int64_t bufferSize)
+{
+    TestFiles* files = &testFiles;
+    files->stopAt = stopAt;
+    files->calls  = 0;
+    memset(files->seen, 0, sizeof(files->seen));
+    return JsonParseFiles((const char* const*)testFilesPaths, count, JsonParseFlags_Default, threadCount, Test_OnFile, files, buffer, bufferSize);
+}
+
+static void Test_MakeFiles(void)
+{
+    for (int32_t i = 0; i < TEST_FILES_COUNT; i++)
+    {
+        char path[64];
+        sprintf(path, Test_IsDirectory(i) ? "src" : "json_parallel_test_%d.tmp", i);
+        testFilesPaths[i] = (char*)malloc(strlen(path) + 1);
+        strcpy(testFilesPaths[i], path);
+
+        if (Test_IsDirectory(i))
+        {
+            continue;
+        }
+
+        remove(testFilesPaths[i]);
+        if (Test_IsMissingFile(i))
+        {
+            continue;
+        }
+
+        FILE* file = fopen(testFilesPaths[i], "wb");
+        TEST_CHECK(file != NULL);
+        if (file)
+        {
+            const int32_t items = Test_IsLargeFile(i) ? 20000 : (int32_t)Test_Random(200);
+            fprintf(file, "{\"id\":%d,\"data\":[", i);
+            for (int32_t k = 0; k < items; k++)
+            {
+                fprintf(file, "%s{\"k\":%d,\"s\":\"v\\\"%d]\"}", k ? "," : "", k, k);
+            }
+            fprintf(file, Test_IsMalformedFile(i) ? "]" : "]}");
+            fclose(file);
+        }
+    }
+}
+
+static void Test_Files(void)
+{
+    const int64_t bufferSize = (int64_t)1 << 27;
+    char* buffer = (char*)malloc((size_t)bufferSize);
+
+    Test_MakeFiles();
+    TestMutex_Init(&testFiles.mutex);
+
+    for (int32_t t = 0; t < (int32_t)(sizeof(testThreadCounts) / sizeof(testThreadCounts[0])); t++)
+    {
+        TEST_CHECK(Test_ParseFiles(TEST_FILES_COUNT, testThreadCounts[t], 0, buffer, bufferSize) == JsonError_None);
+
+        int32_t mismatches = 0;
+        for (int32_t i = 0; i < TEST_FILES_COUNT; i++)
+        {
+            bool expected;
+            if (Test_IsMissingFile(i) || Test_IsDirectory(i))
+            {
+                expected = testFiles.errors[i] == JsonError_FileUnreadable;
+            }
+            else if (Test_IsMalformedFile(i))
+            {
+                expected = testFiles.errors[i] != JsonError_None && testFiles.errors[i] != JsonError_FileUnreadable;
+            }
+            else
+            {
+                expected = testFiles.errors[i] == JsonError_None && testFiles.ids[i] == i;
+            }
+
+            mismatches += testFiles.seen[i] != 1 || !expected;
+        }
+        if (mismatches > 0)
+        {
+            fprintf(stderr, "%d files differ with %d threads\n", mismatches, testThreadCounts[t]);
+            testFailures++;
+        }
+    }
+
+    // Stopping leaves at most one file per other worker in flight
+    TEST_CHECK(Test_ParseFiles(TEST_FILES_COUNT, 4, 50, buffer, bufferSize) == JsonError_InvalidValue);
+    TEST_CHECK(testFiles.calls >= 50 && testFiles.calls < 54);
+
+    // Files larger than the arena of a worker fail alone
+    static char small[300000];
+    TEST_CHECK(Test_ParseFiles(TEST_FILES_COUNT, 2, 0, small, sizeof(small)) == JsonError_None);
+    for (int32_t i = 0; i < TEST_FILES_COUNT; i++)
+    {
+        TEST_CHECK(testFiles.seen[i] == 1);
+        TEST_CHECK(!Test_IsLargeFile(i) || Test_IsMissingFile(i) || Test_IsDirectory(i) || testFiles.errors[i] == JsonError_OutOfMemory);
+    }
+
+    char tiny[100];
+    TEST_CHECK(Test_ParseFiles(TEST_FILES_COUNT, 2, 0, tiny, sizeof(tiny)) == JsonError_OutOfMemory);
+    TEST_CHECK(Test_ParseFiles(0, 2, 0, buffer, bufferSize) == JsonError_None && testFiles.calls == 0);
+
+    TestMutex_Destroy(&testFiles.mutex);
+    for (int32_t i = 0; i < TEST_FILES_COUNT; i++)
+    {
+        if (!Test_IsDirectory(i))
+        {
+            remove(testFilesPaths[i]);
+        }
+        free(testFilesPaths[i]);
+    }
+    free(buffer);
+}
+
+// -------------------------------------------------------------------
+// First parses racing on plain threads
+// -------------------------------------------------------------------
+
+#define TEST_RACE_THREADS 4
+
+static char testRaceBuffers[TEST_RACE_THREADS][1 << 16];
+
+TEST_THREAD_FUNC(Test_RaceWorker)
+{
+    char*       buffer = (char*)argument;
+    const char* text   = "{\"a\":[1,2,3],\"b\":\"  text  \",\"c\":{\"d\":null}}";
+
+    Json value;
+    const JsonResult result = JsonParse(text, (int32_t)strlen(text), JsonParseFlags_Default, buffer, sizeof(testRaceBuffers[0]), &value);
+    TEST_CHECK(result.error == JsonError_None && value.type == JsonType_Object && value.length == 3);
+    TEST_CHECK(JsonValidate(text, (int32_t)strlen(text), JsonParseFlags_Default, NULL) == JsonError_None);
+    TEST_THREAD_RETURN;
+}
+
+/* Must run before anything else parses, the scanning kernels are picked by the first call of the process */
+static void Test_FirstParseRace(void)
+{
+    TestThread threads[TEST_RACE_THREADS];
+    for (int32_t i = 0; i < TEST_RACE_THREADS; i++)
+    {
+        Test_StartThread(&threads[i], Test_RaceWorker, testRaceBuffers[i]);
+    }
+
+    for (int32_t i = 0; i < TEST_RACE_THREADS; i++)
+    {
+        Test_JoinThread(threads[i]);
+    }
+}
+
+int main(void)
+{
+    Test_FirstParseRace();
+    Test_Lines();
+    Test_SparseLines();
+    Test_TightLines();
+    Test_Parallel();
+    Test_Files();
+
+    if (testFailures > 0)
+    {
+        fprintf(stderr, "Parallel tests failed: %d checks\n", testFailures);
+        return 1;
+    }
+
+    printf("Parallel tests succeed.\n");
+    return 0;
+}
@@ -93,7 +93,7 @@ int main(int argc, char* argv[])
         }
     }
 
-    printf("Unit testing succeed.\n");
+    printf("Unit testing succeed (%s kernels).\n", JsonKernelName());
     free(allocatorBuffer);
     free(fileBuffer);
 